@@ -4,6 +4,7 @@
 #include <iomanip>
 #include <fstream>
 #include <algorithm>
+#include <cmath>
 #ifdef _WIN32
 #include <direct.h>
 #else
@@ -12,6 +13,24 @@
 
 namespace latency {
 
+// "RTSP/TCP", "RTP/UDP", "RTP/UDP batched" or "File"
+static std::string connectionLabel(const VideoDecoder& decoder) {
+    if (decoder.getDetectedProtocol() == StreamProtocol::LOCAL_FILE) {
+        return "File";
+    }
+
+    std::string protoStr = (decoder.getDetectedProtocol() == StreamProtocol::RTP) ? "RTP" : "RTSP";
+    const auto& diag = decoder.getConnectionDiagnostics();
+    std::string transportStr = "TCP";
+    if (!diag.attempts.empty()) {
+        transportStr = (diag.attempts.back().transport == TransportProtocol::UDP) ? "UDP" : "TCP";
+    }
+    if (decoder.isBatchedUdp()) {
+        transportStr += " batched";
+    }
+    return protoStr + "/" + transportStr;
+}
+
 App::App() = default;
 
 App::~App() {
@@ -70,14 +89,89 @@ bool App::init(const AppConfig& config) {
         if (!largeFont_) largeFont_ = TTF_OpenFont(path, 72);
         if (smallFont_ && font_ && largeFont_) break;
     }
+    smallText_ = std::make_unique<GlyphAtlas>();
+    smallText_->init(renderer_, smallFont_, config_.textAtlas);
+    text_ = std::make_unique<GlyphAtlas>();
+    text_->init(renderer_, font_, config_.textAtlas);
+
+    statsPanel_ = std::make_unique<PanelCache>(renderer_);
+    historyPanel_ = std::make_unique<PanelCache>(renderer_);
+    helpPanel_ = std::make_unique<PanelCache>(renderer_);
+    aboutPanel_ = std::make_unique<PanelCache>(renderer_);
+    diagnosticsPanel_ = std::make_unique<PanelCache>(renderer_);
+
+    streamConfig_.decoderThreading = config_.decoderThreading;
+    streamConfig_.decoderThreadCount = config_.decoderThreadCount;
+    streamConfig_.udpReceive = config_.udpReceive;
+    streamConfig_.senderClockOffsetMs = config_.senderClockOffsetMs;
 
     // Initialize components
     timestampDisplay_ = std::make_unique<TimestampDisplay>();
-    timestampDisplay_->init(renderer_, config_.fontPath, config_.fontSize);
-
+    timestampDisplay_->init(renderer_, config_.fontPath, config_.fontSize, config_.textAtlas);
+    timestampDisplay_->setPatternRows(config_.patternRows);
+    displayTiming_ = std::make_unique<DisplayTiming>();
+    displayTiming_->init(window_, config_.displayLagMs);
+
+    packetRecorder_ = std::make_unique<PacketRecorder>();
+    packetRecorder_->setLimits(config_.packetBufferSec,
+                               static_cast<size_t>(std::max(1, config_.packetBufferMaxMB)) * 1024 * 1024);
     videoDecoder_ = std::make_unique<VideoDecoder>();
+    videoDecoder_->setPacketRecorder(packetRecorder_.get());
+    if (!config_.frameExportName.empty()) {
+        if (!config_.streamUrls.empty()) {
+            std::cerr << "Frame export is single-stream only; not exporting" << std::endl;
+        } else {
+            framePublisher_ = std::make_unique<FramePublisher>();
+            if (framePublisher_->open(config_.frameExportName, config_.frameExportSlots,
+                                      config_.frameExportMaxWidth, config_.frameExportMaxHeight)) {
+                framePublisher_->attach(videoDecoder_->getFrameBus());
+            } else {
+                std::cerr << "Frame export disabled: " << framePublisher_->getLastError() << std::endl;
+                framePublisher_.reset();
+            }
+        }
+    }
     videoRenderer_ = std::make_unique<VideoRenderer>();
     videoRenderer_->init(renderer_);
+    resultsManager_ = std::make_unique<ResultsManager>();
+    resultsManager_->setWarmupFrames(config_.test.warmupFrames);
+    latencyMeasurer_ = std::make_unique<LatencyMeasurer>();
+    if (config_.flashMode) {
+        if (!config_.streamUrls.empty()) {
+            std::cerr << "Flash mode is single-stream only; reading the pattern" << std::endl;
+        } else {
+            flashDetector_ = std::make_unique<FlashDetector>();
+            timestampDisplay_->setFlashMode(true);
+        }
+    }
+    if (config_.clockOcr && !flashDetector_) {
+        clockReader_ = std::make_unique<ClockReader>();
+        if (!clockReader_->init(timestampDisplay_->getClockFont())) {
+            std::cerr << "Clock digit templates unavailable; no OCR fallback" << std::endl;
+            clockReader_.reset();
+        }
+    }
+
+    // Impairment relay: receivers connect to it instead of the camera
+    if (config_.impairment.mode != ImpairmentMode::NONE) {
+        impairmentProxy_ = std::make_unique<ImpairmentProxy>();
+        if (!impairmentProxy_->start(config_.impairment)) {
+            std::cerr << "Failed to start impairment relay: " << impairmentProxy_->getLastError() << std::endl;
+            return false;
+        }
+    }
+
+    // Multi-stream mode: decoders share a bounded worker pool, one tile each
+    if (!config_.streamUrls.empty()) {
+        streamManager_ = std::make_unique<StreamManager>(
+            static_cast<size_t>(std::max(0, config_.workerThreads)), timestampDisplay_.get());
+        streamManager_->setStreams(config_.streamUrls);
+        for (size_t i = 0; i < config_.streamUrls.size(); i++) {
+            auto tile = std::make_unique<VideoRenderer>();
+            tile->init(renderer_);
+            tileRenderers_.push_back(std::move(tile));
+        }
+    }
 
     // Load connection history
     historyFilePath_ = "connection_history.txt";
@@ -99,18 +193,87 @@ bool App::init(const AppConfig& config) {
 void App::run() {
     appRunning_ = true;
 
+    // A measured frame waits for its present time to complete the latency budget
+    bool budgetPending = false;
+    double budgetMeasuredMs = 0.0;
+    FrameTimeline budgetTimeline;
+    std::chrono::steady_clock::time_point budgetDequeuedAt;
+
     while (appRunning_) {
         handleEvents();
 
-        // Process video frames (unless paused)
-        if (videoDecoder_->isConnected() && !paused_) {
+        if (streamManager_) {
+            // Show only the newest frame of each stream; measurement already
+            // happened on the worker pool
+            for (size_t i = 0; i < streamManager_->getStreamCount(); i++) {
+                auto& decoder = streamManager_->getStream(i).getDecoder();
+                SharedFrame latest;
+                while (auto frame = decoder.getFrame()) {
+                    latest = std::move(frame);
+                }
+                if (latest) {
+                    tileRenderers_[i]->updateFrame(std::move(latest));
+                }
+            }
+
+            uint32_t ticks = SDL_GetTicks();
+            if (state_ == AppState::Running && ticks - lastScalingSampleTicks_ >= 1000) {
+                streamManager_->sampleScaling();
+                lastScalingSampleTicks_ = ticks;
+            }
+        } else if (videoDecoder_->isConnected() && !paused_) {
+            // Process video frames (unless paused)
             auto frame = videoDecoder_->getFrame();
             if (frame) {
+                auto dequeuedAt = std::chrono::steady_clock::now();
+                if (state_ == AppState::Running) {
+                    uint32_t now = timestampDisplay_->getCurrentTimestamp();
+                    auto measurement = flashDetector_
+                        ? flashDetector_->process(*frame, now, *timestampDisplay_)
+                        : latencyMeasurer_->measure(frame.get(), now);
+                    if (!measurement.valid && clockReader_) {
+                        measurement = clockReader_->measure(*frame, now);
+                    }
+                    resultsManager_->addMeasurement(measurement);
+                    if (frame->senderClock != SenderClockSource::None) {
+                        resultsManager_->addSenderLatency(frame->senderLatencyMs, frame->senderClock);
+                    }
+                    if (measurement.valid) {
+                        lastMeasurement_ = measurement;
+                        if (frame->timeline.valid) {
+                            budgetPending = true;
+                            budgetMeasuredMs = measurement.latencyMs;
+                            budgetTimeline = frame->timeline;
+                            budgetDequeuedAt = dequeuedAt;
+                        }
+                    }
+
+                    // Keep the packets that led up to a spike, at most once per buffer window
+                    uint32_t ticks = SDL_GetTicks();
+                    if (config_.spikeThresholdMs > 0 && measurement.valid &&
+                        measurement.latencyMs >= config_.spikeThresholdMs &&
+                        ticks - lastSpikeDumpTicks_ >= config_.packetBufferSec * 1000.0) {
+                        lastSpikeDumpTicks_ = ticks;
+                        dumpPacketBuffer("spike_" + std::to_string(measurement.latencyMs) + "ms");
+                    }
+                }
+
+                auto uploadStart = std::chrono::steady_clock::now();
                 videoRenderer_->updateFrame(std::move(frame));
+                double uploadUs = std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - uploadStart).count();
+                videoDecoder_->recordStageTime(PipelineStage::Render, uploadUs);
             }
         }
 
         render();
+        if (budgetPending) {
+            double presentMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - budgetDequeuedAt).count();
+            resultsManager_->addLatencyBreakdown(
+                splitLatency(budgetMeasuredMs, budgetTimeline, budgetDequeuedAt, presentMs));
+            budgetPending = false;
+        }
         SDL_Delay(1);
     }
 }
@@ -118,10 +281,27 @@ void App::run() {
 void App::shutdown() {
     disconnect();
 
+    streamManager_.reset();
+    tileRenderers_.clear();
+    impairmentProxy_.reset();
+
     timestampDisplay_.reset();
+    framePublisher_.reset();
     videoDecoder_.reset();
+    packetRecorder_.reset();
     videoRenderer_.reset();
-
+    if (historyCompare_.joinable()) {
+        historyCompare_.join();
+    }
+    resultsManager_.reset();
+
+    statsPanel_.reset();
+    historyPanel_.reset();
+    helpPanel_.reset();
+    aboutPanel_.reset();
+    diagnosticsPanel_.reset();
+    smallText_.reset();
+    text_.reset();
     if (largeFont_) { TTF_CloseFont(largeFont_); largeFont_ = nullptr; }
     if (font_) { TTF_CloseFont(font_); font_ = nullptr; }
     if (smallFont_) { TTF_CloseFont(smallFont_); smallFont_ = nullptr; }
@@ -151,6 +331,15 @@ void App::handleEvents() {
                     config_.windowHeight = event.window.data2;
                 }
                 break;
+            case SDL_RENDER_TARGETS_RESET:
+            case SDL_RENDER_DEVICE_RESET:
+                // Cached panels lost their contents
+                statsPanel_->invalidate();
+                historyPanel_->invalidate();
+                helpPanel_->invalidate();
+                aboutPanel_->invalidate();
+                diagnosticsPanel_->invalidate();
+                break;
         }
     }
 }
@@ -209,7 +398,7 @@ void App::handleKeyDown(SDL_Keycode key) {
             break;
 
         case SDLK_SPACE:
-            if (state_ == AppState::Running || state_ == AppState::Connected) {
+            if (!streamManager_ && (state_ == AppState::Running || state_ == AppState::Connected)) {
                 togglePause();
             }
             break;
@@ -229,6 +418,30 @@ void App::handleKeyDown(SDL_Keycode key) {
             }
             break;
 
+        case SDLK_t:
+            if (state_ == AppState::Disconnected) {
+                cycleDecoderThreading();
+            }
+            break;
+
+        case SDLK_h:
+            showingStageLatency_ = !showingStageLatency_;
+            break;
+
+        case SDLK_r:
+            if (state_ != AppState::Disconnected) resetStageStats();
+            break;
+
+        case SDLK_b:
+            if (!streamManager_ && videoDecoder_->isConnected()) {
+                dumpPacketBuffer("manual");
+            }
+            break;
+
+        case SDLK_e:
+            if (state_ == AppState::Running) exportResults();
+            break;
+
         case SDLK_ESCAPE:
             if (showingHelp_ || showingAbout_) {
                 showingHelp_ = false;
@@ -254,7 +467,7 @@ void App::handleKeyDown(SDL_Keycode key) {
         case SDLK_1: case SDLK_2: case SDLK_3:
         case SDLK_4: case SDLK_5: case SDLK_6:
         case SDLK_7: case SDLK_8: case SDLK_9:
-            if (state_ == AppState::Disconnected && !urlInputActive_) {
+            if (state_ == AppState::Disconnected && !urlInputActive_ && !streamManager_) {
                 int index = key - SDLK_1;
                 selectFromHistory(index);
             }
@@ -280,35 +493,65 @@ void App::render() {
     const int bottomBarHeight = 35;
     const int contentHeight = config_.windowHeight - topBarHeight - bottomBarHeight;
 
+    displayTiming_->beginFrame();
     renderUI();
 
-    // Timestamp display (left panel) - pass paused state to freeze the clock
+    // Timestamp display (left panel) - pass paused state to freeze the clock.
+    // Each pattern row shows the time it is expected on screen, not the time
+    // it is drawn; rows further down are scanned out later. The first row is
+    // predicted last, as it sets the display's reported scan-out lead.
     int timestampWidth = config_.timestampPanelWidth;
+    TimestampDisplay::PatternRowTimes rowShownAt;
+    for (int row = timestampDisplay_->getPatternRows() - 1; row >= 0; row--) {
+        rowShownAt[row] = displayTiming_->predictScanout(
+            topBarHeight + timestampDisplay_->patternOffsetY(row, contentHeight));
+    }
+    if (timestampDisplay_->getPatternRows() > 1) {
+        displayRowSkewMs_ = std::chrono::duration<double, std::milli>(rowShownAt[1] - rowShownAt[0]).count();
+    }
     timestampDisplay_->render(
         padding,
         topBarHeight,
         timestampWidth - padding * 2,
         contentHeight,
         paused_,
-        pausedTimestamp_
+        pausedTimestamp_,
+        rowShownAt
     );
 
-    // Video (right panel)
+    // Video (right panel) - one tile per stream in multi-stream mode
     int videoX = timestampWidth;
     int videoWidth = config_.windowWidth - videoX - padding;
-    videoRenderer_->render(
-        videoX,
-        topBarHeight,
-        videoWidth,
-        contentHeight
-    );
+    if (streamManager_) {
+        renderStreamTiles(videoX, topBarHeight, videoWidth, contentHeight);
+    } else {
+        videoRenderer_->render(
+            videoX,
+            topBarHeight,
+            videoWidth,
+            contentHeight
+        );
+        if (state_ == AppState::Running && !paused_ && resultsManager_->getCurrentBudget().getCount() > 0) {
+            renderLatencyBudget(videoX + padding, topBarHeight + padding, std::min(videoWidth - padding * 2, 640));
+        }
+    }
+
+    // Overlays are composited from cached textures, redrawn only when what they show changes
+    const int windowWidth = config_.windowWidth;
+    const int windowHeight = config_.windowHeight;
 
-    // Stats panel (before pause overlay so it's visible when not paused)
-    renderStatsPanel();
+    // Stats panel (before pause overlay so it's visible when not paused).
+    // Layout changes redraw it at once, values at most every STATS_REFRESH_MS.
+    uint64_t statsKey = PanelCache::combine(static_cast<uint64_t>(state_), showingStageLatency_ ? 1 : 0);
+    statsPanel_->render(windowWidth, windowHeight, statsKey, STATS_REFRESH_MS, [this] { renderStatsPanel(); });
 
     // Connection history (when disconnected)
-    if (state_ == AppState::Disconnected && !connectionHistory_.empty()) {
-        renderConnectionHistory();
+    if (state_ == AppState::Disconnected && !connectionHistory_.empty() && !streamManager_) {
+        uint64_t historyKey = connectionHistory_.size();
+        for (const auto& url : connectionHistory_) {
+            historyKey = PanelCache::combine(historyKey, url);
+        }
+        historyPanel_->render(windowWidth, windowHeight, historyKey, 0, [this] { renderConnectionHistory(); });
     }
 
     // Pause overlay
@@ -316,20 +559,27 @@ void App::render() {
         renderPauseOverlay();
     }
 
-    // Help/About panels
+    // Help/About panels never change
     if (showingHelp_) {
-        renderHelpPanel();
+        helpPanel_->render(windowWidth, windowHeight, 0, 0, [this] { renderHelpPanel(); });
     }
     if (showingAbout_) {
-        renderAboutPanel();
+        aboutPanel_->render(windowWidth, windowHeight, 0, 0, [this] { renderAboutPanel(); });
     }
     if (showingDiagnostics_) {
-        renderDiagnosticsPanel();
+        const auto& diag = videoDecoder_->getConnectionDiagnostics();
+        uint64_t diagnosticsKey = PanelCache::combine(diag.attempts.size(), diag.suggestions.size());
+        diagnosticsKey = PanelCache::combine(diagnosticsKey, diag.summary);
+        diagnosticsKey = PanelCache::combine(diagnosticsKey, diag.url);
+        diagnosticsKey = PanelCache::combine(diagnosticsKey, static_cast<uint64_t>(streamConfig_.transport));
+        diagnosticsPanel_->render(windowWidth, windowHeight, diagnosticsKey, 0, [this] { renderDiagnosticsPanel(); });
     }
 
     renderStatusBar();
 
+    displayTiming_->endFrame();
     SDL_RenderPresent(renderer_);
+    displayTiming_->onPresented();
 }
 
 void App::renderUI() {
@@ -362,18 +612,7 @@ void App::renderInputField(int x, int y, int width, int height,
                             const std::string& label, const std::string& value, bool active) {
     // Label above the input
     SDL_Color labelColor = active ? SDL_Color{255, 255, 100, 255} : SDL_Color{150, 150, 150, 255};
-    if (smallFont_) {
-        SDL_Surface* surface = TTF_RenderText_Blended(smallFont_, label.c_str(), labelColor);
-        if (surface) {
-            SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, surface);
-            if (texture) {
-                SDL_Rect rect = {x, y, surface->w, surface->h};
-                SDL_RenderCopy(renderer_, texture, nullptr, &rect);
-                SDL_DestroyTexture(texture);
-            }
-            SDL_FreeSurface(surface);
-        }
-    }
+    smallText_->draw(label, x, y, labelColor);
 
     // Input box with highlight when active
     SDL_Rect boxRect = {x, y + 20, width, height};
@@ -390,32 +629,17 @@ void App::renderInputField(int x, int y, int width, int height,
     }
     SDL_RenderDrawRect(renderer_, &boxRect);
 
-    // URL text
-    if (smallFont_ && !value.empty()) {
-        SDL_Color textColor = {255, 255, 255, 255};
-        SDL_Surface* surface = TTF_RenderText_Blended(smallFont_, value.c_str(), textColor);
-        if (surface) {
-            SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, surface);
-            if (texture) {
-                // Clip to box width
-                SDL_Rect srcRect = {0, 0, std::min(surface->w, width - 10), surface->h};
-                SDL_Rect dstRect = {x + 5, y + 23, srcRect.w, srcRect.h};
-                SDL_RenderCopy(renderer_, texture, &srcRect, &dstRect);
-                SDL_DestroyTexture(texture);
-            }
-            SDL_FreeSurface(surface);
-        }
-    }
+    // URL text, clipped to box width
+    SDL_Color textColor = {255, 255, 255, 255};
+    smallText_->draw(value, x + 5, y + 23, textColor, width - 10);
 
     // Blinking cursor when active
     if (active) {
         uint32_t ticks = SDL_GetTicks();
         if ((ticks / 500) % 2 == 0) {
             int cursorX = x + 5;
-            if (smallFont_ && !value.empty()) {
-                int textWidth;
-                TTF_SizeText(smallFont_, value.c_str(), &textWidth, nullptr);
-                cursorX = x + 5 + std::min(textWidth, width - 15);
+            if (!value.empty()) {
+                cursorX = x + 5 + std::min(smallText_->measure(value), width - 15);
             }
             SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 255);
             SDL_RenderDrawLine(renderer_, cursorX, y + 24, cursorX, y + 20 + height - 4);
@@ -431,19 +655,9 @@ void App::renderButton(int x, int y, int width, int height,
     SDL_SetRenderDrawColor(renderer_, enabled ? 80 : 50, enabled ? 120 : 50, enabled ? 180 : 60, 255);
     SDL_RenderDrawRect(renderer_, &rect);
 
-    if (smallFont_) {
-        SDL_Color color = enabled ? SDL_Color{255, 255, 255, 255} : SDL_Color{100, 100, 100, 255};
-        SDL_Surface* surface = TTF_RenderText_Blended(smallFont_, text.c_str(), color);
-        if (surface) {
-            SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, surface);
-            if (texture) {
-                SDL_Rect textRect = {x + (width - surface->w) / 2, y + (height - surface->h) / 2, surface->w, surface->h};
-                SDL_RenderCopy(renderer_, texture, nullptr, &textRect);
-                SDL_DestroyTexture(texture);
-            }
-            SDL_FreeSurface(surface);
-        }
-    }
+    SDL_Color color = enabled ? SDL_Color{255, 255, 255, 255} : SDL_Color{100, 100, 100, 255};
+    smallText_->draw(text, x + (width - smallText_->measure(text)) / 2,
+                     y + (height - smallText_->getHeight()) / 2, color);
 }
 
 void App::renderPauseOverlay() {
@@ -467,14 +681,36 @@ void App::renderStatsPanel() {
         return;  // No stats to show
     }
 
+    if (streamManager_) {
+        renderScalingPanel();
+        return;
+    }
+
     auto stats = videoDecoder_->getDecodeStats();
     const auto& streamInfo = videoDecoder_->getStreamInfo();
 
+    if (showingStageLatency_) {
+        renderStageLatencyPanel(stats);
+        return;
+    }
+
     // Stats panel position - bottom right corner, above status bar
     const int panelWidth = 280;
     const int lineHeight = 18;
     const int padding = 8;
-    int numLines = 12;
+    bool hasSenderClock = stats.senderClock != SenderClockSource::None;
+    // Frame bus consumers besides the display queue, one row each
+    auto subscribers = videoDecoder_->getFrameBus().getStats();
+    int extraSubscribers = static_cast<int>(subscribers.size()) - 1;
+    std::string historyStatus;
+    bool historyRegression = false;
+    {
+        std::lock_guard<std::mutex> lock(historyMutex_);
+        historyStatus = historyStatus_;
+        historyRegression = historyRegression_;
+    }
+    int numLines = 21 + (flashDetector_ ? 0 : 1) + (impairmentProxy_ ? 1 : 0) + (framePublisher_ ? 1 : 0) + (clockReader_ ? 1 : 0) +
+                   (timestampDisplay_->getPatternRows() > 1 ? 1 : 0) + (hasSenderClock ? 1 : 0) + (historyStatus.empty() ? 0 : 1) + (stats.hasRtpStats ? 4 : 0) + std::max(0, extraSubscribers);
     const int panelHeight = lineHeight * numLines + padding * 2;
     const int panelX = config_.windowWidth - panelWidth - padding;
     const int panelY = config_.windowHeight - 30 - panelHeight - padding;
@@ -515,17 +751,14 @@ void App::renderStatsPanel() {
     renderText(stats.hwAccelType, valueX, y, accelColor);
     y += lineHeight;
 
+    // Decoder threading actually in use
+    renderText("Threading:", labelX, y, labelColor);
+    renderText(stats.threading, valueX, y, valueColor);
+    y += lineHeight;
+
     // Transport protocol (TCP/UDP)
     renderText("Transport:", labelX, y, labelColor);
-    {
-        std::string protoStr = (videoDecoder_->getDetectedProtocol() == StreamProtocol::RTP) ? "RTP" : "RTSP";
-        const auto& diag = videoDecoder_->getConnectionDiagnostics();
-        std::string transportStr = "TCP";
-        if (!diag.attempts.empty()) {
-            transportStr = (diag.attempts.back().transport == TransportProtocol::UDP) ? "UDP" : "TCP";
-        }
-        renderText(protoStr + "/" + transportStr, valueX, y, valueColor);
-    }
+    renderText(connectionLabel(*videoDecoder_), valueX, y, valueColor);
     y += lineHeight;
 
     // Resolution
@@ -574,15 +807,508 @@ void App::renderStatsPanel() {
     renderText(frameStr.str(), valueX, y, frameColor);
     y += lineHeight;
 
+    // Decoder failures and concealed frames, to tell network damage from a slow decoder
+    renderText("Errors:", labelX, y, labelColor);
+    std::ostringstream errorStr;
+    errorStr << stats.decodeErrors << " dec " << stats.corruptFrames << " corrupt";
+    renderText(errorStr.str(), valueX, y, stats.decodeErrors + stats.corruptFrames > 0 ? yellowColor : valueColor);
+    y += lineHeight;
+
     // Queue depth
     renderText("Queue:", labelX, y, labelColor);
     std::string queueStr = std::to_string(stats.queueDepth) + "/" + std::to_string(stats.maxQueueSize);
     renderText(queueStr, valueX, y, valueColor);
+    y += lineHeight;
+
+    // Each other consumer's queue, how far behind it is and what it lost
+    for (const auto& subscriber : subscribers) {
+        if (subscriber.name == VideoDecoder::DISPLAY_QUEUE) continue;
+        std::ostringstream subStr;
+        subStr << subscriber.depth << "/" << subscriber.capacity << " lag " << subscriber.lagFrames
+               << " drop " << subscriber.dropped;
+        renderText(" " + subscriber.name + ":", labelX, y, labelColor);
+        renderText(subStr.str(), valueX, y, subscriber.dropped > 0 ? yellowColor : valueColor);
+        y += lineHeight;
+    }
+
+    // Latest latency read from the timestamp pattern (or the clock digits)
+    renderText("Latency:", labelX, y, labelColor);
+    if (lastMeasurement_.valid) {
+        bool fromOcr = lastMeasurement_.source == MeasurementSource::Ocr;
+        renderText(std::to_string(lastMeasurement_.latencyMs) + (fromOcr ? " ms (OCR)" : " ms"), valueX, y,
+                   greenColor);
+    } else {
+        renderText(flashDetector_ ? "no edge" : "no pattern", valueX, y, yellowColor);
+    }
+    y += lineHeight;
+
+    // Pattern read yield: frames read (some only after resolving a display
+    // update caught mid-exposure), CRC rejects and full-frame searches
+    // (flash mode: luma sampling cost per frame and edges timed of those seen)
+    if (flashDetector_) {
+        auto flash = flashDetector_->getStats();
+        std::ostringstream flashStr;
+        flashStr << std::fixed << std::setprecision(1) << flash.avgSampleUs << " us "
+                 << flash.matched << "/" << flash.edges << " edges";
+        renderText("Flash:", labelX, y, labelColor);
+        renderText(flashStr.str(), valueX, y, flash.edges > 0 ? valueColor : yellowColor);
+    } else {
+        const auto& reads = latencyMeasurer_->getReadStats();
+        std::ostringstream readStr;
+        readStr << std::fixed << std::setprecision(1)
+                << (reads.frames > 0 ? 100.0 * reads.read / reads.frames : 0.0) << "% "
+                << reads.corrected << " fix " << reads.rejected << " crc " << reads.detections << " det";
+        renderText("Pattern:", labelX, y, labelColor);
+        renderText(readStr.str(), valueX, y, valueColor);
+        y += lineHeight;
+
+        // Black/white levels the last read was thresholded between, its
+        // weakest bit, and frames rejected as too faint to trust
+        const auto& quality = latencyMeasurer_->getLastQuality();
+        std::ostringstream levelStr;
+        levelStr << quality.blackLevel << "/" << quality.whiteLevel << " conf "
+                 << std::fixed << std::setprecision(2) << quality.minConfidence << " "
+                 << reads.lowConfidence << " low";
+        renderText("Levels:", labelX, y, labelColor);
+        renderText(levelStr.str(), valueX, y, quality.lowConfidence ? yellowColor : valueColor);
+    }
+    y += lineHeight;
+
+    // Share of frames giving a valid sample over the last few seconds
+    {
+        double validRate = resultsManager_->getRecentValidRate(VALID_RATE_WINDOW_SEC);
+        std::ostringstream validStr;
+        validStr << std::fixed << std::setprecision(1) << 100.0 * validRate << "% last "
+                 << VALID_RATE_WINDOW_SEC << " s";
+        renderText("Valid:", labelX, y, labelColor);
+        renderText(validStr.str(), valueX, y, validRate >= 0.5 ? valueColor : yellowColor);
+    }
+    y += lineHeight;
+
+    // Warmup left out of the statistics and level changes since (change-point detection)
+    {
+        auto regime = resultsManager_->getRegimeStatus();
+        std::ostringstream regimeStr;
+        regimeStr << std::fixed << std::setprecision(1);
+        if (regime.warmingUp) {
+            regimeStr << "warmup";
+        } else if (regime.shifts > 0) {
+            regimeStr << regime.shifts << " shift" << (regime.shifts > 1 ? "s" : "") << ", last "
+                      << regime.lastShiftSec << " s";
+        } else {
+            regimeStr << "steady";
+        }
+        regimeStr << " (from " << regime.warmupSec << " s)";
+        renderText("Regime:", labelX, y, labelColor);
+        renderText(regimeStr.str(), valueX, y, regime.warmingUp || regime.shifts > 0 ? yellowColor : valueColor);
+    }
+    y += lineHeight;
+
+    // Last exported run against the previous one of the same stream setup
+    if (!historyStatus.empty()) {
+        renderText("Vs last run:", labelX, y, labelColor);
+        renderText(historyStatus, valueX, y, historyRegression ? yellowColor : valueColor);
+        y += lineHeight;
+    }
+
+    // Clock digit fallback: frames where the pattern failed and the digits
+    // were read, digits too unsure to use, and full-frame searches
+    if (clockReader_) {
+        const auto& ocr = clockReader_->getReadStats();
+        std::ostringstream ocrStr;
+        ocrStr << std::fixed << std::setprecision(1)
+               << (ocr.frames > 0 ? 100.0 * ocr.read / ocr.frames : 0.0) << "% of "
+               << ocr.frames << " " << ocr.unsure << " unsure " << ocr.searches << " det";
+        renderText("OCR:", labelX, y, labelColor);
+        renderText(ocrStr.str(), valueX, y, valueColor);
+        y += lineHeight;
+    }
+
+    // Top-to-bottom skew: the camera's readout between the pattern rows it
+    // sees, and the display's scan-out between the rows it draws
+    if (timestampDisplay_->getPatternRows() > 1) {
+        auto rows = latencyMeasurer_->getRowStats();
+        std::ostringstream skewStr;
+        skewStr << std::fixed << std::setprecision(1);
+        if (rows.rows > 1 && rows.frames > 0) {
+            skewStr << "cam " << rows.readoutMs() << " ms";
+        } else {
+            skewStr << "cam " << rows.rows << "/" << timestampDisplay_->getPatternRows() << " rows";
+        }
+        skewStr << " disp " << displayRowSkewMs_ << " ms";
+        renderText("Skew:", labelX, y, labelColor);
+        renderText(skewStr.str(), valueX, y, rows.rows > 1 ? valueColor : yellowColor);
+        y += lineHeight;
+    }
+
+    // Refresh the clock is shown at, and the +/- it leaves on each reading
+    auto display = displayTiming_->getStats();
+    std::ostringstream displayStr;
+    displayStr << std::fixed << std::setprecision(0) << 1000.0 / display.periodMs << " Hz +/-"
+               << std::setprecision(1) << display.uncertaintyMs << " ms";
+    if (!display.vsyncLocked) {
+        displayStr << " no vsync";
+    } else if (display.missedVblanks > 0) {
+        displayStr << " " << display.missedVblanks << " miss";
+    }
+    renderText("Display:", labelX, y, labelColor);
+    renderText(displayStr.str(), valueX, y,
+               display.vsyncLocked && display.missedVblanks == 0 ? valueColor : yellowColor);
+    y += lineHeight;
+
+    // Time to draw a frame: it delays the clock's present and widens its spread
+    std::ostringstream renderStr;
+    renderStr << std::fixed << std::setprecision(2) << display.renderMs << " ms"
+              << (smallText_->hasAtlas() ? " (atlas)" : " (TTF)");
+    renderText("Render:", labelX, y, labelColor);
+    renderText(renderStr.str(), valueX, y, valueColor);
+    y += lineHeight;
+
+    // Pre-trigger packet buffer fill and memory
+    auto ring = packetRecorder_->getStats();
+    std::ostringstream ringStr;
+    ringStr << std::fixed << std::setprecision(1) << ring.bufferedSec << "s "
+            << ring.bufferedBytes / (1024.0 * 1024.0) << "/" << std::setprecision(0)
+            << ring.maxBytes / (1024.0 * 1024.0) << " MB";
+    if (ring.writesPending > 0) {
+        ringStr << " saving";
+    }
+    renderText("Buffer:", labelX, y, labelColor);
+    renderText(ringStr.str(), valueX, y, ring.writesPending > 0 ? yellowColor : valueColor);
+    y += lineHeight;
+
+    // Frames handed to external analyzers through the shared-memory ring
+    if (framePublisher_) {
+        auto exported = framePublisher_->getStats();
+        std::ostringstream exportStr;
+        exportStr << exported.published << " " << framePublisher_->getName();
+        if (exported.oversized > 0) {
+            exportStr << " (" << exported.oversized << " too big)";
+        }
+        renderText("Export:", labelX, y, labelColor);
+        renderText(exportStr.str(), valueX, y, exported.oversized > 0 ? yellowColor : valueColor);
+        y += lineHeight;
+    }
+
+    // What the impairment relay has done since the test started
+    if (impairmentProxy_) {
+        auto impaired = impairmentProxy_->getStats();
+        std::ostringstream impairStr;
+        impairStr << "lost " << impaired.packetsLost + impaired.packetsOverflow
+                  << " reord " << impaired.packetsReordered
+                  << " q " << impaired.queuedPackets;
+        renderText("Impair:", labelX, y, labelColor);
+        renderText(impairStr.str(), valueX, y, impaired.lastError.empty() ? valueColor : yellowColor);
+        y += lineHeight;
+    }
+
+    // Latency against the camera's own clock, when it sends one
+    if (hasSenderClock) {
+        std::ostringstream senderStr;
+        senderStr << std::fixed << std::setprecision(1) << stats.senderLatencyMs << " ms "
+                  << senderClockSourceName(stats.senderClock);
+        renderText("Sender lat:", labelX, y, labelColor);
+        renderText(senderStr.str(), valueX, y, valueColor);
+        y += lineHeight;
+    }
+
+    // Batched UDP input: RTP accounting and socket overflows
+    if (stats.hasRtpStats) {
+        const auto& rtp = stats.rtp;
+        std::ostringstream lossStr;
+        lossStr << std::fixed << std::setprecision(2) << rtp.lossPercent << "% / "
+                << std::setprecision(1) << rtp.jitterMs << " ms";
+        renderText("Loss/jitter:", labelX, y, labelColor);
+        renderText(lossStr.str(), valueX, y, rtp.lost > 0 ? yellowColor : valueColor);
+        y += lineHeight;
+
+        std::ostringstream rateStr;
+        rateStr << std::fixed << std::setprecision(1) << rtp.bytesPerSec * 8.0 / 1e6 << " Mb/s "
+                << std::setprecision(0) << rtp.packetsPerSec << "/s";
+        renderText("Rate:", labelX, y, labelColor);
+        renderText(rateStr.str(), valueX, y, valueColor);
+        y += lineHeight;
+
+        renderText("Reorder/dup:", labelX, y, labelColor);
+        renderText(std::to_string(rtp.reordered) + " / " + std::to_string(rtp.duplicates), valueX, y,
+                   rtp.reordered + rtp.duplicates > 0 ? yellowColor : valueColor);
+        y += lineHeight;
+
+        std::ostringstream socketStr;
+        socketStr << stats.udpKernelDrops << " drop " << std::fixed << std::setprecision(1)
+                  << stats.udpPacketsPerCall << "/call";
+        renderText("Socket:", labelX, y, labelColor);
+        renderText(socketStr.str(), valueX, y, stats.udpKernelDrops > 0 ? yellowColor : valueColor);
+    }
+}
+
+void App::renderLatencyBudget(int x, int y, int width) {
+    // Mean split of this run's measurements as a stacked bar, with a legend
+    static const SDL_Color segmentColors[BUDGET_SEGMENT_COUNT] = {
+        {90, 140, 230, 255},   // Camera + network
+        {230, 170, 60, 255},   // Buffering
+        {200, 90, 200, 255},   // Decode
+        {90, 200, 120, 255},   // Queue
+        {200, 200, 200, 255}   // Present
+    };
+    const auto& budget = resultsManager_->getCurrentBudget();
+    const int lineHeight = 18;
+    const int padding = 6;
+    const int barHeight = 14;
+    const int panelHeight = lineHeight * 2 + barHeight + padding * 4;
+
+    SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 200);
+    SDL_Rect panelRect = {x, y, width, panelHeight};
+    SDL_RenderFillRect(renderer_, &panelRect);
+    SDL_SetRenderDrawColor(renderer_, 80, 80, 100, 255);
+    SDL_RenderDrawRect(renderer_, &panelRect);
+
+    SDL_Color headerColor = {100, 200, 255, 255};
+    SDL_Color labelColor = {180, 180, 180, 255};
+
+    int textY = y + padding;
+    std::ostringstream header;
+    header << "LATENCY BUDGET " << std::fixed << std::setprecision(0) << budget.getMeanTotalMs()
+           << " ms (mean of " << budget.getCount() << ")";
+    renderText(header.str(), x + padding, textY, headerColor);
+    textY += lineHeight + padding;
+
+    // Negative means (clock or misread artefacts) take no width
+    const int barWidth = width - padding * 2;
+    double positiveTotal = 0.0;
+    for (size_t i = 0; i < BUDGET_SEGMENT_COUNT; i++) {
+        positiveTotal += std::max(0.0, budget.getMeanMs(static_cast<BudgetSegment>(i)));
+    }
+    int segmentX = x + padding;
+    for (size_t i = 0; i < BUDGET_SEGMENT_COUNT && positiveTotal > 0.0; i++) {
+        double share = std::max(0.0, budget.getMeanMs(static_cast<BudgetSegment>(i))) / positiveTotal;
+        int segmentWidth = i + 1 == BUDGET_SEGMENT_COUNT
+            ? x + padding + barWidth - segmentX
+            : static_cast<int>(share * barWidth + 0.5);
+        SDL_Rect segmentRect = {segmentX, textY, segmentWidth, barHeight};
+        SDL_SetRenderDrawColor(renderer_, segmentColors[i].r, segmentColors[i].g, segmentColors[i].b, 255);
+        SDL_RenderFillRect(renderer_, &segmentRect);
+        segmentX += segmentWidth;
+    }
+    textY += barHeight + padding;
+
+    // Legend: colour key and mean per segment
+    int legendX = x + padding;
+    for (size_t i = 0; i < BUDGET_SEGMENT_COUNT; i++) {
+        auto segment = static_cast<BudgetSegment>(i);
+        SDL_Rect key = {legendX, textY + 4, 10, 10};
+        SDL_SetRenderDrawColor(renderer_, segmentColors[i].r, segmentColors[i].g, segmentColors[i].b, 255);
+        SDL_RenderFillRect(renderer_, &key);
+
+        std::ostringstream item;
+        item << budgetSegmentName(segment) << " " << std::fixed << std::setprecision(0) << budget.getMeanMs(segment);
+        if (segment == BudgetSegment::Buffering && budget.getKernelArrivalCount() == 0) {
+            item << "*";  // Not measured: no kernel arrival times on this input
+        }
+        renderText(item.str(), legendX + 14, textY, labelColor);
+        legendX += width / static_cast<int>(BUDGET_SEGMENT_COUNT);
+    }
+}
+
+void App::renderStreamTiles(int x, int y, int width, int height) {
+    size_t count = streamManager_->getStreamCount();
+    if (count == 0) return;
+
+    // Near-square grid
+    const int gap = 4;
+    int cols = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    int rows = (static_cast<int>(count) + cols - 1) / cols;
+    int tileWidth = (width - gap * (cols - 1)) / cols;
+    int tileHeight = (height - gap * (rows - 1)) / rows;
+
+    SDL_Color titleColor = {255, 255, 255, 255};
+    SDL_Color valueColor = {100, 255, 100, 255};
+    SDL_Color warnColor = {255, 255, 100, 255};
+    SDL_Color errorColor = {255, 100, 100, 255};
+
+    for (size_t i = 0; i < count; i++) {
+        int tileX = x + static_cast<int>(i % cols) * (tileWidth + gap);
+        int tileY = y + static_cast<int>(i / cols) * (tileHeight + gap);
+        tileRenderers_[i]->render(tileX, tileY, tileWidth, tileHeight);
+
+        auto& stream = streamManager_->getStream(i);
+
+        // Label strip across the top of the tile
+        SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 170);
+        SDL_Rect labelRect = {tileX, tileY, tileWidth, 40};
+        SDL_RenderFillRect(renderer_, &labelRect);
+
+        // URL without the scheme, truncated to the tile width
+        std::string url = stream.getUrl();
+        size_t schemeEnd = url.find("://");
+        if (schemeEnd != std::string::npos) url = url.substr(schemeEnd + 3);
+        size_t maxChars = static_cast<size_t>(std::max(8, tileWidth / 10 - 4));
+        if (url.length() > maxChars) url = url.substr(0, maxChars - 3) + "...";
+        renderText("#" + std::to_string(i + 1) + " " + url, tileX + 4, tileY + 2, titleColor);
+
+        if (!stream.isConnected()) {
+            renderText(state_ == AppState::Disconnected ? "idle" : "not connected",
+                       tileX + 4, tileY + 20, errorColor);
+            continue;
+        }
+
+        auto stats = stream.getDecoder().getDecodeStats();
+        auto measurement = stream.getLastMeasurement();
+
+        std::ostringstream line;
+        if (measurement.valid) {
+            line << measurement.latencyMs << " ms";
+        } else {
+            line << "no pattern";
+        }
+        line << " | " << std::fixed << std::setprecision(1) << stats.actualFps << " fps";
+        if (stats.framesDropped > 0) {
+            line << " | " << stats.framesDropped << " drop";
+        }
+        SDL_Color lineColor = measurement.valid && stats.framesDropped == 0 ? valueColor : warnColor;
+        renderText(line.str(), tileX + 4, tileY + 20, lineColor);
+    }
+}
+
+void App::renderScalingPanel() {
+    auto sample = streamManager_->getLatestScaling();
+
+    const int panelWidth = 280;
+    const int lineHeight = 18;
+    const int padding = 8;
+    const int numLines = 8;
+    const int panelHeight = lineHeight * numLines + padding * 2;
+    const int panelX = config_.windowWidth - panelWidth - padding;
+    const int panelY = config_.windowHeight - 30 - panelHeight - padding;
+
+    // Semi-transparent background
+    SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 200);
+    SDL_Rect panelRect = {panelX, panelY, panelWidth, panelHeight};
+    SDL_RenderFillRect(renderer_, &panelRect);
+
+    // Border
+    SDL_SetRenderDrawColor(renderer_, 80, 80, 100, 255);
+    SDL_RenderDrawRect(renderer_, &panelRect);
+
+    SDL_Color headerColor = {100, 200, 255, 255};
+    SDL_Color labelColor = {180, 180, 180, 255};
+    SDL_Color valueColor = {255, 255, 255, 255};
+    SDL_Color yellowColor = {255, 255, 100, 255};
+
+    int y = panelY + padding;
+    int labelX = panelX + padding;
+    int valueX = panelX + 140;
+
+    renderText("MULTI-STREAM", labelX, y, headerColor);
+    y += lineHeight + 4;
+
+    renderText("Streams:", labelX, y, labelColor);
+    renderText(std::to_string(streamManager_->getConnectedCount()) + "/" +
+               std::to_string(streamManager_->getStreamCount()), valueX, y, valueColor);
+    y += lineHeight;
+
+    renderText("Workers:", labelX, y, labelColor);
+    renderText(std::to_string(streamManager_->getWorkerCount()) + " (" +
+               std::to_string(sample.pendingTasks) + " queued)", valueX, y, valueColor);
+    y += lineHeight;
+
+    std::ostringstream cpuStr;
+    cpuStr << std::fixed << std::setprecision(0) << sample.cpuPercent << "% ("
+           << std::setprecision(1) << sample.cpuPerStream << "%/str)";
+    renderText("CPU:", labelX, y, labelColor);
+    renderText(cpuStr.str(), valueX, y, valueColor);
+    y += lineHeight;
+
+    std::ostringstream fpsStr;
+    fpsStr << std::fixed << std::setprecision(1) << sample.totalDecodeFps;
+    renderText("Decode fps:", labelX, y, labelColor);
+    renderText(fpsStr.str(), valueX, y, valueColor);
+    y += lineHeight;
+
+    renderText("Dropped:", labelX, y, labelColor);
+    renderText(std::to_string(sample.framesDropped), valueX, y,
+               sample.framesDropped > 0 ? yellowColor : valueColor);
+    y += lineHeight;
+
+    renderText("Cores:", labelX, y, labelColor);
+    renderText(std::to_string(std::thread::hardware_concurrency()), valueX, y, valueColor);
+}
+
+void App::renderStageLatencyPanel(const DecodeStats& stats) {
+    // Compact per-stage percentile table, same corner as the decode stats
+    const int panelWidth = 340;
+    const int lineHeight = 18;
+    const int padding = 8;
+    const int numLines = static_cast<int>(PIPELINE_STAGE_COUNT) + 4;
+    const int panelHeight = lineHeight * numLines + padding * 2;
+    const int panelX = config_.windowWidth - panelWidth - padding;
+    const int panelY = config_.windowHeight - 30 - panelHeight - padding;
+
+    // Semi-transparent background
+    SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 200);
+    SDL_Rect panelRect = {panelX, panelY, panelWidth, panelHeight};
+    SDL_RenderFillRect(renderer_, &panelRect);
+
+    // Border
+    SDL_SetRenderDrawColor(renderer_, 80, 80, 100, 255);
+    SDL_RenderDrawRect(renderer_, &panelRect);
+
+    SDL_Color headerColor = {100, 200, 255, 255};
+    SDL_Color labelColor = {180, 180, 180, 255};
+    SDL_Color valueColor = {255, 255, 255, 255};
+    SDL_Color yellowColor = {255, 255, 100, 255};
+
+    // Column positions: stage name, then p50 / p90 / p99 / p99.9
+    const int labelX = panelX + padding;
+    const int columnX[4] = {panelX + 110, panelX + 167, panelX + 224, panelX + 281};
+
+    int y = panelY + padding;
+    renderText("STAGE LATENCY (ms)", labelX, y, headerColor);
+    y += lineHeight + 4;
+
+    renderText("p50", columnX[0], y, labelColor);
+    renderText("p90", columnX[1], y, labelColor);
+    renderText("p99", columnX[2], y, labelColor);
+    renderText("p99.9", columnX[3], y, labelColor);
+    y += lineHeight;
+
+    auto formatMs = [](double us) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(us < 10000.0 ? 2 : 1) << (us / 1000.0);
+        return oss.str();
+    };
+
+    for (size_t i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+        const auto& p = stats.stageLatency[i];
+        renderText(pipelineStageName(static_cast<PipelineStage>(i)), labelX, y, labelColor);
+        if (p.count > 0) {
+            // Highlight a heavy tail (p99.9 more than 4x the median)
+            SDL_Color tailColor = (p.p999Us > p.p50Us * 4.0) ? yellowColor : valueColor;
+            renderText(formatMs(p.p50Us), columnX[0], y, valueColor);
+            renderText(formatMs(p.p90Us), columnX[1], y, valueColor);
+            renderText(formatMs(p.p99Us), columnX[2], y, tailColor);
+            renderText(formatMs(p.p999Us), columnX[3], y, tailColor);
+        } else {
+            renderText("-", columnX[0], y, labelColor);
+        }
+        y += lineHeight;
+    }
+
+    y += 4;
+    const auto& decode = stats.stageLatency[static_cast<size_t>(PipelineStage::Decode)];
+    std::ostringstream windowStr;
+    windowStr << decode.count << " frames / " << std::fixed << std::setprecision(0)
+              << stats.stageWindowSec << " s  [R] reset";
+    renderText(windowStr.str(), labelX, y, labelColor);
 }
 
 void App::renderHelpPanel() {
     const int panelWidth = 500;
-    const int panelHeight = 450;
+    const int panelHeight = 632;
     const int panelX = (config_.windowWidth - panelWidth) / 2;
     const int panelY = (config_.windowHeight - panelHeight) / 2;
     const int padding = 20;
@@ -629,6 +1355,9 @@ void App::renderHelpPanel() {
     y += lineHeight;
     renderText("P", panelX + padding + 20, y, keyColor);
     renderText("Cycle transport (Auto/TCP/UDP)", panelX + padding + 80, y, descColor);
+    y += lineHeight;
+    renderText("T", panelX + padding + 20, y, keyColor);
+    renderText("Cycle decoder threading", panelX + padding + 80, y, descColor);
     y += lineHeight + 8;
 
     // Test section
@@ -639,6 +1368,22 @@ void App::renderHelpPanel() {
     y += lineHeight;
     renderText("S", panelX + padding + 20, y, keyColor);
     renderText("Save screenshot", panelX + padding + 80, y, descColor);
+    y += lineHeight;
+    renderText("E", panelX + padding + 20, y, keyColor);
+    renderText("Export results (starts a new run)", panelX + padding + 80, y, descColor);
+    y += lineHeight;
+    renderText("B", panelX + padding + 20, y, keyColor);
+    renderText("Save last seconds of stream to file", panelX + padding + 80, y, descColor);
+    y += lineHeight + 8;
+
+    // Stats section
+    renderText("STATISTICS:", panelX + padding, y, headerColor);
+    y += lineHeight;
+    renderText("H", panelX + padding + 20, y, keyColor);
+    renderText("Toggle stage latency percentiles", panelX + padding + 80, y, descColor);
+    y += lineHeight;
+    renderText("R", panelX + padding + 20, y, keyColor);
+    renderText("Reset stage latency histograms", panelX + padding + 80, y, descColor);
     y += lineHeight + 8;
 
     // General section
@@ -785,10 +1530,16 @@ void App::renderStatusBar() {
                 case TransportProtocol::TCP:  transportLabel = "TCP"; break;
                 case TransportProtocol::UDP:  transportLabel = "UDP"; break;
             }
+            switch (streamConfig_.decoderThreading) {
+                case DecoderThreading::AUTO:  transportLabel += ", threads auto"; break;
+                case DecoderThreading::FRAME: transportLabel += ", frame threads"; break;
+                case DecoderThreading::SLICE: transportLabel += ", slice threads"; break;
+                case DecoderThreading::NONE:  transportLabel += ", 1 thread"; break;
+            }
             if (!connectionHistory_.empty()) {
-                statusText = "Disconnected [" + transportLabel + "] - C: connect, U: edit URL, P: transport, 1-9: recent";
+                statusText = "Disconnected [" + transportLabel + "] - C: connect, U: edit URL, P: transport, T: threads, 1-9: recent";
             } else {
-                statusText = "Disconnected [" + transportLabel + "] - C: connect, U: edit URL, P: transport";
+                statusText = "Disconnected [" + transportLabel + "] - C: connect, U: edit URL, P: transport, T: threads";
             }
             statusColor = {150, 150, 150, 255};
             break;
@@ -798,13 +1549,7 @@ void App::renderStatusBar() {
             statusColor = {255, 200, 100, 255};
             break;
         case AppState::Connected: {
-            std::string protoStr = (videoDecoder_->getDetectedProtocol() == StreamProtocol::RTP) ? "RTP" : "RTSP";
-            const auto& diag = videoDecoder_->getConnectionDiagnostics();
-            std::string transportStr = "TCP";
-            if (!diag.attempts.empty()) {
-                transportStr = (diag.attempts.back().transport == TransportProtocol::UDP) ? "UDP" : "TCP";
-            }
-            statusText = "Connected [" + protoStr + "/" + transportStr + "] - D: disconnect";
+            statusText = "Connected [" + connectionLabel(*videoDecoder_) + "] - D: disconnect";
             statusColor = {100, 200, 100, 255};
             break;
         }
@@ -819,7 +1564,16 @@ void App::renderStatusBar() {
             break;
     }
 
-    if (!videoDecoder_->getLastError().empty() && state_ == AppState::Disconnected) {
+    if (streamManager_) {
+        std::string counts = std::to_string(streamManager_->getConnectedCount()) + "/" +
+                             std::to_string(streamManager_->getStreamCount());
+        if (state_ == AppState::Running) {
+            statusText = "Multi-stream: " + counts + " connected - D: disconnect all, E: export, R: reset";
+        } else if (state_ == AppState::Disconnected) {
+            statusText = "Multi-stream: " + std::to_string(streamManager_->getStreamCount()) +
+                         " streams - C: connect all";
+        }
+    } else if (!videoDecoder_->getLastError().empty() && state_ == AppState::Disconnected) {
         statusText = "Error: " + videoDecoder_->getLastError();
         statusColor = {255, 100, 100, 255};
     }
@@ -829,48 +1583,38 @@ void App::renderStatusBar() {
     // Help/About shortcuts on right side
     SDL_Color helpColor = {120, 120, 140, 255};
     std::string helpText = "F1: Help  |  F2: About";
-    if (smallFont_) {
-        int textWidth;
-        TTF_SizeText(smallFont_, helpText.c_str(), &textWidth, nullptr);
-        renderText(helpText, config_.windowWidth - textWidth - 10, y, helpColor);
-    }
+    renderText(helpText, config_.windowWidth - smallText_->measure(helpText) - 10, y, helpColor);
 }
 
 void App::renderText(const std::string& text, int x, int y, SDL_Color color) {
-    if (!smallFont_ || text.empty()) return;
-
-    SDL_Surface* surface = TTF_RenderText_Blended(smallFont_, text.c_str(), color);
-    if (!surface) return;
-
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, surface);
-    if (texture) {
-        SDL_Rect rect = {x, y, surface->w, surface->h};
-        SDL_RenderCopy(renderer_, texture, nullptr, &rect);
-        SDL_DestroyTexture(texture);
-    }
-    SDL_FreeSurface(surface);
+    smallText_->draw(text, x, y, color);
 }
 
 void App::renderTextCentered(const std::string& text, int centerX, int y, SDL_Color color) {
-    if (!font_ || text.empty()) return;
-
-    SDL_Surface* surface = TTF_RenderText_Blended(font_, text.c_str(), color);
-    if (!surface) return;
-
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, surface);
-    if (texture) {
-        SDL_Rect rect = {centerX - surface->w / 2, y, surface->w, surface->h};
-        SDL_RenderCopy(renderer_, texture, nullptr, &rect);
-        SDL_DestroyTexture(texture);
-    }
-    SDL_FreeSurface(surface);
+    text_->drawCentered(text, centerX, y, color);
 }
 
 void App::connect() {
+    if (streamManager_) {
+        connectAllStreams();
+        return;
+    }
+
     state_ = AppState::Connecting;
     streamConfig_.url = urlInput_;
     showingDiagnostics_ = false;
 
+    latencyMeasurer_->clearPatternRegion();
+    latencyMeasurer_->resetReadStats();
+    if (flashDetector_) {
+        flashDetector_->reset();
+    }
+    if (clockReader_) {
+        clockReader_->clearRegion();
+        clockReader_->resetReadStats();
+    }
+    lastMeasurement_ = LatencyMeasurement{};
+
     if (videoDecoder_->connect(streamConfig_)) {
         state_ = AppState::Connected;
         addToConnectionHistory(urlInput_);
@@ -881,7 +1625,34 @@ void App::connect() {
     }
 }
 
+void App::connectAllStreams() {
+    state_ = AppState::Connecting;
+
+    // The clock must run before the first frame reaches a measurer
+    timestampDisplay_->startTest();
+
+    int connected = streamManager_->connectAll(streamConfig_);
+    std::cout << "Connected " << connected << "/" << streamManager_->getStreamCount()
+              << " streams on " << streamManager_->getWorkerCount() << " workers" << std::endl;
+
+    if (connected == 0) {
+        timestampDisplay_->stopTest();
+        state_ = AppState::Disconnected;
+        return;
+    }
+
+    lastScalingSampleTicks_ = SDL_GetTicks();
+    state_ = AppState::Running;
+}
+
 void App::disconnect() {
+    if (streamManager_) {
+        streamManager_->disconnectAll();
+        timestampDisplay_->stopTest();
+        state_ = AppState::Disconnected;
+        return;
+    }
+
     if (state_ == AppState::Running) {
         stopClock();
     }
@@ -893,6 +1664,14 @@ void App::disconnect() {
 void App::startClock() {
     if (state_ != AppState::Connected) return;
     timestampDisplay_->startTest();
+
+    const auto& info = videoDecoder_->getStreamInfo();
+    resultsManager_->startTest(streamConfig_.url, info.codecName, info.width, info.height);
+    displayTiming_->resetCounters();
+    if (impairmentProxy_) {
+        impairmentProxy_->resetStats();
+    }
+
     paused_ = false;
     state_ = AppState::Running;
 }
@@ -900,6 +1679,7 @@ void App::startClock() {
 void App::stopClock() {
     if (state_ != AppState::Running) return;
     timestampDisplay_->stopTest();
+    resultsManager_->endTest();
     paused_ = false;
     state_ = AppState::Connected;
 }
@@ -928,6 +1708,154 @@ void App::cycleTransportProtocol() {
     }
 }
 
+void App::cycleDecoderThreading() {
+    switch (streamConfig_.decoderThreading) {
+        case DecoderThreading::AUTO:
+            streamConfig_.decoderThreading = DecoderThreading::SLICE;
+            break;
+        case DecoderThreading::SLICE:
+            streamConfig_.decoderThreading = DecoderThreading::FRAME;
+            break;
+        case DecoderThreading::FRAME:
+            streamConfig_.decoderThreading = DecoderThreading::NONE;
+            break;
+        case DecoderThreading::NONE:
+            streamConfig_.decoderThreading = DecoderThreading::AUTO;
+            break;
+    }
+}
+
+void App::resetStageStats() {
+    if (streamManager_) {
+        for (size_t i = 0; i < streamManager_->getStreamCount(); i++) {
+            streamManager_->getStream(i).getDecoder().resetStageHistograms();
+        }
+    } else {
+        videoDecoder_->resetStageHistograms();
+    }
+    std::cout << "Stage latency histograms reset" << std::endl;
+}
+
+void App::exportResults() {
+    if (streamManager_) {
+        std::string filename = "results/multistream_" + ResultsManager::generateTestId() + ".json";
+#ifdef _WIN32
+        _mkdir("results");
+#else
+        mkdir("results", 0755);
+#endif
+        if (streamManager_->exportResults(filename)) {
+            std::cout << "Results exported: " << filename << std::endl;
+        } else {
+            std::cerr << "Failed to export results: " << filename << std::endl;
+        }
+        return;
+    }
+
+    if (!resultsManager_->isTestRunning()) return;
+
+    // Finish the current run with the stage histograms attached
+    auto stats = videoDecoder_->getDecodeStats();
+    resultsManager_->setStageHistograms(videoDecoder_->getStageHistograms(), stats.stageWindowSec);
+    resultsManager_->setFrameCounters(stats.framesDecoded, stats.framesDropped,
+                                      stats.decodeErrors, stats.corruptFrames);
+    if (stats.hasRtpStats) {
+        resultsManager_->setRtpStats(stats.rtp);
+    }
+    if (impairmentProxy_) {
+        resultsManager_->setImpairment(impairmentProxy_->getConfig(), impairmentProxy_->getStats());
+    }
+    resultsManager_->setDisplayTiming(displayTiming_->getStats());
+    if (timestampDisplay_->getPatternRows() > 1) {
+        resultsManager_->setPatternRows(latencyMeasurer_->getRowStats(), displayRowSkewMs_);
+    }
+    TestResult result = resultsManager_->endTest();
+
+    // Ensure results directory exists
+    std::string resultsDir = "results";
+#ifdef _WIN32
+    _mkdir(resultsDir.c_str());
+#else
+    mkdir(resultsDir.c_str(), 0755);
+#endif
+
+    std::string filename = resultsDir + "/latency_" + result.testId + ".json";
+    if (resultsManager_->exportToJson(filename)) {
+        std::cout << "Results exported: " << filename << std::endl;
+    } else {
+        std::cerr << "Failed to export results: " << filename << std::endl;
+        filename.clear();
+    }
+    recordHistory(result, filename);
+
+    // Start a fresh run so the next export covers only new data
+    const auto& info = videoDecoder_->getStreamInfo();
+    resultsManager_->startTest(streamConfig_.url, info.codecName, info.width, info.height);
+    videoDecoder_->resetStageHistograms();
+    if (impairmentProxy_) {
+        impairmentProxy_->resetStats();
+    }
+}
+
+void App::recordHistory(const TestResult& result, const std::string& resultsFile) {
+    HistoryRun run = ResultsHistory::fromResult(result);
+    if (run.latencyCounts.empty()) return;
+
+    // Appending is one line. Reading the store back and bootstrapping the
+    // comparison can take seconds for long runs, so that happens off the UI
+    // thread: the clock the camera films has to keep running.
+    ResultsHistory history;
+    history.setPath(config_.historyPath);
+    if (!history.append(run)) {
+        std::cerr << history.getLastError() << std::endl;
+        return;
+    }
+
+    // Only one comparison at a time; a second export within seconds waits here
+    if (historyCompare_.joinable()) {
+        historyCompare_.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(historyMutex_);
+        historyStatus_ = "comparing";
+        historyRegression_ = false;
+    }
+    size_t threads = static_cast<size_t>(std::max(0, config_.workerThreads));
+    historyCompare_ = std::thread([this, run = std::move(run), path = config_.historyPath, resultsFile, threads] {
+        ResultsHistory history;
+        const HistoryRun* previous = nullptr;
+        if (!history.load(path)) {
+            std::cerr << history.getLastError() << std::endl;
+        } else {
+            previous = history.findPrevious(run);
+        }
+        if (!previous) {
+            std::lock_guard<std::mutex> lock(historyMutex_);
+            historyStatus_ = "no previous run";
+            return;
+        }
+
+        // Flag a slowdown against the last run of the same stream setup, in
+        // the stats panel and next to the run in its exported report
+        auto comparison = ResultsHistory::compare(*previous, run, ResultsHistory::BOOTSTRAP_RESAMPLES, threads);
+        std::cout << ResultsHistory::formatComparison(comparison) << std::flush;
+        if (!resultsFile.empty() && !history.attachComparison(resultsFile, comparison)) {
+            std::cerr << history.getLastError() << std::endl;
+        }
+        if (comparison.regression) {
+            std::ostringstream oss;
+            oss << "Latency regression against " << previous->testId << ": "
+                << std::showpos << std::fixed << std::setprecision(1) << comparison.shiftMs
+                << std::noshowpos << " ms";
+            std::cerr << oss.str() << std::endl;
+        }
+
+        std::lock_guard<std::mutex> lock(historyMutex_);
+        historyStatus_ = ResultsHistory::formatSummary(comparison);
+        historyRegression_ = comparison.regression;
+    });
+}
+
 void App::renderDiagnosticsPanel() {
     const auto& diag = videoDecoder_->getConnectionDiagnostics();
 
@@ -1061,6 +1989,22 @@ void App::renderDiagnosticsPanel() {
                        panelX + panelWidth / 2, y, footerColor);
 }
 
+void App::dumpPacketBuffer(const std::string& reason) {
+    // Ensure recordings directory exists
+    std::string recordingDir = "recordings";
+#ifdef _WIN32
+    _mkdir(recordingDir.c_str());
+#else
+    mkdir(recordingDir.c_str(), 0755);
+#endif
+
+    std::string filename = recordingDir + "/" + reason + "_" + ResultsManager::generateTestId() +
+                           packetRecorder_->preferredExtension();
+    if (!packetRecorder_->dump(filename)) {
+        std::cerr << "Packet buffer holds no keyframe yet - nothing to save" << std::endl;
+    }
+}
+
 void App::saveScreenshot() {
     int w, h;
     SDL_GetRendererOutputSize(renderer_, &w, &h);
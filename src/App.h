@@ -1,14 +1,28 @@
 #pragma once
 
+#include "ClockReader.h"
 #include "Config.h"
+#include "DisplayTiming.h"
+#include "FlashDetector.h"
+#include "FramePublisher.h"
+#include "GlyphAtlas.h"
+#include "ImpairmentProxy.h"
+#include "PanelCache.h"
 #include "TimestampDisplay.h"
 #include "VideoDecoder.h"
 #include "VideoRenderer.h"
+#include "ResultsManager.h"
+#include "ResultsHistory.h"
+#include "LatencyMeasurer.h"
+#include "StreamManager.h"
+#include "PacketRecorder.h"
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 namespace latency {
 
@@ -40,6 +54,10 @@ private:
     void renderStatusBar();
     void renderPauseOverlay();
     void renderStatsPanel();
+    void renderStageLatencyPanel(const DecodeStats& stats);
+    void renderLatencyBudget(int x, int y, int width);
+    void renderStreamTiles(int x, int y, int width, int height);
+    void renderScalingPanel();
     void renderHelpPanel();
     void renderAboutPanel();
     void renderConnectionHistory();
@@ -51,12 +69,18 @@ private:
 
     // Actions
     void connect();
+    void connectAllStreams();
     void disconnect();
     void startClock();
     void stopClock();
     void togglePause();
     void saveScreenshot();
     void cycleTransportProtocol();
+    void cycleDecoderThreading();
+    void resetStageStats();
+    void exportResults();
+    void recordHistory(const TestResult& result, const std::string& resultsFile);  // Append to the results history and compare with the last run
+    void dumpPacketBuffer(const std::string& reason);
 
     // Connection history
     void loadConnectionHistory();
@@ -73,13 +97,43 @@ private:
     TTF_Font* font_ = nullptr;
     TTF_Font* smallFont_ = nullptr;
     TTF_Font* largeFont_ = nullptr;
+    std::unique_ptr<GlyphAtlas> smallText_;              // smallFont_: panels, labels, buttons
+    std::unique_ptr<GlyphAtlas> text_;                   // font_: dialog titles
+
+    // Overlays drawn into cached textures
+    static constexpr uint32_t STATS_REFRESH_MS = 250;
+    static constexpr int VALID_RATE_WINDOW_SEC = 5;     // Stats panel's recent valid-sample rate
+    std::unique_ptr<PanelCache> statsPanel_;
+    std::unique_ptr<PanelCache> historyPanel_;
+    std::unique_ptr<PanelCache> helpPanel_;
+    std::unique_ptr<PanelCache> aboutPanel_;
+    std::unique_ptr<PanelCache> diagnosticsPanel_;
 
     AppConfig config_;
     StreamConfig streamConfig_;
 
     std::unique_ptr<TimestampDisplay> timestampDisplay_;
+    std::unique_ptr<DisplayTiming> displayTiming_;       // Present timing behind the clock panel
+    std::unique_ptr<PacketRecorder> packetRecorder_;  // Outlives the decoder feeding it
     std::unique_ptr<VideoDecoder> videoDecoder_;
+    std::unique_ptr<FramePublisher> framePublisher_;  // Subscribed to the decoder's frame bus; only with --export-frames
     std::unique_ptr<VideoRenderer> videoRenderer_;
+    std::unique_ptr<ResultsManager> resultsManager_;
+    std::thread historyCompare_;                         // Exported run vs the history, off the UI thread
+    std::mutex historyMutex_;                            // Guards the comparison's outcome below
+    std::string historyStatus_;                          // Stats panel summary; empty until a run is exported
+    bool historyRegression_ = false;
+    std::unique_ptr<LatencyMeasurer> latencyMeasurer_;
+    std::unique_ptr<FlashDetector> flashDetector_;       // Replaces the pattern reader with --flash
+    std::unique_ptr<ClockReader> clockReader_;           // Reads the clock digits when the pattern fails
+    std::unique_ptr<ImpairmentProxy> impairmentProxy_;   // Only when a relay is configured
+    LatencyMeasurement lastMeasurement_;
+    uint32_t lastSpikeDumpTicks_ = 0;
+
+    // Multi-stream mode: one pipeline and tile per camera
+    std::unique_ptr<StreamManager> streamManager_;
+    std::vector<std::unique_ptr<VideoRenderer>> tileRenderers_;
+    uint32_t lastScalingSampleTicks_ = 0;
 
     AppState state_ = AppState::Disconnected;
     bool appRunning_ = false;
@@ -97,10 +151,16 @@ private:
     bool paused_ = false;
     uint32_t pausedTimestamp_ = 0;  // Clock time when paused
 
+    // Predicted scan-out time from the top pattern row to the bottom one
+    double displayRowSkewMs_ = 0.0;
+
     // Help/About/Diagnostics panel state
     bool showingHelp_ = false;
     bool showingAbout_ = false;
     bool showingDiagnostics_ = false;
+
+    // Stats panel shows per-stage percentiles instead of averages
+    bool showingStageLatency_ = false;
 };
 
 } // namespace latency
@@ -0,0 +1,111 @@
+#include "ChangePointDetector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace latency {
+
+namespace {
+
+double median(std::vector<double> values) {
+    auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+
+} // namespace
+
+bool ChangePointDetector::add(double latencyMs) {
+    samples_.push_back(latencyMs);
+
+    bool changed = false;
+    while (true) {
+        if (!ready_) {
+            if (samples_.size() < BASELINE_SAMPLES) break;
+            learnBaseline();
+        }
+        if (next_ >= samples_.size()) break;
+        changed |= step(next_++);
+    }
+
+    // Samples before both runs began can no longer become part of a change
+    size_t settled = std::min(highStart_, lowStart_);
+    if (ready_ && settled > TRIM_SAMPLES) {
+        samples_.erase(samples_.begin(), samples_.begin() + settled);
+        segmentStart_ += settled;
+        next_ -= settled;
+        highStart_ -= settled;
+        lowStart_ -= settled;
+    }
+    return changed;
+}
+
+void ChangePointDetector::reset() {
+    *this = ChangePointDetector{};
+}
+
+void ChangePointDetector::learnBaseline() {
+    std::vector<double> baseline(samples_.begin(), samples_.begin() + BASELINE_SAMPLES);
+    level_ = median(baseline);
+    for (double& value : baseline) {
+        value = std::abs(value - level_);
+    }
+    // MAD scaled to a normal distribution's standard deviation
+    spread_ = std::max(MIN_SPREAD_MS, 1.4826 * median(baseline));
+    drift_ = std::max(DRIFT_SPREADS, MIN_SHIFT_MS / 2.0 / spread_);
+
+    levelSum_ = 0.0;
+    levelCount_ = 0;
+    high_ = 0.0;
+    low_ = 0.0;
+    highStart_ = 0;
+    lowStart_ = 0;
+    next_ = 0;
+    ready_ = true;
+}
+
+bool ChangePointDetector::step(size_t i) {
+    // Clipped beyond the drift, so a quiet series (drift widened to
+    // MIN_SHIFT_MS) can still build up a sum
+    const double clip = CLIP_SPREADS + drift_;
+    double z = std::clamp((samples_[i] - level_) / spread_, -clip, clip);
+
+    // A run starts at the first sample that lifts its sum off zero
+    if (high_ <= 0.0) highStart_ = i;
+    if (low_ <= 0.0) lowStart_ = i;
+    high_ = std::max(0.0, high_ + z - drift_);
+    low_ = std::max(0.0, low_ - z - drift_);
+
+    if (high_ <= ALARM_SPREADS && low_ <= ALARM_SPREADS) {
+        levelSum_ += level_ + z * spread_;
+        levelCount_++;
+        if (levelCount_ >= BASELINE_SAMPLES) {
+            level_ = levelSum_ / levelCount_;
+        }
+        return false;
+    }
+
+    // A run from the segment's first sample would start the same segment
+    // again (its baseline outvoted a short burst at the start): drop the run
+    // and keep the segment
+    size_t start = high_ > ALARM_SPREADS ? highStart_ : lowStart_;
+    if (segmentStart_ + start == segmentBegin_) {
+        high_ = 0.0;
+        low_ = 0.0;
+        return false;
+    }
+
+    // New segment from where the run began; its samples are learned again
+    segmentBegin_ = segmentStart_ + start;
+    changePoints_.push_back(segmentBegin_);
+    samples_.erase(samples_.begin(), samples_.begin() + start);
+    segmentStart_ = segmentBegin_;
+    next_ = 0;
+    high_ = 0.0;
+    low_ = 0.0;
+    highStart_ = 0;
+    lowStart_ = 0;
+    ready_ = false;
+    return true;
+}
+
+} // namespace latency
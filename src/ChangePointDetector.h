@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace latency {
+
+// Online change-point detection on a latency series: a two-sided CUSUM of
+// each sample's distance from the current segment's level, in units of the
+// segment's spread. Level and spread are learned from the first samples of
+// every segment (median and MAD, so a stray spike doesn't skew them), and
+// single outliers are clipped so that only a sustained shift raises an
+// alarm. The change is placed where the alarming sum last left zero, and a
+// new segment is learned from there. Constant work per sample.
+class ChangePointDetector {
+public:
+    // Feed the next sample; true if it confirmed a change (see getChangePoints())
+    bool add(double latencyMs);
+
+    void reset();
+
+    // Index of the first sample of every segment after the first, in order
+    const std::vector<size_t>& getChangePoints() const { return changePoints_; }
+
+    // Still learning the current segment's level
+    bool isLearning() const { return !ready_; }
+    double getLevelMs() const { return level_; }
+    double getSpreadMs() const { return spread_; }
+
+    static constexpr size_t BASELINE_SAMPLES = 30;   // Learned per segment before watching for shifts
+    static constexpr double MIN_SHIFT_MS = 10.0;     // Smaller level changes aren't flagged
+    static constexpr double MIN_SPREAD_MS = 1.0;
+
+private:
+    void learnBaseline();
+    bool step(size_t i);
+
+    static constexpr double DRIFT_SPREADS = 0.5;     // CUSUM allowance per sample (k)
+    static constexpr double ALARM_SPREADS = 10.0;    // CUSUM decision threshold (h)
+    static constexpr double CLIP_SPREADS = 3.0;      // Outliers count no further than this past the drift
+    static constexpr size_t TRIM_SAMPLES = 1024;     // Drop settled history once this much builds up
+
+    std::vector<double> samples_;      // Current segment, from segmentStart_ (trimmed as it settles)
+    std::vector<size_t> changePoints_;
+    size_t segmentBegin_ = 0;          // Index of the current segment's first sample in the whole series
+    size_t segmentStart_ = 0;          // Index of samples_[0] in the whole series
+    size_t next_ = 0;                  // Next entry of samples_ to run through the CUSUM
+    bool ready_ = false;
+
+    double level_ = 0.0;
+    double spread_ = 0.0;
+    double drift_ = DRIFT_SPREADS;     // In spreads, widened to MIN_SHIFT_MS / 2 for quiet series
+    double levelSum_ = 0.0;            // Clipped samples behind the running level
+    size_t levelCount_ = 0;
+
+    double high_ = 0.0;                // Upward and downward sums, and where each run began
+    double low_ = 0.0;
+    size_t highStart_ = 0;
+    size_t lowStart_ = 0;
+};
+
+} // namespace latency
@@ -0,0 +1,397 @@
+#include "ClockReader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace latency {
+
+namespace {
+
+constexpr int DIGIT_COUNT = 10;
+constexpr int CENTISECOND_MS = 10;
+
+} // namespace
+
+bool ClockReader::init(TTF_Font* font) {
+    ready_ = false;
+    if (!font) return false;
+
+    templates_.assign(static_cast<size_t>(CELL_SIZE) * DIGIT_LANES, 0.0f);
+    SDL_Color white = {255, 255, 255, 255};
+
+    for (int digit = 0; digit < DIGIT_COUNT; digit++) {
+        SDL_Surface* glyph = TTF_RenderGlyph_Blended(font, static_cast<Uint16>('0' + digit), white);
+        if (!glyph) return false;
+        SDL_Surface* argb = SDL_ConvertSurfaceFormat(glyph, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(glyph);
+        if (!argb) return false;
+
+        // Coverage is the ink; crop to where it's over half, as the frame's
+        // threshold crops a digit blob
+        const int width = argb->w;
+        const int height = argb->h;
+        std::vector<uint8_t> ink(static_cast<size_t>(width) * height);
+        int x0 = width, y0 = height, x1 = -1, y1 = -1;
+        SDL_LockSurface(argb);
+        for (int y = 0; y < height; y++) {
+            const uint32_t* row = reinterpret_cast<const uint32_t*>(
+                static_cast<const uint8_t*>(argb->pixels) + y * argb->pitch);
+            for (int x = 0; x < width; x++) {
+                uint8_t alpha = static_cast<uint8_t>(row[x] >> 24);
+                ink[y * width + x] = alpha;
+                if (alpha >= 128) {
+                    x0 = std::min(x0, x);
+                    y0 = std::min(y0, y);
+                    x1 = std::max(x1, x);
+                    y1 = std::max(y1, y);
+                }
+            }
+        }
+        SDL_UnlockSurface(argb);
+        SDL_FreeSurface(argb);
+
+        std::array<float, CELL_SIZE> cell;
+        if (x1 < 0 || !sampleCell(ink.data(), width, x0, y0, x1 - x0 + 1, y1 - y0 + 1, cell)) {
+            return false;
+        }
+        for (int i = 0; i < CELL_SIZE; i++) {
+            templates_[i * DIGIT_LANES + digit] = cell[i];
+        }
+    }
+
+    ready_ = true;
+    return true;
+}
+
+LatencyMeasurement ClockReader::measure(const VideoFrame& frame, uint32_t currentTimestamp) {
+    LatencyMeasurement result;
+    result.source = MeasurementSource::Ocr;
+    result.actualTimestamp = currentTimestamp;
+    if (!ready_ || !frame.data || frame.width <= 0 || frame.height <= 0) {
+        return result;
+    }
+    readStats_.frames++;
+
+    int unsure = 0;
+    std::vector<ClockReading> readings;
+    if (region_) {
+        readings = readArea(frame, *region_, 1, unsure);
+        if (readings.empty() && unsure == 0) {
+            clearRegion();  // No clock layout where it was: it moved
+        }
+    }
+
+    // Searching the whole frame is the expensive part; while the clock is
+    // lost, do it only every few frames
+    if (!region_) {
+        if (framesSinceSearch_ < SEARCH_INTERVAL_FRAMES) {
+            framesSinceSearch_++;
+            return result;
+        }
+        framesSinceSearch_ = 0;
+        readStats_.searches++;
+        readings = readArea(frame, Area{0, 0, frame.width, frame.height}, 1, unsure);
+    }
+
+    if (readings.empty()) {
+        if (unsure > 0) readStats_.unsure++;
+        return result;
+    }
+    readStats_.read++;
+
+    // Next frame, look around this clock only (the .cc line is below MM:SS)
+    const ClockReading& reading = readings.front();
+    int x0 = std::max(0, reading.x - reading.height * 3 / 2);
+    int y0 = std::max(0, reading.y - reading.height / 2);
+    int x1 = std::min(frame.width, reading.x + reading.width + reading.height * 3 / 2);
+    int y1 = std::min(frame.height, reading.y + reading.height * 3);
+    region_ = Area{x0, y0, x1 - x0, y1 - y0};
+
+    // The shown time is within the hour; take the one nearest the clock. It
+    // is truncated to 10 ms, so it was on screen for the 10 ms after it.
+    int64_t diff = (static_cast<int64_t>(currentTimestamp) - reading.timestamp) % CLOCK_WRAP_MS;
+    if (diff < 0) diff += CLOCK_WRAP_MS;
+    if (diff >= CLOCK_WRAP_MS / 2) diff -= CLOCK_WRAP_MS;
+    int32_t latency = static_cast<int32_t>(diff) - CENTISECOND_MS / 2;
+
+    if (latency < MIN_PLAUSIBLE_LATENCY_MS || latency > MAX_PLAUSIBLE_LATENCY_MS) {
+        return result;
+    }
+
+    result.displayedTimestamp = currentTimestamp - static_cast<uint32_t>(latency);
+    result.latencyMs = latency;
+    result.valid = true;
+    return result;
+}
+
+std::vector<ClockReading> ClockReader::readAll(const VideoFrame& frame) {
+    if (!ready_ || !frame.data || frame.width <= 0 || frame.height <= 0) {
+        return {};
+    }
+    int unsure = 0;
+    return readArea(frame, Area{0, 0, frame.width, frame.height}, SIZE_MAX, unsure);
+}
+
+std::vector<ClockReading> ClockReader::readArea(const VideoFrame& frame, const Area& area, size_t maxReadings,
+                                                int& unsure) {
+    std::vector<ClockReading> readings;
+    std::vector<Blob> blobs = findDigitBlobs(frame, area);
+    std::sort(blobs.begin(), blobs.end(), [](const Blob& a, const Blob& b) { return a.x0 < b.x0; });
+    std::vector<bool> used(blobs.size(), false);
+
+    // Closest unused blob to an expected centre that passes a test
+    auto nearest = [&](double centerX, double tolerance, auto&& accept) -> int {
+        int best = -1;
+        double bestDistance = tolerance;
+        for (size_t i = 0; i < blobs.size(); i++) {
+            double distance = std::fabs(blobs[i].centerX() - centerX);
+            if (!used[i] && distance <= bestDistance && accept(blobs[i])) {
+                best = static_cast<int>(i);
+                bestDistance = distance;
+            }
+        }
+        return best;
+    };
+
+    for (size_t a = 0; a < blobs.size() && readings.size() < maxReadings; a++) {
+        if (used[a]) continue;
+        const Blob& first = blobs[a];
+        const double h = first.height();
+        auto onLine = [&](const Blob& blob) {
+            return std::abs(blob.height() - first.height()) <= 0.15 * h && std::abs(blob.y1 - first.y1) <= 0.15 * h;
+        };
+
+        // "MM:SS" in a monospaced font: digit centres one advance apart,
+        // with the colon taking a cell between the pairs
+        for (size_t b = a + 1; b < blobs.size(); b++) {
+            const Blob& second = blobs[b];
+            if (second.x0 > first.x1 + 1.5 * h) break;
+            if (used[b] || !onLine(second)) continue;
+            const double advance = second.centerX() - first.centerX();
+            if (advance < 0.4 * h || advance > 1.3 * h) continue;
+
+            int c = nearest(second.centerX() + 2 * advance, 0.25 * advance, onLine);
+            if (c < 0) continue;
+            int d = nearest(blobs[c].centerX() + advance, 0.25 * advance, onLine);
+            if (d < 0) continue;
+
+            // ".cc" is centred under the clock: its digits sit at the colon and one advance right
+            const double colonX = (second.centerX() + blobs[c].centerX()) / 2.0;
+            auto belowLine = [&](const Blob& blob) {
+                return std::abs(blob.height() - first.height()) <= 0.15 * h &&
+                       blob.y0 >= first.y1 - 0.2 * h && blob.y0 <= first.y1 + 1.5 * h;
+            };
+            int e = nearest(colonX, 0.3 * advance, belowLine);
+            if (e < 0) continue;
+            auto besideE = [&](const Blob& blob) {
+                return belowLine(blob) && std::abs(blob.y1 - blobs[e].y1) <= 0.15 * h;
+            };
+            int f = nearest(blobs[e].centerX() + advance, 0.25 * advance, besideE);
+            if (f < 0) continue;
+
+            const int indices[6] = {static_cast<int>(a), static_cast<int>(b), c, d, e, f};
+            int digits[6];
+            float minScore = 1.0f;
+            bool matched = true;
+            for (int i = 0; i < 6 && matched; i++) {
+                float score = 0.0f;
+                digits[i] = matchDigit(blobs[indices[i]], area.width, score);
+                matched = digits[i] >= 0;
+                minScore = std::min(minScore, score);
+            }
+            // Tens of minutes and seconds only go to 5
+            if (!matched || digits[0] > 5 || digits[2] > 5) {
+                unsure++;
+                continue;
+            }
+
+            for (int index : indices) used[index] = true;
+
+            ClockReading reading;
+            uint32_t minutes = digits[0] * 10 + digits[1];
+            uint32_t seconds = digits[2] * 10 + digits[3];
+            uint32_t centiseconds = digits[4] * 10 + digits[5];
+            reading.timestamp = (minutes * 60 + seconds) * 1000 + centiseconds * CENTISECOND_MS;
+            reading.x = area.x + first.x0;
+            reading.y = area.y + std::min({first.y0, second.y0, blobs[c].y0, blobs[d].y0});
+            reading.width = blobs[d].x1 - first.x0 + 1;
+            reading.height = std::max({first.y1, second.y1, blobs[c].y1, blobs[d].y1}) + area.y - reading.y + 1;
+            reading.score = minScore;
+            readings.push_back(reading);
+            break;
+        }
+    }
+
+    return readings;
+}
+
+std::vector<ClockReader::Blob> ClockReader::findDigitBlobs(const VideoFrame& frame, const Area& area) {
+    std::vector<Blob> blobs;
+    const int width = area.width;
+    const int height = area.height;
+    if (width <= 0 || height <= 0) return blobs;
+
+    // Ink is inverted BT.601 luma: dark digits on the white panel are high
+    const size_t size = static_cast<size_t>(width) * height;
+    ink_.resize(size);
+    mask_.resize(size);
+    uint32_t histogram[256] = {};
+    for (int y = 0; y < height; y++) {
+        const uint8_t* src = frame.data + (area.y + y) * frame.pitch + area.x * 3;
+        uint8_t* out = &ink_[static_cast<size_t>(y) * width];
+        for (int x = 0; x < width; x++, src += 3) {
+            uint8_t value = static_cast<uint8_t>(255 - ((77 * src[0] + 150 * src[1] + 29 * src[2]) >> 8));
+            out[x] = value;
+            histogram[value]++;
+        }
+    }
+
+    // Otsu: the threshold that best separates the levels into two classes
+    double sumAll = 0.0;
+    for (int i = 0; i < 256; i++) sumAll += static_cast<double>(i) * histogram[i];
+    double sumBack = 0.0;
+    uint64_t weightBack = 0;
+    double bestVariance = 0.0;
+    double bestGap = 0.0;
+    int threshold = 255;
+    for (int t = 0; t < 256; t++) {
+        weightBack += histogram[t];
+        if (weightBack == 0) continue;
+        uint64_t weightFore = size - weightBack;
+        if (weightFore == 0) break;
+        sumBack += static_cast<double>(t) * histogram[t];
+        double meanBack = sumBack / weightBack;
+        double meanFore = (sumAll - sumBack) / weightFore;
+        double variance = static_cast<double>(weightBack) * weightFore * (meanFore - meanBack) * (meanFore - meanBack);
+        if (variance > bestVariance) {
+            bestVariance = variance;
+            bestGap = meanFore - meanBack;
+            threshold = t;
+        }
+    }
+    if (bestGap < MIN_INK_CONTRAST) return blobs;
+
+    for (size_t i = 0; i < size; i++) {
+        mask_[i] = ink_[i] > threshold ? 1 : 0;
+    }
+
+    // 8-connected components; visited pixels are marked 2
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            size_t start = static_cast<size_t>(y) * width + x;
+            if (mask_[start] != 1) continue;
+
+            Blob blob{x, y, x, y, 0};
+            mask_[start] = 2;
+            stack_.clear();
+            stack_.push_back(static_cast<int32_t>(start));
+            while (!stack_.empty()) {
+                int32_t p = stack_.back();
+                stack_.pop_back();
+                int px = p % width;
+                int py = p / width;
+                blob.pixels++;
+                blob.x0 = std::min(blob.x0, px);
+                blob.x1 = std::max(blob.x1, px);
+                blob.y0 = std::min(blob.y0, py);
+                blob.y1 = std::max(blob.y1, py);
+                for (int ny = std::max(0, py - 1); ny <= std::min(height - 1, py + 1); ny++) {
+                    for (int nx = std::max(0, px - 1); nx <= std::min(width - 1, px + 1); nx++) {
+                        int32_t n = ny * width + nx;
+                        if (mask_[n] == 1) {
+                            mask_[n] = 2;
+                            stack_.push_back(n);
+                        }
+                    }
+                }
+            }
+
+            // Digits are upright, taller than wide, partly inked and whole
+            const int h = blob.height();
+            const int w = blob.width();
+            const double aspect = static_cast<double>(h) / w;
+            const double fill = static_cast<double>(blob.pixels) / (static_cast<double>(w) * h);
+            const bool touchesEdge = blob.x0 == 0 || blob.y0 == 0 || blob.x1 == width - 1 || blob.y1 == height - 1;
+            if (!touchesEdge && h >= MIN_DIGIT_HEIGHT && h <= height / 2 && aspect >= 1.15 && aspect <= 5.0 &&
+                fill >= 0.1 && fill <= 0.85) {
+                blobs.push_back(blob);
+            }
+        }
+    }
+    return blobs;
+}
+
+int ClockReader::matchDigit(const Blob& blob, int areaWidth, float& score) const {
+    std::array<float, CELL_SIZE> cell;
+    if (!sampleCell(ink_.data(), areaWidth, blob.x0, blob.y0, blob.width(), blob.height(), cell)) {
+        score = 0.0f;
+        return -1;
+    }
+
+    // All ten correlations in one pass over the cell. The inner loop runs
+    // across digits, not pixels, so it vectorizes without reordering sums.
+    alignas(64) float scores[DIGIT_LANES] = {};
+    const float* weights = templates_.data();
+    for (int i = 0; i < CELL_SIZE; i++, weights += DIGIT_LANES) {
+        const float value = cell[i];
+        for (int lane = 0; lane < DIGIT_LANES; lane++) {
+            scores[lane] += value * weights[lane];
+        }
+    }
+
+    int best = 0;
+    float second = -1.0f;
+    for (int digit = 1; digit < DIGIT_COUNT; digit++) {
+        if (scores[digit] > scores[best]) {
+            second = scores[best];
+            best = digit;
+        } else {
+            second = std::max(second, scores[digit]);
+        }
+    }
+
+    score = scores[best];
+    if (score < MIN_DIGIT_SCORE || score - second < MIN_DIGIT_MARGIN) {
+        return -1;
+    }
+    return best;
+}
+
+bool ClockReader::sampleCell(const uint8_t* ink, int pitch, int x, int y, int width, int height,
+                             std::array<float, CELL_SIZE>& cell) {
+    float mean = 0.0f;
+    for (int cy = 0; cy < CELL_HEIGHT; cy++) {
+        const int sy0 = y + cy * height / CELL_HEIGHT;
+        const int sy1 = std::max(sy0 + 1, y + (cy + 1) * height / CELL_HEIGHT);
+        for (int cx = 0; cx < CELL_WIDTH; cx++) {
+            const int sx0 = x + cx * width / CELL_WIDTH;
+            const int sx1 = std::max(sx0 + 1, x + (cx + 1) * width / CELL_WIDTH);
+            uint32_t sum = 0;
+            for (int sy = sy0; sy < sy1; sy++) {
+                const uint8_t* row = ink + static_cast<size_t>(sy) * pitch;
+                for (int sx = sx0; sx < sx1; sx++) {
+                    sum += row[sx];
+                }
+            }
+            float value = static_cast<float>(sum) / ((sy1 - sy0) * (sx1 - sx0));
+            cell[cy * CELL_WIDTH + cx] = value;
+            mean += value;
+        }
+    }
+    mean /= CELL_SIZE;
+
+    float norm = 0.0f;
+    for (float& value : cell) {
+        value -= mean;
+        norm += value * value;
+    }
+    if (norm < 1.0f) return false;
+
+    const float scale = 1.0f / std::sqrt(norm);
+    for (float& value : cell) {
+        value *= scale;
+    }
+    return true;
+}
+
+} // namespace latency
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "LatencyMeasurer.h"
+#include <SDL_ttf.h>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace latency {
+
+// The human-readable clock as read from a frame. Only the time within the
+// hour is shown (MM:SS.cc), so the timestamp is milliseconds into the hour.
+struct ClockReading {
+    uint32_t timestamp = 0;          // (MM * 60 + SS) * 1000 + cc * 10
+    int x = 0;                       // Bounds of the MM:SS line in the frame
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    float score = 0.0f;              // Weakest digit match (correlation, 0-1)
+};
+
+// How clock reads have gone since the last reset
+struct ClockReadStats {
+    uint64_t frames = 0;             // Frames offered to measure()
+    uint64_t read = 0;               // Clocks read
+    uint64_t unsure = 0;             // Clock layout found but a digit didn't match
+    uint64_t searches = 0;           // Whole-frame searches for the clock
+};
+
+// Fallback reader for the MM:SS and .cc digits TimestampDisplay draws, for
+// frames where the binary pattern is cropped or out of focus. Digit
+// templates come from the panel's own font. Dark blobs are found with an
+// Otsu threshold and connected components; the clock is the group laid out
+// like "MM:SS" over ".cc" in a monospaced font, and each digit is matched by
+// normalized correlation against all ten templates at once.
+class ClockReader {
+public:
+    // Render the digit templates from the clock font. False if it has no digits.
+    bool init(TTF_Font* font);
+    bool isReady() const { return ready_; }
+
+    // Latency from the clock shown in a frame, against the current clock time
+    // (ms). Resolution is the clock's 10 ms; measurements are tagged
+    // MeasurementSource::Ocr.
+    LatencyMeasurement measure(const VideoFrame& frame, uint32_t currentTimestamp);
+
+    // Every clock in the frame, left to right (e.g. the panel and the camera's
+    // view of it in a freeze-frame screenshot)
+    std::vector<ClockReading> readAll(const VideoFrame& frame);
+
+    void clearRegion() {
+        region_.reset();
+        framesSinceSearch_ = SEARCH_INTERVAL_FRAMES;
+    }
+    const ClockReadStats& getReadStats() const { return readStats_; }
+    void resetReadStats() { readStats_ = ClockReadStats{}; }
+
+    static constexpr uint32_t CLOCK_WRAP_MS = 3600000;  // MM:SS repeats every hour
+
+private:
+    static constexpr int CELL_WIDTH = 12;             // Digits are compared at this size
+    static constexpr int CELL_HEIGHT = 18;
+    static constexpr int CELL_SIZE = CELL_WIDTH * CELL_HEIGHT;
+    static constexpr int DIGIT_LANES = 16;            // Ten digits, padded for vector registers
+    static constexpr int MIN_DIGIT_HEIGHT = 10;       // Frame pixels
+    static constexpr float MIN_DIGIT_SCORE = 0.6f;
+    static constexpr float MIN_DIGIT_MARGIN = 0.05f;  // Over the second-best digit
+    static constexpr int SEARCH_INTERVAL_FRAMES = 10; // Between whole-frame searches while lost
+    static constexpr int MIN_INK_CONTRAST = 40;       // Between the Otsu classes' mean levels
+
+    struct Area {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    struct Blob {
+        int x0, y0, x1, y1;                           // Inclusive bounds within the area
+        int pixels;
+        int height() const { return y1 - y0 + 1; }
+        int width() const { return x1 - x0 + 1; }
+        double centerX() const { return (x0 + x1) / 2.0; }
+    };
+
+    // Read up to maxReadings clocks inside an area; unsure counts layouts
+    // whose digits didn't all match
+    std::vector<ClockReading> readArea(const VideoFrame& frame, const Area& area, size_t maxReadings,
+                                       int& unsure);
+
+    // Dark connected components in the area that could be digits (fills ink_)
+    std::vector<Blob> findDigitBlobs(const VideoFrame& frame, const Area& area);
+
+    // Best digit for a blob, or -1 if no template matches well enough
+    int matchDigit(const Blob& blob, int areaWidth, float& score) const;
+
+    // Box-filter an 8-bit ink plane region down (or up) to CELL_WIDTH x
+    // CELL_HEIGHT, normalized to zero mean and unit length. False if flat.
+    static bool sampleCell(const uint8_t* ink, int pitch, int x, int y, int width, int height,
+                           std::array<float, CELL_SIZE>& cell);
+
+    // Templates interleaved by pixel: templates_[i * DIGIT_LANES + digit]
+    std::vector<float> templates_;
+    bool ready_ = false;
+
+    std::optional<Area> region_;
+    int framesSinceSearch_ = SEARCH_INTERVAL_FRAMES;
+    ClockReadStats readStats_;
+
+    // Scratch planes reused across frames
+    std::vector<uint8_t> ink_;
+    std::vector<uint8_t> mask_;
+    std::vector<int32_t> stack_;
+};
+
+} // namespace latency
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -14,7 +15,15 @@ enum class TransportProtocol {
 enum class StreamProtocol {
     AUTO,   // Auto-detect from URL scheme
     RTSP,   // rtsp:// - Real Time Streaming Protocol
-    RTP     // rtp:// - Real-time Transport Protocol (direct)
+    RTP,    // rtp:// - Real-time Transport Protocol (direct)
+    LOCAL_FILE  // file: URL or .mp4/.mkv/.ts path - a recording, decoded offline
+};
+
+enum class DecoderThreading {
+    AUTO,   // Let FFmpeg choose; low-delay stays on, so slice threading where available
+    FRAME,  // Frame threading - adds up to (threads - 1) frames of delay
+    SLICE,  // Slice threading - no added delay, only helps sliced streams
+    NONE    // Single-threaded decoding
 };
 
 enum class ConnectionStage {
@@ -42,6 +51,15 @@ struct ConnectionDiagnostics {
     std::string summary;
 };
 
+// Custom RTP/UDP input (Linux): batched reads with kernel arrival timestamps
+// instead of FFmpeg's UDP protocol handler. H.264/H.265 only.
+struct UdpReceiveConfig {
+    bool enabled = false;
+    int socketBufferKB = 16384;      // SO_RCVBUF; above net.core.rmem_max needs CAP_NET_ADMIN
+    int batchSize = 64;              // Datagrams per recvmmsg call
+    int busyPollUs = 0;              // SO_BUSY_POLL; 0 = off
+};
+
 struct StreamConfig {
     std::string url;
     StreamProtocol protocol = StreamProtocol::AUTO;
@@ -50,6 +68,44 @@ struct StreamConfig {
     int receiveTimeoutMs = 5000;
     int probeSize = 131072;          // 128KB - enough for H.264 SPS/PPS detection
     int analyzeDurationUs = 500000;  // 500ms - balanced for quick stream detection
+    DecoderThreading decoderThreading = DecoderThreading::AUTO;
+    int decoderThreadCount = 2;      // 0 = one thread per core (FFmpeg auto)
+    bool rtspListen = false;         // Wait for a publisher (ANNOUNCE/RECORD) instead of dialing out
+    UdpReceiveConfig udpReceive;     // RTP streams only
+    double senderClockOffsetMs = 0.0;  // Local clock minus the sender's, removed from sender latency
+};
+
+enum class ImpairmentMode {
+    NONE,
+    UDP,    // Relay RTP/RTCP datagrams (port and port + 1)
+    TCP     // Relay an RTSP connection; interleaved RTP frames are impaired
+};
+
+enum class DelayDistribution {
+    CONSTANT,   // delayMs exactly; jitter ignored
+    UNIFORM,    // delayMs +/- jitterMs
+    NORMAL,     // mean delayMs, standard deviation jitterMs
+    PARETO      // delayMs plus a heavy tail averaging jitterMs
+};
+
+// Network impairment applied by the relay to traffic from the camera
+struct ImpairmentConfig {
+    ImpairmentMode mode = ImpairmentMode::NONE;
+    int listenPort = 0;              // Local port receivers connect/send to
+    std::string targetHost;          // Camera (or test source) address
+    int targetPort = 0;
+
+    double delayMs = 0.0;
+    double jitterMs = 0.0;
+    DelayDistribution distribution = DelayDistribution::NORMAL;
+    double lossPercent = 0.0;        // Long-run packet loss
+    double lossBurst = 1.0;          // Mean packets per loss burst (1 = independent losses)
+    double reorderPercent = 0.0;     // Packets sent ahead of the delay queue (needs delay)
+    double bandwidthKbps = 0.0;      // 0 = unlimited
+    int queueLimitMs = 500;          // Drop once the bandwidth queue is this deep
+    uint32_t seed = 0;               // 0 = random; fixed seeds replay the same impairment
+    std::string logPath;             // Per-packet CSV of every decision (empty = off)
+    std::string capturePath;         // pcap of camera packets as received, before impairment
 };
 
 struct TestConfig {
@@ -68,6 +124,35 @@ struct AppConfig {
     int timestampPanelWidth = 400;
     std::string fontPath = "resources/fonts/RobotoMono-Bold.ttf";
     int fontSize = 48;
+    DecoderThreading decoderThreading = DecoderThreading::AUTO;
+    int decoderThreadCount = 2;
+    UdpReceiveConfig udpReceive;
+    double senderClockOffsetMs = 0.0;
+    double displayLagMs = 0.0;       // Panel processing delay after scan-out, if known
+    bool textAtlas = true;           // Draw text from glyph atlases (false: SDL_ttf per string)
+    bool flashMode = false;          // Flash the panel black/white and time luma edges (single stream)
+    bool clockOcr = true;            // Read the MM:SS.cc digits when the pattern can't be read
+    int patternRows = 1;             // Pattern copies down the clock panel, for rolling-shutter skew (1-3)
+    TestConfig test;
+    std::string historyPath = "results/history.jsonl";  // Append-only store of exported runs
+
+    // Pre-trigger packet buffer, dumped to recordings/ with B or on a latency spike
+    double packetBufferSec = 10.0;
+    int packetBufferMaxMB = 64;
+    int spikeThresholdMs = 0;        // 0 = no automatic dumps
+
+    // Shared-memory ring of decoded frames for external analyzers (empty name = off)
+    std::string frameExportName;
+    int frameExportSlots = 4;
+    int frameExportMaxWidth = 3840;  // Slot size; larger frames are skipped
+    int frameExportMaxHeight = 2160;
+
+    // Impairment relay started with the app (mode NONE = off)
+    ImpairmentConfig impairment;
+
+    // Multi-stream mode (enabled when streamUrls is non-empty)
+    std::vector<std::string> streamUrls;
+    int workerThreads = 0;           // 0 = hardware threads - 1
 };
 
 } // namespace latency
@@ -0,0 +1,315 @@
+#include "DecoderBenchmark.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+
+namespace latency {
+
+static const char* threadingLabel(DecoderThreading threading) {
+    switch (threading) {
+        case DecoderThreading::AUTO:  return "auto";
+        case DecoderThreading::FRAME: return "frame";
+        case DecoderThreading::SLICE: return "slice";
+        case DecoderThreading::NONE:  return "none";
+    }
+    return "unknown";
+}
+
+DecoderBenchmark::DecoderBenchmark() = default;
+
+DecoderBenchmark::~DecoderBenchmark() {
+    clear();
+}
+
+void DecoderBenchmark::clear() {
+    for (auto* packet : packets_) {
+        av_packet_free(&packet);
+    }
+    packets_.clear();
+
+    if (codecpar_) {
+        avcodec_parameters_free(&codecpar_);
+        codecpar_ = nullptr;
+    }
+}
+
+bool DecoderBenchmark::loadClip(const std::string& path, int maxFrames) {
+    clear();
+    clipPath_ = path;
+    lastError_.clear();
+
+    AVFormatContext* formatCtx = nullptr;
+    int ret = avformat_open_input(&formatCtx, path.c_str(), nullptr, nullptr);
+    if (ret < 0) {
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        lastError_ = "Failed to open clip: " + std::string(errBuf);
+        return false;
+    }
+
+    if (avformat_find_stream_info(formatCtx, nullptr) < 0) {
+        lastError_ = "Failed to find stream info";
+        avformat_close_input(&formatCtx);
+        return false;
+    }
+
+    int videoIndex = av_find_best_stream(formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (videoIndex < 0) {
+        lastError_ = "No video stream found";
+        avformat_close_input(&formatCtx);
+        return false;
+    }
+
+    AVStream* stream = formatCtx->streams[videoIndex];
+    codecpar_ = avcodec_parameters_alloc();
+    avcodec_parameters_copy(codecpar_, stream->codecpar);
+
+    streamInfo_ = StreamInfo{};
+    streamInfo_.codecName = avcodec_get_name(codecpar_->codec_id);
+    streamInfo_.width = codecpar_->width;
+    streamInfo_.height = codecpar_->height;
+    streamInfo_.bitrate = static_cast<int>(formatCtx->bit_rate);
+    if (stream->avg_frame_rate.den > 0) {
+        streamInfo_.fps = static_cast<double>(stream->avg_frame_rate.num) / stream->avg_frame_rate.den;
+    }
+
+    // Buffer the compressed packets so every run decodes identical input
+    AVPacket* packet = av_packet_alloc();
+    while (static_cast<int>(packets_.size()) < maxFrames && av_read_frame(formatCtx, packet) >= 0) {
+        if (packet->stream_index == videoIndex) {
+            packets_.push_back(av_packet_clone(packet));
+        }
+        av_packet_unref(packet);
+    }
+    av_packet_free(&packet);
+    avformat_close_input(&formatCtx);
+
+    if (packets_.empty()) {
+        lastError_ = "Clip contains no video packets";
+        return false;
+    }
+
+    return true;
+}
+
+DecoderBenchmarkResult DecoderBenchmark::run(const DecoderBenchmarkCase& benchCase) {
+    DecoderBenchmarkResult result;
+    result.config = benchCase;
+
+    const AVCodec* codec = codecpar_ ? avcodec_find_decoder(codecpar_->codec_id) : nullptr;
+    if (!codec) {
+        result.error = "Unsupported codec";
+        return result;
+    }
+
+    AVCodecContext* ctx = avcodec_alloc_context3(codec);
+    if (!ctx || avcodec_parameters_to_context(ctx, codecpar_) < 0) {
+        result.error = "Failed to set up codec context";
+        avcodec_free_context(&ctx);
+        return result;
+    }
+
+    // Same low-latency flags as VideoDecoder::openCodec
+    ctx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    ctx->flags2 |= AV_CODEC_FLAG2_FAST;
+    VideoDecoder::configureThreading(ctx, benchCase.threading, benchCase.threadCount);
+
+    int ret = avcodec_open2(ctx, codec, nullptr);
+    if (ret < 0) {
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        result.error = "Failed to open codec: " + std::string(errBuf);
+        avcodec_free_context(&ctx);
+        return result;
+    }
+    result.activeThreading = VideoDecoder::describeActiveThreading(ctx);
+
+    AVFrame* frame = av_frame_alloc();
+    LatencyHistogram delayHistogram;
+    std::unordered_map<int64_t, std::chrono::steady_clock::time_point> sendTimes;
+    uint64_t packetsSent = 0;
+    uint64_t delayFramesTotal = 0;
+
+    // Receive all frames currently available, recording per-frame delay
+    auto drainFrames = [&]() {
+        while (avcodec_receive_frame(ctx, frame) >= 0) {
+            auto now = std::chrono::steady_clock::now();
+            result.framesDecoded++;
+
+            int inFlight = static_cast<int>(static_cast<int64_t>(packetsSent) -
+                                            static_cast<int64_t>(result.framesDecoded));
+            delayFramesTotal += std::max(inFlight, 0);
+            result.maxDelayFrames = std::max(result.maxDelayFrames, inFlight);
+
+            auto it = sendTimes.find(frame->pts);
+            if (it != sendTimes.end()) {
+                delayHistogram.record(std::chrono::duration<double, std::micro>(now - it->second).count());
+                sendTimes.erase(it);
+            }
+            av_frame_unref(frame);
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (AVPacket* source : packets_) {
+        AVPacket* packet = av_packet_clone(source);
+
+        // Key by pts, falling back to dts for streams without presentation times
+        if (packet->pts == AV_NOPTS_VALUE) {
+            packet->pts = packet->dts;
+        }
+        sendTimes[packet->pts] = std::chrono::steady_clock::now();
+
+        ret = avcodec_send_packet(ctx, packet);
+        while (ret == AVERROR(EAGAIN)) {
+            drainFrames();
+            ret = avcodec_send_packet(ctx, packet);
+        }
+        av_packet_free(&packet);
+        if (ret >= 0) {
+            packetsSent++;
+        }
+
+        drainFrames();
+    }
+
+    // Flush frames held back by frame threading / reordering
+    avcodec_send_packet(ctx, nullptr);
+    drainFrames();
+
+    auto end = std::chrono::steady_clock::now();
+    result.wallTimeSec = std::chrono::duration<double>(end - start).count();
+    if (result.wallTimeSec > 0.0) {
+        result.throughputFps = result.framesDecoded / result.wallTimeSec;
+    }
+
+    result.delayUs = delayHistogram.getPercentiles();
+    if (result.framesDecoded > 0) {
+        result.avgDelayFrames = static_cast<double>(delayFramesTotal) / result.framesDecoded;
+    }
+
+    // On a live stream each frame held inside the decoder waits one frame interval
+    if (streamInfo_.fps > 0.0) {
+        result.liveDelayMs = result.avgDelayFrames * 1000.0 / streamInfo_.fps +
+                             result.delayUs.p50Us / 1000.0;
+    }
+
+    av_frame_free(&frame);
+    avcodec_free_context(&ctx);
+    return result;
+}
+
+std::vector<DecoderBenchmarkResult> DecoderBenchmark::runAll(const std::vector<DecoderBenchmarkCase>& cases) {
+    std::vector<DecoderBenchmarkResult> results;
+    results.reserve(cases.size());
+    for (const auto& benchCase : cases) {
+        results.push_back(run(benchCase));
+    }
+    return results;
+}
+
+std::vector<DecoderBenchmarkCase> DecoderBenchmark::defaultCases() {
+    std::vector<DecoderBenchmarkCase> cases;
+    cases.push_back({DecoderThreading::NONE, 1});
+
+    for (DecoderThreading threading : {DecoderThreading::SLICE, DecoderThreading::FRAME}) {
+        for (int threads : {2, 4, 0}) {
+            cases.push_back({threading, threads});
+        }
+    }
+
+    cases.push_back({DecoderThreading::AUTO, 2});  // Current default
+    return cases;
+}
+
+bool DecoderBenchmark::writeReport(const std::string& filename,
+                                   const std::vector<DecoderBenchmarkResult>& results) const {
+    nlohmann::json j;
+    j["clip"] = clipPath_;
+    j["codec"] = streamInfo_.codecName;
+    j["resolution"] = {
+        {"width", streamInfo_.width},
+        {"height", streamInfo_.height}
+    };
+    j["fps"] = streamInfo_.fps;
+    j["packets"] = packets_.size();
+    j["hardware_threads"] = std::thread::hardware_concurrency();
+
+    nlohmann::json runs = nlohmann::json::array();
+    for (const auto& r : results) {
+        nlohmann::json run = {
+            {"threading", threadingLabel(r.config.threading)},
+            {"thread_count", r.config.threadCount},
+            {"active_threading", r.activeThreading},
+            {"frames_decoded", r.framesDecoded},
+            {"wall_time_sec", r.wallTimeSec},
+            {"throughput_fps", r.throughputFps},
+            {"delay_p50_us", r.delayUs.p50Us},
+            {"delay_p99_us", r.delayUs.p99Us},
+            {"delay_max_us", r.delayUs.maxUs},
+            {"avg_delay_frames", r.avgDelayFrames},
+            {"max_delay_frames", r.maxDelayFrames},
+            {"live_delay_ms", r.liveDelayMs}
+        };
+        if (!r.error.empty()) {
+            run["error"] = r.error;
+        }
+        runs.push_back(run);
+    }
+    j["runs"] = runs;
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << j.dump(2);
+    return true;
+}
+
+std::string DecoderBenchmark::formatTable(const std::vector<DecoderBenchmarkResult>& results) const {
+    std::ostringstream oss;
+    oss << "Clip: " << clipPath_ << " (" << streamInfo_.codecName << " "
+        << streamInfo_.width << "x" << streamInfo_.height << " @ "
+        << std::fixed << std::setprecision(1) << streamInfo_.fps << " fps, "
+        << packets_.size() << " packets)\n\n";
+
+    oss << std::left << std::setw(8) << "Mode" << std::setw(9) << "Threads"
+        << std::setw(12) << "Active" << std::right
+        << std::setw(10) << "Fps" << std::setw(12) << "Delay p50"
+        << std::setw(12) << "Delay p99" << std::setw(10) << "Frames"
+        << std::setw(12) << "Live (ms)" << "\n";
+
+    for (const auto& r : results) {
+        std::string threads = r.config.threadCount == 0 ? "auto" : std::to_string(r.config.threadCount);
+        oss << std::left << std::setw(8) << threadingLabel(r.config.threading)
+            << std::setw(9) << threads;
+
+        if (!r.error.empty()) {
+            oss << "error: " << r.error << "\n";
+            continue;
+        }
+
+        oss << std::setw(12) << r.activeThreading << std::right << std::fixed
+            << std::setw(10) << std::setprecision(1) << r.throughputFps
+            << std::setw(12) << std::setprecision(2) << r.delayUs.p50Us / 1000.0
+            << std::setw(12) << r.delayUs.p99Us / 1000.0
+            << std::setw(10) << std::setprecision(1) << r.avgDelayFrames
+            << std::setw(12) << r.liveDelayMs << "\n";
+    }
+
+    return oss.str();
+}
+
+} // namespace latency
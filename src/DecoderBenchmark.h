@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Config.h"
+#include "LatencyHistogram.h"
+#include "VideoDecoder.h"
+#include <string>
+#include <vector>
+
+// Forward declarations for FFmpeg types
+struct AVPacket;
+struct AVCodecParameters;
+
+namespace latency {
+
+struct DecoderBenchmarkCase {
+    DecoderThreading threading = DecoderThreading::AUTO;
+    int threadCount = 2;
+};
+
+struct DecoderBenchmarkResult {
+    DecoderBenchmarkCase config;
+    std::string activeThreading;        // What FFmpeg actually used
+    uint64_t framesDecoded = 0;
+    double wallTimeSec = 0.0;
+    double throughputFps = 0.0;
+
+    // Per-frame decoder delay: packet submitted -> matching frame returned
+    LatencyPercentiles delayUs;
+    double avgDelayFrames = 0.0;        // Packets in flight when a frame came out
+    int maxDelayFrames = 0;
+    double liveDelayMs = 0.0;           // avgDelayFrames at the clip frame rate + p50 delay
+
+    std::string error;
+};
+
+// Decodes a recorded clip under several threading configurations.
+// The clip's video packets are read into memory once so disk and demux
+// time don't skew the comparison.
+class DecoderBenchmark {
+public:
+    DecoderBenchmark();
+    ~DecoderBenchmark();
+
+    // Load up to maxFrames video packets from a local file
+    bool loadClip(const std::string& path, int maxFrames = 1500);
+
+    DecoderBenchmarkResult run(const DecoderBenchmarkCase& benchCase);
+    std::vector<DecoderBenchmarkResult> runAll(const std::vector<DecoderBenchmarkCase>& cases);
+
+    // No threading, then slice and frame threading at 2/4/auto threads, then AUTO
+    static std::vector<DecoderBenchmarkCase> defaultCases();
+
+    // Write results as JSON (returns false on I/O error)
+    bool writeReport(const std::string& filename, const std::vector<DecoderBenchmarkResult>& results) const;
+
+    // Human-readable table
+    std::string formatTable(const std::vector<DecoderBenchmarkResult>& results) const;
+
+    const StreamInfo& getStreamInfo() const { return streamInfo_; }
+    std::string getLastError() const { return lastError_; }
+
+private:
+    void clear();
+
+    std::string clipPath_;
+    std::vector<AVPacket*> packets_;
+    AVCodecParameters* codecpar_ = nullptr;
+    StreamInfo streamInfo_;
+    std::string lastError_;
+};
+
+} // namespace latency
@@ -0,0 +1,146 @@
+#include "DisplayTiming.h"
+#include <algorithm>
+#include <cmath>
+
+namespace latency {
+
+namespace {
+
+double elapsedMs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+std::chrono::steady_clock::duration fromMs(double ms) {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(ms));
+}
+
+} // namespace
+
+void DisplayTiming::init(SDL_Window* window, double displayLagMs) {
+    window_ = window;
+    displayLagMs_ = std::max(0.0, displayLagMs);
+    queryDisplayMode();
+    periodMs_ = 1000.0 / (refreshHz_ > 0.0 ? refreshHz_ : DEFAULT_REFRESH_HZ);
+}
+
+void DisplayTiming::queryDisplayMode() {
+    lastModeQueryTicks_ = SDL_GetTicks();
+    int index = window_ ? SDL_GetWindowDisplayIndex(window_) : -1;
+    if (index < 0) return;
+
+    SDL_DisplayMode mode;
+    double refreshHz = 0.0;
+    if (SDL_GetCurrentDisplayMode(index, &mode) == 0 && mode.refresh_rate > 0) {
+        refreshHz = mode.refresh_rate;
+    }
+    if (refreshHz != refreshHz_ && refreshHz > 0.0) {
+        // Moved to another display or the mode changed: start from its nominal rate
+        periodMs_ = 1000.0 / refreshHz;
+        pacedScore_ = 0.0;
+    }
+    refreshHz_ = refreshHz;
+
+    SDL_Rect bounds;
+    if (SDL_GetDisplayBounds(index, &bounds) == 0) {
+        displayTop_ = bounds.y;
+        displayHeight_ = bounds.h;
+    }
+}
+
+void DisplayTiming::beginFrame() {
+    frameStart_ = std::chrono::steady_clock::now();
+    if (SDL_GetTicks() - lastModeQueryTicks_ >= MODE_QUERY_INTERVAL_MS) {
+        queryDisplayMode();
+    }
+}
+
+void DisplayTiming::endFrame() {
+    double renderMs = elapsedMs(frameStart_, std::chrono::steady_clock::now());
+    renderMs_ = renderMs_ > 0.0 ? renderMs_ + (renderMs - renderMs_) * 0.1 : renderMs;
+}
+
+void DisplayTiming::onPresented() {
+    auto now = std::chrono::steady_clock::now();
+    presents_++;
+    if (!havePresent_) {
+        havePresent_ = true;
+        lastPresent_ = now;
+        return;
+    }
+
+    double intervalMs = elapsedMs(lastPresent_, now);
+    lastPresent_ = now;
+
+    // Paced: close to a whole number of periods. Vsync off (or ignored by the
+    // driver) shows up as intervals well short of one period.
+    double periods = intervalMs / periodMs_;
+    double whole = std::max(1.0, std::round(periods));
+    double residualMs = intervalMs - whole * periodMs_;
+    bool paced = periods >= 1.0 - PACING_TOLERANCE && std::fabs(residualMs) <= periodMs_ * PACING_TOLERANCE;
+    pacedScore_ += ((paced ? 1.0 : 0.0) - pacedScore_) * 0.1;
+    if (!paced) return;
+
+    if (whole > 1.0) {
+        missedVblanks_ += static_cast<uint64_t>(whole) - 1;
+    } else {
+        periodMs_ += (intervalMs - periodMs_) * PERIOD_SMOOTHING;
+    }
+    jitterSumSq_ += residualMs * residualMs;
+    jitterCount_++;
+}
+
+std::chrono::steady_clock::time_point DisplayTiming::predictScanout(int windowY) {
+    auto now = std::chrono::steady_clock::now();
+
+    // Scan-out reaches the row this far into the refresh
+    double rowFraction = 0.0;
+    if (window_ && displayHeight_ > 0) {
+        int windowX = 0, windowTop = 0;
+        SDL_GetWindowPosition(window_, &windowX, &windowTop);
+        rowFraction = std::clamp(static_cast<double>(windowTop + windowY - displayTop_) / displayHeight_, 0.0, 1.0);
+    }
+
+    // First vblank once the frame being drawn is presented; without vsync
+    // the row is next scanned anywhere in the coming period
+    auto ready = now + fromMs(renderMs_);
+    std::chrono::steady_clock::time_point vblank;
+    if (havePresent_ && pacedScore_ >= 0.5) {
+        double sinceMs = elapsedMs(lastPresent_, ready);
+        double periods = std::max(0.0, std::ceil(sinceMs / periodMs_));
+        vblank = lastPresent_ + fromMs(periods * periodMs_);
+    } else {
+        vblank = ready;
+    }
+
+    auto visible = vblank + fromMs((rowFraction + 0.5) * periodMs_ + displayLagMs_);
+    lastLeadMs_ = elapsedMs(now, visible);
+    return visible;
+}
+
+DisplayTimingStats DisplayTiming::getStats() const {
+    DisplayTimingStats stats;
+    stats.refreshHz = refreshHz_;
+    stats.periodMs = periodMs_;
+    stats.vsyncLocked = havePresent_ && pacedScore_ >= 0.5;
+    stats.presents = presents_;
+    stats.missedVblanks = missedVblanks_;
+    stats.presentJitterMs = jitterCount_ ? std::sqrt(jitterSumSq_ / jitterCount_) : 0.0;
+    stats.renderMs = renderMs_;
+    stats.scanoutLeadMs = lastLeadMs_;
+    stats.displayLagMs = displayLagMs_;
+
+    // Half a refresh from where in it the camera sampled; without vsync the
+    // refresh itself is unknown, and present timing adds its own spread
+    stats.uncertaintyMs = periodMs_ * (stats.vsyncLocked ? 0.5 : 1.0) + stats.presentJitterMs;
+    return stats;
+}
+
+void DisplayTiming::resetCounters() {
+    presents_ = 0;
+    missedVblanks_ = 0;
+    jitterSumSq_ = 0.0;
+    jitterCount_ = 0;
+}
+
+} // namespace latency
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <SDL.h>
+#include <chrono>
+#include <cstdint>
+
+namespace latency {
+
+struct DisplayTimingStats {
+    double refreshHz = 0.0;            // Display mode (0 = unknown, 60 assumed)
+    double periodMs = 0.0;             // Refresh period measured from presents
+    bool vsyncLocked = false;          // Presents are paced by vblank
+    uint64_t presents = 0;
+    uint64_t missedVblanks = 0;        // Refreshes that went by without a new frame
+    double presentJitterMs = 0.0;      // Std dev of paced present intervals around the period
+    double renderMs = 0.0;             // Average time to draw a frame, before presenting it
+    double scanoutLeadMs = 0.0;        // Last frame: render time -> expected scan-out of the pattern
+    double displayLagMs = 0.0;         // Configured panel processing delay, added to the lead
+    double uncertaintyMs = 0.0;        // +/- a reading carries from the display side
+};
+
+// Tracks when frames are actually presented, so the clock panel can show
+// the time its pixels are on screen rather than the time they were drawn.
+// With vsync, presents return on vblank: they set the phase of the vblank
+// grid and the measured period. A frame drawn now is expected on the first
+// vblank after the usual render time, plus the scan-out time down to the
+// pattern's row and the configured panel lag. A camera samples the pixels
+// anywhere in the refresh they stay up for, so the prediction is the middle
+// of that refresh and a reading is good to half a period either way.
+// Intervals of more than one period count as missed vblanks. UI thread only.
+class DisplayTiming {
+public:
+    // displayLagMs: panel processing delay, if known (not measurable here)
+    void init(SDL_Window* window, double displayLagMs);
+
+    // Bracket each frame: before drawing, before SDL_RenderPresent and after it
+    void beginFrame();
+    void endFrame();
+    void onPresented();
+
+    // When pixels drawn now at window row y are expected on screen (middle of their refresh)
+    std::chrono::steady_clock::time_point predictScanout(int windowY);
+
+    DisplayTimingStats getStats() const;
+
+    // Start counting presents and missed vblanks afresh (a new test)
+    void resetCounters();
+
+private:
+    void queryDisplayMode();
+
+    static constexpr double DEFAULT_REFRESH_HZ = 60.0;
+    static constexpr double PERIOD_SMOOTHING = 0.05;      // EMA weight of a paced interval
+    static constexpr double PACING_TOLERANCE = 0.25;      // Of a period, for an interval to count as paced
+    static constexpr uint32_t MODE_QUERY_INTERVAL_MS = 2000;
+
+    SDL_Window* window_ = nullptr;
+    double displayLagMs_ = 0.0;
+    double refreshHz_ = 0.0;
+    int displayTop_ = 0;               // Screen rows of the window's display
+    int displayHeight_ = 0;
+    uint32_t lastModeQueryTicks_ = 0;
+
+    double periodMs_ = 1000.0 / DEFAULT_REFRESH_HZ;
+    bool havePresent_ = false;
+    std::chrono::steady_clock::time_point lastPresent_;
+    std::chrono::steady_clock::time_point frameStart_;
+    double renderMs_ = 0.0;            // EMA of beginFrame -> endFrame
+    double pacedScore_ = 0.0;          // EMA of presents landing on the vblank grid
+
+    uint64_t presents_ = 0;
+    uint64_t missedVblanks_ = 0;
+    double jitterSumSq_ = 0.0;
+    uint64_t jitterCount_ = 0;
+    double lastLeadMs_ = 0.0;
+};
+
+} // namespace latency
@@ -0,0 +1,141 @@
+#include "FlashDetector.h"
+#include "TimestampDisplay.h"
+#include "TimestampPattern.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace latency {
+
+double FlashDetector::meanLuma(const VideoFrame& frame) {
+    if (!frame.data || frame.width <= 0 || frame.height <= 0) {
+        return 0.0;
+    }
+
+    const int bytesPerPixel = 3;  // RGB24
+    const int columns = std::min(FLASH_GRID_COLUMNS, frame.width);
+    const int rows = std::min(FLASH_GRID_ROWS, frame.height);
+
+    // Cell centres; integer BT.601 weights scaled by 256
+    uint32_t total = 0;
+    for (int r = 0; r < rows; r++) {
+        int y = (2 * r + 1) * frame.height / (2 * rows);
+        const uint8_t* row = frame.data + y * frame.pitch;
+        for (int c = 0; c < columns; c++) {
+            const uint8_t* pixel = row + ((2 * c + 1) * frame.width / (2 * columns)) * bytesPerPixel;
+            total += 77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2];
+        }
+    }
+    return total / 256.0 / (rows * columns);
+}
+
+LatencyMeasurement FlashDetector::process(const VideoFrame& frame, uint32_t now, const TimestampDisplay& display) {
+    LatencyMeasurement result;
+    result.source = MeasurementSource::Flash;
+    result.actualTimestamp = now;
+
+    auto sampleStart = std::chrono::steady_clock::now();
+    double luma = meanLuma(frame);
+    double sampleUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sampleStart).count();
+
+    stats_.frames++;
+    totalSampleUs_ += sampleUs;
+    stats_.avgSampleUs = totalSampleUs_ / stats_.frames;
+    stats_.maxSampleUs = std::max(stats_.maxSampleUs, sampleUs);
+
+    // Until the panel has flashed once, just learn the dark and bright levels
+    if (!haveLevels_) {
+        lowLuma_ = highLuma_ = luma;
+        haveLevels_ = true;
+    }
+    if (highLuma_ - lowLuma_ < MIN_CONTRAST) {
+        lowLuma_ = std::min(lowLuma_, luma);
+        highLuma_ = std::max(highLuma_, luma);
+        bright_ = luma > (lowLuma_ + highLuma_) / 2.0;
+        stats_.lowLuma = lowLuma_;
+        stats_.highLuma = highLuma_;
+        return result;
+    }
+
+    const double mid = (lowLuma_ + highLuma_) / 2.0;
+    const double band = HYSTERESIS * (highLuma_ - lowLuma_);
+    const bool wasBright = bright_;
+    if (!bright_ && luma > mid + band) {
+        bright_ = true;
+    } else if (bright_ && luma < mid - band) {
+        bright_ = false;
+    }
+
+    // Follow exposure and scene changes using frames settled in their state
+    if (bright_ && luma > mid + band) {
+        highLuma_ += (luma - highLuma_) * LEVEL_RATE;
+    } else if (!bright_ && luma < mid - band) {
+        lowLuma_ += (luma - lowLuma_) * LEVEL_RATE;
+    }
+    stats_.lowLuma = lowLuma_;
+    stats_.highLuma = highLuma_;
+
+    if (bright_ == wasBright) {
+        return result;
+    }
+    stats_.edges++;
+
+    // Time since the previous edge, from the camera's timestamps when it has them
+    double intervalMs = 0.0;
+    if (havePreviousEdge_) {
+        intervalMs = frame.ptsMs > previousEdgePtsMs_ ? frame.ptsMs - previousEdgePtsMs_
+                                                      : static_cast<double>(now - previousEdgeTime_);
+    }
+    havePreviousEdge_ = true;
+    previousEdgePtsMs_ = frame.ptsMs;
+    previousEdgeTime_ = now;
+
+    uint32_t edgeTimestamp = 0;
+    if (!matchEdge(bright_, intervalMs, now, display, edgeTimestamp)) {
+        return result;
+    }
+
+    int32_t latency = static_cast<int32_t>(now - edgeTimestamp);
+    if (latency < MIN_PLAUSIBLE_LATENCY_MS || latency > MAX_PLAUSIBLE_LATENCY_MS) {
+        return result;
+    }
+
+    stats_.matched++;
+    result.displayedTimestamp = edgeTimestamp;
+    result.latencyMs = latency;
+    result.valid = true;
+    return result;
+}
+
+bool FlashDetector::matchEdge(bool toWhite, double intervalMs, uint32_t now, const TimestampDisplay& display,
+                              uint32_t& edgeTimestamp) const {
+    // The first edge, or one after a missed edge, can't be placed in the cycle
+    if (intervalMs <= 0.0) {
+        return false;
+    }
+
+    for (int edge = toWhite ? 0 : 1; edge < FLASH_EDGES_PER_CYCLE; edge += 2) {
+        if (std::fabs(intervalMs - flashIntervalBefore(edge)) <= FLASH_INTERVAL_TOLERANCE_MS) {
+            return display.findFlashEdge(edge, now, edgeTimestamp);
+        }
+    }
+    return false;
+}
+
+void FlashDetector::reset() {
+    stats_ = FlashDetectorStats{};
+    totalSampleUs_ = 0.0;
+    haveLevels_ = false;
+    bright_ = false;
+    havePreviousEdge_ = false;
+    previousEdgePtsMs_ = 0.0;
+    previousEdgeTime_ = 0;
+    lowLuma_ = 0.0;
+    highLuma_ = 0.0;
+}
+
+FlashDetectorStats FlashDetector::getStats() const {
+    return stats_;
+}
+
+} // namespace latency
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "LatencyMeasurer.h"
+#include <cstdint>
+
+namespace latency {
+
+class TimestampDisplay;
+
+struct FlashDetectorStats {
+    uint64_t frames = 0;
+    uint64_t edges = 0;              // Black/white transitions seen in the video
+    uint64_t matched = 0;            // Edges paired with the display edge they show
+    double lowLuma = 0.0;            // Tracked dark and bright levels (0-255)
+    double highLuma = 0.0;
+    double avgSampleUs = 0.0;        // Cost of the luma sampling per frame
+    double maxSampleUs = 0.0;
+};
+
+// Flash-mode reader: instead of decoding a pattern, follows the mean luma of
+// a sparse grid over the whole frame and reports a latency at each
+// black/white edge, against the time the clock panel drew that edge. Costs
+// a few microseconds per frame; resolution is one camera frame. The panel
+// should fill much of the camera's view.
+class FlashDetector {
+public:
+    // Analyze one frame received at clock time now (ms). Valid only on frames
+    // where an edge was matched to the display.
+    LatencyMeasurement process(const VideoFrame& frame, uint32_t now, const TimestampDisplay& display);
+
+    void reset();
+    FlashDetectorStats getStats() const;
+
+    // Mean luma (BT.601, 0-255) of a FLASH_GRID_COLUMNS x FLASH_GRID_ROWS grid of pixels
+    static double meanLuma(const VideoFrame& frame);
+
+    static constexpr int FLASH_GRID_COLUMNS = 64;
+    static constexpr int FLASH_GRID_ROWS = 36;
+
+private:
+    bool matchEdge(bool toWhite, double intervalMs, uint32_t now, const TimestampDisplay& display,
+                   uint32_t& edgeTimestamp) const;
+
+    FlashDetectorStats stats_;
+    double totalSampleUs_ = 0.0;
+
+    bool haveLevels_ = false;
+    bool bright_ = false;
+    bool havePreviousEdge_ = false;
+    double previousEdgePtsMs_ = 0.0;
+    uint32_t previousEdgeTime_ = 0;
+    double lowLuma_ = 0.0;
+    double highLuma_ = 0.0;
+
+    static constexpr double MIN_CONTRAST = 24.0;     // Luma levels between dark and bright
+    static constexpr double HYSTERESIS = 0.15;       // Of the contrast, either side of the midpoint
+    static constexpr double LEVEL_RATE = 0.05;       // Settled frames' pull on the dark/bright level
+};
+
+} // namespace latency
@@ -0,0 +1,429 @@
+#include "FleetSurvey.h"
+#include "WorkerPool.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+
+namespace latency {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// Aborts blocking FFmpeg I/O once the deadline has passed
+struct Deadline {
+    Clock::time_point at;
+
+    static int check(void* opaque) {
+        return Clock::now() > static_cast<Deadline*>(opaque)->at ? 1 : 0;
+    }
+};
+
+// Time the RTSP TEARDOWN gets once the probe deadline has already passed
+constexpr int CLOSE_TIMEOUT_MS = 1000;
+
+// Closes the input under a fresh deadline: an expired one would abort the
+// TEARDOWN and leave the camera streaming to us and holding the session
+void closeInput(AVFormatContext*& formatCtx, Deadline& deadline) {
+    deadline.at = Clock::now() + std::chrono::milliseconds(CLOSE_TIMEOUT_MS);
+    avformat_close_input(&formatCtx);
+}
+
+std::string ffmpegError(int code) {
+    char errBuf[256];
+    av_strerror(code, errBuf, sizeof(errBuf));
+    return errBuf;
+}
+
+StreamProtocol protocolOf(const std::string& url) {
+    if (url.find("rtp://") == 0) return StreamProtocol::RTP;
+    if (url.size() > 4 && url.compare(url.size() - 4, 4, ".sdp") == 0) return StreamProtocol::RTP;
+    if (url.find("file:") == 0 || url.find("://") == std::string::npos) return StreamProtocol::LOCAL_FILE;
+    return StreamProtocol::RTSP;
+}
+
+const char* transportKey(TransportProtocol transport) {
+    switch (transport) {
+        case TransportProtocol::TCP: return "tcp";
+        case TransportProtocol::UDP: return "udp";
+        default:                     return "auto";
+    }
+}
+
+const char* stageKey(ConnectionStage stage) {
+    switch (stage) {
+        case ConnectionStage::OpeningInput:       return "opening_input";
+        case ConnectionStage::FindingStreamInfo:  return "finding_stream_info";
+        case ConnectionStage::FindingVideoStream: return "finding_video_stream";
+        case ConnectionStage::OpeningCodec:       return "opening_codec";
+        case ConnectionStage::Connected:          return "connected";
+        default:                                  return "not_started";
+    }
+}
+
+// Position in the sample when a keyframe arrived
+struct KeyframeMark {
+    int64_t pts = AV_NOPTS_VALUE;
+    Clock::time_point at;
+    uint64_t packetsBefore = 0;
+    uint64_t bytesBefore = 0;
+};
+
+} // namespace
+
+FleetSurvey::FleetSurvey(const SurveyConfig& config)
+    : config_(config) {
+}
+
+std::vector<SurveyResult> FleetSurvey::run(const std::vector<std::string>& urls, const ResultCallback& onResult) {
+    std::vector<SurveyResult> results(urls.size());
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t finished = 0;
+
+    {
+        // Probes mostly wait on the network: size the pool by the concurrency limit, not the cores
+        WorkerPool pool(static_cast<size_t>(std::max(1, config_.concurrency)));
+        for (size_t i = 0; i < urls.size(); i++) {
+            pool.submit([&, i] {
+                SurveyResult result = probe(urls[i]);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                results[i] = std::move(result);
+                finished++;
+                if (onResult) onResult(results[i], finished);
+                cv.notify_all();
+            });
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return finished == urls.size(); });
+    }
+    return results;
+}
+
+SurveyResult FleetSurvey::probe(const std::string& url) const {
+    SurveyResult result;
+    result.url = url;
+    auto start = Clock::now();
+
+    StreamProtocol protocol = protocolOf(url);
+    std::vector<TransportProtocol> transports = { TransportProtocol::UDP };
+    if (protocol == StreamProtocol::RTSP) {
+        transports = { TransportProtocol::UDP, TransportProtocol::TCP };
+    }
+
+    Deadline deadline;
+    AVFormatContext* formatCtx = nullptr;
+    int videoIndex = -1;
+
+    for (auto transport : transports) {
+        SurveyAttempt attempt;
+        attempt.transport = transport;
+        deadline.at = Clock::now() + std::chrono::milliseconds(config_.connectionTimeoutMs);
+
+        formatCtx = avformat_alloc_context();
+        if (!formatCtx) {
+            attempt.failedAt = ConnectionStage::OpeningInput;
+            attempt.error = "Failed to allocate format context";
+            result.attempts.push_back(attempt);
+            break;
+        }
+        formatCtx->interrupt_callback.callback = &Deadline::check;
+        formatCtx->interrupt_callback.opaque = &deadline;
+
+        AVDictionary* options = nullptr;
+        if (protocol == StreamProtocol::RTSP) {
+            av_dict_set(&options, "rtsp_transport", transport == TransportProtocol::TCP ? "tcp" : "udp", 0);
+            // Don't set up audio or metadata tracks
+            av_dict_set(&options, "allowed_media_types", "video", 0);
+        } else if (protocol == StreamProtocol::RTP) {
+            av_dict_set(&options, "protocol_whitelist", "file,udp,rtp", 0);
+            av_dict_set(&options, "reorder_queue_size", "500", 0);
+        }
+        if (protocol != StreamProtocol::LOCAL_FILE) {
+            av_dict_set(&options, "probesize", std::to_string(config_.probeSize).c_str(), 0);
+            av_dict_set(&options, "analyzeduration", std::to_string(config_.analyzeDurationUs).c_str(), 0);
+        }
+
+        // Stage: Opening input (frees the context on failure)
+        attempt.failedAt = ConnectionStage::OpeningInput;
+        auto stageStart = Clock::now();
+        int ret = avformat_open_input(&formatCtx, url.c_str(), nullptr, &options);
+        av_dict_free(&options);
+        attempt.openInputMs = elapsedMs(stageStart, Clock::now());
+        if (ret < 0) {
+            attempt.error = ffmpegError(ret);
+            formatCtx = nullptr;
+            result.attempts.push_back(attempt);
+            continue;
+        }
+
+        // Stage: Finding stream info
+        attempt.failedAt = ConnectionStage::FindingStreamInfo;
+        stageStart = Clock::now();
+        ret = avformat_find_stream_info(formatCtx, nullptr);
+        attempt.streamInfoMs = elapsedMs(stageStart, Clock::now());
+        if (ret < 0) {
+            attempt.error = ffmpegError(ret);
+            closeInput(formatCtx, deadline);
+            result.attempts.push_back(attempt);
+            continue;
+        }
+
+        // Stage: Finding video stream
+        attempt.failedAt = ConnectionStage::FindingVideoStream;
+        videoIndex = av_find_best_stream(formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (videoIndex < 0) {
+            attempt.error = "No video stream found";
+            closeInput(formatCtx, deadline);
+            result.attempts.push_back(attempt);
+            continue;
+        }
+
+        attempt.failedAt = ConnectionStage::Connected;
+        result.attempts.push_back(attempt);
+        if (protocol == StreamProtocol::RTSP) {
+            result.transport = transportKey(transport);
+        } else {
+            result.transport = protocol == StreamProtocol::RTP ? "rtp" : "file";
+        }
+        break;
+    }
+
+    result.connectMs = elapsedMs(start, Clock::now());
+    if (!formatCtx) {
+        result.error = result.attempts.empty() ? "Not attempted" : result.attempts.back().error;
+        return result;
+    }
+    result.reachable = true;
+
+    AVStream* stream = formatCtx->streams[videoIndex];
+    result.codec = avcodec_get_name(stream->codecpar->codec_id);
+    result.width = stream->codecpar->width;
+    result.height = stream->codecpar->height;
+    if (stream->avg_frame_rate.den > 0 && stream->avg_frame_rate.num > 0) {
+        result.fps = av_q2d(stream->avg_frame_rate);
+    } else if (stream->r_frame_rate.den > 0) {
+        result.fps = av_q2d(stream->r_frame_rate);
+    }
+
+    // Only the video packets are demuxed; none of them are decoded
+    for (unsigned int i = 0; i < formatCtx->nb_streams; i++) {
+        if (static_cast<int>(i) != videoIndex) {
+            formatCtx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    auto sampleStart = Clock::now();
+    deadline.at = sampleStart + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(config_.sampleSec));
+
+    AVPacket* packet = av_packet_alloc();
+    uint64_t bytes = 0;
+    KeyframeMark firstKey;
+    KeyframeMark lastKey;
+    while (packet && result.keyframes < static_cast<uint64_t>(std::max(2, config_.sampleKeyframes))) {
+        int ret = av_read_frame(formatCtx, packet);
+        if (ret == AVERROR(EAGAIN)) continue;
+        if (ret < 0) {
+            // The deadline ending the sample is not an error
+            if (ret != AVERROR_EXIT && ret != AVERROR_EOF && result.packets == 0) {
+                result.error = "No packets: " + ffmpegError(ret);
+            }
+            break;
+        }
+
+        if (packet->stream_index == videoIndex) {
+            if (packet->flags & AV_PKT_FLAG_KEY) {
+                KeyframeMark mark;
+                mark.pts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+                mark.at = Clock::now();
+                mark.packetsBefore = result.packets;
+                mark.bytesBefore = bytes;
+                if (result.keyframes == 0) {
+                    result.firstKeyframeMs = elapsedMs(start, mark.at);
+                    firstKey = mark;
+                }
+                lastKey = mark;
+                result.keyframes++;
+            }
+            result.packets++;
+            bytes += static_cast<uint64_t>(packet->size);
+        }
+        av_packet_unref(packet);
+    }
+    av_packet_free(&packet);
+    result.sampleSec = elapsedMs(sampleStart, Clock::now()) / 1000.0;
+
+    // Whole GOPs between the first and last keyframe give the steady-state rate;
+    // without two keyframes fall back to the whole sample
+    uint64_t gops = result.keyframes >= 2 ? result.keyframes - 1 : 0;
+    if (gops > 0) {
+        double spanMs = elapsedMs(firstKey.at, lastKey.at);
+        if (firstKey.pts != AV_NOPTS_VALUE && lastKey.pts != AV_NOPTS_VALUE && lastKey.pts > firstKey.pts) {
+            spanMs = (lastKey.pts - firstKey.pts) * av_q2d(stream->time_base) * 1000.0;
+        }
+        uint64_t gopPackets = lastKey.packetsBefore - firstKey.packetsBefore;
+        result.gopFrames = static_cast<double>(gopPackets) / gops;
+        result.gopMs = spanMs / gops;
+        if (spanMs > 0.0) {
+            result.bitrateKbps = (lastKey.bytesBefore - firstKey.bytesBefore) * 8.0 / spanMs;
+            result.measuredFps = gopPackets * 1000.0 / spanMs;
+        }
+    } else if (result.sampleSec > 0.0) {
+        result.bitrateKbps = bytes * 8.0 / (result.sampleSec * 1000.0);
+        result.measuredFps = result.packets / result.sampleSec;
+    }
+
+    closeInput(formatCtx, deadline);
+    return result;
+}
+
+bool FleetSurvey::writeReport(const std::string& filename, const std::vector<SurveyResult>& results,
+                              double wallTimeSec) const {
+    nlohmann::json j;
+    j["cameras"] = results.size();
+    j["reachable"] = std::count_if(results.begin(), results.end(),
+                                   [](const SurveyResult& r) { return r.reachable; });
+    j["concurrency"] = config_.concurrency;
+    j["sample_sec"] = config_.sampleSec;
+    j["connection_timeout_ms"] = config_.connectionTimeoutMs;
+    j["wall_time_sec"] = wallTimeSec;
+
+    nlohmann::json cameras = nlohmann::json::array();
+    for (const auto& r : results) {
+        nlohmann::json camera;
+        camera["url"] = r.url;
+        camera["reachable"] = r.reachable;
+        if (!r.error.empty()) {
+            camera["error"] = r.error;
+        }
+        camera["connect_ms"] = r.connectMs;
+
+        nlohmann::json attempts = nlohmann::json::array();
+        for (const auto& attempt : r.attempts) {
+            nlohmann::json a = {
+                {"transport", transportKey(attempt.transport)},
+                {"result", stageKey(attempt.failedAt)},
+                {"open_input_ms", attempt.openInputMs},
+                {"stream_info_ms", attempt.streamInfoMs}
+            };
+            if (!attempt.error.empty()) {
+                a["error"] = attempt.error;
+            }
+            attempts.push_back(a);
+        }
+        camera["attempts"] = attempts;
+
+        if (r.reachable) {
+            camera["transport"] = r.transport;
+            camera["codec"] = r.codec;
+            camera["resolution"] = {
+                {"width", r.width},
+                {"height", r.height}
+            };
+            camera["fps"] = r.fps;
+            camera["measured_fps"] = r.measuredFps;
+            camera["gop_frames"] = r.gopFrames;
+            camera["gop_ms"] = r.gopMs;
+            camera["bitrate_kbps"] = r.bitrateKbps;
+            camera["first_keyframe_ms"] = r.firstKeyframeMs >= 0.0 ? nlohmann::json(r.firstKeyframeMs)
+                                                                   : nlohmann::json(nullptr);
+            camera["sample_sec"] = r.sampleSec;
+            camera["packets"] = r.packets;
+            camera["keyframes"] = r.keyframes;
+        }
+        cameras.push_back(camera);
+    }
+    j["results"] = cameras;
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << j.dump(2);
+    return true;
+}
+
+std::string FleetSurvey::formatLine(const SurveyResult& result) {
+    std::ostringstream oss;
+    oss << result.url << ": ";
+    if (!result.reachable) {
+        oss << "FAILED (" << result.error << ")";
+        return oss.str();
+    }
+
+    oss << result.transport << " " << result.codec << " " << result.width << "x" << result.height
+        << std::fixed << std::setprecision(1) << " " << result.measuredFps << " fps, ";
+    if (result.gopFrames > 0.0) {
+        oss << "GOP " << result.gopFrames << " (" << std::setprecision(0) << result.gopMs << " ms), ";
+    } else {
+        oss << "GOP ? (" << result.keyframes << " keyframe" << (result.keyframes == 1 ? "" : "s") << "), ";
+    }
+    oss << std::setprecision(0) << result.bitrateKbps << " kb/s, connect " << result.connectMs << " ms";
+    if (result.firstKeyframeMs >= 0.0) {
+        oss << ", keyframe " << result.firstKeyframeMs << " ms";
+    }
+    return oss.str();
+}
+
+std::string FleetSurvey::formatTable(const std::vector<SurveyResult>& results) {
+    size_t reachable = 0;
+    std::map<std::string, size_t> transports;
+    std::map<std::string, size_t> codecs;
+    std::vector<double> connectMs;
+    for (const auto& r : results) {
+        if (!r.reachable) continue;
+        reachable++;
+        transports[r.transport]++;
+        codecs[r.codec]++;
+        connectMs.push_back(r.connectMs);
+    }
+
+    std::ostringstream oss;
+    oss << reachable << "/" << results.size() << " cameras reachable";
+    for (const auto& t : transports) {
+        oss << ", " << t.second << " " << t.first;
+    }
+    oss << "\n";
+
+    if (!codecs.empty()) {
+        oss << "Codecs:";
+        for (const auto& c : codecs) {
+            oss << " " << c.first << " x" << c.second;
+        }
+        oss << "\n";
+    }
+
+    if (!connectMs.empty()) {
+        std::sort(connectMs.begin(), connectMs.end());
+        oss << "Connect: median " << std::fixed << std::setprecision(0)
+            << connectMs[connectMs.size() / 2] << " ms, slowest " << connectMs.back() << " ms\n";
+    }
+
+    for (const auto& r : results) {
+        if (!r.reachable) {
+            oss << "  FAILED " << r.url << ": " << r.error << "\n";
+        }
+    }
+    return oss.str();
+}
+
+} // namespace latency
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Config.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace latency {
+
+struct SurveyConfig {
+    int concurrency = 16;            // Cameras probed at once
+    double sampleSec = 10.0;         // Longest time spent reading packets from each camera
+    int sampleKeyframes = 3;         // Stop reading once this many keyframes arrived (two whole GOPs)
+    int connectionTimeoutMs = 10000; // Per transport attempt
+    int probeSize = 131072;
+    int analyzeDurationUs = 500000;
+};
+
+struct SurveyAttempt {
+    TransportProtocol transport = TransportProtocol::UDP;
+    ConnectionStage failedAt = ConnectionStage::NotStarted;  // Connected on success
+    std::string error;
+    double openInputMs = 0.0;        // avformat_open_input (RTSP DESCRIBE/SETUP/PLAY)
+    double streamInfoMs = 0.0;       // avformat_find_stream_info
+};
+
+struct SurveyResult {
+    std::string url;
+    bool reachable = false;
+    std::string error;
+    std::vector<SurveyAttempt> attempts;
+    std::string transport;           // "udp", "tcp", "rtp" or "file"
+    double connectMs = 0.0;          // Probe start -> stream info, failed attempts included
+
+    std::string codec;
+    int width = 0;
+    int height = 0;
+    double fps = 0.0;                // Nominal, from the stream
+
+    // From the sampled packets
+    double sampleSec = 0.0;
+    uint64_t packets = 0;
+    uint64_t keyframes = 0;
+    double measuredFps = 0.0;
+    double gopFrames = 0.0;          // Mean frames per whole GOP (0 = fewer than two keyframes)
+    double gopMs = 0.0;
+    double bitrateKbps = 0.0;        // Over whole GOPs when there are any
+    double firstKeyframeMs = -1.0;   // Probe start -> first keyframe demuxed (-1 = none)
+};
+
+// Health check of many cameras at once. Each camera is opened with the
+// same transport fallback as a live connection, then its video packets are
+// read for a few seconds without decoding: keyframe flags, sizes and
+// timestamps give the GOP, bitrate and frame rate. Other media are not set
+// up. Every network wait is bounded by an interrupt deadline, so a dead
+// camera costs at most its timeouts.
+class FleetSurvey {
+public:
+    explicit FleetSurvey(const SurveyConfig& config = SurveyConfig{});
+
+    // Probe every URL, at most config.concurrency at a time. onResult is
+    // called once per camera as it finishes (serialized, any thread) with
+    // the number finished so far. Results keep the order of urls.
+    using ResultCallback = std::function<void(const SurveyResult&, size_t finished)>;
+    std::vector<SurveyResult> run(const std::vector<std::string>& urls, const ResultCallback& onResult = nullptr);
+
+    SurveyResult probe(const std::string& url) const;
+
+    // Write results as JSON (returns false on I/O error)
+    bool writeReport(const std::string& filename, const std::vector<SurveyResult>& results,
+                     double wallTimeSec) const;
+
+    // One line per camera, and a per-site table
+    static std::string formatLine(const SurveyResult& result);
+    static std::string formatTable(const std::vector<SurveyResult>& results);
+
+private:
+    SurveyConfig config_;
+};
+
+} // namespace latency
@@ -0,0 +1,202 @@
+#include "FrameBus.h"
+#include <algorithm>
+
+namespace latency {
+
+namespace {
+
+double msSince(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // namespace
+
+FrameSubscription::FrameSubscription(std::string name, size_t depth, FrameDropPolicy policy)
+    : name_(std::move(name)), depth_(std::max<size_t>(1, depth)), policy_(policy) {
+}
+
+void FrameSubscription::deliver(const SharedFrame& frame, uint64_t sequence) {
+    auto now = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (closed_) return;
+    seenUpTo_ = sequence + 1;
+
+    if (queue_.size() >= depth_) {
+        switch (policy_) {
+        case FrameDropPolicy::DropOldest:
+            while (queue_.size() >= depth_) {
+                queue_.pop_front();
+                dropped_++;
+            }
+            break;
+        case FrameDropPolicy::DropNewest:
+            dropped_++;
+            return;
+        case FrameDropPolicy::Block:
+            cv_.wait(lock, [this] { return queue_.size() < depth_ || closed_; });
+            if (closed_) return;
+            blockedMs_ += msSince(now, std::chrono::steady_clock::now());
+            now = std::chrono::steady_clock::now();
+            break;
+        }
+    }
+
+    queue_.push_back(BusFrame{frame, sequence, now});
+    delivered_++;
+    lock.unlock();
+    cv_.notify_all();
+}
+
+BusFrame FrameSubscription::popLocked() {
+    if (queue_.empty()) return BusFrame{};
+    BusFrame frame = std::move(queue_.front());
+    queue_.pop_front();
+    taken_++;
+    takenUpTo_ = frame.sequence + 1;
+    return frame;
+}
+
+BusFrame FrameSubscription::take() {
+    BusFrame frame;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        frame = popLocked();
+    }
+    if (frame) {
+        cv_.notify_all();  // Room for a publisher blocked on a full queue
+    }
+    return frame;
+}
+
+BusFrame FrameSubscription::waitTake(int timeoutMs) {
+    BusFrame frame;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] {
+            return !queue_.empty() || closed_;
+        });
+        frame = popLocked();
+    }
+    if (frame) {
+        cv_.notify_all();
+    }
+    return frame;
+}
+
+void FrameSubscription::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    cv_.notify_all();
+}
+
+bool FrameSubscription::isClosed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return closed_;
+}
+
+void FrameSubscription::reopen(size_t depth, FrameDropPolicy policy) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    depth_ = std::max<size_t>(1, depth);
+    policy_ = policy;
+    queue_.clear();
+    closed_ = false;
+    delivered_ = 0;
+    taken_ = 0;
+    dropped_ = 0;
+    blockedMs_ = 0.0;
+    takenUpTo_ = seenUpTo_;
+}
+
+void FrameSubscription::clear() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.clear();
+    }
+    cv_.notify_all();
+}
+
+FrameSubscriberStats FrameSubscription::getStats() const {
+    FrameSubscriberStats stats;
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.name = name_;
+    stats.policy = policy_;
+    stats.depth = queue_.size();
+    stats.capacity = depth_;
+    stats.delivered = delivered_;
+    stats.taken = taken_;
+    stats.dropped = dropped_;
+    stats.lagFrames = seenUpTo_ - std::min(seenUpTo_, takenUpTo_);
+    stats.lagMs = queue_.empty() ? 0.0 : msSince(queue_.front().queuedAt, now);
+    stats.blockedMs = blockedMs_;
+    return stats;
+}
+
+FrameBus::FrameBus() : subscribers_(std::make_shared<const SubscriberList>()) {
+}
+
+std::shared_ptr<FrameSubscription> FrameBus::subscribe(const std::string& name, size_t depth,
+                                                       FrameDropPolicy policy) {
+    auto subscription = std::make_shared<FrameSubscription>(name, depth, policy);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Frames published before now don't count as lag
+    subscription->seenUpTo_ = published_;
+    subscription->takenUpTo_ = published_;
+    auto list = std::make_shared<SubscriberList>(*subscribers_);
+    list->push_back(subscription);
+    subscribers_ = std::move(list);
+    return subscription;
+}
+
+void FrameBus::unsubscribe(const std::shared_ptr<FrameSubscription>& subscription) {
+    if (!subscription) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto list = std::make_shared<SubscriberList>(*subscribers_);
+        list->erase(std::remove(list->begin(), list->end(), subscription), list->end());
+        subscribers_ = std::move(list);
+    }
+    subscription->close();
+}
+
+void FrameBus::publish(const SharedFrame& frame) {
+    if (!frame) return;
+
+    std::shared_ptr<const SubscriberList> subscribers;
+    uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        subscribers = subscribers_;
+        sequence = published_++;
+    }
+
+    for (const auto& subscription : *subscribers) {
+        subscription->deliver(frame, sequence);
+    }
+}
+
+uint64_t FrameBus::getPublished() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return published_;
+}
+
+std::vector<FrameSubscriberStats> FrameBus::getStats() const {
+    std::shared_ptr<const SubscriberList> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        subscribers = subscribers_;
+    }
+
+    std::vector<FrameSubscriberStats> stats;
+    stats.reserve(subscribers->size());
+    for (const auto& subscription : *subscribers) {
+        stats.push_back(subscription->getStats());
+    }
+    return stats;
+}
+
+} // namespace latency
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace latency {
+
+struct VideoFrame;
+
+// Decoded frames are immutable once published, so every consumer can hold
+// the same buffer; the last one to let go frees it
+using SharedFrame = std::shared_ptr<const VideoFrame>;
+
+enum class FrameDropPolicy {
+    DropOldest,   // Live consumers: a full queue evicts its oldest frame
+    DropNewest,   // A full queue refuses new frames until the consumer catches up
+    Block         // Never drop: the publisher waits for room (offline decoding only)
+};
+
+struct FrameSubscriberStats {
+    std::string name;
+    FrameDropPolicy policy = FrameDropPolicy::DropOldest;
+    size_t depth = 0;
+    size_t capacity = 0;
+    uint64_t delivered = 0;          // Frames queued
+    uint64_t taken = 0;
+    uint64_t dropped = 0;            // Evicted or refused by the drop policy
+    uint64_t lagFrames = 0;          // Published after the last frame taken
+    double lagMs = 0.0;              // Age of the oldest queued frame
+    double blockedMs = 0.0;          // Block policy: time the publisher waited for room
+};
+
+// A frame as taken from a subscription, with its place in the bus
+struct BusFrame {
+    SharedFrame frame;
+    uint64_t sequence = 0;           // Publish order on the bus
+    std::chrono::steady_clock::time_point queuedAt;
+
+    explicit operator bool() const { return frame != nullptr; }
+};
+
+// One consumer's queue on a FrameBus. Each subscription has its own depth
+// and drop policy, so a slow consumer only ever loses its own frames.
+class FrameSubscription {
+public:
+    FrameSubscription(std::string name, size_t depth, FrameDropPolicy policy);
+
+    FrameSubscription(const FrameSubscription&) = delete;
+    FrameSubscription& operator=(const FrameSubscription&) = delete;
+
+    // Oldest queued frame, or an empty BusFrame if none
+    BusFrame take();
+    // Wait up to timeoutMs; returns at once when closed and empty
+    BusFrame waitTake(int timeoutMs);
+
+    // Stop receiving: wakes waiters and a publisher blocked on this queue.
+    // Frames already queued can still be taken.
+    void close();
+    bool isClosed() const;
+    // Start receiving again with a new depth and policy, from an empty queue and counters
+    void reopen(size_t depth, FrameDropPolicy policy);
+    void clear();
+
+    FrameSubscriberStats getStats() const;
+
+private:
+    friend class FrameBus;
+    void deliver(const SharedFrame& frame, uint64_t sequence);
+    BusFrame popLocked();
+
+    const std::string name_;
+    size_t depth_;
+    FrameDropPolicy policy_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;     // Frame queued, room freed, or closed
+    std::deque<BusFrame> queue_;
+    bool closed_ = false;
+
+    uint64_t delivered_ = 0;
+    uint64_t taken_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t seenUpTo_ = 0;          // Sequence after the newest frame offered
+    uint64_t takenUpTo_ = 0;         // Sequence after the newest frame taken
+    double blockedMs_ = 0.0;
+};
+
+// Publish/subscribe fan-out of decoded frames. Publishing hands each
+// subscription a reference to the same frame: adding a consumer costs a
+// queue slot, never a copy of the pixels. Subscribers may come and go
+// while frames are published.
+class FrameBus {
+public:
+    FrameBus();
+
+    FrameBus(const FrameBus&) = delete;
+    FrameBus& operator=(const FrameBus&) = delete;
+
+    std::shared_ptr<FrameSubscription> subscribe(const std::string& name, size_t depth,
+                                                 FrameDropPolicy policy = FrameDropPolicy::DropOldest);
+    // Remove and close a subscription
+    void unsubscribe(const std::shared_ptr<FrameSubscription>& subscription);
+
+    // Called by the producer. Only waits when a Block subscription is full.
+    void publish(const SharedFrame& frame);
+
+    uint64_t getPublished() const;
+    std::vector<FrameSubscriberStats> getStats() const;
+
+private:
+    using SubscriberList = std::vector<std::shared_ptr<FrameSubscription>>;
+
+    // Replaced, never modified, so publish() iterates a snapshot without the lock
+    std::shared_ptr<const SubscriberList> subscribers_;
+    uint64_t published_ = 0;
+    mutable std::mutex mutex_;
+};
+
+} // namespace latency
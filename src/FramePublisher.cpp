@@ -0,0 +1,157 @@
+#include "FramePublisher.h"
+#include "VideoDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+namespace latency {
+
+namespace {
+
+int64_t sinceEpochNs(std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+FramePublisher::~FramePublisher() {
+    close();
+}
+
+bool FramePublisher::open(const std::string& name, int slots, int maxWidth, int maxHeight) {
+    close();
+    lastError_.clear();
+    if (name.empty() || slots < 2 || maxWidth <= 0 || maxHeight <= 0) {
+        lastError_ = "Frame export needs a name, at least 2 slots and a maximum frame size";
+        return false;
+    }
+
+    const size_t slotHeaderBytes = frameRingAlign(sizeof(FrameSlotHeader));
+    const size_t dataBytes = frameRingAlign(static_cast<size_t>(maxWidth) * 3 * static_cast<size_t>(maxHeight));
+    const size_t firstSlot = frameRingAlign(sizeof(FrameRingHeader));
+    const size_t stride = slotHeaderBytes + dataBytes;
+    if (!memory_.create(name, firstSlot + stride * static_cast<size_t>(slots))) {
+        lastError_ = memory_.getLastError();
+        return false;
+    }
+
+    header_ = new (memory_.data()) FrameRingHeader();
+    header_->slotCount = static_cast<uint32_t>(slots);
+    header_->slotHeaderBytes = static_cast<uint32_t>(slotHeaderBytes);
+    header_->firstSlotOffset = firstSlot;
+    header_->slotStride = stride;
+    header_->slotDataBytes = dataBytes;
+    header_->published.store(0, std::memory_order_relaxed);
+    header_->writerOpen.store(1, std::memory_order_relaxed);
+    for (int i = 0; i < slots; i++) {
+        new (slotAt(static_cast<uint64_t>(i))) FrameSlotHeader();
+        slotAt(static_cast<uint64_t>(i))->sequence.store(0, std::memory_order_relaxed);
+    }
+
+    // Readers check the magic last, once the rest of the header is in place
+    header_->version = FRAME_RING_VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = FRAME_RING_MAGIC;
+
+    name_ = name;
+    oversized_ = 0;
+    return true;
+}
+
+void FramePublisher::close() {
+    if (subscription_) {
+        bus_->unsubscribe(subscription_);  // Closes it, ending publishLoop
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        subscription_.reset();
+        bus_ = nullptr;
+    }
+    if (header_) {
+        header_->writerOpen.store(0, std::memory_order_release);
+        header_ = nullptr;
+    }
+    memory_.close();
+}
+
+void FramePublisher::attach(FrameBus& bus) {
+    if (!header_ || subscription_) return;
+    bus_ = &bus;
+    subscription_ = bus.subscribe("export", QUEUE_DEPTH, FrameDropPolicy::DropOldest);
+    thread_ = std::thread(&FramePublisher::publishLoop, this);
+}
+
+void FramePublisher::publishLoop() {
+    while (true) {
+        BusFrame frame = subscription_->waitTake(100);
+        if (frame) {
+            publish(*frame.frame);
+        } else if (subscription_->isClosed()) {
+            break;  // Closed and drained
+        }
+    }
+}
+
+FrameSlotHeader* FramePublisher::slotAt(uint64_t index) const {
+    uint8_t* base = memory_.data() + header_->firstSlotOffset;
+    return reinterpret_cast<FrameSlotHeader*>(base + (index % header_->slotCount) * header_->slotStride);
+}
+
+void FramePublisher::publish(const VideoFrame& frame) {
+    if (!header_ || !frame.data) return;
+
+    const uint64_t rowBytes = static_cast<uint64_t>(frame.width) * 3;
+    const uint64_t bytes = static_cast<uint64_t>(frame.pitch) * frame.height;
+    if (bytes > header_->slotDataBytes || rowBytes > static_cast<uint64_t>(frame.pitch)) {
+        oversized_++;
+        return;
+    }
+
+    // Only this thread writes, so the count needs no read-modify-write
+    const uint64_t n = header_->published.load(std::memory_order_relaxed);
+    FrameSlotHeader* slot = slotAt(n);
+
+    // Odd: readers that look now, or looked before and check again, see the slot as torn
+    slot->sequence.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Stamp the time the decoder published the frame, not when it was copied out here
+    auto nowSteady = std::chrono::steady_clock::now();
+    int64_t nowUnixNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    auto decodedSteady = frame.queuedAt.time_since_epoch().count() != 0 ? frame.queuedAt : nowSteady;
+    int64_t decodedUnixNs = nowUnixNs - sinceEpochNs(nowSteady) + sinceEpochNs(decodedSteady);
+
+    slot->frameNumber = n;
+    slot->ptsUs = static_cast<int64_t>(std::llround(frame.ptsMs * 1000.0));
+    slot->decodedUnixNs = decodedUnixNs;
+    slot->decodedSteadyNs = sinceEpochNs(decodedSteady);
+    slot->firstPacketSteadyNs = frame.timeline.valid ? sinceEpochNs(frame.timeline.firstPacket) : 0;
+    slot->senderUnixNs = frame.senderClock != SenderClockSource::None
+        ? decodedUnixNs - static_cast<int64_t>(std::llround(frame.senderLatencyMs * 1e6)) : 0;
+    slot->width = static_cast<uint32_t>(frame.width);
+    slot->height = static_cast<uint32_t>(frame.height);
+    slot->stride = static_cast<uint32_t>(frame.pitch);
+    slot->format = FRAME_FORMAT_RGB24;
+    slot->dataBytes = bytes;
+    std::memcpy(reinterpret_cast<uint8_t*>(slot) + header_->slotHeaderBytes, frame.data, bytes);
+
+    slot->sequence.store(2 * n + 2, std::memory_order_release);
+    header_->published.store(n + 1, std::memory_order_release);
+}
+
+FramePublisherStats FramePublisher::getStats() const {
+    FramePublisherStats stats;
+    if (header_) {
+        stats.published = header_->published.load(std::memory_order_relaxed);
+    }
+    stats.oversized = oversized_;
+    if (subscription_) {
+        stats.dropped = subscription_->getStats().dropped;
+    }
+    return stats;
+}
+
+} // namespace latency
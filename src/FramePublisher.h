@@ -0,0 +1,67 @@
+#pragma once
+
+#include "FrameBus.h"
+#include "FrameRing.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace latency {
+
+struct VideoFrame;
+
+struct FramePublisherStats {
+    uint64_t published = 0;
+    uint64_t oversized = 0;          // Frames larger than a slot, not published
+    uint64_t dropped = 0;            // Decoded faster than they could be copied out
+};
+
+// Writes decoded frames into a named shared-memory ring (FrameRing.h) for
+// other processes, which read them in place with FrameRingReader. Slots
+// are sized for the largest frame expected, so the ring never has to be
+// recreated under its readers. Frames come from a FrameBus subscription
+// and are copied out on the publisher's own thread, so the decoder never
+// waits for the copy; if it falls behind, the oldest frames are dropped.
+class FramePublisher {
+public:
+    FramePublisher() = default;
+    ~FramePublisher();
+
+    FramePublisher(const FramePublisher&) = delete;
+    FramePublisher& operator=(const FramePublisher&) = delete;
+
+    // slots: frames kept for readers; maxWidth x maxHeight RGB24 per slot
+    bool open(const std::string& name, int slots, int maxWidth, int maxHeight);
+    // Stops the publishing thread and marks the ring closed for readers
+    void close();
+    bool isOpen() const { return header_ != nullptr; }
+
+    // Start publishing every frame on the bus (after open). The bus must
+    // outlive the publisher or its close().
+    void attach(FrameBus& bus);
+
+    void publish(const VideoFrame& frame);
+
+    FramePublisherStats getStats() const;
+    const std::string& getName() const { return name_; }
+    const std::string& getLastError() const { return lastError_; }
+
+private:
+    FrameSlotHeader* slotAt(uint64_t index) const;
+    void publishLoop();
+
+    SharedMemory memory_;
+    FrameRingHeader* header_ = nullptr;
+    std::string name_;
+    std::atomic<uint64_t> oversized_{0};
+
+    FrameBus* bus_ = nullptr;
+    std::shared_ptr<FrameSubscription> subscription_;
+    std::thread thread_;
+    static constexpr size_t QUEUE_DEPTH = 2;
+    std::string lastError_;
+};
+
+} // namespace latency
@@ -0,0 +1,159 @@
+#include "FrameRing.h"
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace latency {
+
+namespace {
+
+std::string osMappingName(const std::string& name) {
+#ifdef _WIN32
+    return "Local\\" + name;
+#else
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+#endif
+}
+
+} // namespace
+
+SharedMemory::~SharedMemory() {
+    close();
+}
+
+bool SharedMemory::create(const std::string& name, size_t size) {
+    close();
+    osName_ = osMappingName(name);
+    lastError_.clear();
+
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                        static_cast<DWORD>(size & 0xFFFFFFFF), osName_.c_str());
+    if (!mapping) {
+        lastError_ = "CreateFileMapping failed: error " + std::to_string(GetLastError());
+        return false;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        // A reader still holds an older ring of this name; its size may not fit
+        CloseHandle(mapping);
+        lastError_ = "Shared memory " + name + " is still open in another process";
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!view) {
+        lastError_ = "MapViewOfFile failed: error " + std::to_string(GetLastError());
+        CloseHandle(mapping);
+        return false;
+    }
+    handle_ = reinterpret_cast<intptr_t>(mapping);
+#else
+    // Replace a ring left behind by a process that didn't close it
+    shm_unlink(osName_.c_str());
+    int fd = shm_open(osName_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+    if (fd < 0) {
+        lastError_ = "shm_open " + osName_ + " failed: " + std::strerror(errno);
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        lastError_ = "ftruncate failed: " + std::string(std::strerror(errno));
+        ::close(fd);
+        shm_unlink(osName_.c_str());
+        return false;
+    }
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        lastError_ = "mmap failed: " + std::string(std::strerror(errno));
+        ::close(fd);
+        shm_unlink(osName_.c_str());
+        return false;
+    }
+    handle_ = fd;
+#endif
+
+    owner_ = true;
+    data_ = static_cast<uint8_t*>(view);
+    size_ = size;
+    return true;
+}
+
+bool SharedMemory::open(const std::string& name) {
+    close();
+    osName_ = osMappingName(name);
+    lastError_.clear();
+
+#ifdef _WIN32
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, osName_.c_str());
+    if (!mapping) {
+        lastError_ = "No shared memory named " + name;
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (!view || VirtualQuery(view, &info, sizeof(info)) == 0) {
+        lastError_ = "MapViewOfFile failed: error " + std::to_string(GetLastError());
+        if (view) UnmapViewOfFile(view);
+        CloseHandle(mapping);
+        return false;
+    }
+    handle_ = reinterpret_cast<intptr_t>(mapping);
+    size_ = info.RegionSize;
+#else
+    int fd = shm_open(osName_.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        lastError_ = "No shared memory named " + osName_ + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        lastError_ = "Shared memory " + osName_ + " is empty";
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        lastError_ = "mmap failed: " + std::string(std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    handle_ = fd;
+    size_ = static_cast<size_t>(st.st_size);
+#endif
+
+    owner_ = false;
+    data_ = static_cast<uint8_t*>(view);
+    return true;
+}
+
+void SharedMemory::close() {
+    if (data_) {
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+#else
+        munmap(data_, size_);
+#endif
+        data_ = nullptr;
+    }
+    if (handle_ != -1) {
+#ifdef _WIN32
+        CloseHandle(reinterpret_cast<HANDLE>(handle_));
+#else
+        ::close(static_cast<int>(handle_));
+        // Readers keep their mapping; new ones can't find this ring any more
+        if (owner_) shm_unlink(osName_.c_str());
+#endif
+        handle_ = -1;
+    }
+    owner_ = false;
+    size_ = 0;
+}
+
+} // namespace latency
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace latency {
+
+// Layout of the shared-memory frame ring written by FramePublisher and read
+// by FrameRingReader. One writer, any number of readers, no locks: each
+// slot's sequence number is odd while the writer fills it and even once the
+// frame is complete (a seqlock), so a reader can tell a torn or reused slot
+// from a good one. Fixed-width fields only, so readers built with other
+// compilers agree on the layout.
+
+constexpr uint32_t FRAME_RING_MAGIC = 0x52464C54;      // "TLFR"
+constexpr uint32_t FRAME_RING_VERSION = 1;
+constexpr uint32_t FRAME_FORMAT_RGB24 = 0x33424752;    // FOURCC "RGB3": packed R, G, B bytes
+constexpr size_t FRAME_RING_ALIGN = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared atomics must not need a lock");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Shared atomics must not need a lock");
+
+struct FrameRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotHeaderBytes;        // Pixel data starts this far into a slot
+    uint64_t firstSlotOffset;        // From the start of the mapping
+    uint64_t slotStride;             // From one slot to the next
+    uint64_t slotDataBytes;          // Pixel capacity of each slot
+    std::atomic<uint64_t> published; // Frames written so far; frame n is in slot n % slotCount
+    std::atomic<uint32_t> writerOpen;   // Cleared when the publisher closes
+    uint32_t reserved;
+};
+
+struct FrameSlotHeader {
+    std::atomic<uint64_t> sequence;  // 2n + 1 while frame n is written, 2n + 2 once it is complete
+    uint64_t frameNumber;
+    int64_t ptsUs;                   // Presentation time since stream start
+    int64_t decodedUnixNs;           // System clock when decoded
+    int64_t decodedSteadyNs;         // Steady clock when decoded (CLOCK_MONOTONIC / QPC, machine-wide)
+    int64_t firstPacketSteadyNs;     // Steady clock when its first packet arrived (0 = unknown)
+    int64_t senderUnixNs;            // Sender's wall clock at capture (0 = unknown)
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;                 // Bytes per row
+    uint32_t format;                 // FRAME_FORMAT_*
+    uint64_t dataBytes;
+};
+
+constexpr size_t frameRingAlign(size_t bytes) {
+    return (bytes + FRAME_RING_ALIGN - 1) / FRAME_RING_ALIGN * FRAME_RING_ALIGN;
+}
+
+// A named shared-memory mapping: POSIX shm_open on Linux/macOS ("/name"),
+// a pagefile-backed file mapping on Windows ("Local\name")
+class SharedMemory {
+public:
+    SharedMemory() = default;
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    // Create (or replace) a mapping of size bytes for writing
+    bool create(const std::string& name, size_t size);
+    // Map an existing one read-only
+    bool open(const std::string& name);
+    void close();
+
+    uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    const std::string& getLastError() const { return lastError_; }
+
+private:
+    std::string osName_;
+    bool owner_ = false;
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    intptr_t handle_ = -1;           // File descriptor, or the mapping HANDLE on Windows
+    std::string lastError_;
+};
+
+} // namespace latency
@@ -0,0 +1,123 @@
+#include "FrameRingReader.h"
+#include <algorithm>
+
+namespace latency {
+
+bool FrameRingReader::open(const std::string& name) {
+    close();
+    lastError_.clear();
+    if (!memory_.open(name)) {
+        lastError_ = memory_.getLastError();
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const FrameRingHeader*>(memory_.data());
+    if (memory_.size() < sizeof(FrameRingHeader) || header->magic != FRAME_RING_MAGIC) {
+        lastError_ = "Not a frame ring (or its publisher is still starting)";
+        memory_.close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->version != FRAME_RING_VERSION) {
+        lastError_ = "Frame ring version " + std::to_string(header->version) + ", reader supports " +
+                     std::to_string(FRAME_RING_VERSION);
+        memory_.close();
+        return false;
+    }
+    if (header->firstSlotOffset + header->slotStride * header->slotCount > memory_.size()) {
+        lastError_ = "Frame ring is larger than its mapping";
+        memory_.close();
+        return false;
+    }
+
+    header_ = header;
+    haveFrame_ = false;
+    missed_ = 0;
+    return true;
+}
+
+void FrameRingReader::close() {
+    header_ = nullptr;
+    memory_.close();
+}
+
+bool FrameRingReader::read(uint64_t frameNumber, FrameView& view) const {
+    const uint8_t* base = memory_.data() + header_->firstSlotOffset;
+    const auto* slot = reinterpret_cast<const FrameSlotHeader*>(
+        base + (frameNumber % header_->slotCount) * header_->slotStride);
+
+    uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence != 2 * frameNumber + 2) return false;  // Being written, or already reused
+
+    view.frameNumber = slot->frameNumber;
+    view.ptsUs = slot->ptsUs;
+    view.decodedUnixNs = slot->decodedUnixNs;
+    view.decodedSteadyNs = slot->decodedSteadyNs;
+    view.firstPacketSteadyNs = slot->firstPacketSteadyNs;
+    view.senderUnixNs = slot->senderUnixNs;
+    view.width = slot->width;
+    view.height = slot->height;
+    view.stride = slot->stride;
+    view.format = slot->format;
+    view.dataBytes = static_cast<size_t>(std::min<uint64_t>(slot->dataBytes, header_->slotDataBytes));
+    view.data = reinterpret_cast<const uint8_t*>(slot) + header_->slotHeaderBytes;
+    view.slot = slot;
+    view.sequence = sequence;
+
+    // The metadata is only good if the writer didn't start on the slot while it was copied
+    return isValid(view);
+}
+
+bool FrameRingReader::next(FrameView& view) {
+    if (!header_) return false;
+
+    uint64_t published = header_->published.load(std::memory_order_acquire);
+    uint64_t wanted = haveFrame_ ? lastFrame_ + 1 : (published > 0 ? published - 1 : 0);
+    if (wanted >= published) return false;
+
+    // Frames more than a ring behind are gone; the oldest slot may be mid-write
+    uint64_t oldest = published > header_->slotCount - 1 ? published - (header_->slotCount - 1) : 0;
+    if (wanted < oldest) {
+        missed_ += oldest - wanted;
+        wanted = oldest;
+    }
+
+    for (; wanted < published; wanted++) {
+        if (read(wanted, view)) {
+            haveFrame_ = true;
+            lastFrame_ = wanted;
+            return true;
+        }
+        missed_++;
+    }
+    return false;
+}
+
+bool FrameRingReader::latest(FrameView& view) {
+    if (!header_) return false;
+
+    uint64_t published = header_->published.load(std::memory_order_acquire);
+    if (published == 0) return false;
+    uint64_t newest = published - 1;
+    if (haveFrame_ && newest <= lastFrame_) return false;
+
+    if (!read(newest, view)) return false;
+    if (haveFrame_) {
+        missed_ += newest - lastFrame_ - 1;
+    }
+    haveFrame_ = true;
+    lastFrame_ = newest;
+    return true;
+}
+
+bool FrameRingReader::isValid(const FrameView& view) const {
+    if (!view.slot) return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return view.slot->sequence.load(std::memory_order_relaxed) == view.sequence;
+}
+
+bool FrameRingReader::isWriterOpen() const {
+    return header_ && header_->writerOpen.load(std::memory_order_acquire) != 0;
+}
+
+} // namespace latency
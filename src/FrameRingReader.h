@@ -0,0 +1,69 @@
+#pragma once
+
+#include "FrameRing.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace latency {
+
+// A frame in the shared ring, read in place. data points into the shared
+// memory: once done with it, isValid() tells whether the writer reused the
+// slot meanwhile (then the pixels may be torn and the frame should be
+// dropped). With N slots a reader has N - 1 frame intervals to finish.
+struct FrameView {
+    uint64_t frameNumber = 0;
+    int64_t ptsUs = 0;
+    int64_t decodedUnixNs = 0;
+    int64_t decodedSteadyNs = 0;
+    int64_t firstPacketSteadyNs = 0; // 0 = unknown
+    int64_t senderUnixNs = 0;        // 0 = unknown
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t stride = 0;
+    uint32_t format = 0;             // FRAME_FORMAT_*
+    const uint8_t* data = nullptr;
+    size_t dataBytes = 0;
+
+    const FrameSlotHeader* slot = nullptr;
+    uint64_t sequence = 0;
+};
+
+// Reader side of the frame ring, for other processes. Depends only on
+// FrameRing.h/.cpp (the LatencyFrameRing library target), not on the rest
+// of the tool. Not thread-safe; use one reader per consuming thread.
+class FrameRingReader {
+public:
+    // Map the ring the publisher created under this name
+    bool open(const std::string& name);
+    void close();
+    bool isOpen() const { return header_ != nullptr; }
+
+    // The frame after the last one returned. Frames the writer has already
+    // overwritten are skipped and counted as missed. False if none is new.
+    bool next(FrameView& view);
+
+    // The newest frame, if it is newer than the last one returned
+    bool latest(FrameView& view);
+
+    // Whether view's pixels are still the frame it describes
+    bool isValid(const FrameView& view) const;
+
+    // False once the publisher has closed the ring (reopen to follow a new one)
+    bool isWriterOpen() const;
+
+    uint64_t getMissedFrames() const { return missed_; }
+    const std::string& getLastError() const { return lastError_; }
+
+private:
+    bool read(uint64_t frameNumber, FrameView& view) const;
+
+    SharedMemory memory_;
+    const FrameRingHeader* header_ = nullptr;
+    bool haveFrame_ = false;
+    uint64_t lastFrame_ = 0;
+    uint64_t missed_ = 0;
+    std::string lastError_;
+};
+
+} // namespace latency
@@ -0,0 +1,163 @@
+#include "GlyphAtlas.h"
+#include <algorithm>
+
+namespace latency {
+
+GlyphAtlas::~GlyphAtlas() {
+    if (texture_) {
+        SDL_DestroyTexture(texture_);
+    }
+}
+
+bool GlyphAtlas::init(SDL_Renderer* renderer, TTF_Font* font, bool build) {
+    renderer_ = renderer;
+    font_ = font;
+    if (!font_) {
+        lastError_ = "No font";
+        return false;
+    }
+    height_ = TTF_FontHeight(font_);
+    if (!build) return true;
+
+    // Render every glyph, then pack them left to right in rows
+    const SDL_Color white = {255, 255, 255, 255};
+    std::array<SDL_Surface*, GLYPH_COUNT> surfaces{};
+    int penX = 0;
+    int penY = 0;
+    int rowHeight = 0;
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        Uint16 ch = static_cast<Uint16>(FIRST_CHAR + i);
+        int advance = 0;
+        TTF_GlyphMetrics(font_, ch, nullptr, nullptr, nullptr, nullptr, &advance);
+        glyphs_[i].advance = advance;
+
+        // Blank glyphs (space) may not render; they only advance
+        surfaces[i] = TTF_RenderGlyph_Blended(font_, ch, white);
+        if (!surfaces[i]) continue;
+
+        int w = std::min(surfaces[i]->w, ATLAS_WIDTH);
+        int h = surfaces[i]->h;
+        if (penX + w > ATLAS_WIDTH) {
+            penX = 0;
+            penY += rowHeight + 1;
+            rowHeight = 0;
+        }
+        glyphs_[i].src = {penX, penY, w, h};
+        penX += w + 1;  // 1px gutter so filtering never samples a neighbour
+        rowHeight = std::max(rowHeight, h);
+    }
+
+    textureWidth_ = ATLAS_WIDTH;
+    textureHeight_ = std::max(1, penY + rowHeight);
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, textureWidth_, textureHeight_, 32,
+                                                        SDL_PIXELFORMAT_ARGB8888);
+    if (atlas) {
+        SDL_FillRect(atlas, nullptr, SDL_MapRGBA(atlas->format, 255, 255, 255, 0));
+        for (int i = 0; i < GLYPH_COUNT; i++) {
+            if (!surfaces[i]) continue;
+            // Copy coverage into the alpha channel rather than blending onto nothing
+            SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+            SDL_Rect dst = glyphs_[i].src;
+            SDL_BlitSurface(surfaces[i], nullptr, atlas, &dst);
+        }
+        texture_ = SDL_CreateTextureFromSurface(renderer_, atlas);
+        if (texture_) {
+            SDL_SetTextureBlendMode(texture_, SDL_BLENDMODE_BLEND);
+        } else {
+            lastError_ = "Failed to create glyph atlas texture: " + std::string(SDL_GetError());
+        }
+        SDL_FreeSurface(atlas);
+    } else {
+        lastError_ = "Failed to create glyph atlas surface: " + std::string(SDL_GetError());
+    }
+
+    for (SDL_Surface* surface : surfaces) {
+        if (surface) SDL_FreeSurface(surface);
+    }
+    return texture_ != nullptr;
+}
+
+const GlyphAtlas::Glyph& GlyphAtlas::glyphFor(char c) const {
+    int code = static_cast<unsigned char>(c);
+    if (code < FIRST_CHAR || code > LAST_CHAR) code = '?';
+    return glyphs_[code - FIRST_CHAR];
+}
+
+void GlyphAtlas::draw(const std::string& text, int x, int y, SDL_Color color, int maxWidth) {
+    if (!font_ || text.empty()) return;
+    if (!texture_) {
+        drawWithTtf(text, x, y, color, maxWidth);
+        return;
+    }
+
+    vertices_.clear();
+    indices_.clear();
+    const float scaleU = 1.0f / textureWidth_;
+    const float scaleV = 1.0f / textureHeight_;
+
+    int penX = x;
+    for (char c : text) {
+        const Glyph& glyph = glyphFor(c);
+        if (maxWidth > 0 && penX - x + glyph.src.w > maxWidth) break;
+
+        if (glyph.src.w > 0) {
+            float x0 = static_cast<float>(penX);
+            float y0 = static_cast<float>(y);
+            float x1 = x0 + glyph.src.w;
+            float y1 = y0 + glyph.src.h;
+            float u0 = glyph.src.x * scaleU;
+            float v0 = glyph.src.y * scaleV;
+            float u1 = (glyph.src.x + glyph.src.w) * scaleU;
+            float v1 = (glyph.src.y + glyph.src.h) * scaleV;
+
+            int base = static_cast<int>(vertices_.size());
+            vertices_.push_back({{x0, y0}, color, {u0, v0}});
+            vertices_.push_back({{x1, y0}, color, {u1, v0}});
+            vertices_.push_back({{x0, y1}, color, {u0, v1}});
+            vertices_.push_back({{x1, y1}, color, {u1, v1}});
+            indices_.insert(indices_.end(), {base, base + 1, base + 2, base + 2, base + 1, base + 3});
+        }
+        penX += glyph.advance;
+    }
+
+    if (!indices_.empty()) {
+        SDL_RenderGeometry(renderer_, texture_, vertices_.data(), static_cast<int>(vertices_.size()),
+                           indices_.data(), static_cast<int>(indices_.size()));
+    }
+}
+
+void GlyphAtlas::drawCentered(const std::string& text, int centerX, int y, SDL_Color color) {
+    draw(text, centerX - measure(text) / 2, y, color);
+}
+
+int GlyphAtlas::measure(const std::string& text) const {
+    if (!font_ || text.empty()) return 0;
+    if (!texture_) {
+        int width = 0;
+        TTF_SizeText(font_, text.c_str(), &width, nullptr);
+        return width;
+    }
+
+    int width = 0;
+    for (char c : text) {
+        width += glyphFor(c).advance;
+    }
+    return width;
+}
+
+void GlyphAtlas::drawWithTtf(const std::string& text, int x, int y, SDL_Color color, int maxWidth) {
+    SDL_Surface* surface = TTF_RenderText_Blended(font_, text.c_str(), color);
+    if (!surface) return;
+
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, surface);
+    if (texture) {
+        int width = maxWidth > 0 ? std::min(surface->w, maxWidth) : surface->w;
+        SDL_Rect srcRect = {0, 0, width, surface->h};
+        SDL_Rect dstRect = {x, y, width, surface->h};
+        SDL_RenderCopy(renderer_, texture, &srcRect, &dstRect);
+        SDL_DestroyTexture(texture);
+    }
+    SDL_FreeSurface(surface);
+}
+
+} // namespace latency
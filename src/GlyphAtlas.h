@@ -0,0 +1,68 @@
+#pragma once
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace latency {
+
+// Printable ASCII of one font, rendered once into a texture. Text is then
+// drawn as textured quads, one SDL_RenderGeometry call per string, instead
+// of a TTF render, texture upload and destroy per string per frame. Glyphs
+// are white in the atlas and tinted by vertex colour. Layout follows each
+// glyph's advance without kerning; characters outside the atlas draw as '?'.
+// Without an atlas (disabled, or building it failed) strings go through
+// SDL_ttf as before. Must be destroyed before its renderer.
+class GlyphAtlas {
+public:
+    GlyphAtlas() = default;
+    ~GlyphAtlas();
+
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+    // The font stays owned by the caller. build = false keeps the per-string TTF path.
+    bool init(SDL_Renderer* renderer, TTF_Font* font, bool build = true);
+
+    // Text with its top-left at (x, y); glyphs past maxWidth are dropped (0 = no limit)
+    void draw(const std::string& text, int x, int y, SDL_Color color, int maxWidth = 0);
+    void drawCentered(const std::string& text, int centerX, int y, SDL_Color color);
+
+    int measure(const std::string& text) const;
+    int getHeight() const { return height_; }
+    bool isLoaded() const { return font_ != nullptr; }
+    bool hasAtlas() const { return texture_ != nullptr; }
+    const std::string& getLastError() const { return lastError_; }
+
+private:
+    static constexpr int FIRST_CHAR = 32;
+    static constexpr int LAST_CHAR = 126;
+    static constexpr int GLYPH_COUNT = LAST_CHAR - FIRST_CHAR + 1;
+    static constexpr int ATLAS_WIDTH = 1024;
+
+    struct Glyph {
+        SDL_Rect src{};      // In the atlas (empty for blank glyphs)
+        int advance = 0;
+    };
+
+    const Glyph& glyphFor(char c) const;
+    void drawWithTtf(const std::string& text, int x, int y, SDL_Color color, int maxWidth);
+
+    SDL_Renderer* renderer_ = nullptr;
+    TTF_Font* font_ = nullptr;
+    SDL_Texture* texture_ = nullptr;
+    int textureWidth_ = 0;
+    int textureHeight_ = 0;
+    int height_ = 0;
+    std::array<Glyph, GLYPH_COUNT> glyphs_{};
+
+    // Reused between strings
+    std::vector<SDL_Vertex> vertices_;
+    std::vector<int> indices_;
+
+    std::string lastError_;
+};
+
+} // namespace latency
@@ -0,0 +1,806 @@
+#include "ImpairmentProxy.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <ctime>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace latency {
+
+namespace {
+
+constexpr size_t MAX_DATAGRAM = 65536;
+constexpr size_t MAX_RTSP_HEADER = 64 * 1024;  // Pass through anything that doesn't parse by then
+constexpr int POLL_INTERVAL_MS = 100;           // How often blocked threads check for stop()
+constexpr int UDP_RECEIVE_BUFFER = 4 * 1024 * 1024;
+
+#ifdef _WIN32
+using NativeSocket = SOCKET;
+using SockLen = int;
+#else
+using NativeSocket = int;
+using SockLen = socklen_t;
+#endif
+
+NativeSocket native(intptr_t handle) { return static_cast<NativeSocket>(handle); }
+
+void closeSocket(intptr_t handle) {
+    if (handle == -1) return;
+#ifdef _WIN32
+    closesocket(native(handle));
+#else
+    close(native(handle));
+#endif
+}
+
+intptr_t openSocket(int type) {
+    NativeSocket s = socket(AF_INET, type, 0);
+#ifdef _WIN32
+    return s == INVALID_SOCKET ? -1 : static_cast<intptr_t>(s);
+#else
+    return s;
+#endif
+}
+
+bool bindPort(intptr_t handle, int port) {
+    int reuse = 1;
+    setsockopt(native(handle), SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    return bind(native(handle), reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+}
+
+bool resolveIPv4(const std::string& host, int port, std::vector<uint8_t>& out) {
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    addrinfo* info = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &info) != 0 || !info) {
+        return false;
+    }
+    sockaddr_in addr = *reinterpret_cast<sockaddr_in*>(info->ai_addr);
+    freeaddrinfo(info);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+
+    out.resize(sizeof(addr));
+    std::memcpy(out.data(), &addr, sizeof(addr));
+    return true;
+}
+
+// Wait until one of the sockets is readable; returns the readable subset
+std::vector<intptr_t> waitReadable(const std::vector<intptr_t>& sockets, int timeoutMs) {
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    NativeSocket maxFd = 0;
+    for (intptr_t s : sockets) {
+        FD_SET(native(s), &readSet);
+        maxFd = std::max(maxFd, native(s));
+    }
+
+    timeval tv{};
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+
+    std::vector<intptr_t> ready;
+    if (select(static_cast<int>(maxFd + 1), &readSet, nullptr, nullptr, &tv) > 0) {
+        for (intptr_t s : sockets) {
+            if (FD_ISSET(native(s), &readSet)) ready.push_back(s);
+        }
+    }
+    return ready;
+}
+
+int64_t wallClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Ask the kernel to timestamp received datagrams (Linux)
+void enableReceiveTimestamps(intptr_t handle) {
+#ifdef SO_TIMESTAMPNS
+    int enable = 1;
+    setsockopt(native(handle), SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+#else
+    (void)handle;
+#endif
+}
+
+// recvfrom that also returns the receive time: the kernel's where it is
+// available, otherwise the time the datagram was read
+int receiveDatagram(intptr_t handle, uint8_t* buffer, size_t size, sockaddr_in& from, int64_t& timestampNs) {
+#ifdef SO_TIMESTAMPNS
+    iovec iov{buffer, size};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(timespec))];
+    msghdr msg{};
+    msg.msg_name = &from;
+    msg.msg_namelen = sizeof(from);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    int received = static_cast<int>(recvmsg(native(handle), &msg, 0));
+    timestampNs = wallClockNs();
+    for (cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+            timespec ts;
+            std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+            timestampNs = static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+        }
+    }
+    return received;
+#else
+    SockLen fromLen = sizeof(from);
+    int received = recvfrom(native(handle), reinterpret_cast<char*>(buffer), static_cast<int>(size), 0,
+                            reinterpret_cast<sockaddr*>(&from), &fromLen);
+    timestampNs = wallClockNs();
+    return received;
+#endif
+}
+
+bool sendAll(intptr_t handle, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        int sent = send(native(handle), reinterpret_cast<const char*>(data), static_cast<int>(size), 0);
+        if (sent <= 0) return false;
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+// Length of the next complete unit in an RTSP server stream, or 0 if more
+// bytes are needed. Interleaved frames are '$', channel, 16-bit length.
+size_t nextRtspUnit(const uint8_t* data, size_t size, bool& interleaved) {
+    if (size == 0) return 0;
+
+    if (data[0] == '$') {
+        interleaved = true;
+        if (size < 4) return 0;
+        size_t length = 4 + ((static_cast<size_t>(data[2]) << 8) | data[3]);
+        return size >= length ? length : 0;
+    }
+
+    interleaved = false;
+    static const char HEADER_END[] = "\r\n\r\n";
+    const uint8_t* end = std::search(data, data + size, HEADER_END, HEADER_END + 4);
+    if (end == data + size) {
+        return size > MAX_RTSP_HEADER ? size : 0;
+    }
+
+    size_t headerLength = static_cast<size_t>(end - data) + 4;
+    std::string header(data, data + headerLength);
+    std::transform(header.begin(), header.end(), header.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    size_t contentLength = 0;
+    size_t pos = header.find("\ncontent-length:");
+    if (pos != std::string::npos) {
+        contentLength = static_cast<size_t>(std::strtoul(header.c_str() + pos + 16, nullptr, 10));
+    }
+    size_t length = headerLength + contentLength;
+    return size >= length ? length : 0;
+}
+
+} // namespace
+
+ImpairmentProxy::ImpairmentProxy() = default;
+
+ImpairmentProxy::~ImpairmentProxy() {
+    stop();
+}
+
+bool ImpairmentProxy::start(const ImpairmentConfig& config) {
+    stop();
+    config_ = config;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        lastError_.clear();
+    }
+
+    if (config_.mode == ImpairmentMode::NONE || config_.listenPort <= 0 ||
+        config_.targetPort <= 0 || config_.targetHost.empty()) {
+        setError("Impairment relay needs a mode, listen port and target host:port");
+        return false;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        setError("WSAStartup failed");
+        return false;
+    }
+#endif
+    networkInitialized_ = true;
+
+    bool opened = config_.mode == ImpairmentMode::UDP ? openUdp() : openTcp();
+    if (!opened) {
+        stop();
+        return false;
+    }
+
+    if (!config_.logPath.empty()) {
+        log_.open(config_.logPath);
+        if (!log_.is_open()) {
+            setError("Cannot write impairment log: " + config_.logPath);
+            stop();
+            return false;
+        }
+        log_ << "# " << describe(config_) << "\n";
+        log_ << "seq,arrival_ms,channel,bytes,action,delay_ms,reordered\n";
+    }
+
+    if (!config_.capturePath.empty() && !capture_.open(config_.capturePath)) {
+        setError("Cannot write capture: " + config_.capturePath);
+        stop();
+        return false;
+    }
+
+    rng_.seed(config_.seed != 0 ? config_.seed : std::random_device{}());
+    lossBurstState_ = false;
+    startTime_ = Clock::now();
+    lastRelease_ = startTime_;
+    linkFreeAt_ = startTime_;
+    nextSeq_ = 0;
+    resetStats();
+
+    running_ = true;
+    senderThread_ = std::thread(&ImpairmentProxy::senderLoop, this);
+    if (config_.mode == ImpairmentMode::UDP) {
+        receiveThread_ = std::thread(&ImpairmentProxy::udpLoop, this);
+    } else {
+        receiveThread_ = std::thread(&ImpairmentProxy::tcpAcceptLoop, this);
+    }
+
+    std::cout << "Impairment relay: " << describe(config_) << std::endl;
+    return true;
+}
+
+void ImpairmentProxy::stop() {
+    running_ = false;
+    queueCv_.notify_all();
+    if (receiveThread_.joinable()) {
+        receiveThread_.join();
+    }
+    if (senderThread_.joinable()) {
+        senderThread_.join();
+    }
+
+    closeSockets();
+    clearQueue();
+    if (log_.is_open()) {
+        log_.close();
+    }
+    capture_.close();
+
+#ifdef _WIN32
+    if (networkInitialized_) {
+        WSACleanup();
+    }
+#endif
+    networkInitialized_ = false;
+}
+
+bool ImpairmentProxy::openUdp() {
+    // RTP on the port itself, RTCP on the next one up
+    for (int i = 0; i < 2; i++) {
+        UdpChannel channel;
+        channel.listenSocket = openSocket(SOCK_DGRAM);
+        channel.forwardSocket = openSocket(SOCK_DGRAM);
+        udpChannels_.push_back(channel);
+
+        if (channel.listenSocket == NO_SOCKET || channel.forwardSocket == NO_SOCKET) {
+            setError("Failed to create UDP socket");
+            return false;
+        }
+        if (!bindPort(channel.listenSocket, config_.listenPort + i)) {
+            setError("Cannot bind UDP port " + std::to_string(config_.listenPort + i));
+            return false;
+        }
+
+        // Cameras send a keyframe as a burst of datagrams
+        int bufferSize = UDP_RECEIVE_BUFFER;
+        setsockopt(native(channel.listenSocket), SOL_SOCKET, SO_RCVBUF,
+                   reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+        enableReceiveTimestamps(channel.listenSocket);
+
+        if (!resolveIPv4(config_.targetHost, config_.targetPort + i, udpChannels_.back().targetAddr)) {
+            setError("Cannot resolve " + config_.targetHost);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ImpairmentProxy::openTcp() {
+    tcpListenSocket_ = openSocket(SOCK_STREAM);
+    if (tcpListenSocket_ == NO_SOCKET) {
+        setError("Failed to create TCP socket");
+        return false;
+    }
+    if (!bindPort(tcpListenSocket_, config_.listenPort) || listen(native(tcpListenSocket_), 1) != 0) {
+        setError("Cannot listen on TCP port " + std::to_string(config_.listenPort));
+        return false;
+    }
+
+    std::vector<uint8_t> addr;
+    if (!resolveIPv4(config_.targetHost, config_.targetPort, addr)) {
+        setError("Cannot resolve " + config_.targetHost);
+        return false;
+    }
+    targetAddr_ = ntohl(reinterpret_cast<const sockaddr_in*>(addr.data())->sin_addr.s_addr);
+    return true;
+}
+
+void ImpairmentProxy::closeSockets() {
+    for (auto& channel : udpChannels_) {
+        closeSocket(channel.listenSocket);
+        closeSocket(channel.forwardSocket);
+    }
+    udpChannels_.clear();
+
+    closeSocket(tcpListenSocket_);
+    tcpListenSocket_ = NO_SOCKET;
+}
+
+void ImpairmentProxy::clearQueue() {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    while (!queue_.empty()) {
+        queue_.pop();
+    }
+}
+
+void ImpairmentProxy::udpLoop() {
+    std::vector<intptr_t> sockets;
+    for (const auto& channel : udpChannels_) {
+        sockets.push_back(channel.listenSocket);
+        sockets.push_back(channel.forwardSocket);
+    }
+
+    std::vector<uint8_t> buffer(MAX_DATAGRAM);
+    while (running_) {
+        for (intptr_t s : waitReadable(sockets, POLL_INTERVAL_MS)) {
+            for (size_t i = 0; i < udpChannels_.size(); i++) {
+                auto& channel = udpChannels_[i];
+                if (s != channel.listenSocket && s != channel.forwardSocket) continue;
+
+                sockaddr_in from{};
+                int64_t receivedNs = 0;
+                int received = receiveDatagram(s, buffer.data(), buffer.size(), from, receivedNs);
+                if (received <= 0) break;
+
+                if (s == channel.listenSocket) {
+                    // Camera -> receiver: captured as it arrived, then impaired
+                    capturePacket(receivedNs, ntohl(from.sin_addr.s_addr), ntohs(from.sin_port),
+                                  config_.listenPort + static_cast<int>(i), buffer.data(), received);
+                    channel.upstreamAddr.assign(reinterpret_cast<uint8_t*>(&from),
+                                                reinterpret_cast<uint8_t*>(&from) + sizeof(from));
+                    impair(std::vector<uint8_t>(buffer.begin(), buffer.begin() + received),
+                           static_cast<int>(i), true);
+                } else if (!channel.upstreamAddr.empty()) {
+                    // Receiver -> camera (RTCP receiver reports): passed straight back
+                    sendto(native(channel.listenSocket), reinterpret_cast<const char*>(buffer.data()),
+                           received, 0, reinterpret_cast<const sockaddr*>(channel.upstreamAddr.data()),
+                           static_cast<SockLen>(channel.upstreamAddr.size()));
+                }
+                break;
+            }
+        }
+    }
+}
+
+void ImpairmentProxy::tcpAcceptLoop() {
+    while (running_) {
+        if (waitReadable({tcpListenSocket_}, POLL_INTERVAL_MS).empty()) {
+            continue;
+        }
+
+        NativeSocket accepted = accept(native(tcpListenSocket_), nullptr, nullptr);
+        intptr_t client = static_cast<intptr_t>(accepted);
+#ifdef _WIN32
+        if (accepted == INVALID_SOCKET) continue;
+#else
+        if (accepted < 0) continue;
+#endif
+        relayTcpSession(client);
+    }
+}
+
+void ImpairmentProxy::relayTcpSession(SocketHandle client) {
+    std::vector<uint8_t> addr;
+    SocketHandle server = openSocket(SOCK_STREAM);
+    if (server == NO_SOCKET || !resolveIPv4(config_.targetHost, config_.targetPort, addr) ||
+        connect(native(server), reinterpret_cast<const sockaddr*>(addr.data()),
+                static_cast<SockLen>(addr.size())) != 0) {
+        setError("Cannot connect to " + config_.targetHost + ":" + std::to_string(config_.targetPort));
+        closeSocket(server);
+        closeSocket(client);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(tcpClientMutex_);
+        tcpClient_ = client;
+    }
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.sessions++;
+    }
+
+    std::vector<uint8_t> chunk(MAX_DATAGRAM);
+    std::vector<uint8_t> downstream;
+    bool open = true;
+    while (running_ && open) {
+        for (intptr_t s : waitReadable({client, server}, POLL_INTERVAL_MS)) {
+            int received = recv(native(s), reinterpret_cast<char*>(chunk.data()), static_cast<int>(chunk.size()), 0);
+            if (received <= 0) {
+                open = false;
+                break;
+            }
+
+            if (s == client) {
+                // Requests to the camera are not impaired
+                if (!sendAll(server, chunk.data(), static_cast<size_t>(received))) {
+                    open = false;
+                    break;
+                }
+                continue;
+            }
+
+            // Split the camera's byte stream into RTSP replies and interleaved frames
+            int64_t receivedNs = wallClockNs();
+            downstream.insert(downstream.end(), chunk.begin(), chunk.begin() + received);
+            size_t offset = 0;
+            while (offset < downstream.size()) {
+                const uint8_t* unit = downstream.data() + offset;
+                bool interleaved = false;
+                size_t length = nextRtspUnit(unit, downstream.size() - offset, interleaved);
+                if (length == 0) break;
+                if (interleaved) {
+                    capturePacket(receivedNs, targetAddr_, config_.targetPort + unit[1],
+                                  config_.listenPort + unit[1], unit + 4, length - 4);
+                } else {
+                    saveSessionDescription(unit, length);
+                }
+                // Log interleaved frames by their channel, RTSP replies as -1
+                impair(std::vector<uint8_t>(unit, unit + length), interleaved ? unit[1] : -1, interleaved);
+                offset += length;
+            }
+            downstream.erase(downstream.begin(), downstream.begin() + offset);
+        }
+    }
+
+    // Anything still queued belongs to this connection
+    clearQueue();
+    {
+        std::lock_guard<std::mutex> lock(tcpClientMutex_);
+        tcpClient_ = NO_SOCKET;
+    }
+    closeSocket(server);
+    closeSocket(client);
+}
+
+double ImpairmentProxy::sampleDelayMs() {
+    double delay = config_.delayMs;
+    double jitter = config_.jitterMs;
+
+    if (jitter > 0.0) {
+        switch (config_.distribution) {
+            case DelayDistribution::CONSTANT:
+                break;
+            case DelayDistribution::UNIFORM:
+                delay += std::uniform_real_distribution<double>(-jitter, jitter)(rng_);
+                break;
+            case DelayDistribution::NORMAL:
+                delay = std::normal_distribution<double>(delay, jitter)(rng_);
+                break;
+            case DelayDistribution::PARETO: {
+                // Lomax tail with shape 2.5, scaled so the mean extra delay is jitterMs
+                constexpr double SHAPE = 2.5;
+                double u = std::uniform_real_distribution<double>(1e-9, 1.0)(rng_);
+                delay += jitter * (SHAPE - 1.0) * (std::pow(u, -1.0 / SHAPE) - 1.0);
+                break;
+            }
+        }
+    }
+    return std::max(0.0, delay);
+}
+
+bool ImpairmentProxy::sampleLoss() {
+    if (config_.lossPercent <= 0.0) return false;
+
+    // Gilbert-Elliott with a lossless good state and a lossy bad state:
+    // mean burst = 1 / r, long-run loss = p / (p + r)
+    double loss = std::min(config_.lossPercent / 100.0, 0.99);
+    double r = 1.0 / std::max(1.0, config_.lossBurst);
+    double p = std::min(1.0, loss * r / (1.0 - loss));
+
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    if (lossBurstState_) {
+        lossBurstState_ = uniform(rng_) >= r;
+    } else {
+        lossBurstState_ = uniform(rng_) < p;
+    }
+    return lossBurstState_;
+}
+
+void ImpairmentProxy::impair(std::vector<uint8_t>&& data, int channel, bool droppable) {
+    auto now = Clock::now();
+    uint64_t seq = nextSeq_++;
+    size_t bytes = data.size();
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.packetsIn++;
+        stats_.bytesIn += bytes;
+    }
+
+    if (droppable && sampleLoss()) {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.packetsLost++;
+        logDecision(seq, now, channel, bytes, "loss", 0.0, false);
+        return;
+    }
+
+    // Bandwidth cap: the packet waits for the link, then takes its serialization time
+    auto sentAt = now;
+    if (config_.bandwidthKbps > 0.0) {
+        auto start = std::max(now, linkFreeAt_);
+        if (droppable && start - now > std::chrono::milliseconds(config_.queueLimitMs)) {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            stats_.packetsOverflow++;
+            logDecision(seq, now, channel, bytes, "overflow", 0.0, false);
+            return;
+        }
+        double txSec = bytes * 8.0 / (config_.bandwidthKbps * 1000.0);
+        linkFreeAt_ = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(txSec));
+        sentAt = linkFreeAt_;
+    }
+
+    // Propagation delay; reordered packets skip it (netem style) and overtake
+    // whatever is still in flight. Others never overtake each other.
+    auto release = sentAt + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(sampleDelayMs()));
+    bool reordered = false;
+    if (droppable && config_.reorderPercent > 0.0 &&
+        std::uniform_real_distribution<double>(0.0, 100.0)(rng_) < config_.reorderPercent) {
+        release = sentAt;
+        reordered = release < lastRelease_;
+    } else {
+        release = std::max(release, lastRelease_);
+        lastRelease_ = release;
+    }
+
+    double delayMs = std::chrono::duration<double, std::milli>(release - now).count();
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        if (reordered) stats_.packetsReordered++;
+        logDecision(seq, now, channel, bytes, "forward", delayMs, reordered);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        QueuedPacket packet;
+        packet.releaseAt = release;
+        packet.arrivedAt = now;
+        packet.seq = seq;
+        packet.channel = channel;
+        packet.data = std::move(data);
+        queue_.push(std::move(packet));
+    }
+    queueCv_.notify_one();
+}
+
+void ImpairmentProxy::senderLoop() {
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    while (running_) {
+        if (queue_.empty()) {
+            queueCv_.wait_for(lock, std::chrono::milliseconds(POLL_INTERVAL_MS));
+            continue;
+        }
+
+        auto releaseAt = queue_.top().releaseAt;
+        if (releaseAt > Clock::now()) {
+            queueCv_.wait_until(lock, releaseAt);
+            continue;
+        }
+
+        QueuedPacket packet = queue_.top();
+        queue_.pop();
+        lock.unlock();
+
+        bool sent = deliver(packet);
+        auto sentAt = Clock::now();
+        {
+            std::lock_guard<std::mutex> statsLock(statsMutex_);
+            if (sent) {
+                stats_.packetsForwarded++;
+                stats_.bytesForwarded += packet.data.size();
+                delayHistogram_.record(std::chrono::duration<double, std::micro>(sentAt - packet.arrivedAt).count());
+            }
+        }
+
+        lock.lock();
+    }
+}
+
+bool ImpairmentProxy::deliver(const QueuedPacket& packet) {
+    if (config_.mode == ImpairmentMode::UDP) {
+        const auto& channel = udpChannels_[packet.channel];
+        int sent = sendto(native(channel.forwardSocket), reinterpret_cast<const char*>(packet.data.data()),
+                          static_cast<int>(packet.data.size()), 0,
+                          reinterpret_cast<const sockaddr*>(channel.targetAddr.data()),
+                          static_cast<SockLen>(channel.targetAddr.size()));
+        return sent == static_cast<int>(packet.data.size());
+    }
+
+    std::lock_guard<std::mutex> lock(tcpClientMutex_);
+    if (tcpClient_ == NO_SOCKET) return false;
+    return sendAll(tcpClient_, packet.data.data(), packet.data.size());
+}
+
+void ImpairmentProxy::capturePacket(int64_t timestampNs, uint32_t srcAddr, int srcPort, int dstPort,
+                                    const uint8_t* data, size_t size) {
+    if (!capture_.isOpen()) return;
+
+    CapturedDatagram datagram;
+    datagram.timestampNs = timestampNs;
+    datagram.srcAddr = srcAddr;
+    datagram.dstAddr = 0x7f000001;  // 127.0.0.1
+    datagram.srcPort = static_cast<uint16_t>(srcPort);
+    datagram.dstPort = static_cast<uint16_t>(dstPort);
+    datagram.payload.assign(data, data + size);
+    if (capture_.write(datagram)) {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.packetsCaptured++;
+    }
+}
+
+void ImpairmentProxy::saveSessionDescription(const uint8_t* reply, size_t size) {
+    if (!capture_.isOpen()) return;
+
+    // The DESCRIBE reply carries the SDP as its body
+    std::string text(reply, reply + size);
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    size_t bodyStart = text.find("\r\n\r\n");
+    if (lower.find("application/sdp") == std::string::npos || bodyStart == std::string::npos) {
+        return;
+    }
+
+    // FFmpeg sets streams up in SDP order on interleaved channels 2k/2k+1,
+    // which the capture stores at listenPort + channel
+    std::string sdpPath = config_.capturePath + ".sdp";
+    std::ofstream file(sdpPath);
+    if (file.is_open()) {
+        file << rewriteSdpPorts(text.substr(bodyStart + 4), config_.listenPort, "127.0.0.1");
+    } else {
+        setError("Cannot write " + sdpPath);
+    }
+}
+
+void ImpairmentProxy::logDecision(uint64_t seq, Clock::time_point arrival, int channel, size_t bytes,
+                                  const char* action, double delayMs, bool reordered) {
+    // Caller holds statsMutex_
+    if (!log_.is_open()) return;
+    double arrivalMs = std::chrono::duration<double, std::milli>(arrival - startTime_).count();
+    log_ << seq << ',' << std::fixed << std::setprecision(3) << arrivalMs << ','
+         << channel << ',' << bytes << ','
+         << action << ',' << delayMs << ',' << (reordered ? 1 : 0) << '\n';
+}
+
+ImpairmentStats ImpairmentProxy::getStats() const {
+    ImpairmentStats stats;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats = stats_;
+        stats.addedDelayUs = delayHistogram_.getPercentiles();
+        stats.lastError = lastError_;
+    }
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    stats.queuedPackets = queue_.size();
+    return stats;
+}
+
+void ImpairmentProxy::resetStats() {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    int sessions = stats_.sessions;
+    stats_ = ImpairmentStats{};
+    stats_.sessions = sessions;
+    delayHistogram_.reset();
+}
+
+std::string ImpairmentProxy::getLastError() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return lastError_;
+}
+
+void ImpairmentProxy::setError(const std::string& error) {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    lastError_ = error;
+    std::cerr << "Impairment relay: " << error << std::endl;
+}
+
+bool ImpairmentProxy::parseRelaySpec(const std::string& spec, ImpairmentConfig& config) {
+    size_t first = spec.find(':');
+    size_t second = first == std::string::npos ? first : spec.find(':', first + 1);
+    size_t last = spec.rfind(':');
+    if (first == std::string::npos || second == std::string::npos || last <= second) {
+        return false;
+    }
+
+    std::string mode = spec.substr(0, first);
+    if (mode == "udp") {
+        config.mode = ImpairmentMode::UDP;
+    } else if (mode == "tcp") {
+        config.mode = ImpairmentMode::TCP;
+    } else {
+        return false;
+    }
+
+    config.listenPort = std::atoi(spec.substr(first + 1, second - first - 1).c_str());
+    config.targetHost = spec.substr(second + 1, last - second - 1);
+    config.targetPort = std::atoi(spec.substr(last + 1).c_str());
+    return config.listenPort > 0 && config.targetPort > 0 && !config.targetHost.empty();
+}
+
+bool ImpairmentProxy::parseDistribution(const std::string& name, DelayDistribution& out) {
+    if (name == "constant") { out = DelayDistribution::CONSTANT; return true; }
+    if (name == "uniform")  { out = DelayDistribution::UNIFORM;  return true; }
+    if (name == "normal")   { out = DelayDistribution::NORMAL;   return true; }
+    if (name == "pareto")   { out = DelayDistribution::PARETO;   return true; }
+    return false;
+}
+
+const char* ImpairmentProxy::distributionName(DelayDistribution distribution) {
+    switch (distribution) {
+        case DelayDistribution::CONSTANT: return "constant";
+        case DelayDistribution::UNIFORM:  return "uniform";
+        case DelayDistribution::NORMAL:   return "normal";
+        case DelayDistribution::PARETO:   return "pareto";
+    }
+    return "unknown";
+}
+
+std::string ImpairmentProxy::describe(const ImpairmentConfig& config) {
+    std::ostringstream oss;
+    oss << (config.mode == ImpairmentMode::TCP ? "tcp" : "udp") << " :" << config.listenPort
+        << " -> " << config.targetHost << ":" << config.targetPort << ", "
+        << config.delayMs << " ms " << distributionName(config.distribution);
+    if (config.jitterMs > 0.0 && config.distribution != DelayDistribution::CONSTANT) {
+        oss << " +/-" << config.jitterMs;
+    }
+    if (config.lossPercent > 0.0) {
+        oss << ", " << config.lossPercent << "% loss";
+        if (config.lossBurst > 1.0) oss << " (burst " << config.lossBurst << ")";
+    }
+    if (config.reorderPercent > 0.0) {
+        oss << ", " << config.reorderPercent << "% reorder";
+    }
+    if (config.bandwidthKbps > 0.0) {
+        oss << ", " << config.bandwidthKbps << " kbps (queue " << config.queueLimitMs << " ms)";
+    }
+    if (config.seed != 0) {
+        oss << ", seed " << config.seed;
+    }
+    return oss.str();
+}
+
+} // namespace latency
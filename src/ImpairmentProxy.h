@@ -0,0 +1,159 @@
+#pragma once
+
+#include "Config.h"
+#include "LatencyHistogram.h"
+#include "PcapFile.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace latency {
+
+struct ImpairmentStats {
+    uint64_t packetsIn = 0;
+    uint64_t packetsForwarded = 0;
+    uint64_t packetsLost = 0;       // Dropped by the loss model
+    uint64_t packetsOverflow = 0;   // Dropped because the bandwidth queue was full
+    uint64_t packetsReordered = 0;  // Sent ahead of packets that arrived earlier
+    uint64_t bytesIn = 0;
+    uint64_t bytesForwarded = 0;
+    size_t queuedPackets = 0;
+    int sessions = 0;               // TCP connections relayed
+    uint64_t packetsCaptured = 0;   // Written to the capture file
+    LatencyPercentiles addedDelayUs;  // Delay actually applied to forwarded packets
+    std::string lastError;
+};
+
+// Relay between a camera and VideoDecoder that degrades the stream the way
+// a WAN would: delay with a chosen distribution, jitter, Gilbert-Elliott
+// burst loss, reordering and a bandwidth cap with a bounded queue.
+//
+// UDP mode forwards datagrams arriving on listenPort and listenPort + 1
+// (RTP and RTCP) to the target, and returns replies from the receiver
+// unimpaired. TCP mode relays one RTSP connection at a time; the camera's
+// interleaved RTP/RTCP frames are impaired individually, RTSP replies are
+// only delayed. Every decision is logged when logPath is set, so runs can
+// be correlated with measured latency and dropped frames.
+//
+// With capturePath set, camera packets are also written to a pcap file as
+// they arrive, before any impairment, for RtpReplayer. UDP packets carry
+// the kernel receive timestamp where the OS provides one (Linux). TCP
+// frames are stored as UDP datagrams to port listenPort + channel, and the
+// RTSP session description is saved next to the capture as <file>.sdp.
+class ImpairmentProxy {
+public:
+    ImpairmentProxy();
+    ~ImpairmentProxy();
+
+    ImpairmentProxy(const ImpairmentProxy&) = delete;
+    ImpairmentProxy& operator=(const ImpairmentProxy&) = delete;
+
+    bool start(const ImpairmentConfig& config);
+    void stop();
+    bool isRunning() const { return running_; }
+
+    const ImpairmentConfig& getConfig() const { return config_; }
+    ImpairmentStats getStats() const;
+    void resetStats();
+
+    std::string getLastError() const;
+
+    // "udp:LISTEN_PORT:HOST:PORT" or "tcp:LISTEN_PORT:HOST:PORT"
+    static bool parseRelaySpec(const std::string& spec, ImpairmentConfig& config);
+    static bool parseDistribution(const std::string& name, DelayDistribution& out);
+    static const char* distributionName(DelayDistribution distribution);
+
+    // One-line description of the impairment ("50 ms normal +/-20, 1% loss ...")
+    static std::string describe(const ImpairmentConfig& config);
+
+private:
+    using Clock = std::chrono::steady_clock;
+    using SocketHandle = intptr_t;  // SOCKET on Windows, fd elsewhere
+    static constexpr SocketHandle NO_SOCKET = -1;
+
+    struct QueuedPacket {
+        Clock::time_point releaseAt;
+        Clock::time_point arrivedAt;
+        uint64_t seq = 0;
+        int channel = 0;              // UDP: 0 = RTP, 1 = RTCP; TCP: interleaved channel, -1 = RTSP
+        std::vector<uint8_t> data;
+        bool operator>(const QueuedPacket& other) const {
+            return releaseAt != other.releaseAt ? releaseAt > other.releaseAt : seq > other.seq;
+        }
+    };
+
+    struct UdpChannel {
+        SocketHandle listenSocket = NO_SOCKET;   // Camera sends here
+        SocketHandle forwardSocket = NO_SOCKET;  // We send to the receiver from here
+        std::vector<uint8_t> targetAddr;         // sockaddr of the receiver
+        std::vector<uint8_t> upstreamAddr;       // Last camera address seen
+    };
+
+    // Decide what happens to a unit arriving now; queue it unless dropped.
+    // Units that must arrive (RTSP messages) are never lost or reordered.
+    void impair(std::vector<uint8_t>&& data, int channel, bool droppable);
+    double sampleDelayMs();
+    bool sampleLoss();
+
+    void udpLoop();
+    void tcpAcceptLoop();
+    void relayTcpSession(SocketHandle client);
+    void senderLoop();
+    bool deliver(const QueuedPacket& packet);
+
+    bool openUdp();
+    bool openTcp();
+    void closeSockets();
+    void clearQueue();
+    void capturePacket(int64_t timestampNs, uint32_t srcAddr, int srcPort, int dstPort,
+                       const uint8_t* data, size_t size);
+    void saveSessionDescription(const uint8_t* reply, size_t size);
+    void setError(const std::string& error);
+    void logDecision(uint64_t seq, Clock::time_point arrival, int channel, size_t bytes,
+                     const char* action, double delayMs, bool reordered);
+
+    ImpairmentConfig config_;
+    std::atomic<bool> running_{false};
+    std::thread receiveThread_;
+    std::thread senderThread_;
+    Clock::time_point startTime_;
+
+    // Sockets
+    std::vector<UdpChannel> udpChannels_;
+    SocketHandle tcpListenSocket_ = NO_SOCKET;
+    std::mutex tcpClientMutex_;                // Sender thread writes while the session reads
+    SocketHandle tcpClient_ = NO_SOCKET;
+    bool networkInitialized_ = false;
+
+    // Release queue (receive threads push, sender thread pops at releaseAt)
+    mutable std::mutex queueMutex_;
+    std::condition_variable queueCv_;
+    std::priority_queue<QueuedPacket, std::vector<QueuedPacket>, std::greater<QueuedPacket>> queue_;
+
+    // Impairment state (receive thread only)
+    std::mt19937 rng_;
+    bool lossBurstState_ = false;      // Gilbert-Elliott: in a loss burst
+    Clock::time_point lastRelease_;    // Keeps non-reordered packets in order
+    Clock::time_point linkFreeAt_;     // Bandwidth cap: when the link is idle again
+    uint64_t nextSeq_ = 0;
+
+    mutable std::mutex statsMutex_;
+    ImpairmentStats stats_;
+    LatencyHistogram delayHistogram_;
+    std::ofstream log_;
+    std::string lastError_;
+
+    // Capture (receive thread only)
+    PcapWriter capture_;
+    uint32_t targetAddr_ = 0;          // IPv4 of the camera, host byte order
+};
+
+} // namespace latency
@@ -0,0 +1,115 @@
+#include "LatencyBudget.h"
+#include <algorithm>
+#include <cmath>
+
+namespace latency {
+
+namespace {
+
+double elapsedMs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+} // namespace
+
+const char* budgetSegmentName(BudgetSegment segment) {
+    switch (segment) {
+        case BudgetSegment::CameraNetwork: return "Cam+net";
+        case BudgetSegment::Buffering:     return "Buffer";
+        case BudgetSegment::Decode:        return "Decode";
+        case BudgetSegment::Queue:         return "Queue";
+        case BudgetSegment::Present:       return "Present";
+        default:                           return "Unknown";
+    }
+}
+
+const char* budgetSegmentKey(BudgetSegment segment) {
+    switch (segment) {
+        case BudgetSegment::CameraNetwork: return "camera_network";
+        case BudgetSegment::Buffering:     return "buffering";
+        case BudgetSegment::Decode:        return "decode";
+        case BudgetSegment::Queue:         return "queue";
+        case BudgetSegment::Present:       return "present";
+        default:                           return "unknown";
+    }
+}
+
+double LatencyBreakdown::totalMs() const {
+    double total = 0.0;
+    for (double value : ms) {
+        total += value;
+    }
+    return total;
+}
+
+LatencyBreakdown splitLatency(double measuredMs, const FrameTimeline& timeline,
+                              std::chrono::steady_clock::time_point dequeuedAt, double presentMs) {
+    LatencyBreakdown breakdown;
+    breakdown.kernelArrival = timeline.kernelArrival;
+    breakdown.ms[static_cast<size_t>(BudgetSegment::CameraNetwork)] =
+        measuredMs - elapsedMs(timeline.firstPacket, dequeuedAt);
+    breakdown.ms[static_cast<size_t>(BudgetSegment::Buffering)] = elapsedMs(timeline.firstPacket, timeline.demuxed);
+    breakdown.ms[static_cast<size_t>(BudgetSegment::Decode)] = elapsedMs(timeline.demuxed, timeline.converted);
+    breakdown.ms[static_cast<size_t>(BudgetSegment::Queue)] = elapsedMs(timeline.converted, dequeuedAt);
+    breakdown.ms[static_cast<size_t>(BudgetSegment::Present)] = presentMs;
+    return breakdown;
+}
+
+void LatencyBudget::add(const LatencyBreakdown& breakdown) {
+    for (size_t i = 0; i < BUDGET_SEGMENT_COUNT; i++) {
+        if (breakdown.ms[i] < 0.0) {
+            belowZero_[i].record(-breakdown.ms[i] * 1000.0);
+        } else {
+            histograms_[i].record(breakdown.ms[i] * 1000.0);
+        }
+        sumMs_[i] += breakdown.ms[i];
+    }
+    count_++;
+    if (breakdown.kernelArrival) {
+        kernelArrivals_++;
+    }
+}
+
+void LatencyBudget::reset() {
+    for (size_t i = 0; i < BUDGET_SEGMENT_COUNT; i++) {
+        histograms_[i].reset();
+        belowZero_[i].reset();
+    }
+    sumMs_.fill(0.0);
+    count_ = 0;
+    kernelArrivals_ = 0;
+}
+
+double LatencyBudget::getMeanMs(BudgetSegment segment) const {
+    return count_ ? sumMs_[static_cast<size_t>(segment)] / count_ : 0.0;
+}
+
+double LatencyBudget::getPercentileMs(BudgetSegment segment, double quantile) const {
+    const auto& positive = histograms_[static_cast<size_t>(segment)];
+    const auto& negative = belowZero_[static_cast<size_t>(segment)];
+    uint64_t below = negative.getCount();
+    uint64_t total = below + positive.getCount();
+    if (total == 0) return 0.0;
+
+    // Rank of the wanted sample across both sides, as LatencyHistogram counts
+    // it. The negatives come first, largest magnitude first; each side is
+    // asked for its own rank half a sample below it so the ceil lands on it.
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * total));
+    rank = std::max<uint64_t>(rank, 1);
+    if (rank <= below) {
+        double fromLargest = static_cast<double>(below - rank + 1);
+        return -negative.getPercentileUs((fromLargest - 0.5) / below) / 1000.0;
+    }
+    double fromSmallest = static_cast<double>(rank - below);
+    return positive.getPercentileUs((fromSmallest - 0.5) / positive.getCount()) / 1000.0;
+}
+
+double LatencyBudget::getMeanTotalMs() const {
+    double total = 0.0;
+    for (size_t i = 0; i < BUDGET_SEGMENT_COUNT; i++) {
+        total += getMeanMs(static_cast<BudgetSegment>(i));
+    }
+    return total;
+}
+
+} // namespace latency
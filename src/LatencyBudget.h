@@ -0,0 +1,64 @@
+#pragma once
+
+#include "LatencyHistogram.h"
+#include "VideoDecoder.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace latency {
+
+// Consecutive parts of one glass-to-glass measurement
+enum class BudgetSegment {
+    CameraNetwork,  // Capture, encode and network, up to the frame's first packet
+    Buffering,      // First packet -> demuxed: transfer, jitter and reorder buffering
+    Decode,         // Demuxed -> decoded and converted to RGB
+    Queue,          // Converted -> taken by the UI thread
+    Present,        // Taken -> texture uploaded and presented
+    Count
+};
+
+constexpr size_t BUDGET_SEGMENT_COUNT = static_cast<size_t>(BudgetSegment::Count);
+
+const char* budgetSegmentName(BudgetSegment segment);  // Display label ("Cam+net")
+const char* budgetSegmentKey(BudgetSegment segment);   // Export key ("camera_network")
+
+struct LatencyBreakdown {
+    std::array<double, BUDGET_SEGMENT_COUNT> ms{};
+    bool kernelArrival = false;        // Buffering measured from the socket, not zero by definition
+
+    double totalMs() const;
+};
+
+// Split an optical latency read when the frame was dequeued (measuredMs at
+// dequeuedAt) along the frame's pipeline timeline, adding the time it then
+// took to present. The segments sum to measuredMs + presentMs. Without
+// kernel arrival times the first packet is the demux time, so Buffering is
+// zero and network buffering counts as Camera+network.
+LatencyBreakdown splitLatency(double measuredMs, const FrameTimeline& timeline,
+                              std::chrono::steady_clock::time_point dequeuedAt, double presentMs);
+
+// Per-segment histograms over many breakdowns. Values below zero (clocks
+// can put Camera+network there) are kept by magnitude in a second histogram,
+// so percentiles stay signed like the means.
+class LatencyBudget {
+public:
+    void add(const LatencyBreakdown& breakdown);
+    void reset();
+
+    uint64_t getCount() const { return count_; }
+    uint64_t getKernelArrivalCount() const { return kernelArrivals_; }
+    double getMeanMs(BudgetSegment segment) const;
+    double getMeanTotalMs() const;
+    double getPercentileMs(BudgetSegment segment, double quantile) const;
+
+private:
+    std::array<LatencyHistogram, BUDGET_SEGMENT_COUNT> histograms_;      // Values >= 0
+    std::array<LatencyHistogram, BUDGET_SEGMENT_COUNT> belowZero_;       // Magnitudes of values < 0
+    std::array<double, BUDGET_SEGMENT_COUNT> sumMs_{};  // Signed: clocks can put Camera+network below zero
+    uint64_t count_ = 0;
+    uint64_t kernelArrivals_ = 0;
+};
+
+} // namespace latency
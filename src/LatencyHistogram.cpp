@@ -0,0 +1,123 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace latency {
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    buckets_.fill(0);
+    count_ = 0;
+    minUs_ = 0;
+    maxUs_ = 0;
+    sumUs_ = 0.0;
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t valueUs) {
+    if (valueUs > MAX_TRACKABLE_US) {
+        valueUs = MAX_TRACKABLE_US;
+    }
+    if (valueUs < SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(valueUs);  // Exact buckets for small values
+    }
+
+    // Position of the highest set bit
+    int msb = 0;
+    for (uint64_t v = valueUs; v > 1; v >>= 1) {
+        msb++;
+    }
+
+    int shift = msb - SUB_BUCKET_BITS + 1;
+    uint64_t mantissa = valueUs >> shift;  // In [SUB_BUCKET_HALF, SUB_BUCKET_COUNT)
+    return static_cast<size_t>(shift * SUB_BUCKET_HALF + mantissa);
+}
+
+uint64_t LatencyHistogram::bucketLowerBoundUs(size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+    uint64_t shift = index / SUB_BUCKET_HALF - 1;
+    uint64_t mantissa = index - shift * SUB_BUCKET_HALF;
+    return mantissa << shift;
+}
+
+uint64_t LatencyHistogram::bucketWidthUs(size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return 1;
+    }
+    return 1ULL << (index / SUB_BUCKET_HALF - 1);
+}
+
+void LatencyHistogram::record(double valueUs) {
+    uint64_t v = valueUs > 0.0 ? static_cast<uint64_t>(std::llround(valueUs)) : 0;
+
+    buckets_[bucketIndex(v)]++;
+
+    if (count_ == 0) {
+        minUs_ = v;
+        maxUs_ = v;
+    } else {
+        minUs_ = std::min(minUs_, v);
+        maxUs_ = std::max(maxUs_, v);
+    }
+    count_++;
+    sumUs_ += static_cast<double>(v);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.count_ == 0) return;
+
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        buckets_[i] += other.buckets_[i];
+    }
+
+    if (count_ == 0) {
+        minUs_ = other.minUs_;
+        maxUs_ = other.maxUs_;
+    } else {
+        minUs_ = std::min(minUs_, other.minUs_);
+        maxUs_ = std::max(maxUs_, other.maxUs_);
+    }
+    count_ += other.count_;
+    sumUs_ += other.sumUs_;
+}
+
+double LatencyHistogram::getPercentileUs(double quantile) const {
+    if (count_ == 0) return 0.0;
+
+    quantile = std::clamp(quantile, 0.0, 1.0);
+    uint64_t target = static_cast<uint64_t>(std::ceil(quantile * count_));
+    if (target == 0) target = 1;
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        cumulative += buckets_[i];
+        if (cumulative >= target) {
+            // Midpoint of the bucket, clamped to the observed range
+            double mid = bucketLowerBoundUs(i) + (bucketWidthUs(i) - 1) / 2.0;
+            return std::clamp(mid, static_cast<double>(minUs_), static_cast<double>(maxUs_));
+        }
+    }
+
+    return static_cast<double>(maxUs_);
+}
+
+LatencyPercentiles LatencyHistogram::getPercentiles() const {
+    LatencyPercentiles p;
+    p.count = count_;
+    if (count_ == 0) return p;
+
+    p.minUs = getMinUs();
+    p.maxUs = getMaxUs();
+    p.meanUs = getMeanUs();
+    p.p50Us = getPercentileUs(0.50);
+    p.p90Us = getPercentileUs(0.90);
+    p.p99Us = getPercentileUs(0.99);
+    p.p999Us = getPercentileUs(0.999);
+    return p;
+}
+
+} // namespace latency
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace latency {
+
+// Summary of a histogram at a point in time (all values in microseconds)
+struct LatencyPercentiles {
+    uint64_t count = 0;
+    double minUs = 0.0;
+    double maxUs = 0.0;
+    double meanUs = 0.0;
+    double p50Us = 0.0;
+    double p90Us = 0.0;
+    double p99Us = 0.0;
+    double p999Us = 0.0;
+};
+
+// Fixed-memory log-linear histogram for microsecond latencies.
+// Values below SUB_BUCKET_COUNT are stored exactly; above that each power of
+// two is split into SUB_BUCKET_COUNT / 2 linear buckets, giving ~3% worst-case
+// relative error up to MAX_TRACKABLE_US. Larger values land in the last bucket.
+// Not thread-safe - callers guard it with their own stats mutex.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr uint64_t SUB_BUCKET_COUNT = 1ULL << SUB_BUCKET_BITS;   // 32
+    static constexpr uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;       // 16
+    static constexpr int MAX_VALUE_BITS = 27;                               // ~134 s
+    static constexpr uint64_t MAX_TRACKABLE_US = (1ULL << MAX_VALUE_BITS) - 1;
+    static constexpr size_t BUCKET_COUNT =
+        (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_HALF + SUB_BUCKET_HALF;
+
+    LatencyHistogram();
+
+    // Record one sample (negative values are clamped to zero)
+    void record(double valueUs);
+
+    // Merge another histogram's samples into this one
+    void merge(const LatencyHistogram& other);
+
+    void reset();
+
+    uint64_t getCount() const { return count_; }
+    double getMinUs() const { return count_ ? static_cast<double>(minUs_) : 0.0; }
+    double getMaxUs() const { return count_ ? static_cast<double>(maxUs_) : 0.0; }
+    double getMeanUs() const { return count_ ? sumUs_ / count_ : 0.0; }
+
+    // Value at the given quantile (0.0 - 1.0), reported as the bucket midpoint
+    double getPercentileUs(double quantile) const;
+
+    LatencyPercentiles getPercentiles() const;
+
+    // Raw bucket access (for export)
+    uint64_t getBucketCount(size_t index) const { return buckets_[index]; }
+    static uint64_t bucketLowerBoundUs(size_t index);
+    static uint64_t bucketWidthUs(size_t index);
+    static size_t bucketIndex(uint64_t valueUs);
+
+private:
+    std::array<uint64_t, BUCKET_COUNT> buckets_;
+    uint64_t count_ = 0;
+    uint64_t minUs_ = 0;
+    uint64_t maxUs_ = 0;
+    double sumUs_ = 0.0;
+};
+
+} // namespace latency
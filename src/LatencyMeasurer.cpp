@@ -1,6 +1,9 @@
 #include "LatencyMeasurer.h"
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdlib>
+#include <vector>
 
 namespace latency {
 
@@ -12,6 +15,30 @@ void LatencyMeasurer::setPatternRegion(const PatternRegion& region) {
 
 void LatencyMeasurer::clearPatternRegion() {
     patternRegion_.reset();
+    rowRegions_.clear();
+}
+
+void LatencyMeasurer::resetReadStats() {
+    readStats_ = PatternReadStats{};
+    rowFrames_ = 0;
+    rowOffsetSumMs_ = {};
+}
+
+PatternRowStats LatencyMeasurer::getRowStats() const {
+    PatternRowStats stats;
+    if (!patternRegion_) {
+        return stats;
+    }
+
+    stats.rows = 1 + static_cast<int>(rowRegions_.size());
+    stats.frameHeight = rowFrameHeight_;
+    stats.frames = rowFrames_;
+    stats.rowY[0] = patternRegion_->y + patternRegion_->height / 2;
+    for (size_t i = 0; i < rowRegions_.size(); i++) {
+        stats.rowY[i + 1] = rowRegions_[i].y + rowRegions_[i].height / 2;
+        stats.offsetMs[i + 1] = rowFrames_ > 0 ? rowOffsetSumMs_[i + 1] / rowFrames_ : 0.0;
+    }
+    return stats;
 }
 
 LatencyMeasurement LatencyMeasurer::measure(const VideoFrame* frame, uint32_t currentTimestamp) {
@@ -19,48 +46,76 @@ LatencyMeasurement LatencyMeasurer::measure(const VideoFrame* frame, uint32_t cu
     result.actualTimestamp = currentTimestamp;
     result.valid = false;
 
-    if (!frame || !frame->data) {
+    auto timestamp = readTimestamp(frame);
+    if (!timestamp) {
+        return result;
+    }
+
+    // Sanity check: latency should be reasonable (-10s to +60s). The CRC
+    // already vouches for the read, so the region stays: this is another
+    // clock's pattern (e.g. a recording on screen), not a misplaced region.
+    int32_t latency = static_cast<int32_t>(currentTimestamp) - static_cast<int32_t>(*timestamp);
+    if (latency < MIN_PLAUSIBLE_LATENCY_MS || latency > MAX_PLAUSIBLE_LATENCY_MS) {
         return result;
     }
 
+    result.displayedTimestamp = *timestamp;
+    result.latencyMs = latency;
+    result.valid = true;
+
+    readPatternRows(frame, *timestamp);
+    return result;
+}
+
+std::optional<uint32_t> LatencyMeasurer::readTimestamp(const VideoFrame* frame) {
+    if (!frame || !frame->data) {
+        return std::nullopt;
+    }
+
+    readStats_.frames++;
+
     // Auto-detect pattern region if not set
     if (!patternRegion_) {
+        readStats_.detections++;
         auto detected = detectPatternRegion(frame);
         if (detected) {
             patternRegion_ = detected;
+            // Rows below it may have moved with it
+            rowRegions_.clear();
+            framesSinceRowSearch_ = ROW_SEARCH_INTERVAL_FRAMES;
         } else {
-            return result;  // Pattern not found
+            return std::nullopt;  // Pattern not found
         }
     }
 
     // Decode timestamp from pattern
-    auto timestamp = decodeBinaryPattern(frame, *patternRegion_);
+    auto timestamp = decodeBinaryPattern(frame, *patternRegion_, lastQuality_);
     if (!timestamp) {
-        // Pattern detection might have drifted, try re-detecting
-        patternRegion_.reset();
-        return result;
+        if (lastQuality_.regionLost) {
+            // Pattern detection might have drifted, try re-detecting
+            patternRegion_.reset();
+        } else if (lastQuality_.lowConfidence) {
+            // Too dim or washed out this frame; the pattern is still there
+            readStats_.lowConfidence++;
+        } else {
+            // Pattern still in place, just unreadable in this frame: keep the region
+            readStats_.rejected++;
+        }
+        return std::nullopt;
     }
 
     // Sanity check: timestamp should be reasonable (less than 24 hours in ms)
     const uint32_t MAX_REASONABLE_TIMESTAMP = 24 * 60 * 60 * 1000;  // 24 hours
     if (*timestamp > MAX_REASONABLE_TIMESTAMP) {
         patternRegion_.reset();
-        return result;
+        return std::nullopt;
     }
 
-    // Sanity check: latency should be reasonable (-10s to +60s)
-    int32_t latency = static_cast<int32_t>(currentTimestamp) - static_cast<int32_t>(*timestamp);
-    if (latency < -10000 || latency > 60000) {
-        // Likely a false detection, re-detect next frame
-        patternRegion_.reset();
-        return result;
+    readStats_.read++;
+    if (lastQuality_.corrected) {
+        readStats_.corrected++;
     }
-
-    result.displayedTimestamp = *timestamp;
-    result.latencyMs = latency;
-    result.valid = true;
-
-    return result;
+    return timestamp;
 }
 
 std::optional<PatternRegion> LatencyMeasurer::detectPatternRegion(const VideoFrame* frame) {
@@ -185,15 +240,24 @@ bool LatencyMeasurer::validateSyncPattern(const VideoFrame* frame, int x, int y)
 
     if (y < 0 || y >= frame->height) return false;
 
-    // Check for alternating pattern: expect at least 3 transitions in first 80 pixels
+    // Check for alternating pattern: expect at least 3 transitions in first
+    // 80 pixels, around the midpoint of the levels found there
+    std::vector<int> levels;
+    for (int dx = 0; dx < 80 && (x + dx) < frame->width; dx += 8) {
+        int offset = y * frame->pitch + (x + dx) * bytesPerPixel;
+        levels.push_back((frame->data[offset] + frame->data[offset + 1] + frame->data[offset + 2]) / 3);
+    }
+    if (levels.empty()) return false;
+    auto [darkest, brightest] = std::minmax_element(levels.begin(), levels.end());
+    if (*brightest - *darkest < MIN_SYNC_CONTRAST) return false;
+    const int threshold = (*darkest + *brightest) / 2;
+
     int transitions = 0;
     bool lastBright = false;
     bool firstSample = true;
 
-    for (int dx = 0; dx < 80 && (x + dx) < frame->width; dx += 8) {
-        int offset = y * frame->pitch + (x + dx) * bytesPerPixel;
-        int brightness = (frame->data[offset] + frame->data[offset + 1] + frame->data[offset + 2]) / 3;
-        bool isBright = brightness > brightnessThreshold_;
+    for (int brightness : levels) {
+        bool isBright = brightness > threshold;
 
         if (firstSample) {
             lastBright = isBright;
@@ -208,7 +272,9 @@ bool LatencyMeasurer::validateSyncPattern(const VideoFrame* frame, int x, int y)
 }
 
 std::optional<uint32_t> LatencyMeasurer::decodeBinaryPattern(const VideoFrame* frame,
-                                                               const PatternRegion& region) {
+                                                               const PatternRegion& region,
+                                                               PatternReadQuality& quality) {
+    quality = PatternReadQuality{};
     if (!frame || !frame->data) {
         return std::nullopt;
     }
@@ -216,41 +282,33 @@ std::optional<uint32_t> LatencyMeasurer::decodeBinaryPattern(const VideoFrame* f
     const int bytesPerPixel = 3;
 
     // Calculate bit dimensions based on region size
-    // Account for the white border (PATTERN_BORDER on each side)
-    int innerWidth = region.width - 2 * PATTERN_BORDER;
-    int totalBits = SYNC_BITS + PATTERN_BITS + SYNC_BITS;
-    float bitWidth = static_cast<float>(innerWidth) / totalBits;
+    // The region spans the white border too, which is PATTERN_BORDER_BITS wide on each side
+    float bitWidth = static_cast<float>(region.width) / PATTERN_TOTAL_UNITS;
 
     if (bitWidth < 2.0f) {
+        quality.regionLost = true;
         return std::nullopt;  // Pattern too small
     }
 
     // Sample from middle of pattern height
     int sampleY = region.y + region.height / 2;
     if (sampleY < 0 || sampleY >= frame->height) {
+        quality.regionLost = true;
         return std::nullopt;
     }
 
     const uint8_t* row = frame->data + sampleY * frame->pitch;
 
-    // Skip border and start sync pattern, read data bits
-    int dataStartX = region.x + PATTERN_BORDER + static_cast<int>(SYNC_BITS * bitWidth);
-
-    uint32_t timestamp = 0;
-    int highBits = 0;
-    int lowBits = 0;
-
-    for (int bit = 0; bit < PATTERN_BITS; bit++) {
-        int sampleX = dataStartX + static_cast<int>((bit + 0.5f) * bitWidth);
-
+    // Average brightness across the middle of one pattern unit, -1 outside the frame
+    auto sampleUnit = [&](int unit) {
+        int sampleX = region.x + static_cast<int>((unit + 0.5f) * bitWidth);
         if (sampleX < 0 || sampleX >= frame->width) {
-            return std::nullopt;
+            return -1;
         }
 
         // Sample a small region for robustness
         int totalBrightness = 0;
         int samples = 0;
-
         for (int dx = -2; dx <= 2; dx++) {
             int xPos = sampleX + dx;
             if (xPos >= 0 && xPos < frame->width) {
@@ -259,27 +317,223 @@ std::optional<uint32_t> LatencyMeasurer::decodeBinaryPattern(const VideoFrame* f
                 samples++;
             }
         }
+        return samples > 0 ? totalBrightness / samples : -1;
+    };
+
+    // Reference units whose colour never changes: the sync runs (alternating,
+    // black first) and the white quiet zone at each end
+    const int dataStart = PATTERN_BORDER_BITS + SYNC_BITS;
+    const int endSyncStart = dataStart + PATTERN_DATA_BITS;
+    constexpr int REFERENCE_COUNT = SYNC_BITS * 2 + PATTERN_BORDER_BITS * 2;
+    std::array<int, REFERENCE_COUNT> referenceUnits{};
+    std::array<bool, REFERENCE_COUNT> referenceWhite{};
+    std::array<int, REFERENCE_COUNT> referenceLevels{};
+    int references = 0;
+    for (int i = 0; i < SYNC_BITS; i++) {
+        for (int unit : {PATTERN_BORDER_BITS + i, endSyncStart + i}) {
+            referenceUnits[references] = unit;
+            referenceWhite[references++] = i % 2 == 1;
+        }
+    }
+    for (int i = 0; i < PATTERN_BORDER_BITS; i++) {
+        for (int unit : {i, PATTERN_TOTAL_UNITS - 1 - i}) {
+            referenceUnits[references] = unit;
+            referenceWhite[references++] = true;
+        }
+    }
 
-        int avgBrightness = samples > 0 ? totalBrightness / samples : 0;
-        bool bitValue = avgBrightness > brightnessThreshold_;
-
-        if (bitValue) {
-            highBits++;
-            timestamp |= (1U << (PATTERN_BITS - 1 - bit));
+    int blackSum = 0, blackCount = 0, whiteSum = 0, whiteCount = 0;
+    for (int i = 0; i < REFERENCE_COUNT; i++) {
+        referenceLevels[i] = sampleUnit(referenceUnits[i]);
+        if (referenceLevels[i] < 0) {
+            quality.regionLost = true;
+            return std::nullopt;
+        }
+        (referenceWhite[i] ? whiteSum : blackSum) += referenceLevels[i];
+        (referenceWhite[i] ? whiteCount : blackCount)++;
+    }
+    quality.blackLevel = blackSum / blackCount;
+    quality.whiteLevel = whiteSum / whiteCount;
+    quality.threshold = (quality.blackLevel + quality.whiteLevel) / 2;
+    const int threshold = quality.threshold;
+
+    // If the references aren't on their side of the midpoint, the pattern has
+    // moved (unlike data bits, which may be mid-transition). One may be off,
+    // e.g. under a speck of glare; it doesn't count towards the separation.
+    int referenceErrors = 0;
+    int darkestWhite = 255;
+    int brightestBlack = 0;
+    for (int i = 0; i < REFERENCE_COUNT; i++) {
+        if ((referenceLevels[i] > threshold) != referenceWhite[i]) {
+            referenceErrors++;
+        } else if (referenceWhite[i]) {
+            darkestWhite = std::min(darkestWhite, referenceLevels[i]);
         } else {
-            lowBits++;
+            brightestBlack = std::max(brightestBlack, referenceLevels[i]);
         }
     }
+    if (referenceErrors > 1 || quality.whiteLevel <= quality.blackLevel) {
+        quality.regionLost = true;
+        return std::nullopt;
+    }
 
-    // Sanity check: should have a mix of high and low bits for a valid timestamp
-    // (all zeros or all ones is suspicious)
-    if (highBits < 2 || lowBits < 2) {
+    // Still in place but too dim, washed out or uneven to read: skip the frame, keep the region
+    quality.separation = darkestWhite - brightestBlack;
+    if (quality.separation < MIN_REFERENCE_SEPARATION) {
+        quality.lowConfidence = true;
         return std::nullopt;
     }
 
+    // Read the Gray-coded timestamp and its CRC, keeping how sure each bit is
+    const float halfRange = (quality.whiteLevel - quality.blackLevel) / 2.0f;
+    uint32_t word = 0;
+    auto& confidence = quality.bitConfidence;
+    quality.minConfidence = 1.0f;
+    for (int bit = 0; bit < PATTERN_DATA_BITS; bit++) {
+        int brightness = sampleUnit(dataStart + bit);
+        if (brightness < 0) {
+            quality.regionLost = true;
+            return std::nullopt;
+        }
+        if (brightness > threshold) {
+            word |= 1U << (PATTERN_DATA_BITS - 1 - bit);
+        }
+        confidence[bit] = std::min(1.0f, std::abs(brightness - threshold) / halfRange);
+        quality.minConfidence = std::min(quality.minConfidence, confidence[bit]);
+    }
+
+    uint32_t timestamp = 0;
+    if (decodePatternWord(word, timestamp)) {
+        return timestamp;
+    }
+
+    // Exposed across a display update: the bits that changed read grey and
+    // may have landed either way. Try the least certain ones both ways.
+    std::vector<int> unsure;
+    for (int bit = 0; bit < PATTERN_DATA_BITS; bit++) {
+        if (confidence[bit] < UNSURE_CONFIDENCE) {
+            unsure.push_back(bit);
+        }
+    }
+    if (unsure.empty()) {
+        return std::nullopt;
+    }
+    std::sort(unsure.begin(), unsure.end(), [&](int a, int b) { return confidence[a] < confidence[b]; });
+    if (unsure.size() > static_cast<size_t>(MAX_UNSURE_BITS)) {
+        unsure.resize(MAX_UNSURE_BITS);
+    }
+
+    // The least costly flip that passes the CRC is the likelier side of the
+    // update. Candidates far apart mean the CRC matched by chance.
+    bool found = false;
+    float bestCost = 0.0f;
+    uint32_t lowest = 0;
+    uint32_t highest = 0;
+    for (uint32_t combo = 1; combo < (1U << unsure.size()); combo++) {
+        uint32_t candidate = word;
+        float cost = 0.0f;
+        for (size_t i = 0; i < unsure.size(); i++) {
+            if (combo & (1U << i)) {
+                candidate ^= 1U << (PATTERN_DATA_BITS - 1 - unsure[i]);
+                cost += confidence[unsure[i]];
+            }
+        }
+
+        uint32_t value = 0;
+        if (!decodePatternWord(candidate, value)) {
+            continue;
+        }
+        if (!found || cost < bestCost) {
+            bestCost = cost;
+            timestamp = value;
+        }
+        lowest = found ? std::min(lowest, value) : value;
+        highest = found ? std::max(highest, value) : value;
+        found = true;
+    }
+
+    if (!found || highest - lowest > MAX_BLEND_SPREAD_MS) {
+        return std::nullopt;
+    }
+    quality.corrected = true;
     return timestamp;
 }
 
+std::vector<PatternRegion> LatencyMeasurer::findPatternRows(const VideoFrame* frame, const PatternRegion& first) {
+    const int bytesPerPixel = 3;
+    std::vector<PatternRegion> rows;
+
+    // The copies' green borders line up with the first one's: scan a narrow
+    // strip around its left edge, downwards from below its border
+    const int stripLeft = std::max(0, first.x - first.height / 4);
+    const int stripRight = std::min(frame->width - 1, first.x + first.height / 8);
+    int y = first.y + first.height + first.height / 4;
+
+    while (y < frame->height - 20 && static_cast<int>(rows.size()) + 1 < MAX_PATTERN_ROWS) {
+        bool found = false;
+        for (int x = stripLeft; x <= stripRight && !found; x++) {
+            const uint8_t* pixel = frame->data + y * frame->pitch + x * bytesPerPixel;
+            if (pixel[1] <= 180 || pixel[0] >= 100 || pixel[2] >= 100) {
+                continue;
+            }
+            auto region = findPatternNearGreen(frame, x, y);
+            if (region && std::abs(region->width - first.width) <= first.width / 20 &&
+                std::abs(region->x - first.x) <= first.height / 4) {
+                rows.push_back(*region);
+                y = region->y + region->height + first.height / 4;
+                found = true;
+            }
+        }
+        if (!found) {
+            y++;
+        }
+    }
+    return rows;
+}
+
+void LatencyMeasurer::readPatternRows(const VideoFrame* frame, uint32_t firstTimestamp) {
+    // Look for rows when the first is found, and now and then while some are missing
+    if (static_cast<int>(rowRegions_.size()) + 1 < MAX_PATTERN_ROWS &&
+        ++framesSinceRowSearch_ >= ROW_SEARCH_INTERVAL_FRAMES) {
+        framesSinceRowSearch_ = 0;
+        auto rows = findPatternRows(frame, *patternRegion_);
+        if (rows.size() != rowRegions_.size() || frame->height != rowFrameHeight_) {
+            rowFrames_ = 0;
+            rowOffsetSumMs_ = {};
+        }
+        rowRegions_ = std::move(rows);
+        rowFrameHeight_ = frame->height;
+    }
+    if (rowRegions_.empty()) {
+        return;
+    }
+
+    // Offsets count only from frames where every row was read
+    std::array<int32_t, MAX_PATTERN_ROWS> offsets{};
+    for (size_t i = 0; i < rowRegions_.size(); i++) {
+        PatternReadQuality quality;
+        auto timestamp = decodeBinaryPattern(frame, rowRegions_[i], quality);
+        if (quality.regionLost) {
+            rowRegions_.clear();
+            framesSinceRowSearch_ = ROW_SEARCH_INTERVAL_FRAMES;
+            return;
+        }
+        if (!timestamp) {
+            return;
+        }
+        int32_t offset = static_cast<int32_t>(*timestamp - firstTimestamp);
+        if (std::abs(offset) > MAX_ROW_OFFSET_MS) {
+            return;
+        }
+        offsets[i + 1] = offset;
+    }
+
+    rowFrames_++;
+    for (size_t i = 1; i <= rowRegions_.size(); i++) {
+        rowOffsetSumMs_[i] += offsets[i];
+    }
+}
+
 uint8_t LatencyMeasurer::getRegionBrightness(const uint8_t* data, int pitch,
                                               int x, int y, int w, int h) const {
     const int bytesPerPixel = 3;
@@ -2,12 +2,18 @@
 
 #include "VideoDecoder.h"
 #include "TimestampDisplay.h"
+#include "TimestampPattern.h"
+#include <array>
 #include <vector>
 #include <cstdint>
 #include <optional>
 
 namespace latency {
 
+// Latencies outside this range are treated as a misread pattern
+constexpr int32_t MIN_PLAUSIBLE_LATENCY_MS = -10000;
+constexpr int32_t MAX_PLAUSIBLE_LATENCY_MS = 60000;
+
 struct PatternRegion {
     int x = 0;
     int y = 0;
@@ -15,11 +21,62 @@ struct PatternRegion {
     int height = 0;
 };
 
+// How pattern reads have gone since the last reset
+struct PatternReadStats {
+    uint64_t frames = 0;             // Frames offered to readTimestamp()
+    uint64_t read = 0;               // Timestamps read (including corrected)
+    uint64_t corrected = 0;          // Read only after resolving mid-transition bits
+    uint64_t rejected = 0;           // Pattern in place but no timestamp passed the CRC
+    uint64_t lowConfidence = 0;      // Pattern in place but its black and white too close to read
+    uint64_t detections = 0;         // Full-frame searches for the pattern
+};
+
+// How one read of the pattern went. Black and white are taken from the
+// frame itself (the sync bits and the white quiet zone), so exposure drift,
+// glare or a dim monitor move the threshold with them.
+struct PatternReadQuality {
+    int blackLevel = 0;              // Mean of the black sync bits
+    int whiteLevel = 0;              // Mean of the white sync bits and quiet zone
+    int threshold = 0;               // Midpoint between them, applied to every data bit
+    int separation = 0;              // Darkest white reference minus brightest black one
+    float minConfidence = 0.0f;      // Weakest data bit
+    std::array<float, PATTERN_DATA_BITS> bitConfidence{};  // 0 at the threshold, 1 at its reference level
+    bool regionLost = false;         // References out of place: the pattern moved
+    bool lowConfidence = false;      // References too close together to trust the bits
+    bool corrected = false;          // Mid-transition bits had to be resolved
+};
+
+// Extra pattern rows below the first, read from the same frames. Each row
+// shows its own scan-out time, so a row reading later than the first is the
+// camera having read it out later.
+struct PatternRowStats {
+    int rows = 0;                    // Pattern rows found, including the first (0 = none yet)
+    int frameHeight = 0;             // Of the frames the rows were found in
+    uint64_t frames = 0;             // Frames where every row was read
+    std::array<int, MAX_PATTERN_ROWS> rowY{};        // Centre of each row in the frame
+    std::array<double, MAX_PATTERN_ROWS> offsetMs{}; // Mean reading of each row minus the first row's
+
+    // Camera readout between the first and last rows, and scaled to the full frame height
+    double readoutMs() const { return rows > 1 ? offsetMs[rows - 1] : 0.0; }
+    double fullFrameReadoutMs() const {
+        int span = rows > 1 ? rowY[rows - 1] - rowY[0] : 0;
+        return span > 0 ? readoutMs() * frameHeight / span : 0.0;
+    }
+};
+
+// What a measurement's displayed timestamp was read from
+enum class MeasurementSource {
+    Pattern,                          // Binary timestamp pattern
+    Ocr,                              // Human-readable MM:SS.cc clock (ClockReader)
+    Flash                             // Flash-mode luma edge (FlashDetector)
+};
+
 struct LatencyMeasurement {
     uint32_t displayedTimestamp = 0;  // Timestamp read from video
     uint32_t actualTimestamp = 0;     // Actual current timestamp
     int32_t latencyMs = 0;            // Difference (actual - displayed)
     bool valid = false;               // Whether measurement was successful
+    MeasurementSource source = MeasurementSource::Pattern;
 };
 
 class LatencyMeasurer {
@@ -27,9 +84,14 @@ public:
     LatencyMeasurer();
     ~LatencyMeasurer() = default;
 
-    // Analyze a frame and extract the timestamp
+    // Analyze a frame and extract the timestamp (from the first pattern row;
+    // any further rows are read in the same pass for getRowStats())
     LatencyMeasurement measure(const VideoFrame* frame, uint32_t currentTimestamp);
 
+    // Read the timestamp shown in a frame without comparing it to a clock
+    // (detects the pattern region first if needed)
+    std::optional<uint32_t> readTimestamp(const VideoFrame* frame);
+
     // Auto-detect pattern region in frame
     std::optional<PatternRegion> detectPatternRegion(const VideoFrame* frame);
 
@@ -40,9 +102,24 @@ public:
     // Get detected region
     const std::optional<PatternRegion>& getPatternRegion() const { return patternRegion_; }
 
+    const PatternReadStats& getReadStats() const { return readStats_; }
+    // Levels and bit confidences of the last read of the first row
+    const PatternReadQuality& getLastQuality() const { return lastQuality_; }
+    void resetReadStats();
+
+    PatternRowStats getRowStats() const;
+
 private:
-    // Decode binary pattern from pixel data
-    std::optional<uint32_t> decodeBinaryPattern(const VideoFrame* frame, const PatternRegion& region);
+    // Decode the Gray-coded timestamp and check its CRC, thresholding each
+    // bit against the frame's own black and white references
+    std::optional<uint32_t> decodeBinaryPattern(const VideoFrame* frame, const PatternRegion& region,
+                                                PatternReadQuality& quality);
+
+    // Pattern copies straight below the first region, with its width
+    std::vector<PatternRegion> findPatternRows(const VideoFrame* frame, const PatternRegion& first);
+
+    // Read the extra rows and add their offsets from the first row's reading
+    void readPatternRows(const VideoFrame* frame, uint32_t firstTimestamp);
 
     // Find pattern near a detected green pixel
     std::optional<PatternRegion> findPatternNearGreen(const VideoFrame* frame, int greenX, int greenY);
@@ -54,7 +131,30 @@ private:
     uint8_t getRegionBrightness(const uint8_t* data, int pitch, int x, int y, int w, int h) const;
 
     std::optional<PatternRegion> patternRegion_;
-    int brightnessThreshold_ = 128;  // Threshold for black/white detection
+    PatternReadStats readStats_;
+    PatternReadQuality lastQuality_;
+
+    std::vector<PatternRegion> rowRegions_;           // Rows after the first, top to bottom
+    int rowFrameHeight_ = 0;
+    int framesSinceRowSearch_ = ROW_SEARCH_INTERVAL_FRAMES;
+    uint64_t rowFrames_ = 0;
+    std::array<double, MAX_PATTERN_ROWS> rowOffsetSumMs_{};
+
+    static constexpr int ROW_SEARCH_INTERVAL_FRAMES = 60;  // While fewer than MAX_PATTERN_ROWS are found
+    static constexpr int32_t MAX_ROW_OFFSET_MS = 500;      // Rows further apart are misreads
+
+    // Reference black and white closer than this (levels, 0-255) leave too
+    // little room between them to read bits: the frame is skipped
+    static constexpr int MIN_REFERENCE_SEPARATION = 24;
+    // Sync transitions the detector needs to see, and their minimum contrast
+    static constexpr int MIN_SYNC_CONTRAST = 40;
+    // Bits with less confidence than this may be mid-transition; up to
+    // MAX_UNSURE_BITS of them are tried both ways against the CRC
+    static constexpr float UNSURE_CONFIDENCE = 0.375f;
+    static constexpr int MAX_UNSURE_BITS = 5;
+    // Candidates that pass the CRC must be this close together, as the two
+    // sides of one display update are; otherwise the read is ambiguous
+    static constexpr uint32_t MAX_BLEND_SPREAD_MS = 100;
 };
 
 } // namespace latency
@@ -0,0 +1,271 @@
+#include "LoopbackBenchmark.h"
+#include "LatencyMeasurer.h"
+#include "PcapFile.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace latency {
+
+bool LoopbackBenchmark::run(const LoopbackBenchmarkConfig& config, LoopbackBenchmarkResult& result) {
+    lastError_.clear();
+    result = LoopbackBenchmarkResult{};
+    result.url = config.source.url;
+
+    bool rtsp = config.source.url.find("rtsp://") == 0;
+    bool impaired = config.impairment.mode != ImpairmentMode::NONE;
+    if (impaired && (rtsp || config.impairment.mode != ImpairmentMode::UDP)) {
+        lastError_ = "Loopback impairment needs an rtp:// source and a udp relay";
+        return false;
+    }
+    if (impaired && std::abs(config.impairment.listenPort - config.impairment.targetPort) < 2) {
+        lastError_ = "Relay listen and target port pairs overlap";
+        return false;
+    }
+
+    TestSourceConfig sourceConfig = config.source;
+    ImpairmentProxy proxy;
+    if (impaired) {
+        sourceConfig.url = "rtp://127.0.0.1:" + std::to_string(config.impairment.listenPort);
+        if (!proxy.start(config.impairment)) {
+            lastError_ = proxy.getLastError();
+            return false;
+        }
+    }
+
+    StreamConfig streamConfig;
+    streamConfig.url = rtsp ? config.source.url : config.source.sdpPath;
+    streamConfig.protocol = rtsp ? StreamProtocol::RTSP : StreamProtocol::RTP;
+    streamConfig.transport = TransportProtocol::TCP;
+    streamConfig.rtspListen = rtsp;
+    streamConfig.decoderThreading = config.decoderThreading;
+    streamConfig.decoderThreadCount = config.decoderThreadCount;
+    streamConfig.udpReceive = config.udpReceive;
+
+    TestPatternSource source;
+    VideoDecoder decoder;
+
+    // Measure right after convert, on the decode thread, against the source's own clock
+    LatencyMeasurer measurer;
+    ResultsManager results;
+    std::mutex resultsMutex;
+    bool measuring = false;
+    decoder.setFrameCallback([&](const VideoFrame& frame) {
+        LatencyMeasurement measurement = measurer.measure(&frame, source.getCurrentTimestamp());
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        if (measuring) {
+            results.addMeasurement(measurement);
+        }
+    });
+
+    bool connected = false;
+    if (rtsp) {
+        // The receiver listens; the source publishes to it once it is up
+        std::thread listener([&] { connected = decoder.connect(streamConfig); });
+        bool started = source.start(sourceConfig);
+        if (!started) {
+            // Nothing will publish: the listener gives up after its connection timeout
+            lastError_ = source.getLastError();
+        }
+        listener.join();
+        if (!started) {
+            decoder.disconnect();
+            return false;
+        }
+    } else {
+        // RTP: the source writes the SDP the receiver opens
+        if (!source.start(sourceConfig)) {
+            lastError_ = source.getLastError();
+            return false;
+        }
+        if (impaired && !redirectSdp(sourceConfig.sdpPath, config.impairment.targetPort)) {
+            source.stop();
+            return false;
+        }
+        connected = decoder.connect(streamConfig);
+    }
+
+    if (!connected) {
+        lastError_ = "Receiver failed to connect: " + decoder.getLastError();
+        source.stop();
+        return false;
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(config.warmupSec));
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        results.startTest(result.url, decoder.getStreamInfo().codecName,
+                          decoder.getStreamInfo().width, decoder.getStreamInfo().height);
+        measuring = true;
+    }
+    decoder.resetStageHistograms();
+    proxy.resetStats();
+
+    // Drain the display queue ourselves; nothing renders in this mode
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(config.durationSec);
+    while (std::chrono::steady_clock::now() < end && source.isRunning() && decoder.isConnected()) {
+        while (decoder.getFrame()) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        measuring = false;
+        result.latency = results.endTest().statistics;
+    }
+
+    auto stats = decoder.getDecodeStats();
+    decoder.disconnect();
+    result.source = source.getStats();
+    result.encoder = source.getEncoderName();
+    bool sourceFailed = !source.isRunning();
+    std::string sourceError = source.getLastError();
+    source.stop();
+    if (impaired) {
+        result.impaired = true;
+        result.impairment = config.impairment;
+        result.impairmentStats = proxy.getStats();
+        proxy.stop();
+    }
+
+    result.decoder = stats.decoderName;
+    result.decoderThreading = stats.threading;
+    result.framesSent = result.source.framesSent;
+    result.framesDecoded = stats.framesDecoded;
+    result.framesDropped = stats.framesDropped;
+    result.stages = stats.stageLatency;
+    result.receiverOverheadMs = result.latency.p50Ms - result.source.encodeUs.p50Us / 1000.0;
+
+    if (sourceFailed) {
+        lastError_ = "Test source stopped: " + sourceError;
+        return false;
+    }
+    if (result.latency.validSamples == 0) {
+        lastError_ = "No frames with a readable pattern were received";
+        return false;
+    }
+    return true;
+}
+
+bool LoopbackBenchmark::redirectSdp(const std::string& path, int port) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        lastError_ = "Cannot read " + path;
+        return false;
+    }
+    std::stringstream sdp;
+    sdp << in.rdbuf();
+    in.close();
+
+    std::string text = rewriteSdpPorts(sdp.str(), port, "127.0.0.1");
+
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        lastError_ = "Cannot write " + path;
+        return false;
+    }
+    out << text;
+    return true;
+}
+
+bool LoopbackBenchmark::writeReport(const std::string& filename, const LoopbackBenchmarkResult& result) {
+    auto percentiles = [](const LatencyPercentiles& p) {
+        return nlohmann::json{
+            {"count", p.count},
+            {"p50_us", p.p50Us},
+            {"p90_us", p.p90Us},
+            {"p99_us", p.p99Us},
+            {"max_us", p.maxUs}
+        };
+    };
+
+    nlohmann::json j;
+    j["url"] = result.url;
+    j["encoder"] = result.encoder;
+    j["decoder"] = result.decoder;
+    j["decoder_threading"] = result.decoderThreading;
+    j["frames_sent"] = result.framesSent;
+    j["frames_decoded"] = result.framesDecoded;
+    j["frames_dropped"] = result.framesDropped;
+    j["latency"] = {
+        {"min_ms", result.latency.minMs},
+        {"max_ms", result.latency.maxMs},
+        {"avg_ms", result.latency.avgMs},
+        {"std_dev_ms", result.latency.stdDevMs},
+        {"p50_ms", result.latency.p50Ms},
+        {"p95_ms", result.latency.p95Ms},
+        {"p99_ms", result.latency.p99Ms},
+        {"valid_samples", result.latency.validSamples},
+        {"invalid_samples", result.latency.invalidSamples}
+    };
+    j["source"] = {
+        {"frames_late", result.source.framesLate},
+        {"render", percentiles(result.source.renderUs)},
+        {"encode_send", percentiles(result.source.encodeUs)}
+    };
+
+    nlohmann::json stages;
+    for (size_t i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+        stages[pipelineStageKey(static_cast<PipelineStage>(i))] = percentiles(result.stages[i]);
+    }
+    j["receiver_stages"] = stages;
+    j["receiver_overhead_ms"] = result.receiverOverheadMs;
+
+    if (result.impaired) {
+        const auto& stats = result.impairmentStats;
+        j["impairment"] = {
+            {"description", ImpairmentProxy::describe(result.impairment)},
+            {"packets_in", stats.packetsIn},
+            {"packets_forwarded", stats.packetsForwarded},
+            {"packets_lost", stats.packetsLost},
+            {"packets_overflow", stats.packetsOverflow},
+            {"packets_reordered", stats.packetsReordered},
+            {"added_delay", percentiles(stats.addedDelayUs)}
+        };
+    }
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << j.dump(2);
+    return true;
+}
+
+std::string LoopbackBenchmark::formatSummary(const LoopbackBenchmarkResult& result) {
+    std::ostringstream oss;
+    oss << "Loopback: " << result.url << " (" << result.encoder << " -> " << result.decoder
+        << ", " << result.decoderThreading << ")\n";
+    oss << "Frames: " << result.framesSent << " sent, " << result.framesDecoded << " decoded, "
+        << result.framesDropped << " dropped, " << result.source.framesLate << " late at source\n";
+    oss << "End-to-end latency: min " << result.latency.minMs << " / p50 " << result.latency.p50Ms
+        << " / p95 " << result.latency.p95Ms << " / p99 " << result.latency.p99Ms
+        << " / max " << result.latency.maxMs << " ms (" << result.latency.validSamples << " frames)\n";
+    oss << std::fixed << std::setprecision(2)
+        << "Source encode+send p50: " << result.source.encodeUs.p50Us / 1000.0 << " ms\n";
+    for (size_t i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+        const auto& p = result.stages[i];
+        if (p.count == 0) continue;
+        oss << "  " << std::left << std::setw(12) << pipelineStageName(static_cast<PipelineStage>(i))
+            << std::right << " p50 " << std::setw(8) << p.p50Us / 1000.0
+            << " ms  p99 " << std::setw(8) << p.p99Us / 1000.0 << " ms\n";
+    }
+    oss << "Receiver overhead (p50): " << result.receiverOverheadMs << " ms\n";
+    if (result.impaired) {
+        const auto& stats = result.impairmentStats;
+        oss << "Impairment: " << ImpairmentProxy::describe(result.impairment) << "\n"
+            << "  " << stats.packetsIn << " packets, " << stats.packetsLost << " lost, "
+            << stats.packetsOverflow << " overflowed, " << stats.packetsReordered << " reordered, "
+            << "added delay p50 " << stats.addedDelayUs.p50Us / 1000.0 << " ms\n";
+    }
+    return oss.str();
+}
+
+} // namespace latency
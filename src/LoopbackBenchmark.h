@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Config.h"
+#include "ImpairmentProxy.h"
+#include "ResultsManager.h"
+#include "TestPatternSource.h"
+#include "VideoDecoder.h"
+#include <string>
+
+namespace latency {
+
+struct LoopbackBenchmarkConfig {
+    TestSourceConfig source;
+    int durationSec = 30;
+    int warmupSec = 2;              // Skip measurements while the decoder locks on
+    DecoderThreading decoderThreading = DecoderThreading::AUTO;
+    int decoderThreadCount = 2;
+    UdpReceiveConfig udpReceive;    // RTP only
+
+    // Optional UDP relay between source and receiver (RTP only). The source
+    // sends to the relay's listen port; the receiver gets the target port.
+    ImpairmentConfig impairment;
+};
+
+struct LoopbackBenchmarkResult {
+    std::string url;
+    std::string encoder;
+    std::string decoder;
+    std::string decoderThreading;
+    uint64_t framesSent = 0;
+    uint64_t framesDecoded = 0;
+    uint64_t framesDropped = 0;
+
+    // End-to-end latency: frame drawn -> pattern read after decode and convert
+    LatencyStatistics latency;
+
+    // Where that time went
+    TestSourceStats source;
+    std::array<LatencyPercentiles, PIPELINE_STAGE_COUNT> stages;
+
+    // Receiver overhead: end-to-end p50 minus the source's encode + send p50
+    double receiverOverheadMs = 0.0;
+
+    bool impaired = false;
+    ImpairmentConfig impairment;
+    ImpairmentStats impairmentStats;
+};
+
+// Runs the synthetic test source and the receiving pipeline in one process
+// against a single clock, so the measured latency is exact ground truth for
+// encode + loopback network + demux/decode/convert.
+class LoopbackBenchmark {
+public:
+    bool run(const LoopbackBenchmarkConfig& config, LoopbackBenchmarkResult& result);
+
+    // Write the result as JSON (returns false on I/O error)
+    static bool writeReport(const std::string& filename, const LoopbackBenchmarkResult& result);
+
+    // Human-readable summary
+    static std::string formatSummary(const LoopbackBenchmarkResult& result);
+
+    std::string getLastError() const { return lastError_; }
+
+private:
+    // Point the receiver's session description at the relay target port
+    bool redirectSdp(const std::string& path, int port);
+
+    std::string lastError_;
+};
+
+} // namespace latency
@@ -0,0 +1,288 @@
+#include "OfflineAnalyzer.h"
+#include "LatencyMeasurer.h"
+#include "WorkerPool.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+
+namespace latency {
+
+OfflineAnalyzer::OfflineAnalyzer(const OfflineAnalysisOptions& options)
+    : options_(options) {
+}
+
+bool OfflineAnalyzer::analyze(const std::string& path, OfflineAnalysisResult& result) {
+    lastError_.clear();
+    result = OfflineAnalysisResult{};
+    result.file = path;
+
+    // Latency added by the decoder doesn't matter offline, so use frame
+    // threading (AUTO would keep low-delay on and get slice threads at most)
+    // with FFmpeg picking the thread count
+    StreamConfig config;
+    config.url = path;
+    config.protocol = StreamProtocol::LOCAL_FILE;
+    config.decoderThreading = DecoderThreading::FRAME;
+    config.decoderThreadCount = 0;
+
+    VideoDecoder decoder;
+    if (!decoder.connect(config)) {
+        lastError_ = decoder.getLastError();
+        return false;
+    }
+
+    const auto& info = decoder.getStreamInfo();
+    result.codec = info.codecName;
+    result.width = info.width;
+    result.height = info.height;
+    result.fps = info.fps;
+
+    // Shared between the dispatch loop and the pattern readers
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t inFlight = 0;
+    std::optional<PatternRegion> knownRegion;
+    std::vector<OfflineFrameResult> frames;
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        WorkerPool pool(static_cast<size_t>(std::max(0, options_.measureThreads)));
+        result.measureThreads = static_cast<int>(pool.getThreadCount());
+
+        // Bound the decoded frames held in memory
+        const size_t maxInFlight = pool.getThreadCount() * 2;
+
+        while (true) {
+            SharedFrame frame = decoder.waitForFrame(100);
+            if (!frame) {
+                if (decoder.isEndOfStream()) break;
+                continue;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return inFlight < maxInFlight; });
+                inFlight++;
+            }
+
+            pool.submit([&, frame] {
+                // Each task gets its own reader, seeded with the last region that worked
+                LatencyMeasurer measurer;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (knownRegion) measurer.setPatternRegion(*knownRegion);
+                }
+                bool hadRegion = measurer.getPatternRegion().has_value();
+
+                auto timestamp = measurer.readTimestamp(frame.get());
+                if (!timestamp && hadRegion && !measurer.getPatternRegion()) {
+                    // The pattern moved in the shot: detect it again on this frame
+                    // (an unreadable frame with the pattern in place keeps its region)
+                    timestamp = measurer.readTimestamp(frame.get());
+                }
+
+                OfflineFrameResult frameResult;
+                frameResult.ptsMs = frame->ptsMs;
+                if (timestamp) {
+                    frameResult.displayedTimestamp = *timestamp;
+                    frameResult.valid = true;
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                frames.push_back(frameResult);
+                if (timestamp) {
+                    knownRegion = measurer.getPatternRegion();
+                }
+                inFlight--;
+                cv.notify_all();
+            });
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return inFlight == 0; });
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    result.framesDecoded = decoder.getDecodeStats().framesDecoded;
+    decoder.disconnect();
+
+    if (frames.empty()) {
+        lastError_ = "No frames decoded from " + path;
+        return false;
+    }
+
+    std::sort(frames.begin(), frames.end(),
+              [](const OfflineFrameResult& a, const OfflineFrameResult& b) { return a.ptsMs < b.ptsMs; });
+    result.frames = std::move(frames);
+
+    double frameIntervalMs = result.fps > 0.0 ? 1000.0 / result.fps : 0.0;
+    result.mediaDurationSec = (result.frames.back().ptsMs - result.frames.front().ptsMs + frameIntervalMs) / 1000.0;
+    result.wallTimeSec = std::chrono::duration<double>(end - start).count();
+    if (result.wallTimeSec > 0.0) {
+        result.speedup = result.mediaDurationSec / result.wallTimeSec;
+    }
+
+    computeLatencies(result);
+    return true;
+}
+
+void OfflineAnalyzer::computeLatencies(OfflineAnalysisResult& result) const {
+    auto firstValid = std::find_if(result.frames.begin(), result.frames.end(),
+                                   [](const OfflineFrameResult& f) { return f.valid; });
+
+    // Map container time onto the display clock
+    bool absolute = options_.hasClockOffset;
+    double offsetMs = 0.0;
+    if (absolute) {
+        result.clockAnchor = "clock_offset";
+        result.clockOffsetMs = options_.clockOffsetMs;
+        offsetMs = static_cast<double>(options_.clockOffsetMs);
+    } else {
+        // Without a reference, anchor on the first readable frame: latency is
+        // then relative to it, which still shows drift and jitter
+        result.clockAnchor = "first_frame";
+        if (firstValid != result.frames.end()) {
+            offsetMs = firstValid->displayedTimestamp - firstValid->ptsMs;
+            result.clockOffsetMs = static_cast<int64_t>(std::llround(offsetMs));
+        }
+    }
+
+    // A recording has no decoder warmup to skip; startup transients in it
+    // are still found and left out
+    ResultsManager results;
+    results.setWarmupFrames(0);
+    results.startTest(result.file, result.codec, result.width, result.height);
+
+    for (auto& frame : result.frames) {
+        LatencyMeasurement measurement;
+        measurement.actualTimestamp = static_cast<uint32_t>(std::max(0.0, frame.ptsMs + offsetMs));
+
+        if (frame.valid) {
+            frame.latencyMs = static_cast<int32_t>(std::llround(frame.ptsMs + offsetMs)) -
+                              static_cast<int32_t>(frame.displayedTimestamp);
+
+            // Same plausibility window as live measurement, when latency is absolute
+            if (absolute && (frame.latencyMs < MIN_PLAUSIBLE_LATENCY_MS ||
+                             frame.latencyMs > MAX_PLAUSIBLE_LATENCY_MS)) {
+                frame.valid = false;
+                frame.latencyMs = 0;
+            }
+        }
+
+        measurement.displayedTimestamp = frame.displayedTimestamp;
+        measurement.latencyMs = frame.latencyMs;
+        measurement.valid = frame.valid;
+        results.addMeasurement(measurement);
+    }
+
+    result.test = results.endTest();
+    result.test.testDurationSec = static_cast<int>(result.mediaDurationSec);
+}
+
+bool OfflineAnalyzer::writeReport(const std::string& filename, const OfflineAnalysisResult& result) {
+    const auto& stats = result.test.statistics;
+
+    nlohmann::json j;
+    j["file"] = result.file;
+    j["codec"] = result.codec;
+    j["resolution"] = {
+        {"width", result.width},
+        {"height", result.height}
+    };
+    j["fps"] = result.fps;
+    j["frames_decoded"] = result.framesDecoded;
+    j["media_duration_sec"] = result.mediaDurationSec;
+    j["wall_time_sec"] = result.wallTimeSec;
+    j["speedup"] = result.speedup;
+    j["measure_threads"] = result.measureThreads;
+    j["clock_anchor"] = result.clockAnchor;
+    j["clock_offset_ms"] = result.clockOffsetMs;
+    j["latency"] = {
+        {"min_ms", stats.minMs},
+        {"max_ms", stats.maxMs},
+        {"avg_ms", stats.avgMs},
+        {"std_dev_ms", stats.stdDevMs},
+        {"p50_ms", stats.p50Ms},
+        {"p95_ms", stats.p95Ms},
+        {"p99_ms", stats.p99Ms},
+        {"valid_samples", stats.validSamples},
+        {"invalid_samples", stats.invalidSamples}
+    };
+
+    j["warmup_sec"] = result.test.warmupSec;
+    nlohmann::json segments = nlohmann::json::array();
+    for (const auto& segment : result.test.segments) {
+        segments.push_back({
+            {"start_sec", segment.startSec},
+            {"end_sec", segment.endSec},
+            {"avg_ms", segment.statistics.avgMs},
+            {"p50_ms", segment.statistics.p50Ms},
+            {"p95_ms", segment.statistics.p95Ms},
+            {"valid_samples", segment.statistics.validSamples}
+        });
+    }
+    j["segments"] = segments;
+
+    // [pts_ms, displayed_ms, latency_ms] per frame; latency is null where no pattern was read
+    nlohmann::json frames = nlohmann::json::array();
+    for (const auto& f : result.frames) {
+        frames.push_back({
+            f.ptsMs,
+            f.valid ? nlohmann::json(f.displayedTimestamp) : nlohmann::json(nullptr),
+            f.valid ? nlohmann::json(f.latencyMs) : nlohmann::json(nullptr)
+        });
+    }
+    j["frames"] = frames;
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << j.dump(2);
+    return true;
+}
+
+std::string OfflineAnalyzer::formatSummary(const OfflineAnalysisResult& result) {
+    const auto& stats = result.test.statistics;
+
+    std::ostringstream oss;
+    oss << "File: " << result.file << " (" << result.codec << " "
+        << result.width << "x" << result.height << " @ "
+        << std::fixed << std::setprecision(1) << result.fps << " fps)\n";
+    oss << "Decoded " << result.framesDecoded << " frames ("
+        << std::setprecision(1) << result.mediaDurationSec << " s) in "
+        << std::setprecision(2) << result.wallTimeSec << " s - "
+        << std::setprecision(1) << result.speedup << "x real time on "
+        << result.measureThreads << " reader threads\n";
+
+    if (stats.validSamples == 0) {
+        oss << "No timestamp pattern found\n";
+        return oss.str();
+    }
+
+    oss << "Latency (" << (result.clockAnchor == "first_frame" ? "relative to first frame" : "absolute")
+        << ", " << stats.validSamples << "/" << (stats.validSamples + stats.invalidSamples) << " frames): "
+        << "min " << stats.minMs << " / avg " << std::setprecision(1) << stats.avgMs
+        << " / p50 " << stats.p50Ms << " / p95 " << stats.p95Ms << " / p99 " << stats.p99Ms
+        << " / max " << stats.maxMs << " ms\n";
+    if (result.test.warmupDetected) {
+        oss << "Startup transient left out: first " << std::setprecision(1) << result.test.warmupSec << " s\n";
+    }
+    const auto& segments = result.test.segments;
+    for (size_t i = 1; i < segments.size(); i++) {
+        oss << "Level change at " << std::setprecision(1) << segments[i].startSec << " s: p50 "
+            << segments[i - 1].statistics.p50Ms << " -> " << segments[i].statistics.p50Ms << " ms\n";
+    }
+    return oss.str();
+}
+
+} // namespace latency
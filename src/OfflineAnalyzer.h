@@ -0,0 +1,72 @@
+#pragma once
+
+#include "ResultsManager.h"
+#include "VideoDecoder.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace latency {
+
+struct OfflineAnalysisOptions {
+    int measureThreads = 0;          // Pattern reader threads (0 = hardware threads - 1)
+    bool hasClockOffset = false;
+    int64_t clockOffsetMs = 0;       // Clock reading at the recording's first frame
+};
+
+struct OfflineFrameResult {
+    double ptsMs = 0.0;              // Capture time from container timestamps
+    uint32_t displayedTimestamp = 0; // Timestamp read from the pattern
+    int32_t latencyMs = 0;
+    bool valid = false;
+};
+
+struct OfflineAnalysisResult {
+    std::string file;
+    std::string codec;
+    int width = 0;
+    int height = 0;
+    double fps = 0.0;
+
+    uint64_t framesDecoded = 0;
+    double mediaDurationSec = 0.0;
+    double wallTimeSec = 0.0;
+    double speedup = 0.0;            // Media time / wall time
+    int measureThreads = 0;
+
+    // "clock_offset": absolute latency from a known clock reading at the first frame.
+    // "first_frame": latency relative to the first readable frame (variation only).
+    std::string clockAnchor;
+    int64_t clockOffsetMs = 0;
+
+    TestResult test;                 // Latency statistics over the whole recording
+    std::vector<OfflineFrameResult> frames;  // Presentation order
+};
+
+// Measures latency from a recording of the camera feed instead of a live
+// stream. Frames are decoded as fast as possible, the pattern in each one is
+// read on a worker pool, and each frame's capture time comes from the
+// container timestamps rather than the on-screen clock.
+class OfflineAnalyzer {
+public:
+    explicit OfflineAnalyzer(const OfflineAnalysisOptions& options = OfflineAnalysisOptions{});
+
+    bool analyze(const std::string& path, OfflineAnalysisResult& result);
+
+    // Write the result as JSON (returns false on I/O error)
+    static bool writeReport(const std::string& filename, const OfflineAnalysisResult& result);
+
+    // Human-readable summary
+    static std::string formatSummary(const OfflineAnalysisResult& result);
+
+    std::string getLastError() const { return lastError_; }
+
+private:
+    // Turn displayed timestamps into latencies once every frame has been read
+    void computeLatencies(OfflineAnalysisResult& result) const;
+
+    OfflineAnalysisOptions options_;
+    std::string lastError_;
+};
+
+} // namespace latency
@@ -0,0 +1,257 @@
+#include "PacketRecorder.h"
+#include <iostream>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+
+namespace latency {
+
+PacketRecorder::PacketRecorder() {
+    writer_ = std::thread(&PacketRecorder::writerLoop, this);
+}
+
+PacketRecorder::~PacketRecorder() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex_);
+        stopping_ = true;
+    }
+    jobCv_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+
+    stop();
+}
+
+void PacketRecorder::setLimits(double windowSec, size_t maxBytes) {
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    windowSec_ = windowSec;
+    maxBytes_ = maxBytes;
+}
+
+void PacketRecorder::start(const AVStream* stream) {
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    clearBuffer();
+
+    if (!codecpar_) {
+        codecpar_ = avcodec_parameters_alloc();
+    }
+    avcodec_parameters_copy(codecpar_, stream->codecpar);
+    timeBaseNum_ = stream->time_base.num;
+    timeBaseDen_ = stream->time_base.den;
+}
+
+void PacketRecorder::stop() {
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    clearBuffer();
+
+    if (codecpar_) {
+        avcodec_parameters_free(&codecpar_);
+        codecpar_ = nullptr;
+    }
+}
+
+void PacketRecorder::clearBuffer() {
+    for (auto& buffered : buffer_) {
+        av_packet_free(&buffered.packet);
+    }
+    buffer_.clear();
+    bufferedBytes_ = 0;
+}
+
+void PacketRecorder::push(const AVPacket* packet) {
+    AVPacket* ref = av_packet_clone(packet);
+    if (!ref) return;
+
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    if (!codecpar_) {
+        av_packet_free(&ref);
+        return;
+    }
+
+    buffer_.push_back({ref, now});
+    bufferedBytes_ += ref->size;
+
+    // Evict by age, then by size - the newest packet always stays
+    auto oldest = now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(windowSec_));
+    while (buffer_.size() > 1 &&
+           (buffer_.front().receivedAt < oldest || bufferedBytes_ > maxBytes_)) {
+        bufferedBytes_ -= buffer_.front().packet->size;
+        av_packet_free(&buffer_.front().packet);
+        buffer_.pop_front();
+    }
+}
+
+bool PacketRecorder::dump(const std::string& filename) {
+    WriteJob job;
+    job.filename = filename;
+
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex_);
+        if (!codecpar_) return false;
+
+        // Packets before the first keyframe can't be decoded from the clip
+        bool gotKeyframe = false;
+        for (const auto& buffered : buffer_) {
+            if (!gotKeyframe && !(buffered.packet->flags & AV_PKT_FLAG_KEY)) continue;
+            gotKeyframe = true;
+            job.packets.push_back(av_packet_clone(buffered.packet));
+        }
+        if (job.packets.empty()) return false;
+
+        job.codecpar = avcodec_parameters_alloc();
+        avcodec_parameters_copy(job.codecpar, codecpar_);
+        job.timeBaseNum = timeBaseNum_;
+        job.timeBaseDen = timeBaseDen_;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex_);
+        jobs_.push_back(std::move(job));
+    }
+    jobCv_.notify_one();
+    return true;
+}
+
+std::string PacketRecorder::preferredExtension() const {
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    if (codecpar_ && (codecpar_->codec_id == AV_CODEC_ID_H264 || codecpar_->codec_id == AV_CODEC_ID_HEVC)) {
+        return ".ts";
+    }
+    return ".mkv";
+}
+
+PacketRecorderStats PacketRecorder::getStats() const {
+    PacketRecorderStats stats;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex_);
+        stats.bufferedPackets = buffer_.size();
+        stats.bufferedBytes = bufferedBytes_;
+        stats.maxBytes = maxBytes_;
+        stats.windowSec = windowSec_;
+        if (buffer_.size() > 1) {
+            stats.bufferedSec = std::chrono::duration<double>(
+                buffer_.back().receivedAt - buffer_.front().receivedAt).count();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobMutex_);
+        stats.clipsWritten = clipsWritten_;
+        stats.writesPending = static_cast<int>(jobs_.size()) + (writing_ ? 1 : 0);
+        stats.lastClip = lastClip_;
+        stats.lastError = lastError_;
+    }
+    return stats;
+}
+
+void PacketRecorder::writerLoop() {
+    while (true) {
+        WriteJob job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex_);
+            jobCv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+
+            // Finish queued clips before exiting
+            if (jobs_.empty()) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            writing_ = true;
+        }
+
+        std::string error;
+        bool ok = writeClip(job, error);
+
+        for (auto* packet : job.packets) {
+            av_packet_free(&packet);
+        }
+        avcodec_parameters_free(&job.codecpar);
+
+        std::lock_guard<std::mutex> lock(jobMutex_);
+        writing_ = false;
+        if (ok) {
+            clipsWritten_++;
+            lastClip_ = job.filename;
+            std::cout << "Packet buffer written: " << job.filename
+                      << " (" << job.packets.size() << " packets)" << std::endl;
+        } else {
+            lastError_ = error;
+            std::cerr << "Packet buffer dump failed: " << error << std::endl;
+        }
+    }
+}
+
+bool PacketRecorder::writeClip(WriteJob& job, std::string& error) {
+    AVFormatContext* outCtx = nullptr;
+    int ret = avformat_alloc_output_context2(&outCtx, nullptr, nullptr, job.filename.c_str());
+    if (ret < 0 || !outCtx) {
+        error = "Unsupported output format: " + job.filename;
+        return false;
+    }
+
+    AVStream* outStream = avformat_new_stream(outCtx, nullptr);
+    if (!outStream || avcodec_parameters_copy(outStream->codecpar, job.codecpar) < 0) {
+        error = "Failed to create output stream";
+        avformat_free_context(outCtx);
+        return false;
+    }
+    outStream->codecpar->codec_tag = 0;  // Let the muxer pick its own tag
+    AVRational inTimeBase = {job.timeBaseNum, job.timeBaseDen};
+    outStream->time_base = inTimeBase;
+
+    if (!(outCtx->oformat->flags & AVFMT_NOFILE)) {
+        ret = avio_open(&outCtx->pb, job.filename.c_str(), AVIO_FLAG_WRITE);
+        if (ret < 0) {
+            char errBuf[256];
+            av_strerror(ret, errBuf, sizeof(errBuf));
+            error = "Failed to open " + job.filename + ": " + errBuf;
+            avformat_free_context(outCtx);
+            return false;
+        }
+    }
+
+    ret = avformat_write_header(outCtx, nullptr);
+    if (ret < 0) {
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        error = "Failed to write header: " + std::string(errBuf);
+    } else {
+        // Start the clip at zero; packets without any timestamp can't be muxed
+        int64_t origin = AV_NOPTS_VALUE;
+        for (auto* packet : job.packets) {
+            if (packet->dts == AV_NOPTS_VALUE) packet->dts = packet->pts;
+            if (packet->dts == AV_NOPTS_VALUE) continue;
+            if (origin == AV_NOPTS_VALUE) origin = packet->dts;
+
+            packet->dts -= origin;
+            if (packet->pts != AV_NOPTS_VALUE) packet->pts -= origin;
+            packet->stream_index = 0;
+            packet->pos = -1;
+            av_packet_rescale_ts(packet, inTimeBase, outStream->time_base);
+
+            // av_interleaved_write_frame takes the packet's reference
+            ret = av_interleaved_write_frame(outCtx, packet);
+            if (ret < 0) {
+                char errBuf[256];
+                av_strerror(ret, errBuf, sizeof(errBuf));
+                error = "Failed to write packet: " + std::string(errBuf);
+                break;
+            }
+        }
+        av_write_trailer(outCtx);
+    }
+
+    if (!(outCtx->oformat->flags & AVFMT_NOFILE)) {
+        avio_closep(&outCtx->pb);
+    }
+    avformat_free_context(outCtx);
+    return error.empty();
+}
+
+} // namespace latency
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Forward declarations for FFmpeg types
+struct AVPacket;
+struct AVStream;
+struct AVCodecParameters;
+
+namespace latency {
+
+struct PacketRecorderStats {
+    size_t bufferedPackets = 0;
+    size_t bufferedBytes = 0;
+    size_t maxBytes = 0;
+    double bufferedSec = 0.0;     // Receive time covered by the buffer
+    double windowSec = 0.0;
+    int clipsWritten = 0;
+    int writesPending = 0;
+    std::string lastClip;
+    std::string lastError;
+};
+
+// Keeps the last few seconds of compressed video packets from the demux
+// thread and remuxes them to a file on demand. Buffering costs a packet
+// reference each; no decoding is involved. Files are written on a
+// dedicated thread so a dump never stalls demuxing.
+class PacketRecorder {
+public:
+    PacketRecorder();
+    ~PacketRecorder();  // Finishes clips already queued for writing
+
+    PacketRecorder(const PacketRecorder&) = delete;
+    PacketRecorder& operator=(const PacketRecorder&) = delete;
+
+    // Buffer at most windowSec of packets and maxBytes of payload, whichever is smaller
+    void setLimits(double windowSec, size_t maxBytes);
+
+    // Begin buffering packets of this stream (called on connect), or drop the buffer
+    void start(const AVStream* stream);
+    void stop();
+
+    // Add a packet read by the demuxer (the recorder takes its own reference)
+    void push(const AVPacket* packet);
+
+    // Queue the buffered packets, from the first keyframe on, to be written to
+    // filename. The container follows the extension. Returns false if no
+    // keyframe is buffered.
+    bool dump(const std::string& filename);
+
+    // ".ts" where MPEG-TS can carry the codec (H.264/H.265), ".mkv" otherwise
+    std::string preferredExtension() const;
+
+    PacketRecorderStats getStats() const;
+
+private:
+    struct BufferedPacket {
+        AVPacket* packet = nullptr;
+        std::chrono::steady_clock::time_point receivedAt;
+    };
+
+    struct WriteJob {
+        std::string filename;
+        AVCodecParameters* codecpar = nullptr;
+        int timeBaseNum = 0;
+        int timeBaseDen = 1;
+        std::vector<AVPacket*> packets;
+    };
+
+    void clearBuffer();
+    void writerLoop();
+    bool writeClip(WriteJob& job, std::string& error);
+
+    // Ring buffer (demux thread writes, UI thread dumps)
+    mutable std::mutex bufferMutex_;
+    std::deque<BufferedPacket> buffer_;
+    size_t bufferedBytes_ = 0;
+    double windowSec_ = 10.0;
+    size_t maxBytes_ = 64 * 1024 * 1024;
+    AVCodecParameters* codecpar_ = nullptr;
+    int timeBaseNum_ = 0;
+    int timeBaseDen_ = 1;
+
+    // Writer thread
+    std::thread writer_;
+    std::deque<WriteJob> jobs_;
+    mutable std::mutex jobMutex_;
+    std::condition_variable jobCv_;
+    bool stopping_ = false;
+    bool writing_ = false;
+    int clipsWritten_ = 0;
+    std::string lastClip_;
+    std::string lastError_;
+};
+
+} // namespace latency
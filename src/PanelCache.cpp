@@ -0,0 +1,92 @@
+#include "PanelCache.h"
+
+namespace latency {
+
+namespace {
+
+// Target contents are premultiplied by alpha (drawn with normal blending onto transparent)
+SDL_BlendMode premultipliedBlendMode() {
+    return SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                                      SDL_BLENDOPERATION_ADD,
+                                      SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                                      SDL_BLENDOPERATION_ADD);
+}
+
+} // namespace
+
+PanelCache::PanelCache(SDL_Renderer* renderer)
+    : renderer_(renderer)
+    , supported_(SDL_RenderTargetSupported(renderer) == SDL_TRUE) {
+}
+
+PanelCache::~PanelCache() {
+    if (texture_) {
+        SDL_DestroyTexture(texture_);
+    }
+}
+
+bool PanelCache::ensureTexture(int width, int height) {
+    if (texture_ && width == width_ && height == height_) return true;
+
+    if (texture_) {
+        SDL_DestroyTexture(texture_);
+        texture_ = nullptr;
+    }
+    texture_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!texture_ || SDL_SetTextureBlendMode(texture_, premultipliedBlendMode()) != 0) {
+        // Draw directly from now on
+        if (texture_) {
+            SDL_DestroyTexture(texture_);
+            texture_ = nullptr;
+        }
+        supported_ = false;
+        return false;
+    }
+    width_ = width;
+    height_ = height;
+    valid_ = false;
+    return true;
+}
+
+void PanelCache::render(int width, int height, uint64_t key, uint32_t maxAgeMs,
+                        const std::function<void()>& draw) {
+    if (!supported_ || width <= 0 || height <= 0 || !ensureTexture(width, height)) {
+        draw();
+        return;
+    }
+
+    uint32_t now = SDL_GetTicks();
+    bool stale = !valid_ || key != key_ || (maxAgeMs > 0 && now - drawnTicks_ >= maxAgeMs);
+    if (stale) {
+        SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer_);
+        SDL_BlendMode previousBlend;
+        SDL_GetRenderDrawBlendMode(renderer_, &previousBlend);
+
+        SDL_SetRenderTarget(renderer_, texture_);
+        SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 0);
+        SDL_RenderClear(renderer_);
+        SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
+        draw();
+
+        SDL_SetRenderTarget(renderer_, previousTarget);
+        SDL_SetRenderDrawBlendMode(renderer_, previousBlend);
+
+        valid_ = true;
+        key_ = key;
+        drawnTicks_ = now;
+        redraws_++;
+    }
+
+    SDL_RenderCopy(renderer_, texture_, nullptr, nullptr);
+}
+
+uint64_t PanelCache::combine(uint64_t key, uint64_t value) {
+    return key ^ (value + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2));
+}
+
+uint64_t PanelCache::combine(uint64_t key, const std::string& value) {
+    return combine(key, static_cast<uint64_t>(std::hash<std::string>{}(value)));
+}
+
+} // namespace latency
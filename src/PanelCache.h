@@ -0,0 +1,52 @@
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace latency {
+
+// One UI overlay drawn into its own window-sized target texture and
+// composited with a single SDL_RenderCopy per frame. The panel is redrawn
+// only when its key (a hash of whatever it shows) changes, or once it is
+// older than maxAgeMs for panels showing live values. The target keeps
+// premultiplied colour, so it is composited with a matching blend mode.
+// Renderers without target textures or custom blend modes draw the panel
+// directly every frame instead. Must be destroyed before its renderer.
+class PanelCache {
+public:
+    explicit PanelCache(SDL_Renderer* renderer);
+    ~PanelCache();
+
+    PanelCache(const PanelCache&) = delete;
+    PanelCache& operator=(const PanelCache&) = delete;
+
+    // Composite the panel, calling draw (in window coordinates) first if it is stale.
+    // maxAgeMs = 0: redraw on key changes only.
+    void render(int width, int height, uint64_t key, uint32_t maxAgeMs, const std::function<void()>& draw);
+
+    // Redraw on the next render (e.g. after the device lost its targets)
+    void invalidate() { valid_ = false; }
+
+    uint64_t getRedrawCount() const { return redraws_; }
+
+    // Fold a value into a panel key
+    static uint64_t combine(uint64_t key, uint64_t value);
+    static uint64_t combine(uint64_t key, const std::string& value);
+
+private:
+    bool ensureTexture(int width, int height);
+
+    SDL_Renderer* renderer_ = nullptr;
+    SDL_Texture* texture_ = nullptr;
+    int width_ = 0;
+    int height_ = 0;
+    bool supported_ = true;
+    bool valid_ = false;
+    uint64_t key_ = 0;
+    uint32_t drawnTicks_ = 0;
+    uint64_t redraws_ = 0;
+};
+
+} // namespace latency
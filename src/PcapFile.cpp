@@ -0,0 +1,276 @@
+#include "PcapFile.h"
+#include <cstring>
+#include <sstream>
+
+namespace latency {
+
+namespace {
+
+constexpr uint32_t PCAP_MAGIC_US = 0xa1b2c3d4;
+constexpr uint32_t PCAP_MAGIC_NS = 0xa1b23c4d;
+constexpr uint32_t PCAP_SNAPLEN = 262144;
+constexpr size_t MAX_RECORD = 262144;
+
+// Link types
+constexpr uint32_t LINKTYPE_NULL = 0;
+constexpr uint32_t LINKTYPE_ETHERNET = 1;
+constexpr uint32_t LINKTYPE_RAW = 101;
+constexpr uint32_t LINKTYPE_LINUX_SLL = 113;
+constexpr uint32_t LINKTYPE_LINUX_SLL2 = 276;
+
+constexpr size_t IPV4_HEADER = 20;
+constexpr size_t UDP_HEADER = 8;
+constexpr size_t MAX_UDP_PAYLOAD = 65535 - IPV4_HEADER - UDP_HEADER;
+
+uint32_t swap32(uint32_t v) {
+    return (v >> 24) | ((v >> 8) & 0xff00) | ((v << 8) & 0xff0000) | (v << 24);
+}
+
+uint16_t be16(const uint8_t* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+uint32_t be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+void putBe16(uint8_t* p, uint16_t v) { p[0] = v >> 8; p[1] = v & 0xff; }
+void putBe32(uint8_t* p, uint32_t v) { p[0] = v >> 24; p[1] = (v >> 16) & 0xff; p[2] = (v >> 8) & 0xff; p[3] = v & 0xff; }
+
+// pcap headers are written in host byte order; readers detect it from the magic
+template <typename T>
+void writeNative(FILE* file, T value) {
+    fwrite(&value, sizeof(value), 1, file);
+}
+
+} // namespace
+
+PcapWriter::~PcapWriter() {
+    close();
+}
+
+bool PcapWriter::open(const std::string& filename) {
+    close();
+    file_ = fopen(filename.c_str(), "wb");
+    if (!file_) return false;
+
+    writeNative<uint32_t>(file_, PCAP_MAGIC_NS);
+    writeNative<uint16_t>(file_, 2);   // Version 2.4
+    writeNative<uint16_t>(file_, 4);
+    writeNative<int32_t>(file_, 0);    // GMT offset
+    writeNative<uint32_t>(file_, 0);   // Timestamp accuracy
+    writeNative<uint32_t>(file_, PCAP_SNAPLEN);
+    writeNative<uint32_t>(file_, LINKTYPE_RAW);
+    packets_ = 0;
+    return true;
+}
+
+void PcapWriter::close() {
+    if (file_) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool PcapWriter::write(const CapturedDatagram& datagram) {
+    if (!file_ || datagram.payload.size() > MAX_UDP_PAYLOAD) return false;
+
+    size_t udpLength = UDP_HEADER + datagram.payload.size();
+    size_t totalLength = IPV4_HEADER + udpLength;
+
+    uint8_t header[IPV4_HEADER + UDP_HEADER] = {};
+    uint8_t* ip = header;
+    ip[0] = 0x45;                       // IPv4, 5-word header
+    putBe16(ip + 2, static_cast<uint16_t>(totalLength));
+    putBe16(ip + 4, ipId_++);
+    ip[8] = 64;                         // TTL
+    ip[9] = 17;                         // UDP
+    putBe32(ip + 12, datagram.srcAddr);
+    putBe32(ip + 16, datagram.dstAddr);
+
+    uint32_t sum = 0;
+    for (size_t i = 0; i < IPV4_HEADER; i += 2) sum += be16(ip + i);
+    while (sum >> 16) sum = (sum & 0xffff) + (sum >> 16);
+    putBe16(ip + 10, static_cast<uint16_t>(~sum));
+
+    uint8_t* udp = header + IPV4_HEADER;
+    putBe16(udp, datagram.srcPort);
+    putBe16(udp + 2, datagram.dstPort);
+    putBe16(udp + 4, static_cast<uint16_t>(udpLength));
+    // UDP checksum 0 = not computed (allowed for IPv4)
+
+    writeNative<uint32_t>(file_, static_cast<uint32_t>(datagram.timestampNs / 1000000000));
+    writeNative<uint32_t>(file_, static_cast<uint32_t>(datagram.timestampNs % 1000000000));
+    writeNative<uint32_t>(file_, static_cast<uint32_t>(totalLength));
+    writeNative<uint32_t>(file_, static_cast<uint32_t>(totalLength));
+    fwrite(header, sizeof(header), 1, file_);
+    fwrite(datagram.payload.data(), 1, datagram.payload.size(), file_);
+    packets_++;
+    return !ferror(file_);
+}
+
+PcapReader::~PcapReader() {
+    close();
+}
+
+bool PcapReader::open(const std::string& filename) {
+    close();
+    lastError_.clear();
+
+    file_ = fopen(filename.c_str(), "rb");
+    if (!file_) {
+        lastError_ = "Cannot open " + filename;
+        return false;
+    }
+
+    uint8_t header[24];
+    if (fread(header, sizeof(header), 1, file_) != 1) {
+        lastError_ = "Not a pcap file: " + filename;
+        close();
+        return false;
+    }
+
+    uint32_t magic;
+    std::memcpy(&magic, header, 4);
+    if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS) {
+        swapped_ = false;
+    } else if (swap32(magic) == PCAP_MAGIC_US || swap32(magic) == PCAP_MAGIC_NS) {
+        swapped_ = true;
+        magic = swap32(magic);
+    } else {
+        lastError_ = "Not a pcap file (pcapng is not supported): " + filename;
+        close();
+        return false;
+    }
+    nanoseconds_ = magic == PCAP_MAGIC_NS;
+    linkType_ = read32(header + 20) & 0x0fffffff;
+
+    if (linkType_ != LINKTYPE_NULL && linkType_ != LINKTYPE_ETHERNET && linkType_ != LINKTYPE_RAW &&
+        linkType_ != LINKTYPE_LINUX_SLL && linkType_ != LINKTYPE_LINUX_SLL2) {
+        lastError_ = "Unsupported pcap link type " + std::to_string(linkType_);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void PcapReader::close() {
+    if (file_) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+uint32_t PcapReader::read32(const uint8_t* p) const {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return swapped_ ? swap32(v) : v;
+}
+
+bool PcapReader::next(CapturedDatagram& datagram) {
+    if (!file_) return false;
+
+    std::vector<uint8_t> data;
+    while (true) {
+        uint8_t record[16];
+        if (fread(record, sizeof(record), 1, file_) != 1) {
+            return false;
+        }
+
+        uint32_t seconds = read32(record);
+        uint32_t fraction = read32(record + 4);
+        uint32_t capturedLength = read32(record + 8);
+        if (capturedLength > MAX_RECORD) {
+            lastError_ = "Corrupt pcap record";
+            return false;
+        }
+
+        data.resize(capturedLength);
+        if (capturedLength > 0 && fread(data.data(), capturedLength, 1, file_) != 1) {
+            return false;
+        }
+
+        if (parseRecord(data, datagram)) {
+            datagram.timestampNs = static_cast<int64_t>(seconds) * 1000000000 +
+                                   (nanoseconds_ ? fraction : static_cast<int64_t>(fraction) * 1000);
+            return true;
+        }
+    }
+}
+
+bool PcapReader::parseRecord(const std::vector<uint8_t>& data, CapturedDatagram& datagram) const {
+    size_t offset = 0;
+    uint16_t etherType = 0x0800;
+
+    switch (linkType_) {
+        case LINKTYPE_NULL:
+            if (data.size() < 4) return false;
+            offset = 4;  // Address family in capture host order; IPv4 checked below
+            break;
+        case LINKTYPE_ETHERNET:
+            if (data.size() < 14) return false;
+            etherType = be16(data.data() + 12);
+            offset = 14;
+            if (etherType == 0x8100 && data.size() >= 18) {  // 802.1Q VLAN tag
+                etherType = be16(data.data() + 16);
+                offset = 18;
+            }
+            break;
+        case LINKTYPE_LINUX_SLL:
+            if (data.size() < 16) return false;
+            etherType = be16(data.data() + 14);
+            offset = 16;
+            break;
+        case LINKTYPE_LINUX_SLL2:
+            if (data.size() < 20) return false;
+            etherType = be16(data.data());
+            offset = 20;
+            break;
+        default:
+            break;
+    }
+
+    if (etherType != 0x0800 || data.size() < offset + IPV4_HEADER) return false;
+
+    const uint8_t* ip = data.data() + offset;
+    if ((ip[0] >> 4) != 4 || ip[9] != 17) return false;            // IPv4 UDP only
+    if ((be16(ip + 6) & 0x3fff) != 0) return false;                // Fragments
+
+    size_t ipHeader = static_cast<size_t>(ip[0] & 0x0f) * 4;
+    if (data.size() < offset + ipHeader + UDP_HEADER) return false;
+
+    const uint8_t* udp = ip + ipHeader;
+    size_t udpLength = be16(udp + 4);
+    size_t available = data.size() - offset - ipHeader;
+    if (udpLength < UDP_HEADER || udpLength > available) return false;  // Truncated by snaplen
+
+    datagram.srcAddr = be32(ip + 12);
+    datagram.dstAddr = be32(ip + 16);
+    datagram.srcPort = be16(udp);
+    datagram.dstPort = be16(udp + 2);
+    datagram.payload.assign(udp + UDP_HEADER, udp + udpLength);
+    return true;
+}
+
+std::string rewriteSdpPorts(const std::string& sdp, int basePort, const std::string& address) {
+    std::istringstream in(sdp);
+    std::ostringstream out;
+    std::string line;
+    int media = 0;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        if (line.compare(0, 2, "m=") == 0) {
+            // m=<media> <port> <proto> <formats>
+            size_t portStart = line.find(' ');
+            size_t portEnd = portStart == std::string::npos ? portStart : line.find(' ', portStart + 1);
+            if (portEnd != std::string::npos) {
+                line.replace(portStart + 1, portEnd - portStart - 1, std::to_string(basePort + 2 * media));
+            }
+            media++;
+        } else if (line.compare(0, 2, "c=") == 0) {
+            line = "c=IN IP4 " + address;
+        }
+        out << line << "\r\n";
+    }
+    return out.str();
+}
+
+} // namespace latency
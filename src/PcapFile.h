@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace latency {
+
+// One UDP datagram from a capture
+struct CapturedDatagram {
+    int64_t timestampNs = 0;   // Receive time, Unix epoch
+    uint32_t srcAddr = 0;      // IPv4, host byte order
+    uint32_t dstAddr = 0;
+    uint16_t srcPort = 0;
+    uint16_t dstPort = 0;
+    std::vector<uint8_t> payload;
+};
+
+// Writes UDP datagrams to a nanosecond pcap file (LINKTYPE_RAW, synthesized
+// IPv4/UDP headers), readable by Wireshark and tcpdump.
+class PcapWriter {
+public:
+    PcapWriter() = default;
+    ~PcapWriter();
+
+    PcapWriter(const PcapWriter&) = delete;
+    PcapWriter& operator=(const PcapWriter&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const { return file_ != nullptr; }
+
+    bool write(const CapturedDatagram& datagram);
+
+    uint64_t getPacketCount() const { return packets_; }
+
+private:
+    FILE* file_ = nullptr;
+    uint64_t packets_ = 0;
+    uint16_t ipId_ = 0;
+};
+
+// Reads the UDP/IPv4 datagrams of a pcap file (micro- or nanosecond, either
+// byte order; raw IP, Ethernet, Linux cooked or BSD loopback link types).
+// Everything else in the file is skipped.
+class PcapReader {
+public:
+    PcapReader() = default;
+    ~PcapReader();
+
+    PcapReader(const PcapReader&) = delete;
+    PcapReader& operator=(const PcapReader&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+
+    // Next UDP datagram; false at end of file
+    bool next(CapturedDatagram& datagram);
+
+    std::string getLastError() const { return lastError_; }
+
+private:
+    uint32_t read32(const uint8_t* p) const;
+    bool parseRecord(const std::vector<uint8_t>& data, CapturedDatagram& datagram) const;
+
+    FILE* file_ = nullptr;
+    bool swapped_ = false;
+    bool nanoseconds_ = false;
+    uint32_t linkType_ = 0;
+    std::string lastError_;
+};
+
+// Point an SDP's media sections at consecutive port pairs on one address
+// (the k-th m= line gets basePort + 2k), the layout captures are replayed with
+std::string rewriteSdpPorts(const std::string& sdp, int basePort, const std::string& address);
+
+} // namespace latency
@@ -0,0 +1,247 @@
+#include "ReplayBenchmark.h"
+#include "LatencyMeasurer.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace latency {
+
+namespace {
+
+// Let the receiver open its sockets before the first packet goes out
+constexpr int RECEIVER_SETUP_MS = 500;
+
+// After the last packet, time for queued frames to come out of the decoder
+constexpr int DRAIN_MS = 1000;
+
+} // namespace
+
+bool ReplayBenchmark::run(const ReplayBenchmarkConfig& config, ReplayBenchmarkResult& result) {
+    lastError_.clear();
+    result = ReplayBenchmarkResult{};
+    result.pcapPath = config.pcapPath;
+    result.speed = config.speed;
+
+    RtpReplayer replayer;
+    if (!replayer.load(config.pcapPath)) {
+        lastError_ = replayer.getLastError();
+        return false;
+    }
+    result.packets = replayer.getPacketCount();
+    result.captureSec = replayer.getDurationSec();
+
+    // Point the session description at the replay ports
+    std::string sdpPath = config.sdpPath.empty() ? config.pcapPath + ".sdp" : config.sdpPath;
+    std::ifstream sdpIn(sdpPath);
+    if (!sdpIn.is_open()) {
+        lastError_ = "Cannot read " + sdpPath + " (pass --sdp with the stream's session description)";
+        return false;
+    }
+    std::stringstream sdp;
+    sdp << sdpIn.rdbuf();
+
+    std::string replaySdpPath = config.pcapPath + ".replay.sdp";
+    std::ofstream sdpOut(replaySdpPath);
+    if (!sdpOut.is_open()) {
+        lastError_ = "Cannot write " + replaySdpPath;
+        return false;
+    }
+    sdpOut << rewriteSdpPorts(sdp.str(), config.port, "127.0.0.1");
+    sdpOut.close();
+
+    StreamConfig streamConfig;
+    streamConfig.url = replaySdpPath;
+    streamConfig.protocol = StreamProtocol::RTP;
+    streamConfig.decoderThreading = config.decoderThreading;
+    streamConfig.decoderThreadCount = config.decoderThreadCount;
+    streamConfig.udpReceive = config.udpReceive;
+
+    VideoDecoder decoder;
+    LatencyMeasurer measurer;
+    ResultsManager results;
+    results.startTest(config.pcapPath, "", 0, 0);
+
+    // Capture-time clock: replay time scaled back by speed, anchored so the
+    // first readable frame has zero latency
+    std::mutex resultsMutex;
+    std::chrono::steady_clock::time_point replayStart;
+    bool anchored = false;
+    int64_t anchorMs = 0;
+    decoder.setFrameCallback([&](const VideoFrame& frame) {
+        if (config.speed <= 0.0) return;
+        auto timestamp = measurer.readTimestamp(&frame);
+
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        LatencyMeasurement measurement;
+        if (timestamp) {
+            int64_t elapsedMs = static_cast<int64_t>(config.speed * std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - replayStart).count());
+            if (!anchored) {
+                anchorMs = static_cast<int64_t>(*timestamp) - elapsedMs;
+                anchored = true;
+            }
+            measurement.displayedTimestamp = *timestamp;
+            measurement.actualTimestamp = static_cast<uint32_t>(elapsedMs + anchorMs);
+            measurement.latencyMs = static_cast<int32_t>(elapsedMs + anchorMs - *timestamp);
+            measurement.valid = true;
+        }
+        results.addMeasurement(measurement);
+    });
+
+    // The receiver blocks in connect until packets arrive, so replay alongside it
+    bool connected = false;
+    std::thread receiver([&] { connected = decoder.connect(streamConfig); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(RECEIVER_SETUP_MS));
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        replayStart = std::chrono::steady_clock::now();
+    }
+    if (!replayer.start("127.0.0.1", config.port, config.speed)) {
+        lastError_ = replayer.getLastError();
+        receiver.join();
+        decoder.disconnect();
+        return false;
+    }
+    receiver.join();
+
+    if (!connected) {
+        lastError_ = "Receiver failed to open the replay: " + decoder.getLastError();
+        replayer.stop();
+        return false;
+    }
+
+    // Drain the display queue ourselves; nothing renders in this mode
+    while (replayer.isRunning() && decoder.isConnected()) {
+        while (decoder.getFrame()) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    auto drainEnd = std::chrono::steady_clock::now() + std::chrono::milliseconds(DRAIN_MS);
+    while (std::chrono::steady_clock::now() < drainEnd && decoder.isConnected()) {
+        while (decoder.getFrame()) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    auto stats = decoder.getDecodeStats();
+    decoder.disconnect();
+    result.replay = replayer.getStats();
+    replayer.stop();
+
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        result.relativeLatency = results.endTest().statistics;
+    }
+    result.decoder = stats.decoderName;
+    result.decoderThreading = stats.threading;
+    result.framesDecoded = stats.framesDecoded;
+    result.framesDropped = stats.framesDropped;
+    result.decodeErrors = stats.decodeErrors;
+    result.corruptFrames = stats.corruptFrames;
+    result.hasRtpStats = stats.hasRtpStats;
+    result.rtp = stats.rtp;
+    result.stages = stats.stageLatency;
+    return true;
+}
+
+bool ReplayBenchmark::writeReport(const std::string& filename, const ReplayBenchmarkResult& result) {
+    auto percentiles = [](const LatencyPercentiles& p) {
+        return nlohmann::json{
+            {"count", p.count},
+            {"p50_us", p.p50Us},
+            {"p90_us", p.p90Us},
+            {"p99_us", p.p99Us},
+            {"max_us", p.maxUs}
+        };
+    };
+
+    nlohmann::json j;
+    j["capture"] = result.pcapPath;
+    j["packets"] = result.packets;
+    j["capture_sec"] = result.captureSec;
+    j["speed"] = result.speed;
+    j["replay"] = {
+        {"packets_sent", result.replay.packetsSent},
+        {"bytes_sent", result.replay.bytesSent},
+        {"send_errors", result.replay.sendErrors},
+        {"send_late", percentiles(result.replay.sendLateUs)}
+    };
+    j["decoder"] = result.decoder;
+    j["decoder_threading"] = result.decoderThreading;
+    j["frames_decoded"] = result.framesDecoded;
+    j["frames_dropped"] = result.framesDropped;
+    j["decode_errors"] = result.decodeErrors;
+    j["corrupt_frames"] = result.corruptFrames;
+    if (result.hasRtpStats) {
+        j["rtp"] = {
+            {"packets", result.rtp.packets},
+            {"lost", result.rtp.lost},
+            {"reordered", result.rtp.reordered},
+            {"duplicates", result.rtp.duplicates},
+            {"jitter_ms", result.rtp.jitterMs}
+        };
+    }
+
+    nlohmann::json stages;
+    for (size_t i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+        stages[pipelineStageKey(static_cast<PipelineStage>(i))] = percentiles(result.stages[i]);
+    }
+    j["receiver_stages"] = stages;
+
+    const auto& latency = result.relativeLatency;
+    j["relative_latency"] = {
+        {"min_ms", latency.minMs},
+        {"max_ms", latency.maxMs},
+        {"avg_ms", latency.avgMs},
+        {"std_dev_ms", latency.stdDevMs},
+        {"p50_ms", latency.p50Ms},
+        {"p95_ms", latency.p95Ms},
+        {"p99_ms", latency.p99Ms},
+        {"valid_samples", latency.validSamples},
+        {"invalid_samples", latency.invalidSamples}
+    };
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << j.dump(2);
+    return true;
+}
+
+std::string ReplayBenchmark::formatSummary(const ReplayBenchmarkResult& result) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    oss << "Replay: " << result.pcapPath << " (" << result.packets << " packets, "
+        << result.captureSec << " s at " << result.speed << "x)\n";
+    oss << "Sent " << result.replay.packetsSent << " packets, " << result.replay.sendErrors
+        << " errors, send lateness p99 " << result.replay.sendLateUs.p99Us << " us\n";
+    oss << "Decoder " << result.decoder << " (" << result.decoderThreading << "): "
+        << result.framesDecoded << " decoded, " << result.framesDropped << " dropped, "
+        << result.decodeErrors << " decode errors, " << result.corruptFrames << " corrupt\n";
+    if (result.hasRtpStats) {
+        oss << "RTP: " << result.rtp.packets << " packets, " << result.rtp.lost << " lost, "
+            << result.rtp.reordered << " reordered, " << result.rtp.duplicates << " duplicates, jitter "
+            << result.rtp.jitterMs << " ms\n";
+    }
+    for (size_t i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+        const auto& p = result.stages[i];
+        if (p.count == 0) continue;
+        oss << "  " << std::left << std::setw(12) << pipelineStageName(static_cast<PipelineStage>(i))
+            << std::right << " p50 " << std::setw(8) << p.p50Us / 1000.0
+            << " ms  p99 " << std::setw(8) << p.p99Us / 1000.0 << " ms\n";
+    }
+    const auto& latency = result.relativeLatency;
+    oss << "Latency relative to first frame: p50 " << latency.p50Ms << " / p95 " << latency.p95Ms
+        << " / p99 " << latency.p99Ms << " / max " << latency.maxMs << " ms ("
+        << latency.validSamples << " of " << latency.validSamples + latency.invalidSamples
+        << " frames readable)\n";
+    return oss.str();
+}
+
+} // namespace latency
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Config.h"
+#include "ResultsManager.h"
+#include "RtpReplayer.h"
+#include "VideoDecoder.h"
+#include <string>
+
+namespace latency {
+
+struct ReplayBenchmarkConfig {
+    std::string pcapPath;
+    std::string sdpPath;            // Empty = <pcap>.sdp, as saved by the capture
+    int port = 5004;                // Local port pair the capture is replayed to
+    double speed = 1.0;             // 0 = as fast as possible
+    DecoderThreading decoderThreading = DecoderThreading::AUTO;
+    int decoderThreadCount = 2;
+    UdpReceiveConfig udpReceive;
+};
+
+struct ReplayBenchmarkResult {
+    std::string pcapPath;
+    size_t packets = 0;
+    double captureSec = 0.0;
+    double speed = 1.0;
+    ReplayStats replay;
+
+    std::string decoder;
+    std::string decoderThreading;
+    uint64_t framesDecoded = 0;
+    uint64_t framesDropped = 0;
+    uint64_t decodeErrors = 0;
+    uint64_t corruptFrames = 0;
+    bool hasRtpStats = false;        // Batched UDP input only
+    RtpStreamStats rtp;
+    std::array<LatencyPercentiles, PIPELINE_STAGE_COUNT> stages;
+
+    // Capture time -> pattern read, relative to the first readable frame.
+    // The network input is fixed, so this is the receiver's own variation.
+    LatencyStatistics relativeLatency;
+};
+
+// Replays a capture into VideoDecoder and reports how the receiving
+// pipeline handled it. Identical input every run makes decoder and
+// measurer changes directly comparable.
+class ReplayBenchmark {
+public:
+    bool run(const ReplayBenchmarkConfig& config, ReplayBenchmarkResult& result);
+
+    // Write the result as JSON (returns false on I/O error)
+    static bool writeReport(const std::string& filename, const ReplayBenchmarkResult& result);
+
+    // Human-readable summary
+    static std::string formatSummary(const ReplayBenchmarkResult& result);
+
+    std::string getLastError() const { return lastError_; }
+
+private:
+    std::string lastError_;
+};
+
+} // namespace latency
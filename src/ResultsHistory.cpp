@@ -0,0 +1,469 @@
+#include "ResultsHistory.h"
+#include "WorkerPool.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+
+namespace latency {
+
+namespace {
+
+constexpr std::array<double, 3> COMPARED_QUANTILES = {0.50, 0.95, 0.99};
+constexpr uint64_t BOOTSTRAP_SEED = 0x9E3779B97F4A7C15ULL;
+
+// A run's samples laid out for drawing resamples: each sample is the index
+// of its distinct value, so a draw is one random index
+struct SampleTable {
+    std::vector<int32_t> values;     // Distinct latencies, ascending
+    std::vector<uint32_t> samples;   // Value index of every sample
+    uint64_t count = 0;
+
+    explicit SampleTable(const HistoryRun& run) {
+        for (const auto& [value, samples] : run.latencyCounts) {
+            this->samples.insert(this->samples.end(), samples, static_cast<uint32_t>(values.size()));
+            values.push_back(value);
+        }
+        count = samples.size();
+    }
+
+    // Percentiles of one resample of the same size, drawn with replacement
+    void resample(std::mt19937_64& rng, std::vector<uint32_t>& counts,
+                  std::array<int32_t, COMPARED_QUANTILES.size()>& out) const {
+        std::fill(counts.begin(), counts.end(), 0);
+        for (uint64_t i = 0; i < count; i++) {
+            // Multiply-shift maps a 32-bit draw onto [0, count) without a division
+            uint64_t r = ((rng() & 0xFFFFFFFFULL) * count) >> 32;
+            counts[samples[r]]++;
+        }
+
+        size_t q = 0;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < values.size() && q < out.size(); i++) {
+            seen += counts[i];
+            while (q < out.size() && seen > static_cast<uint64_t>(COMPARED_QUANTILES[q] * (count - 1))) {
+                out[q++] = values[i];
+            }
+        }
+    }
+};
+
+std::string formatTime(int64_t unixSeconds) {
+    std::time_t time = static_cast<std::time_t>(unixSeconds);
+    std::tm tm = *std::localtime(&time);
+    std::ostringstream oss;
+    oss << std::put_time(&tm, "%Y-%m-%d %H:%M");
+    return oss.str();
+}
+
+} // namespace
+
+uint64_t HistoryRun::getSampleCount() const {
+    uint64_t count = 0;
+    for (const auto& entry : latencyCounts) {
+        count += entry.second;
+    }
+    return count;
+}
+
+int32_t HistoryRun::getPercentileMs(double quantile) const {
+    uint64_t count = getSampleCount();
+    if (count == 0) return 0;
+
+    uint64_t target = static_cast<uint64_t>(quantile * (count - 1));
+    uint64_t seen = 0;
+    for (const auto& [value, samples] : latencyCounts) {
+        seen += samples;
+        if (seen > target) return value;
+    }
+    return latencyCounts.back().first;
+}
+
+bool ResultsHistory::load(const std::string& path) {
+    path_ = path;
+    runs_.clear();
+    byStream_.clear();
+    byId_.clear();
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return true;  // Nothing stored yet
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (line.empty()) continue;
+
+        auto j = nlohmann::json::parse(line, nullptr, false);
+        bool ok = j.is_object() && j["test_id"].is_string() && j["time"].is_number_integer() &&
+                  j["stream_url"].is_string() && j["codec"].is_string() &&
+                  j["width"].is_number_integer() && j["height"].is_number_integer() &&
+                  j["latency_ms"].is_array();
+
+        HistoryRun run;
+        if (ok) {
+            run.testId = j["test_id"].get<std::string>();
+            run.testTime = j["time"].get<int64_t>();
+            run.streamUrl = j["stream_url"].get<std::string>();
+            run.codec = j["codec"].get<std::string>();
+            run.width = j["width"].get<int>();
+            run.height = j["height"].get<int>();
+            for (const auto& entry : j["latency_ms"]) {
+                if (!entry.is_array() || entry.size() != 2 ||
+                    !entry[0].is_number_integer() || !entry[1].is_number_unsigned()) {
+                    ok = false;
+                    break;
+                }
+                run.latencyCounts.emplace_back(entry[0].get<int32_t>(), entry[1].get<uint32_t>());
+            }
+            ok = ok && std::is_sorted(run.latencyCounts.begin(), run.latencyCounts.end());
+        }
+        if (!ok) {
+            std::cerr << path << ":" << lineNumber << ": unreadable history entry skipped" << std::endl;
+            continue;
+        }
+
+        runs_.push_back(std::move(run));
+        index(runs_.size() - 1);
+    }
+    return true;
+}
+
+bool ResultsHistory::append(const HistoryRun& run) {
+    nlohmann::json counts = nlohmann::json::array();
+    for (const auto& [value, samples] : run.latencyCounts) {
+        counts.push_back({value, samples});
+    }
+    nlohmann::json j = {
+        {"test_id", run.testId},
+        {"time", run.testTime},
+        {"stream_url", run.streamUrl},
+        {"codec", run.codec},
+        {"width", run.width},
+        {"height", run.height},
+        {"latency_ms", counts}
+    };
+
+    std::ofstream file(path_, std::ios::app);
+    if (!file.is_open()) {
+        lastError_ = "Cannot open results history: " + path_;
+        return false;
+    }
+    file << j.dump() << '\n';
+    file.flush();
+    if (!file) {
+        lastError_ = "Cannot write results history: " + path_;
+        return false;
+    }
+
+    runs_.push_back(run);
+    index(runs_.size() - 1);
+    return true;
+}
+
+void ResultsHistory::index(size_t run) {
+    const auto& entry = runs_[run];
+    auto& stream = byStream_[Key(entry.streamUrl, entry.codec, entry.width, entry.height)];
+    auto position = std::upper_bound(stream.begin(), stream.end(), run, [this](size_t a, size_t b) {
+        return runs_[a].testTime < runs_[b].testTime;
+    });
+    stream.insert(position, run);
+    byId_[entry.testId] = run;
+}
+
+std::vector<const HistoryRun*> ResultsHistory::find(const HistoryQuery& query) const {
+    std::vector<const HistoryRun*> found;
+    for (const auto& [key, runs] : byStream_) {
+        const auto& [url, codec, width, height] = key;
+        if ((!query.streamUrl.empty() && url != query.streamUrl) ||
+            (!query.codec.empty() && codec != query.codec) ||
+            (query.width > 0 && width != query.width) ||
+            (query.height > 0 && height != query.height)) {
+            continue;
+        }
+        for (size_t run : runs) {
+            int64_t time = runs_[run].testTime;
+            if ((query.since > 0 && time < query.since) || (query.until > 0 && time > query.until)) {
+                continue;
+            }
+            found.push_back(&runs_[run]);
+        }
+    }
+    std::stable_sort(found.begin(), found.end(), [](const HistoryRun* a, const HistoryRun* b) {
+        return a->testTime < b->testTime;
+    });
+    return found;
+}
+
+const HistoryRun* ResultsHistory::findById(const std::string& testId) const {
+    auto it = byId_.find(testId);
+    return it != byId_.end() ? &runs_[it->second] : nullptr;
+}
+
+const HistoryRun* ResultsHistory::findPrevious(const HistoryRun& run) const {
+    auto it = byStream_.find(Key(run.streamUrl, run.codec, run.width, run.height));
+    if (it == byStream_.end()) return nullptr;
+
+    const HistoryRun* previous = nullptr;
+    for (size_t index : it->second) {
+        const auto& candidate = runs_[index];
+        if (candidate.testId == run.testId || candidate.testTime > run.testTime) break;
+        if (candidate.getSampleCount() > 0) {
+            previous = &candidate;
+        }
+    }
+    return previous;
+}
+
+HistoryRun ResultsHistory::fromResult(const TestResult& result) {
+    HistoryRun run;
+    run.testId = result.testId;
+    run.testTime = static_cast<int64_t>(std::time(nullptr));
+    run.streamUrl = result.streamUrl;
+    run.codec = result.codec;
+    run.width = result.resolutionWidth;
+    run.height = result.resolutionHeight;
+    run.latencyCounts = result.latencyCounts;
+    return run;
+}
+
+RunComparison ResultsHistory::compare(const HistoryRun& baseline, const HistoryRun& candidate,
+                                      int resamples, size_t threadCount) {
+    RunComparison comparison;
+    comparison.baselineId = baseline.testId;
+    comparison.candidateId = candidate.testId;
+    comparison.baselineSamples = baseline.getSampleCount();
+    comparison.candidateSamples = candidate.getSampleCount();
+    for (size_t q = 0; q < COMPARED_QUANTILES.size(); q++) {
+        auto& delta = comparison.deltas[q];
+        delta.quantile = COMPARED_QUANTILES[q];
+        delta.baselineMs = baseline.getPercentileMs(delta.quantile);
+        delta.candidateMs = candidate.getPercentileMs(delta.quantile);
+        delta.deltaMs = delta.candidateMs - delta.baselineMs;
+        delta.lowMs = delta.deltaMs;
+        delta.highMs = delta.deltaMs;
+    }
+    if (comparison.baselineSamples == 0 || comparison.candidateSamples == 0) {
+        return comparison;
+    }
+
+    // Mann-Whitney U: rank sum of the candidate over both runs merged, ties
+    // sharing their average rank
+    const double n1 = static_cast<double>(comparison.baselineSamples);
+    const double n2 = static_cast<double>(comparison.candidateSamples);
+    const double total = n1 + n2;
+    double rankSum = 0.0;
+    double tieTerm = 0.0;
+    double ranked = 0.0;
+    size_t b = 0;
+    size_t c = 0;
+    const auto& base = baseline.latencyCounts;
+    const auto& cand = candidate.latencyCounts;
+    while (b < base.size() || c < cand.size()) {
+        int32_t value = c == cand.size() || (b < base.size() && base[b].first < cand[c].first)
+                        ? base[b].first : cand[c].first;
+        double inBase = b < base.size() && base[b].first == value ? base[b++].second : 0.0;
+        double inCand = c < cand.size() && cand[c].first == value ? cand[c++].second : 0.0;
+        double tied = inBase + inCand;
+        rankSum += inCand * (ranked + (tied + 1.0) / 2.0);
+        tieTerm += tied * tied * tied - tied;
+        ranked += tied;
+    }
+    double u = rankSum - n2 * (n2 + 1.0) / 2.0;
+
+    // Hodges-Lehmann shift: median over every (candidate, baseline) pair
+    std::map<int32_t, uint64_t> differences;
+    for (const auto& [candValue, candSamples] : cand) {
+        for (const auto& [baseValue, baseSamples] : base) {
+            differences[candValue - baseValue] += static_cast<uint64_t>(candSamples) * baseSamples;
+        }
+    }
+    uint64_t pairs = comparison.baselineSamples * comparison.candidateSamples;
+    uint64_t seen = 0;
+    for (const auto& [difference, count] : differences) {
+        seen += count;
+        if (seen > (pairs - 1) / 2) {
+            comparison.shiftMs = difference;
+            break;
+        }
+    }
+
+    double mean = n1 * n2 / 2.0;
+    double variance = n1 * n2 / 12.0 * ((total + 1.0) - tieTerm / (total * (total - 1.0)));
+    comparison.slowerProbability = u / (n1 * n2);
+    if (variance > 0.0) {
+        double continuity = u > mean ? -0.5 : (u < mean ? 0.5 : 0.0);
+        comparison.mannWhitneyZ = (u - mean + continuity) / std::sqrt(variance);
+        comparison.pValue = std::erfc(std::abs(comparison.mannWhitneyZ) / std::sqrt(2.0));
+    }
+
+    // Bootstrap: resample both runs, spread across the pool. Each resample
+    // has its own seed, so the intervals don't depend on the thread count.
+    if (resamples > 0) {
+        SampleTable baseTable(baseline);
+        SampleTable candTable(candidate);
+        std::vector<std::array<double, COMPARED_QUANTILES.size()>> deltas(resamples);
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        int finished = 0;
+        {
+            WorkerPool pool(threadCount);
+            const int chunks = static_cast<int>(pool.getThreadCount()) * 4;
+            for (int chunk = 0; chunk < chunks; chunk++) {
+                pool.submit([&, chunk] {
+                    std::vector<uint32_t> baseCounts(baseTable.values.size());
+                    std::vector<uint32_t> candCounts(candTable.values.size());
+                    std::array<int32_t, COMPARED_QUANTILES.size()> basePercentiles{};
+                    std::array<int32_t, COMPARED_QUANTILES.size()> candPercentiles{};
+                    for (int i = chunk; i < resamples; i += chunks) {
+                        std::mt19937_64 rng(BOOTSTRAP_SEED + static_cast<uint64_t>(i));
+                        baseTable.resample(rng, baseCounts, basePercentiles);
+                        candTable.resample(rng, candCounts, candPercentiles);
+                        for (size_t q = 0; q < COMPARED_QUANTILES.size(); q++) {
+                            deltas[i][q] = candPercentiles[q] - basePercentiles[q];
+                        }
+                    }
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    finished++;
+                    cv.notify_all();
+                });
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return finished == chunks; });
+        }
+
+        std::vector<double> column(resamples);
+        for (size_t q = 0; q < COMPARED_QUANTILES.size(); q++) {
+            for (int i = 0; i < resamples; i++) {
+                column[i] = deltas[i][q];
+            }
+            std::sort(column.begin(), column.end());
+            comparison.deltas[q].lowMs = column[static_cast<size_t>(0.025 * (resamples - 1))];
+            comparison.deltas[q].highMs = column[static_cast<size_t>(0.975 * (resamples - 1))];
+        }
+        comparison.resamples = resamples;
+    }
+
+    if (comparison.pValue < SIGNIFICANCE) {
+        comparison.regression = comparison.mannWhitneyZ > 0 && comparison.shiftMs >= MIN_CHANGE_MS;
+        comparison.improvement = comparison.mannWhitneyZ < 0 && comparison.shiftMs <= -MIN_CHANGE_MS;
+    }
+    return comparison;
+}
+
+std::string ResultsHistory::formatRun(const HistoryRun& run) {
+    std::ostringstream oss;
+    oss << formatTime(run.testTime) << "  " << run.testId << "  " << run.streamUrl << "  "
+        << run.codec << " " << run.width << "x" << run.height << "  "
+        << run.getSampleCount() << " samples  p50 " << run.getPercentileMs(0.50)
+        << " / p95 " << run.getPercentileMs(0.95) << " / p99 " << run.getPercentileMs(0.99) << " ms";
+    return oss.str();
+}
+
+std::string ResultsHistory::formatComparison(const RunComparison& comparison) {
+    std::ostringstream oss;
+    oss << "Baseline  " << comparison.baselineId << " (" << comparison.baselineSamples << " samples)\n";
+    oss << "Candidate " << comparison.candidateId << " (" << comparison.candidateSamples << " samples)\n";
+    for (const auto& delta : comparison.deltas) {
+        oss << "  p" << std::setw(2) << std::left << static_cast<int>(std::lround(delta.quantile * 100)) << std::right
+            << std::setw(6) << delta.baselineMs << " ->" << std::setw(6) << delta.candidateMs << " ms  "
+            << std::showpos << std::fixed << std::setprecision(1) << delta.deltaMs << " ms";
+        if (comparison.resamples > 0) {
+            oss << "  [" << delta.lowMs << ", " << delta.highMs << "]";
+        }
+        oss << std::noshowpos << "\n";
+    }
+    oss << "  Shift " << std::showpos << std::setprecision(1) << comparison.shiftMs << std::noshowpos
+        << " ms, Mann-Whitney z " << std::setprecision(2) << comparison.mannWhitneyZ
+        << ", p " << std::setprecision(4) << comparison.pValue
+        << ", P(slower) " << std::setprecision(3) << comparison.slowerProbability << "\n";
+    if (comparison.regression) {
+        oss << "  REGRESSION: candidate is slower\n";
+    } else if (comparison.improvement) {
+        oss << "  Improvement: candidate is faster\n";
+    } else {
+        oss << "  No significant change\n";
+    }
+    return oss.str();
+}
+
+std::string ResultsHistory::formatSummary(const RunComparison& comparison) {
+    std::ostringstream oss;
+    oss << std::showpos << std::fixed << std::setprecision(1) << comparison.shiftMs << std::noshowpos << " ms ";
+    if (comparison.regression) {
+        oss << "slower";
+    } else if (comparison.improvement) {
+        oss << "faster";
+    } else {
+        oss << "same";
+    }
+    return oss.str();
+}
+
+bool ResultsHistory::attachComparison(const std::string& resultsFile, const RunComparison& comparison) {
+    nlohmann::json report;
+    {
+        std::ifstream file(resultsFile);
+        if (!file.is_open()) {
+            lastError_ = "Cannot open results: " + resultsFile;
+            return false;
+        }
+        report = nlohmann::json::parse(file, nullptr, false);
+    }
+    if (!report.is_object()) {
+        lastError_ = "Cannot parse results: " + resultsFile;
+        return false;
+    }
+
+    nlohmann::json deltas = nlohmann::json::array();
+    for (const auto& delta : comparison.deltas) {
+        deltas.push_back({
+            {"quantile", delta.quantile},
+            {"baseline_ms", delta.baselineMs},
+            {"candidate_ms", delta.candidateMs},
+            {"delta_ms", delta.deltaMs},
+            {"low_ms", delta.lowMs},
+            {"high_ms", delta.highMs}
+        });
+    }
+    report["history_comparison"] = {
+        {"baseline_id", comparison.baselineId},
+        {"baseline_samples", comparison.baselineSamples},
+        {"candidate_samples", comparison.candidateSamples},
+        {"resamples", comparison.resamples},
+        {"percentiles", deltas},
+        {"mann_whitney_z", comparison.mannWhitneyZ},
+        {"p_value", comparison.pValue},
+        {"slower_probability", comparison.slowerProbability},
+        {"shift_ms", comparison.shiftMs},
+        {"regression", comparison.regression},
+        {"improvement", comparison.improvement}
+    };
+
+    std::ofstream file(resultsFile);
+    if (!file.is_open()) {
+        lastError_ = "Cannot write results: " + resultsFile;
+        return false;
+    }
+    file << report.dump(2);
+    if (!file) {
+        lastError_ = "Cannot write results: " + resultsFile;
+        return false;
+    }
+    return true;
+}
+
+} // namespace latency
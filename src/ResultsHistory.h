@@ -0,0 +1,133 @@
+#pragma once
+
+#include "ResultsManager.h"
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace latency {
+
+// One run as kept in the history: what was measured, and its latency
+// samples after the warmup counted per whole millisecond (the resolution
+// they are measured at, so nothing is lost)
+struct HistoryRun {
+    std::string testId;
+    int64_t testTime = 0;            // Unix seconds when the run was stored
+    std::string streamUrl;
+    std::string codec;
+    int width = 0;
+    int height = 0;
+    std::vector<std::pair<int32_t, uint32_t>> latencyCounts;  // (latency ms, samples), ascending
+
+    uint64_t getSampleCount() const;
+
+    // Same rule as the run's exported statistics: sample at floor(q * (n - 1))
+    int32_t getPercentileMs(double quantile) const;
+};
+
+// Filters for finding runs; empty / zero fields match anything
+struct HistoryQuery {
+    std::string streamUrl;
+    std::string codec;
+    int width = 0;
+    int height = 0;
+    int64_t since = 0;               // Unix seconds, inclusive
+    int64_t until = 0;
+};
+
+// A percentile of the candidate run minus the baseline's, with its
+// bootstrap confidence interval
+struct PercentileDelta {
+    double quantile = 0.0;
+    int32_t baselineMs = 0;
+    int32_t candidateMs = 0;
+    double deltaMs = 0.0;
+    double lowMs = 0.0;              // 95% interval of the delta
+    double highMs = 0.0;
+};
+
+struct RunComparison {
+    std::string baselineId;
+    std::string candidateId;
+    uint64_t baselineSamples = 0;
+    uint64_t candidateSamples = 0;
+    std::array<PercentileDelta, 3> deltas;   // p50, p95, p99
+    int resamples = 0;
+
+    // Mann-Whitney U test of the candidate against the baseline
+    double mannWhitneyZ = 0.0;       // Positive: candidate slower
+    double pValue = 1.0;             // Two-sided, normal approximation with tie correction
+    double slowerProbability = 0.5;  // P(candidate sample > baseline sample), ties count half
+    double shiftMs = 0.0;            // Hodges-Lehmann: median candidate - baseline difference
+
+    // Significant, and shifted by at least MIN_CHANGE_MS. Decided on the whole
+    // distribution rather than a percentile's interval, which whole-ms
+    // samples make too coarse for a shift of a couple of ms.
+    bool regression = false;
+    bool improvement = false;
+};
+
+// Local append-only store of test results, one JSON line per run, so runs
+// can be compared across firmware versions and settings. Runs are indexed
+// by stream URL, codec and resolution, and by time within each.
+class ResultsHistory {
+public:
+    // Read the store; a missing file is an empty history. Lines that don't
+    // parse (e.g. cut short by a crash) are skipped with a warning.
+    bool load(const std::string& path);
+
+    // Store to append to without reading it first (load() also sets it)
+    void setPath(const std::string& path) { path_ = path; }
+
+    // Add a run to the store and the index
+    bool append(const HistoryRun& run);
+
+    std::vector<const HistoryRun*> find(const HistoryQuery& query) const;
+    const HistoryRun* findById(const std::string& testId) const;
+
+    // Latest run before this one of the same stream, codec and resolution
+    const HistoryRun* findPrevious(const HistoryRun& run) const;
+
+    size_t size() const { return runs_.size(); }
+    const std::string& getLastError() const { return lastError_; }
+
+    // History entry for a finished test
+    static HistoryRun fromResult(const TestResult& result);
+
+    // Percentile deltas with bootstrap intervals (resampling spread over
+    // threadCount workers, 0 = WorkerPool's default) and a Mann-Whitney U test
+    static RunComparison compare(const HistoryRun& baseline, const HistoryRun& candidate,
+                                 int resamples = BOOTSTRAP_RESAMPLES, size_t threadCount = 0);
+
+    static std::string formatComparison(const RunComparison& comparison);
+
+    // Verdict and shift in a few words, for the stats panel
+    static std::string formatSummary(const RunComparison& comparison);
+
+    // Add the comparison to a run's exported JSON report, as "history_comparison"
+    bool attachComparison(const std::string& resultsFile, const RunComparison& comparison);
+
+    // One line per run: time, id, stream, codec, resolution, samples, percentiles
+    static std::string formatRun(const HistoryRun& run);
+
+    static constexpr int BOOTSTRAP_RESAMPLES = 2000;
+    static constexpr double SIGNIFICANCE = 0.01;     // Mann-Whitney p-value for a change
+    static constexpr double MIN_CHANGE_MS = 1.0;     // Smaller shifts are never flagged
+
+private:
+    using Key = std::tuple<std::string, std::string, int, int>;  // URL, codec, width, height
+
+    void index(size_t run);
+
+    std::string path_;
+    std::vector<HistoryRun> runs_;
+    std::map<Key, std::vector<size_t>> byStream_;   // Run indices, oldest first
+    std::map<std::string, size_t> byId_;
+    std::string lastError_;
+};
+
+} // namespace latency
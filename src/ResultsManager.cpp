@@ -8,6 +8,24 @@
 
 namespace latency {
 
+namespace {
+
+nlohmann::json statisticsJson(const LatencyStatistics& stats) {
+    return {
+        {"min_ms", stats.minMs},
+        {"max_ms", stats.maxMs},
+        {"avg_ms", stats.avgMs},
+        {"std_dev_ms", stats.stdDevMs},
+        {"p50_ms", stats.p50Ms},
+        {"p95_ms", stats.p95Ms},
+        {"p99_ms", stats.p99Ms},
+        {"valid_samples", stats.validSamples},
+        {"invalid_samples", stats.invalidSamples}
+    };
+}
+
+} // namespace
+
 ResultsManager::ResultsManager() = default;
 
 void ResultsManager::startTest(const std::string& streamUrl, const std::string& codec,
@@ -26,17 +44,144 @@ void ResultsManager::startTest(const std::string& streamUrl, const std::string&
 void ResultsManager::addMeasurement(const LatencyMeasurement& measurement) {
     if (!testRunning_) return;
 
+    if (currentTest_.framesAnalyzed == 0) {
+        firstFrameTimestamp_ = measurement.actualTimestamp;
+    }
     currentTest_.framesAnalyzed++;
 
+    lastFrameMs_ = measurement.actualTimestamp - firstFrameTimestamp_;
+    uint32_t second = lastFrameMs_ / 1000;
+    auto& buckets = currentTest_.validRate;
+    if (buckets.empty() || buckets.back().second != second) {
+        ValidRateBucket bucket;
+        bucket.second = second;
+        buckets.push_back(bucket);
+    }
+    buckets.back().frames++;
+
     if (measurement.valid) {
+        buckets.back().valid++;
         latencySamples_.push_back(measurement.latencyMs);
+        sampleTimesMs_.push_back(lastFrameMs_);
+        sampleFrames_.push_back(currentTest_.framesAnalyzed - 1);
+        if (currentTest_.framesAnalyzed <= warmupFrames_) {
+            firstCountedSample_ = latencySamples_.size();
+        } else {
+            changePoints_.add(measurement.latencyMs);
+        }
+        switch (measurement.source) {
+        case MeasurementSource::Pattern: currentTest_.patternSamples++; break;
+        case MeasurementSource::Ocr:     currentTest_.ocrSamples++; break;
+        case MeasurementSource::Flash:   currentTest_.flashSamples++; break;
+        }
     }
 }
 
+double ResultsManager::getRecentValidRate(int seconds) const {
+    const auto& buckets = currentTest_.validRate;
+    if (buckets.empty()) return 0.0;
+
+    uint32_t last = buckets.back().second;
+    int frames = 0;
+    int valid = 0;
+    for (auto it = buckets.rbegin(); it != buckets.rend(); ++it) {
+        if (last - it->second > static_cast<uint32_t>(seconds)) break;
+        frames += it->frames;
+        valid += it->valid;
+    }
+    return frames > 0 ? static_cast<double>(valid) / frames : 0.0;
+}
+
+void ResultsManager::addLatencyBreakdown(const LatencyBreakdown& breakdown) {
+    if (!testRunning_) return;
+
+    currentTest_.latencyBudget.add(breakdown);
+}
+
+void ResultsManager::addSenderLatency(double latencyMs, SenderClockSource source) {
+    if (!testRunning_) return;
+
+    currentTest_.hasSenderLatency = true;
+    currentTest_.senderClock = source;
+    senderSamples_.push_back(static_cast<int32_t>(std::lround(latencyMs)));
+}
+
+void ResultsManager::setStageHistograms(const StageHistograms& histograms, double windowSec) {
+    currentTest_.hasStageHistograms = true;
+    currentTest_.stageHistograms = histograms;
+    currentTest_.stageWindowSec = windowSec;
+}
+
+void ResultsManager::setFrameCounters(uint64_t framesDecoded, uint64_t framesDropped,
+                                      uint64_t decodeErrors, uint64_t corruptFrames) {
+    currentTest_.hasFrameCounters = true;
+    currentTest_.framesDecoded = framesDecoded;
+    currentTest_.framesDropped = framesDropped;
+    currentTest_.decodeErrors = decodeErrors;
+    currentTest_.corruptFrames = corruptFrames;
+}
+
+void ResultsManager::setRtpStats(const RtpStreamStats& stats) {
+    currentTest_.hasRtpStats = true;
+    currentTest_.rtpStats = stats;
+}
+
+void ResultsManager::setDisplayTiming(const DisplayTimingStats& stats) {
+    currentTest_.hasDisplayTiming = true;
+    currentTest_.displayTiming = stats;
+}
+
+void ResultsManager::setPatternRows(const PatternRowStats& stats, double displaySkewMs) {
+    currentTest_.hasPatternRows = true;
+    currentTest_.patternRows = stats;
+    currentTest_.displayRowSkewMs = displaySkewMs;
+}
+
+void ResultsManager::setImpairment(const ImpairmentConfig& config, const ImpairmentStats& stats) {
+    currentTest_.hasImpairment = true;
+    currentTest_.impairment = config;
+    currentTest_.impairmentStats = stats;
+}
+
 TestResult ResultsManager::endTest() {
     testRunning_ = false;
 
-    currentTest_.statistics = computeStatistics();
+    auto starts = segmentStarts();
+    size_t warmupEnd = starts.front();
+    int warmupFrames = warmupFrameCount(warmupEnd);
+    currentTest_.warmupFrames = warmupFrames;
+    currentTest_.warmupSamples = static_cast<int>(warmupEnd);
+    currentTest_.warmupSec = warmupEnd < sampleTimesMs_.size() ? sampleTimesMs_[warmupEnd] / 1000.0 : 0.0;
+    currentTest_.warmupDetected = warmupEnd > firstCountedSample_;
+    currentTest_.statistics = segmentStatistics(warmupEnd, latencySamples_.size(),
+                                                currentTest_.framesAnalyzed - warmupFrames);
+
+    std::vector<int32_t> counted(latencySamples_.begin() + std::min(warmupEnd, latencySamples_.size()),
+                                 latencySamples_.end());
+    std::sort(counted.begin(), counted.end());
+    currentTest_.latencyCounts.clear();
+    for (int32_t value : counted) {
+        if (currentTest_.latencyCounts.empty() || currentTest_.latencyCounts.back().first != value) {
+            currentTest_.latencyCounts.emplace_back(value, 0);
+        }
+        currentTest_.latencyCounts.back().second++;
+    }
+
+    currentTest_.segments.clear();
+    for (size_t i = 0; i < starts.size() && starts[i] < latencySamples_.size(); i++) {
+        size_t from = starts[i];
+        bool last = i + 1 == starts.size();
+        size_t to = last ? latencySamples_.size() : starts[i + 1];
+        int fromFrame = i == 0 ? warmupFrames : sampleFrames_[from];
+        int toFrame = last ? currentTest_.framesAnalyzed : sampleFrames_[to];
+
+        LatencySegment segment;
+        segment.startSec = sampleTimesMs_[from] / 1000.0;
+        segment.endSec = (last ? lastFrameMs_ : sampleTimesMs_[to]) / 1000.0;
+        segment.statistics = segmentStatistics(from, to, toFrame - fromFrame);
+        currentTest_.segments.push_back(segment);
+    }
+    currentTest_.senderStatistics = computeStatistics(senderSamples_, static_cast<int>(senderSamples_.size()));
     currentTest_.testDurationSec = latencySamples_.empty() ? 0 :
         static_cast<int>(latencySamples_.size() / 30);  // Approximate
 
@@ -45,20 +190,67 @@ TestResult ResultsManager::endTest() {
 }
 
 LatencyStatistics ResultsManager::getCurrentStatistics() const {
-    return computeStatistics();
+    size_t warmupEnd = segmentStarts().front();
+    return segmentStatistics(warmupEnd, latencySamples_.size(),
+                             currentTest_.framesAnalyzed - warmupFrameCount(warmupEnd));
 }
 
-LatencyStatistics ResultsManager::computeStatistics() const {
+RegimeStatus ResultsManager::getRegimeStatus() const {
+    RegimeStatus status;
+    auto starts = segmentStarts();
+    status.warmingUp = currentTest_.framesAnalyzed <= warmupFrames_ || lastFrameMs_ < WARMUP_WINDOW_MS;
+    if (starts.front() < sampleTimesMs_.size()) {
+        status.warmupSec = sampleTimesMs_[starts.front()] / 1000.0;
+    }
+    status.shifts = static_cast<int>(starts.size()) - 1;
+    if (status.shifts > 0) {
+        status.lastShiftSec = sampleTimesMs_[starts.back()] / 1000.0;
+    }
+    if (!changePoints_.isLearning()) {
+        status.levelMs = changePoints_.getLevelMs();
+    }
+    return status;
+}
+
+LatencyStatistics ResultsManager::segmentStatistics(size_t from, size_t to, int frames) const {
+    from = std::min(from, latencySamples_.size());
+    to = std::clamp(to, from, latencySamples_.size());
+    std::vector<int32_t> samples(latencySamples_.begin() + from, latencySamples_.begin() + to);
+    return computeStatistics(samples, frames);
+}
+
+std::vector<size_t> ResultsManager::segmentStarts() const {
+    // Change points count from the first sample after the configured warmup
+    std::vector<size_t> starts = {firstCountedSample_};
+    for (size_t change : changePoints_.getChangePoints()) {
+        size_t sample = firstCountedSample_ + change;
+        if (sampleTimesMs_[sample] < WARMUP_WINDOW_MS) {
+            starts.front() = sample;
+        } else {
+            starts.push_back(sample);
+        }
+    }
+    return starts;
+}
+
+int ResultsManager::warmupFrameCount(size_t warmupEnd) const {
+    if (warmupEnd > firstCountedSample_ && warmupEnd < sampleFrames_.size()) {
+        return sampleFrames_[warmupEnd];
+    }
+    return std::min(currentTest_.framesAnalyzed, warmupFrames_);
+}
+
+LatencyStatistics ResultsManager::computeStatistics(const std::vector<int32_t>& samples, int framesAnalyzed) {
     LatencyStatistics stats;
-    stats.validSamples = static_cast<int>(latencySamples_.size());
-    stats.invalidSamples = currentTest_.framesAnalyzed - stats.validSamples;
+    stats.validSamples = static_cast<int>(samples.size());
+    stats.invalidSamples = framesAnalyzed - stats.validSamples;
 
-    if (latencySamples_.empty()) {
+    if (samples.empty()) {
         return stats;
     }
 
     // Create sorted copy for percentile calculations
-    std::vector<int32_t> sorted = latencySamples_;
+    std::vector<int32_t> sorted = samples;
     std::sort(sorted.begin(), sorted.end());
 
     // Min/Max
@@ -103,18 +295,214 @@ bool ResultsManager::exportToJson(const std::string& filename) const {
     j["test_duration_sec"] = lastResult_.testDurationSec;
     j["frames_analyzed"] = lastResult_.framesAnalyzed;
 
-    j["statistics"] = {
-        {"min_ms", lastResult_.statistics.minMs},
-        {"max_ms", lastResult_.statistics.maxMs},
-        {"avg_ms", lastResult_.statistics.avgMs},
-        {"std_dev_ms", lastResult_.statistics.stdDevMs},
-        {"p50_ms", lastResult_.statistics.p50Ms},
-        {"p95_ms", lastResult_.statistics.p95Ms},
-        {"p99_ms", lastResult_.statistics.p99Ms},
-        {"valid_samples", lastResult_.statistics.validSamples},
-        {"invalid_samples", lastResult_.statistics.invalidSamples}
+    j["statistics"] = statisticsJson(lastResult_.statistics);
+    j["statistics"]["sources"] = {
+        {"pattern", lastResult_.patternSamples},
+        {"ocr", lastResult_.ocrSamples},
+        {"flash", lastResult_.flashSamples}
+    };
+
+    j["warmup"] = {
+        {"frames", lastResult_.warmupFrames},
+        {"samples", lastResult_.warmupSamples},
+        {"end_sec", lastResult_.warmupSec},
+        {"detected", lastResult_.warmupDetected}
     };
 
+    // Steady segments, and the level changes between them
+    nlohmann::json segments = nlohmann::json::array();
+    nlohmann::json changePoints = nlohmann::json::array();
+    for (size_t i = 0; i < lastResult_.segments.size(); i++) {
+        const auto& segment = lastResult_.segments[i];
+        segments.push_back({
+            {"start_sec", segment.startSec},
+            {"end_sec", segment.endSec},
+            {"statistics", statisticsJson(segment.statistics)}
+        });
+        if (i > 0) {
+            changePoints.push_back({
+                {"time_sec", segment.startSec},
+                {"from_p50_ms", lastResult_.segments[i - 1].statistics.p50Ms},
+                {"to_p50_ms", segment.statistics.p50Ms}
+            });
+        }
+    }
+    j["segments"] = segments;
+    j["change_points"] = changePoints;
+
+    if (!lastResult_.validRate.empty()) {
+        nlohmann::json rate = nlohmann::json::array();
+        for (const auto& bucket : lastResult_.validRate) {
+            rate.push_back({{"second", bucket.second}, {"frames", bucket.frames}, {"valid", bucket.valid}});
+        }
+        j["valid_rate"] = rate;
+    }
+
+    if (lastResult_.hasDisplayTiming) {
+        const auto& display = lastResult_.displayTiming;
+        j["statistics"]["uncertainty_ms"] = display.uncertaintyMs;
+        j["display"] = {
+            {"refresh_hz", display.refreshHz},
+            {"period_ms", display.periodMs},
+            {"vsync_locked", display.vsyncLocked},
+            {"presents", display.presents},
+            {"missed_vblanks", display.missedVblanks},
+            {"present_jitter_ms", display.presentJitterMs},
+            {"render_ms", display.renderMs},
+            {"scanout_lead_ms", display.scanoutLeadMs},
+            {"display_lag_ms", display.displayLagMs},
+            {"uncertainty_ms", display.uncertaintyMs}
+        };
+    }
+
+    if (lastResult_.hasPatternRows) {
+        const auto& rows = lastResult_.patternRows;
+        nlohmann::json rowList = nlohmann::json::array();
+        for (int i = 0; i < rows.rows; i++) {
+            rowList.push_back({{"frame_y", rows.rowY[i]}, {"offset_ms", rows.offsetMs[i]}});
+        }
+        j["pattern_rows"] = {
+            {"rows", rowList},
+            {"frames", rows.frames},
+            {"camera_readout_ms", rows.readoutMs()},
+            {"camera_full_frame_readout_ms", rows.fullFrameReadoutMs()},
+            {"display_scanout_ms", lastResult_.displayRowSkewMs}
+        };
+    }
+
+    const auto& budget = lastResult_.latencyBudget;
+    if (budget.getCount() > 0) {
+        nlohmann::json segments;
+        for (size_t i = 0; i < BUDGET_SEGMENT_COUNT; i++) {
+            auto segment = static_cast<BudgetSegment>(i);
+            segments[budgetSegmentKey(segment)] = {
+                {"mean_ms", budget.getMeanMs(segment)},
+                {"p50_ms", budget.getPercentileMs(segment, 0.50)},
+                {"p90_ms", budget.getPercentileMs(segment, 0.90)},
+                {"p99_ms", budget.getPercentileMs(segment, 0.99)}
+            };
+        }
+        j["latency_budget"] = {
+            {"samples", budget.getCount()},
+            {"kernel_arrival_samples", budget.getKernelArrivalCount()},
+            {"mean_total_ms", budget.getMeanTotalMs()},
+            {"segments", segments}
+        };
+    }
+
+    if (lastResult_.hasSenderLatency) {
+        const auto& sender = lastResult_.senderStatistics;
+        j["sender_latency"] = {
+            {"clock", senderClockSourceName(lastResult_.senderClock)},
+            {"min_ms", sender.minMs},
+            {"max_ms", sender.maxMs},
+            {"avg_ms", sender.avgMs},
+            {"std_dev_ms", sender.stdDevMs},
+            {"p50_ms", sender.p50Ms},
+            {"p95_ms", sender.p95Ms},
+            {"p99_ms", sender.p99Ms},
+            {"samples", sender.validSamples}
+        };
+    }
+
+    if (lastResult_.hasStageHistograms) {
+        nlohmann::json stages;
+        for (size_t i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+            const auto& histogram = lastResult_.stageHistograms[i];
+            auto p = histogram.getPercentiles();
+
+            // Sparse buckets: [lower_us, width_us, count] for non-empty buckets only
+            nlohmann::json buckets = nlohmann::json::array();
+            for (size_t b = 0; b < LatencyHistogram::BUCKET_COUNT; b++) {
+                uint64_t count = histogram.getBucketCount(b);
+                if (count > 0) {
+                    buckets.push_back({LatencyHistogram::bucketLowerBoundUs(b),
+                                       LatencyHistogram::bucketWidthUs(b), count});
+                }
+            }
+
+            stages[pipelineStageKey(static_cast<PipelineStage>(i))] = {
+                {"count", p.count},
+                {"min_us", p.minUs},
+                {"max_us", p.maxUs},
+                {"mean_us", p.meanUs},
+                {"p50_us", p.p50Us},
+                {"p90_us", p.p90Us},
+                {"p99_us", p.p99Us},
+                {"p999_us", p.p999Us},
+                {"buckets", buckets}
+            };
+        }
+        j["pipeline_stages"] = {
+            {"window_sec", lastResult_.stageWindowSec},
+            {"stages", stages}
+        };
+    }
+
+    if (lastResult_.hasFrameCounters) {
+        j["decoder"] = {
+            {"frames_decoded", lastResult_.framesDecoded},
+            {"frames_dropped", lastResult_.framesDropped},
+            {"decode_errors", lastResult_.decodeErrors},
+            {"corrupt_frames", lastResult_.corruptFrames}
+        };
+    }
+
+    if (lastResult_.hasRtpStats) {
+        const auto& rtp = lastResult_.rtpStats;
+        nlohmann::json history = nlohmann::json::array();
+        for (const auto& sample : rtp.history) {
+            history.push_back({sample.second, sample.packets, sample.bytes});
+        }
+        j["rtp"] = {
+            {"packets", rtp.packets},
+            {"bytes", rtp.bytes},
+            {"lost", rtp.lost},
+            {"loss_percent", rtp.lossPercent},
+            {"reordered", rtp.reordered},
+            {"duplicates", rtp.duplicates},
+            {"sequence_resets", rtp.sequenceResets},
+            {"jitter_ms", rtp.jitterMs},
+            {"history_columns", {"unix_second", "packets", "bytes"}},
+            {"history", history}
+        };
+    }
+
+    if (lastResult_.hasImpairment) {
+        const auto& config = lastResult_.impairment;
+        const auto& stats = lastResult_.impairmentStats;
+        j["impairment"] = {
+            {"relay", config.mode == ImpairmentMode::TCP ? "tcp" : "udp"},
+            {"listen_port", config.listenPort},
+            {"target", config.targetHost + ":" + std::to_string(config.targetPort)},
+            {"delay_ms", config.delayMs},
+            {"jitter_ms", config.jitterMs},
+            {"distribution", ImpairmentProxy::distributionName(config.distribution)},
+            {"loss_percent", config.lossPercent},
+            {"loss_burst", config.lossBurst},
+            {"reorder_percent", config.reorderPercent},
+            {"bandwidth_kbps", config.bandwidthKbps},
+            {"queue_limit_ms", config.queueLimitMs},
+            {"seed", config.seed},
+            {"log", config.logPath},
+            {"packets_in", stats.packetsIn},
+            {"packets_forwarded", stats.packetsForwarded},
+            {"packets_lost", stats.packetsLost},
+            {"packets_overflow", stats.packetsOverflow},
+            {"packets_reordered", stats.packetsReordered},
+            {"bytes_in", stats.bytesIn},
+            {"bytes_forwarded", stats.bytesForwarded},
+            {"added_delay", {
+                {"count", stats.addedDelayUs.count},
+                {"mean_us", stats.addedDelayUs.meanUs},
+                {"p50_us", stats.addedDelayUs.p50Us},
+                {"p90_us", stats.addedDelayUs.p90Us},
+                {"p99_us", stats.addedDelayUs.p99Us},
+                {"max_us", stats.addedDelayUs.maxUs}
+            }}
+        };
+    }
+
     std::ofstream file(filename);
     if (!file.is_open()) {
         return false;
@@ -126,6 +514,12 @@ bool ResultsManager::exportToJson(const std::string& filename) const {
 
 void ResultsManager::clear() {
     latencySamples_.clear();
+    senderSamples_.clear();
+    sampleTimesMs_.clear();
+    sampleFrames_.clear();
+    firstCountedSample_ = 0;
+    changePoints_.reset();
+    lastFrameMs_ = 0;
     currentTest_ = TestResult();
     testRunning_ = false;
 }
@@ -1,11 +1,19 @@
 #pragma once
 
+#include "ChangePointDetector.h"
+#include "Config.h"
+#include "DisplayTiming.h"
+#include "ImpairmentProxy.h"
+#include "LatencyBudget.h"
 #include "LatencyMeasurer.h"
+#include "RtpStreamMonitor.h"
+#include "SenderClock.h"
 #include <vector>
 #include <string>
 #include <cstdint>
 #include <algorithm>
 #include <cmath>
+#include <utility>
 
 namespace latency {
 
@@ -21,6 +29,29 @@ struct LatencyStatistics {
     int invalidSamples = 0;
 };
 
+// Frames and valid samples in one second of a test
+struct ValidRateBucket {
+    uint32_t second = 0;             // Since the test's first frame
+    int frames = 0;
+    int valid = 0;
+};
+
+// A stretch of a test at a steady latency level, between change points
+struct LatencySegment {
+    double startSec = 0.0;           // Since the test's first frame
+    double endSec = 0.0;
+    LatencyStatistics statistics;
+};
+
+// Live view of the warmup and the level changes found so far
+struct RegimeStatus {
+    bool warmingUp = true;           // Within the window where a change still counts as warmup
+    double warmupSec = 0.0;          // Where the counted samples start
+    int shifts = 0;                  // Level changes after the warmup
+    double lastShiftSec = 0.0;
+    double levelMs = 0.0;            // Current segment's level (0 while it's being learned)
+};
+
 struct TestResult {
     std::string testId;
     std::string streamUrl;
@@ -29,7 +60,68 @@ struct TestResult {
     int resolutionHeight = 0;
     int testDurationSec = 0;
     int framesAnalyzed = 0;
-    LatencyStatistics statistics;
+    LatencyStatistics statistics;    // After the warmup
+
+    // Startup transient left out of the statistics: the configured warmup
+    // frames, and any level change found in the first seconds after them
+    int warmupFrames = 0;            // Frames left out, including the configured ones
+    int warmupSamples = 0;           // Valid samples among them
+    double warmupSec = 0.0;
+    bool warmupDetected = false;     // A level change ended the warmup
+
+    // Steady stretches after the warmup; each one after the first starts at
+    // a mid-run level change (encoder profile switch, network path change...)
+    std::vector<LatencySegment> segments;
+
+    // Valid samples after the warmup per whole ms, ascending (for the results history)
+    std::vector<std::pair<int32_t, uint32_t>> latencyCounts;
+
+    // Valid samples by what they were read from
+    int patternSamples = 0;
+    int ocrSamples = 0;
+    int flashSamples = 0;
+
+    // Valid-sample rate over the test, one bucket per second
+    std::vector<ValidRateBucket> validRate;
+
+    // Sender-to-decode latency from the stream's own clock (RTCP SR / ONVIF),
+    // a separate series from the optical measurement above
+    bool hasSenderLatency = false;
+    SenderClockSource senderClock = SenderClockSource::None;
+    LatencyStatistics senderStatistics;
+
+    // Optical measurements split along each frame's pipeline timeline
+    LatencyBudget latencyBudget;
+
+    // Decoder pipeline stage histograms captured at the end of the test
+    bool hasStageHistograms = false;
+    StageHistograms stageHistograms;
+    double stageWindowSec = 0.0;
+
+    // Decoder counters since connect
+    bool hasFrameCounters = false;
+    uint64_t framesDecoded = 0;
+    uint64_t framesDropped = 0;
+    uint64_t decodeErrors = 0;
+    uint64_t corruptFrames = 0;
+
+    // RTP accounting from the batched UDP input
+    bool hasRtpStats = false;
+    RtpStreamStats rtpStats;
+
+    // Present timing of the clock panel, and the +/- it leaves on each reading
+    bool hasDisplayTiming = false;
+    DisplayTimingStats displayTiming;
+
+    // Pattern rows down the panel: camera readout and display scan-out between them
+    bool hasPatternRows = false;
+    PatternRowStats patternRows;
+    double displayRowSkewMs = 0.0;
+
+    // Network impairment applied by the relay during the test
+    bool hasImpairment = false;
+    ImpairmentConfig impairment;
+    ImpairmentStats impairmentStats;
 };
 
 class ResultsManager {
@@ -41,9 +133,41 @@ public:
     void startTest(const std::string& streamUrl, const std::string& codec,
                    int width, int height);
 
+    // Frames skipped at the start of each test before samples count
+    // (decoder warmup); later startup transients are found automatically
+    void setWarmupFrames(int frames) { warmupFrames_ = std::max(0, frames); }
+
     // Add a measurement
     void addMeasurement(const LatencyMeasurement& measurement);
 
+    // Add the split of a valid optical measurement
+    void addLatencyBreakdown(const LatencyBreakdown& breakdown);
+
+    // Add a frame's sender-to-decode latency
+    void addSenderLatency(double latencyMs, SenderClockSource source);
+
+    // Attach decoder pipeline stage histograms to the current test
+    void setStageHistograms(const StageHistograms& histograms, double windowSec);
+
+    // Attach decoder frame and error counters to the current test
+    void setFrameCounters(uint64_t framesDecoded, uint64_t framesDropped,
+                          uint64_t decodeErrors = 0, uint64_t corruptFrames = 0);
+
+    // Attach the stream's RTP loss, jitter and rate history to the current test
+    void setRtpStats(const RtpStreamStats& stats);
+
+    // Attach the clock panel's present timing at the end of the test
+    void setDisplayTiming(const DisplayTimingStats& stats);
+
+    // Attach the pattern rows' readout offsets and the display's scan-out skew between them
+    void setPatternRows(const PatternRowStats& stats, double displaySkewMs);
+
+    // Attach the impairment relay's settings and what it did during the test
+    void setImpairment(const ImpairmentConfig& config, const ImpairmentStats& stats);
+
+    // Whether a test is currently collecting measurements
+    bool isTestRunning() const { return testRunning_; }
+
     // End the test and compute statistics
     TestResult endTest();
 
@@ -52,6 +176,14 @@ public:
 
     // Get current statistics (live update during test)
     LatencyStatistics getCurrentStatistics() const;
+    const LatencyBudget& getCurrentBudget() const { return currentTest_.latencyBudget; }
+
+    // Warmup and level changes so far
+    RegimeStatus getRegimeStatus() const;
+
+    // Fraction of frames with a valid sample over the last few whole seconds
+    // (and the current one); 0 before any frames
+    double getRecentValidRate(int seconds) const;
 
     // Get latest test result
     const TestResult& getLastResult() const { return lastResult_; }
@@ -59,11 +191,34 @@ public:
     // Clear all data
     void clear();
 
-private:
-    LatencyStatistics computeStatistics() const;
+    // Local-time identifier used for test IDs and export filenames
     static std::string generateTestId();
 
+private:
+    static LatencyStatistics computeStatistics(const std::vector<int32_t>& samples, int framesAnalyzed);
+
+    // Statistics of valid samples [from, to) over the frames they came from
+    LatencyStatistics segmentStatistics(size_t from, size_t to, int frames) const;
+
+    // First sample of each segment: the end of the warmup, then every
+    // change point after it
+    std::vector<size_t> segmentStarts() const;
+
+    // Frames analyzed before the counted samples start
+    int warmupFrameCount(size_t warmupEnd) const;
+
+    static constexpr uint32_t WARMUP_WINDOW_MS = 10000;  // Level changes this early are startup transients
+
     std::vector<int32_t> latencySamples_;
+    std::vector<int32_t> senderSamples_;
+    // Per valid sample: ms since the first frame, and frames analyzed before it
+    std::vector<uint32_t> sampleTimesMs_;
+    std::vector<int> sampleFrames_;
+    size_t firstCountedSample_ = 0;  // First sample after the configured warmup frames
+    ChangePointDetector changePoints_;  // Fed the samples from firstCountedSample_ on
+    int warmupFrames_ = TestConfig().warmupFrames;
+    uint32_t firstFrameTimestamp_ = 0;
+    uint32_t lastFrameMs_ = 0;
     TestResult currentTest_;
     TestResult lastResult_;
     bool testRunning_ = false;
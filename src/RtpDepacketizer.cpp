@@ -0,0 +1,195 @@
+#include "RtpDepacketizer.h"
+
+namespace latency {
+
+namespace {
+
+constexpr uint8_t START_CODE[] = {0, 0, 0, 1};
+
+// H.264 payload types (RFC 6184)
+constexpr int H264_STAP_A = 24;
+constexpr int H264_FU_A = 28;
+
+// H.265 payload types (RFC 7798)
+constexpr int HEVC_AP = 48;
+constexpr int HEVC_FU = 49;
+
+// A completed unit nobody collects is dropped beyond this
+constexpr size_t MAX_COMPLETED = 64;
+
+} // namespace
+
+RtpDepacketizer::RtpDepacketizer(RtpVideoCodec codec, int payloadType)
+    : codec_(codec), payloadType_(payloadType) {
+}
+
+void RtpDepacketizer::setParameterSets(std::vector<uint8_t> annexB) {
+    parameterSets_ = std::move(annexB);
+}
+
+void RtpDepacketizer::push(const uint8_t* packet, size_t size, int64_t arrivalNs) {
+    // RTP version 2, at least the fixed header
+    if (size < 12 || (packet[0] >> 6) != 2) {
+        stats_.packetsIgnored++;
+        return;
+    }
+    int payloadType = packet[1] & 0x7F;
+    if ((payloadType_ >= 0 && payloadType != payloadType_) || (payloadType >= 72 && payloadType <= 76)) {
+        stats_.packetsIgnored++;  // Muxed RTCP or another stream
+        return;
+    }
+    bool marker = (packet[1] & 0x80) != 0;
+    uint16_t sequence = static_cast<uint16_t>((packet[2] << 8) | packet[3]);
+    uint32_t timestamp = (static_cast<uint32_t>(packet[4]) << 24) | (packet[5] << 16) | (packet[6] << 8) | packet[7];
+
+    // Payload follows the CSRCs and header extension; padding is trimmed from the end
+    size_t offset = 12 + 4 * static_cast<size_t>(packet[0] & 0x0F);
+    if (packet[0] & 0x10) {
+        if (size < offset + 4) {
+            stats_.packetsIgnored++;
+            return;
+        }
+        offset += 4 + 4 * static_cast<size_t>((packet[offset + 2] << 8) | packet[offset + 3]);
+    }
+    size_t end = size;
+    if (packet[0] & 0x20) {
+        size_t padding = packet[size - 1];
+        end = padding <= size ? size - padding : 0;
+    }
+    if (end <= offset) {
+        stats_.packetsIgnored++;
+        return;
+    }
+
+    bool lost = false;
+    if (haveSequence_) {
+        uint16_t gap = static_cast<uint16_t>(sequence - nextSequence_);
+        if (gap >= 0x8000) {
+            stats_.packetsIgnored++;  // Late or duplicate
+            return;
+        }
+        if (gap > 0) {
+            stats_.packetsLost += gap;
+            lost = true;
+            fragmentOpen_ = false;
+        }
+    }
+    haveSequence_ = true;
+    nextSequence_ = static_cast<uint16_t>(sequence + 1);
+    stats_.packets++;
+
+    // New timestamp without a marker on the previous unit: its last packet was lost
+    if (unitOpen_ && timestamp != current_.rtpTimestamp) {
+        current_.damaged = true;
+        finishUnit();
+    }
+    if (!unitOpen_) {
+        current_ = RtpAccessUnit{};
+        current_.rtpTimestamp = timestamp;
+        current_.firstArrivalNs = arrivalNs;
+        if (!parameterSets_.empty()) {
+            current_.data = std::move(parameterSets_);
+            parameterSets_.clear();
+        }
+        unitOpen_ = true;
+    }
+    // The missing packets may have belonged to this unit
+    if (lost) {
+        current_.damaged = true;
+    }
+    current_.lastArrivalNs = arrivalNs;
+    current_.packets++;
+
+    appendPayload(packet + offset, end - offset);
+
+    if (marker) {
+        finishUnit();
+    }
+}
+
+void RtpDepacketizer::appendNal(const uint8_t* nal, size_t size) {
+    current_.data.insert(current_.data.end(), START_CODE, START_CODE + sizeof(START_CODE));
+    current_.data.insert(current_.data.end(), nal, nal + size);
+}
+
+void RtpDepacketizer::appendPayload(const uint8_t* payload, size_t size) {
+    const bool hevc = codec_ == RtpVideoCodec::HEVC;
+    const size_t headerSize = hevc ? 2 : 1;
+    if (size < headerSize) return;
+
+    int type = hevc ? (payload[0] >> 1) & 0x3F : payload[0] & 0x1F;
+
+    if (type == (hevc ? HEVC_AP : H264_STAP_A)) {
+        // Aggregation: 16-bit size before each NAL unit
+        size_t pos = headerSize;
+        while (pos + 2 <= size) {
+            size_t nalSize = (static_cast<size_t>(payload[pos]) << 8) | payload[pos + 1];
+            pos += 2;
+            if (nalSize == 0 || pos + nalSize > size) {
+                current_.damaged = true;
+                break;
+            }
+            appendNal(payload + pos, nalSize);
+            pos += nalSize;
+        }
+        return;
+    }
+
+    if (type == (hevc ? HEVC_FU : H264_FU_A)) {
+        if (size < headerSize + 1) return;
+        uint8_t fuHeader = payload[headerSize];
+        bool start = (fuHeader & 0x80) != 0;
+        bool last = (fuHeader & 0x40) != 0;
+        const uint8_t* body = payload + headerSize + 1;
+        size_t bodySize = size - headerSize - 1;
+
+        if (start) {
+            // Rebuild the NAL header from the FU indicator and the FU type
+            current_.data.insert(current_.data.end(), START_CODE, START_CODE + sizeof(START_CODE));
+            if (hevc) {
+                current_.data.push_back(static_cast<uint8_t>((payload[0] & 0x81) | ((fuHeader & 0x3F) << 1)));
+                current_.data.push_back(payload[1]);
+            } else {
+                current_.data.push_back(static_cast<uint8_t>((payload[0] & 0xE0) | (fuHeader & 0x1F)));
+            }
+            fragmentOpen_ = true;
+        } else if (!fragmentOpen_) {
+            current_.damaged = true;  // The start fragment was lost
+            return;
+        }
+        current_.data.insert(current_.data.end(), body, body + bodySize);
+        if (last) {
+            fragmentOpen_ = false;
+        }
+        return;
+    }
+
+    appendNal(payload, size);
+}
+
+void RtpDepacketizer::finishUnit() {
+    unitOpen_ = false;
+    fragmentOpen_ = false;
+    if (current_.data.empty()) {
+        return;
+    }
+
+    stats_.accessUnits++;
+    if (current_.damaged) {
+        stats_.damagedUnits++;
+    }
+    if (completed_.size() >= MAX_COMPLETED) {
+        completed_.pop_front();
+    }
+    completed_.push_back(std::move(current_));
+    current_ = RtpAccessUnit{};
+}
+
+bool RtpDepacketizer::pop(RtpAccessUnit& unit) {
+    if (completed_.empty()) return false;
+    unit = std::move(completed_.front());
+    completed_.pop_front();
+    return true;
+}
+
+} // namespace latency
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace latency {
+
+enum class RtpVideoCodec {
+    H264,   // RFC 6184, non-interleaved mode
+    HEVC    // RFC 7798, without DONL
+};
+
+// One access unit in Annex-B form, with when its packets arrived
+struct RtpAccessUnit {
+    std::vector<uint8_t> data;
+    uint32_t rtpTimestamp = 0;
+    int64_t firstArrivalNs = 0;      // First packet of the unit
+    int64_t lastArrivalNs = 0;       // Packet that completed it
+    size_t packets = 0;
+    bool damaged = false;            // Sequence gap or a fragment without its start
+};
+
+struct RtpDepacketizerStats {
+    uint64_t packets = 0;
+    uint64_t packetsLost = 0;        // Sequence numbers never seen
+    uint64_t packetsIgnored = 0;     // Not RTP, other payload types, late duplicates
+    uint64_t accessUnits = 0;
+    uint64_t damagedUnits = 0;
+};
+
+// Reassembles H.264/H.265 RTP payloads (single NAL units, aggregation and
+// fragmentation units) into access units. A unit is complete on the marker
+// bit, or when a packet with a new timestamp shows the marker was lost.
+// Late packets are dropped rather than reordered: the receive path is for
+// measuring, and a reorder buffer would hide the network's own behaviour.
+class RtpDepacketizer {
+public:
+    // payloadType < 0 accepts any dynamic payload type
+    explicit RtpDepacketizer(RtpVideoCodec codec, int payloadType = -1);
+
+    // Annex-B parameter sets from the SDP, put in front of the first unit
+    void setParameterSets(std::vector<uint8_t> annexB);
+
+    void push(const uint8_t* packet, size_t size, int64_t arrivalNs);
+
+    // Next completed access unit, oldest first
+    bool pop(RtpAccessUnit& unit);
+
+    const RtpDepacketizerStats& getStats() const { return stats_; }
+
+private:
+    void appendNal(const uint8_t* nal, size_t size);
+    void appendPayload(const uint8_t* payload, size_t size);
+    void finishUnit();
+
+    RtpVideoCodec codec_;
+    int payloadType_;
+    std::vector<uint8_t> parameterSets_;
+
+    bool haveSequence_ = false;
+    uint16_t nextSequence_ = 0;
+
+    RtpAccessUnit current_;
+    bool unitOpen_ = false;
+    bool fragmentOpen_ = false;      // Inside a fragmented NAL unit
+
+    std::deque<RtpAccessUnit> completed_;
+    RtpDepacketizerStats stats_;
+};
+
+} // namespace latency
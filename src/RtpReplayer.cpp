@@ -0,0 +1,217 @@
+#include "RtpReplayer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace latency {
+
+namespace {
+
+// Sleep until this close to a send time, then spin: sleep_until alone is
+// late by the scheduler tick (~1 ms Linux, up to 15 ms Windows)
+constexpr auto SPIN_WINDOW = std::chrono::microseconds(1500);
+
+} // namespace
+
+RtpReplayer::RtpReplayer() = default;
+
+RtpReplayer::~RtpReplayer() {
+    stop();
+}
+
+bool RtpReplayer::load(const std::string& pcapPath) {
+    packets_.clear();
+    lastError_.clear();
+
+    PcapReader reader;
+    if (!reader.open(pcapPath)) {
+        lastError_ = reader.getLastError();
+        return false;
+    }
+
+    CapturedDatagram datagram;
+    while (reader.next(datagram)) {
+        packets_.push_back(std::move(datagram));
+        datagram = CapturedDatagram{};
+    }
+    if (!reader.getLastError().empty()) {
+        lastError_ = reader.getLastError();
+        return false;
+    }
+    if (packets_.empty()) {
+        lastError_ = "No UDP packets in " + pcapPath;
+        return false;
+    }
+
+    // Captures are in receive order, but merged files may not be
+    std::stable_sort(packets_.begin(), packets_.end(),
+                     [](const CapturedDatagram& a, const CapturedDatagram& b) {
+                         return a.timestampNs < b.timestampNs;
+                     });
+
+    captureBasePort_ = std::min_element(packets_.begin(), packets_.end(),
+                                        [](const CapturedDatagram& a, const CapturedDatagram& b) {
+                                            return a.dstPort < b.dstPort;
+                                        })->dstPort;
+    return true;
+}
+
+double RtpReplayer::getDurationSec() const {
+    if (packets_.size() < 2) return 0.0;
+    return (packets_.back().timestampNs - packets_.front().timestampNs) / 1e9;
+}
+
+bool RtpReplayer::start(const std::string& host, int basePort, double speed) {
+    stop();
+    lastError_.clear();
+    if (packets_.empty()) {
+        lastError_ = "No capture loaded";
+        return false;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        lastError_ = "WSAStartup failed";
+        return false;
+    }
+#endif
+    networkInitialized_ = true;
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* info = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &info) != 0 || !info) {
+        lastError_ = "Cannot resolve " + host;
+        stop();
+        return false;
+    }
+    sockaddr_in addr = *reinterpret_cast<sockaddr_in*>(info->ai_addr);
+    freeaddrinfo(info);
+    addr.sin_port = htons(static_cast<uint16_t>(basePort));
+    targetAddr_.resize(sizeof(addr));
+    std::memcpy(targetAddr_.data(), &addr, sizeof(addr));
+
+#ifdef _WIN32
+    SOCKET s = socket(AF_INET, SOCK_DGRAM, 0);
+    socket_ = s == INVALID_SOCKET ? -1 : static_cast<intptr_t>(s);
+#else
+    socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+#endif
+    if (socket_ == -1) {
+        lastError_ = "Failed to create UDP socket";
+        stop();
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        packetsSent_ = 0;
+        bytesSent_ = 0;
+        sendErrors_ = 0;
+        finished_ = false;
+        lateHistogram_.reset();
+    }
+
+    running_ = true;
+    thread_ = std::thread(&RtpReplayer::sendLoop, this, std::max(0.0, speed));
+    return true;
+}
+
+void RtpReplayer::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    if (socket_ != -1) {
+#ifdef _WIN32
+        closesocket(static_cast<SOCKET>(socket_));
+#else
+        close(static_cast<int>(socket_));
+#endif
+        socket_ = -1;
+    }
+
+#ifdef _WIN32
+    if (networkInitialized_) {
+        WSACleanup();
+    }
+#endif
+    networkInitialized_ = false;
+}
+
+void RtpReplayer::sendLoop(double speed) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const int64_t firstNs = packets_.front().timestampNs;
+    sockaddr_in addr;
+    std::memcpy(&addr, targetAddr_.data(), sizeof(addr));
+    const int basePort = ntohs(addr.sin_port);
+
+    for (const auto& packet : packets_) {
+        if (!running_) break;
+
+        auto due = start;
+        if (speed > 0.0) {
+            due += std::chrono::duration_cast<Clock::duration>(
+                std::chrono::nanoseconds(static_cast<int64_t>((packet.timestampNs - firstNs) / speed)));
+            if (due - Clock::now() > SPIN_WINDOW) {
+                std::this_thread::sleep_until(due - SPIN_WINDOW);
+            }
+            while (Clock::now() < due) {
+            }
+        }
+
+        addr.sin_port = htons(static_cast<uint16_t>(basePort + packet.dstPort - captureBasePort_));
+        auto sentAt = Clock::now();
+#ifdef _WIN32
+        int sent = sendto(static_cast<SOCKET>(socket_), reinterpret_cast<const char*>(packet.payload.data()),
+                          static_cast<int>(packet.payload.size()), 0,
+                          reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+#else
+        int sent = static_cast<int>(sendto(static_cast<int>(socket_), packet.payload.data(), packet.payload.size(), 0,
+                                           reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)));
+#endif
+
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        if (sent == static_cast<int>(packet.payload.size())) {
+            packetsSent_++;
+            bytesSent_ += packet.payload.size();
+        } else {
+            sendErrors_++;
+        }
+        if (speed > 0.0) {
+            lateHistogram_.record(std::chrono::duration<double, std::micro>(sentAt - due).count());
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    finished_ = true;
+    running_ = false;
+}
+
+ReplayStats RtpReplayer::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    ReplayStats stats;
+    stats.packetsSent = packetsSent_;
+    stats.bytesSent = bytesSent_;
+    stats.sendErrors = sendErrors_;
+    stats.sendLateUs = lateHistogram_.getPercentiles();
+    stats.finished = finished_;
+    return stats;
+}
+
+} // namespace latency
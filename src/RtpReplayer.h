@@ -0,0 +1,70 @@
+#pragma once
+
+#include "LatencyHistogram.h"
+#include "PcapFile.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace latency {
+
+struct ReplayStats {
+    uint64_t packetsSent = 0;
+    uint64_t bytesSent = 0;
+    uint64_t sendErrors = 0;
+    LatencyPercentiles sendLateUs;  // How far behind schedule each packet went out
+    bool finished = false;
+};
+
+// Sends the UDP datagrams of a capture to a local receiver with their
+// original spacing (or scaled by speed), so a decoder can be fed exactly the
+// same network input run after run. Destination ports keep their offsets
+// from the lowest port in the capture: basePort + (port - lowest).
+class RtpReplayer {
+public:
+    RtpReplayer();
+    ~RtpReplayer();
+
+    RtpReplayer(const RtpReplayer&) = delete;
+    RtpReplayer& operator=(const RtpReplayer&) = delete;
+
+    // Read the whole capture into memory
+    bool load(const std::string& pcapPath);
+
+    // speed 2.0 replays twice as fast; 0 sends back to back
+    bool start(const std::string& host, int basePort, double speed);
+    void stop();
+    bool isRunning() const { return running_; }
+
+    size_t getPacketCount() const { return packets_.size(); }
+    double getDurationSec() const;
+    int getCaptureBasePort() const { return captureBasePort_; }
+    ReplayStats getStats() const;
+    std::string getLastError() const { return lastError_; }
+
+private:
+    void sendLoop(double speed);
+
+    std::vector<CapturedDatagram> packets_;
+    int captureBasePort_ = 0;
+
+    intptr_t socket_ = -1;
+    std::vector<uint8_t> targetAddr_;  // sockaddr of the receiver, port patched per packet
+    bool networkInitialized_ = false;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    mutable std::mutex statsMutex_;
+    uint64_t packetsSent_ = 0;
+    uint64_t bytesSent_ = 0;
+    uint64_t sendErrors_ = 0;
+    bool finished_ = false;
+    LatencyHistogram lateHistogram_;
+    std::string lastError_;
+};
+
+} // namespace latency
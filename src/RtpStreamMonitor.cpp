@@ -0,0 +1,152 @@
+#include "RtpStreamMonitor.h"
+#include <chrono>
+#include <cmath>
+
+namespace latency {
+
+namespace {
+
+// Extended sequence numbers start one wrap cycle up, so packets from just
+// before the first one can be placed without underflow
+constexpr uint32_t SEQUENCE_OFFSET = 1u << 16;
+
+} // namespace
+
+RtpStreamMonitor::RtpStreamMonitor(int clockRate)
+    : clockRate_(clockRate > 0 ? clockRate : 90000) {
+}
+
+void RtpStreamMonitor::resync(uint16_t sequence) {
+    baseExtended_ = SEQUENCE_OFFSET + sequence;
+    maxExtended_ = baseExtended_;
+    receivedSinceBase_ = 1;
+    seen_.reset();
+    markSeen(maxExtended_);
+}
+
+void RtpStreamMonitor::markSeen(uint32_t extended) {
+    seen_.set(extended % SEEN_WINDOW);
+}
+
+void RtpStreamMonitor::onPacket(const uint8_t* packet, size_t size, int64_t arrivalNs) {
+    if (size < 12 || (packet[0] >> 6) != 2) return;
+    int payloadType = packet[1] & 0x7F;
+    if (payloadType >= 72 && payloadType <= 76) return;  // Muxed RTCP
+
+    uint16_t sequence = static_cast<uint16_t>((packet[2] << 8) | packet[3]);
+    uint32_t timestamp = (static_cast<uint32_t>(packet[4]) << 24) | (packet[5] << 16) | (packet[6] << 8) | packet[7];
+
+    if (!started_) {
+        resync(sequence);
+        started_ = true;
+    } else {
+        uint16_t delta = static_cast<uint16_t>(sequence - static_cast<uint16_t>(maxExtended_));
+        if (delta == 0) {
+            duplicates_.store(duplicates_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        if (delta < MAX_DROPOUT) {
+            // In order, possibly after a gap: forget the sequence numbers skipped over
+            uint32_t extended = maxExtended_ + delta;
+            for (uint32_t s = maxExtended_ + 1; s < extended && s - maxExtended_ <= SEEN_WINDOW; s++) {
+                seen_.reset(s % SEEN_WINDOW);
+            }
+            maxExtended_ = extended;
+            markSeen(extended);
+            receivedSinceBase_++;
+        } else if (delta >= 0x10000 - SEEN_WINDOW) {
+            // Behind the highest: late or a copy of one already seen
+            uint32_t extended = maxExtended_ - (0x10000 - delta);
+            if (seen_.test(extended % SEEN_WINDOW)) {
+                duplicates_.store(duplicates_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return;
+            }
+            markSeen(extended);
+            receivedSinceBase_++;
+            reordered_.store(reordered_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        } else {
+            // Too far either way to be loss or reordering. Only when the next
+            // packet follows on is it the sender restarting, and counting
+            // starts again from that packet; a single stray (or very old
+            // copy) is dropped without touching the counters.
+            if (sequence != badSequence_) {
+                badSequence_ = static_cast<uint16_t>(sequence + 1);
+                return;
+            }
+            badSequence_ = NO_SEQUENCE;
+            uint64_t expected = maxExtended_ - baseExtended_ + 1;
+            lostBeforeBase_ += expected > receivedSinceBase_ ? expected - receivedSinceBase_ : 0;
+            sequenceResets_.store(sequenceResets_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            resync(sequence);
+            lastArrivalNs_ = 0;
+        }
+    }
+
+    // RFC 3550 6.4.1: J += (|D| - J) / 16, in timestamp units
+    if (lastArrivalNs_ != 0) {
+        double arrivalUnits = static_cast<double>(arrivalNs - lastArrivalNs_) * clockRate_ / 1e9;
+        double difference = arrivalUnits - static_cast<int32_t>(timestamp - lastTimestamp_);
+        jitter_ += (std::fabs(difference) - jitter_) / 16.0;
+    }
+    lastArrivalNs_ = arrivalNs;
+    lastTimestamp_ = timestamp;
+
+    uint64_t expected = maxExtended_ - baseExtended_ + 1;
+    uint64_t lost = lostBeforeBase_ + (expected > receivedSinceBase_ ? expected - receivedSinceBase_ : 0);
+
+    packets_.store(packets_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    bytes_.store(bytes_.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+    lost_.store(lost, std::memory_order_relaxed);
+    jitterMs_.store(jitter_ * 1000.0 / clockRate_, std::memory_order_relaxed);
+
+    // Per-second rates; a bucket is reused once its second has left the history
+    int64_t second = arrivalNs / 1000000000;
+    RateBucket& bucket = rates_[static_cast<size_t>(second) % rates_.size()];
+    if (bucket.second.load(std::memory_order_relaxed) != second) {
+        bucket.packets.store(0, std::memory_order_relaxed);
+        bucket.bytes.store(0, std::memory_order_relaxed);
+        bucket.second.store(second, std::memory_order_release);
+    }
+    bucket.packets.store(bucket.packets.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    bucket.bytes.store(bucket.bytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+}
+
+RtpStreamStats RtpStreamMonitor::getStats() const {
+    RtpStreamStats stats;
+    stats.packets = packets_.load(std::memory_order_relaxed);
+    stats.bytes = bytes_.load(std::memory_order_relaxed);
+    stats.lost = lost_.load(std::memory_order_relaxed);
+    stats.reordered = reordered_.load(std::memory_order_relaxed);
+    stats.duplicates = duplicates_.load(std::memory_order_relaxed);
+    stats.sequenceResets = sequenceResets_.load(std::memory_order_relaxed);
+    stats.jitterMs = jitterMs_.load(std::memory_order_relaxed);
+    if (stats.packets + stats.lost > 0) {
+        stats.lossPercent = 100.0 * static_cast<double>(stats.lost) / static_cast<double>(stats.packets + stats.lost);
+    }
+
+    // Whole seconds up to the one before now, so a stalled stream shows zero
+    int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    int64_t first = now - static_cast<int64_t>(HISTORY_SECONDS);
+    bool started = false;
+    for (int64_t second = first; second < now; second++) {
+        const RateBucket& bucket = rates_[static_cast<size_t>(second) % rates_.size()];
+        RtpRateSample sample;
+        sample.second = second;
+        if (bucket.second.load(std::memory_order_acquire) == second) {
+            sample.packets = bucket.packets.load(std::memory_order_relaxed);
+            sample.bytes = bucket.bytes.load(std::memory_order_relaxed);
+            started = true;
+        }
+        if (started) {
+            stats.history.push_back(sample);
+        }
+    }
+    if (!stats.history.empty() && stats.history.back().second == now - 1) {
+        stats.packetsPerSec = static_cast<double>(stats.history.back().packets);
+        stats.bytesPerSec = static_cast<double>(stats.history.back().bytes);
+    }
+    return stats;
+}
+
+} // namespace latency
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace latency {
+
+// Traffic in one whole second of arrival time
+struct RtpRateSample {
+    int64_t second = 0;              // Unix time
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+};
+
+struct RtpStreamStats {
+    uint64_t packets = 0;            // Received, duplicates excluded
+    uint64_t bytes = 0;
+    uint64_t lost = 0;               // Expected minus received (RFC 3550 A.3)
+    uint64_t reordered = 0;          // Arrived after a higher sequence number
+    uint64_t duplicates = 0;
+    uint64_t sequenceResets = 0;     // Jumps too large to be loss, confirmed by the next packet (sender restarted)
+    double lossPercent = 0.0;
+    double jitterMs = 0.0;           // RFC 3550 interarrival jitter
+    double packetsPerSec = 0.0;      // Over the last complete second
+    double bytesPerSec = 0.0;
+    std::vector<RtpRateSample> history;  // Oldest first, up to HISTORY_SECONDS
+};
+
+// Per-stream RTP accounting on the receive path: sequence gaps, reordering,
+// duplicates, interarrival jitter and per-second packet/byte rates.
+// onPacket() is called by a single receive thread; getStats() may be called
+// from any thread at any time. Counters are published through relaxed
+// atomics, so the receive path never waits for a reader.
+class RtpStreamMonitor {
+public:
+    static constexpr size_t HISTORY_SECONDS = 60;
+
+    // clockRate: RTP timestamp units per second (90000 for video)
+    explicit RtpStreamMonitor(int clockRate = 90000);
+
+    // One RTP packet as it arrived (Unix epoch ns); non-RTP data is ignored
+    void onPacket(const uint8_t* packet, size_t size, int64_t arrivalNs);
+
+    RtpStreamStats getStats() const;
+
+private:
+    static constexpr uint32_t MAX_DROPOUT = 3000;     // RFC 3550 A.1
+    static constexpr size_t SEEN_WINDOW = 1024;       // Recent sequence numbers, for duplicates
+    static constexpr uint32_t NO_SEQUENCE = 0x10000 + 1;  // Matches no 16-bit sequence number
+
+    void markSeen(uint32_t extended);
+    void resync(uint16_t sequence);
+
+    struct RateBucket {
+        std::atomic<int64_t> second{0};
+        std::atomic<uint64_t> packets{0};
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    const int clockRate_;
+
+    // Receive-thread state
+    bool started_ = false;
+    uint32_t badSequence_ = NO_SEQUENCE;  // Expected after a jump; arriving confirms the restart (RFC 3550 A.1)
+    uint32_t baseExtended_ = 0;      // First sequence number since the last resync
+    uint32_t maxExtended_ = 0;       // Highest sequence number, with wrap cycles
+    uint64_t receivedSinceBase_ = 0;
+    uint64_t lostBeforeBase_ = 0;    // Loss accounted before a resync
+    std::bitset<SEEN_WINDOW> seen_;
+    int64_t lastArrivalNs_ = 0;
+    uint32_t lastTimestamp_ = 0;
+    double jitter_ = 0.0;            // Timestamp units
+
+    // Published counters
+    std::atomic<uint64_t> packets_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> lost_{0};
+    std::atomic<uint64_t> reordered_{0};
+    std::atomic<uint64_t> duplicates_{0};
+    std::atomic<uint64_t> sequenceResets_{0};
+    std::atomic<double> jitterMs_{0.0};
+    std::array<RateBucket, HISTORY_SECONDS + 2> rates_;
+};
+
+} // namespace latency
@@ -0,0 +1,453 @@
+#include "RtpUdpInput.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/mem.h>
+}
+
+namespace latency {
+
+namespace {
+
+constexpr int IO_BUFFER_SIZE = 64 * 1024;
+
+// Poll interval of the receive thread, so it notices close()
+constexpr int RECEIVE_POLL_MS = 100;
+
+// RTCP is a few packets a second; a small socket is plenty
+constexpr int RTCP_SOCKET_BUFFER_KB = 256;
+constexpr int RTCP_BATCH_SIZE = 8;
+
+// Bytes the demuxer may fall behind (e.g. while paused) before units are dropped
+constexpr size_t MAX_PENDING_BYTES = 64 * 1024 * 1024;
+
+// Arrivals kept for matching; units the demuxer merged or split are skipped
+constexpr size_t MAX_ARRIVALS = 64;
+constexpr size_t ARRIVAL_SEARCH = 8;
+
+// Access unit delimiters (primary_pic_type / pic_type "any")
+constexpr uint8_t H264_AUD[] = {0, 0, 0, 1, 0x09, 0xF0};
+constexpr uint8_t HEVC_AUD[] = {0, 0, 0, 1, 0x46, 0x01, 0x50};
+
+std::vector<uint8_t> decodeBase64(const std::string& text) {
+    std::vector<uint8_t> out;
+    uint32_t bits = 0;
+    int count = 0;
+    for (char c : text) {
+        int value;
+        if (c >= 'A' && c <= 'Z') value = c - 'A';
+        else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') value = c - '0' + 52;
+        else if (c == '+' || c == '-') value = 62;
+        else if (c == '/' || c == '_') value = 63;
+        else continue;  // Padding, whitespace
+        bits = (bits << 6) | static_cast<uint32_t>(value);
+        count += 6;
+        if (count >= 8) {
+            count -= 8;
+            out.push_back(static_cast<uint8_t>(bits >> count));
+        }
+    }
+    return out;
+}
+
+// Value of "name=" in an fmtp parameter list ("a; name=value; b=c")
+std::string fmtpValue(const std::string& fmtp, const std::string& name) {
+    size_t pos = 0;
+    while ((pos = fmtp.find(name + "=", pos)) != std::string::npos) {
+        if (pos == 0 || fmtp[pos - 1] == ' ' || fmtp[pos - 1] == ';') {
+            size_t start = pos + name.size() + 1;
+            size_t end = fmtp.find(';', start);
+            std::string value = fmtp.substr(start, end == std::string::npos ? std::string::npos : end - start);
+            while (!value.empty() && (value.back() == ' ' || value.back() == '\r')) value.pop_back();
+            return value;
+        }
+        pos++;
+    }
+    return "";
+}
+
+void appendParameterSets(std::vector<uint8_t>& out, const std::string& list) {
+    std::stringstream items(list);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        auto nal = decodeBase64(item);
+        if (nal.empty()) continue;
+        static const uint8_t startCode[] = {0, 0, 0, 1};
+        out.insert(out.end(), startCode, startCode + sizeof(startCode));
+        out.insert(out.end(), nal.begin(), nal.end());
+    }
+}
+
+} // namespace
+
+RtpUdpInput::~RtpUdpInput() {
+    close();
+}
+
+bool RtpUdpInput::open(const std::string& url, const UdpReceiveConfig& config, RtpStreamMonitor* monitor) {
+    close();
+    monitor_ = monitor;
+    lastError_.clear();
+    warning_.clear();
+
+    bool sdp = url.size() > 4 && url.compare(url.size() - 4, 4, ".sdp") == 0;
+    if (!(sdp ? parseSdp(url) : parseUrl(url))) {
+        return false;
+    }
+
+    if (!receiver_.open(address_, port_, config)) {
+        lastError_ = receiver_.getLastError();
+        return false;
+    }
+    warning_ = receiver_.getWarning();
+
+    // Sender reports normally arrive on the next port; without it only
+    // RTCP muxed onto the RTP port (RFC 5761) can be used
+    senderClock_.reset();
+    UdpReceiveConfig rtcpConfig;
+    rtcpConfig.enabled = true;
+    rtcpConfig.socketBufferKB = RTCP_SOCKET_BUFFER_KB;
+    rtcpConfig.batchSize = RTCP_BATCH_SIZE;
+    if (port_ < 65535 && !rtcpReceiver_.open(address_, port_ + 1, rtcpConfig)) {
+        warning_ += (warning_.empty() ? "" : "; ") + std::string("no RTCP on port ") +
+                    std::to_string(port_ + 1) + " (" + rtcpReceiver_.getLastError() + ")";
+    }
+
+    auto* buffer = static_cast<unsigned char*>(av_malloc(IO_BUFFER_SIZE));
+    ioContext_ = buffer ? avio_alloc_context(buffer, IO_BUFFER_SIZE, 0, this, &RtpUdpInput::readPacket,
+                                             nullptr, nullptr)
+                        : nullptr;
+    if (!ioContext_) {
+        av_free(buffer);
+        lastError_ = "Failed to allocate the input context";
+        receiver_.close();
+        rtcpReceiver_.close();
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.clear();
+        readPos_ = 0;
+        arrivals_.clear();
+        firstUnit_ = true;
+        stats_ = RtpUdpInputStats{};
+    }
+
+    running_ = true;
+    thread_ = std::thread(&RtpUdpInput::receiveLoop, this);
+    if (rtcpReceiver_.isOpen()) {
+        rtcpThread_ = std::thread(&RtpUdpInput::rtcpLoop, this);
+    }
+    return true;
+}
+
+void RtpUdpInput::interrupt() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    dataCv_.notify_all();
+}
+
+void RtpUdpInput::close() {
+    interrupt();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (rtcpThread_.joinable()) {
+        rtcpThread_.join();
+    }
+    receiver_.close();
+    rtcpReceiver_.close();
+
+    if (ioContext_) {
+        av_freep(&ioContext_->buffer);
+        avio_context_free(&ioContext_);
+        ioContext_ = nullptr;
+    }
+}
+
+const char* RtpUdpInput::getInputFormat() const {
+    return codec_ == RtpVideoCodec::HEVC ? "hevc" : "h264";
+}
+
+bool RtpUdpInput::parseUrl(const std::string& url) {
+    // rtp://[address]:port[?options]
+    const std::string scheme = "rtp://";
+    if (url.compare(0, scheme.size(), scheme) != 0) {
+        lastError_ = "Not an RTP URL: " + url;
+        return false;
+    }
+    std::string rest = url.substr(scheme.size());
+    std::string query;
+    size_t q = rest.find('?');
+    if (q != std::string::npos) {
+        query = rest.substr(q + 1);
+        rest = rest.substr(0, q);
+    }
+    size_t colon = rest.rfind(':');
+    if (colon == std::string::npos) {
+        lastError_ = "RTP URL needs a port: " + url;
+        return false;
+    }
+    address_ = rest.substr(0, colon);
+    port_ = std::atoi(rest.substr(colon + 1).c_str());
+    if (port_ <= 0 || port_ > 65535) {
+        lastError_ = "Invalid port in " + url;
+        return false;
+    }
+
+    // Without an SDP the codec can only come from the URL
+    codec_ = RtpVideoCodec::H264;
+    std::stringstream options(query);
+    std::string option;
+    while (std::getline(options, option, '&')) {
+        if (option == "codec=hevc" || option == "codec=h265") {
+            codec_ = RtpVideoCodec::HEVC;
+        }
+    }
+    payloadType_ = -1;
+    parameterSets_.clear();
+    return true;
+}
+
+bool RtpUdpInput::parseSdp(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        lastError_ = "Cannot read " + path;
+        return false;
+    }
+
+    address_.clear();
+    port_ = 0;
+    payloadType_ = -1;
+    parameterSets_.clear();
+
+    std::string line;
+    std::string encoding;
+    std::string fmtp;
+    bool inMedia = false;
+    bool inVideo = false;
+    bool seenVideo = false;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        if (line.compare(0, 2, "m=") == 0) {
+            // First video section only: m=video <port> RTP/AVP <pt>
+            inMedia = true;
+            inVideo = !seenVideo && line.compare(0, 8, "m=video ") == 0;
+            if (inVideo) {
+                seenVideo = true;
+                std::istringstream fields(line.substr(8));
+                std::string profile;
+                fields >> port_ >> profile >> payloadType_;
+            }
+        } else if (line.compare(0, 9, "c=IN IP4 ") == 0 && (inVideo || !inMedia)) {
+            // Session-level, overridden by the video section's own
+            address_ = line.substr(9);
+            size_t slash = address_.find('/');  // Multicast TTL
+            if (slash != std::string::npos) address_.resize(slash);
+        } else if (inVideo && payloadType_ >= 0) {
+            std::string rtpmap = "a=rtpmap:" + std::to_string(payloadType_) + " ";
+            std::string fmtpPrefix = "a=fmtp:" + std::to_string(payloadType_) + " ";
+            if (line.compare(0, rtpmap.size(), rtpmap) == 0) {
+                encoding = line.substr(rtpmap.size(), line.find('/') - rtpmap.size());
+            } else if (line.compare(0, fmtpPrefix.size(), fmtpPrefix) == 0) {
+                fmtp = line.substr(fmtpPrefix.size());
+            }
+        }
+    }
+
+    if (!seenVideo || port_ <= 0) {
+        lastError_ = "No video stream in " + path;
+        return false;
+    }
+    std::transform(encoding.begin(), encoding.end(), encoding.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    if (encoding == "H264") {
+        codec_ = RtpVideoCodec::H264;
+        if (fmtpValue(fmtp, "packetization-mode") == "2") {
+            lastError_ = "Interleaved H.264 packetization is not supported";
+            return false;
+        }
+        appendParameterSets(parameterSets_, fmtpValue(fmtp, "sprop-parameter-sets"));
+    } else if (encoding == "H265" || encoding == "HEVC") {
+        codec_ = RtpVideoCodec::HEVC;
+        std::string donDiff = fmtpValue(fmtp, "sprop-max-don-diff");
+        if (!donDiff.empty() && donDiff != "0") {
+            lastError_ = "H.265 streams with decoding order numbers are not supported";
+            return false;
+        }
+        appendParameterSets(parameterSets_, fmtpValue(fmtp, "sprop-vps"));
+        appendParameterSets(parameterSets_, fmtpValue(fmtp, "sprop-sps"));
+        appendParameterSets(parameterSets_, fmtpValue(fmtp, "sprop-pps"));
+    } else {
+        lastError_ = "Only H.264 and H.265 are supported (stream is " +
+                     (encoding.empty() ? std::string("unknown") : encoding) + ")";
+        return false;
+    }
+    return true;
+}
+
+void RtpUdpInput::receiveLoop() {
+    RtpDepacketizer depacketizer(codec_, payloadType_);
+    depacketizer.setParameterSets(parameterSets_);
+    RtpAccessUnit unit;
+
+    while (running_) {
+        int count = receiver_.receive(RECEIVE_POLL_MS);
+        if (count < 0) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                lastError_ = receiver_.getLastError();
+                running_ = false;
+            }
+            dataCv_.notify_all();
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            if (SenderClock::isRtcp(receiver_.data(i), receiver_.size(i))) {
+                senderClock_.onRtcp(receiver_.data(i), receiver_.size(i));
+                continue;
+            }
+            senderClock_.onRtp(receiver_.data(i), receiver_.size(i));
+            if (monitor_) {
+                monitor_->onPacket(receiver_.data(i), receiver_.size(i), receiver_.arrivalNs(i));
+            }
+            depacketizer.push(receiver_.data(i), receiver_.size(i), receiver_.arrivalNs(i));
+        }
+
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (depacketizer.pop(unit)) {
+                enqueue(unit);
+                queued = true;
+            }
+            stats_.socket = receiver_.getStats();
+            stats_.rtp = depacketizer.getStats();
+        }
+        if (queued) {
+            dataCv_.notify_all();
+        }
+    }
+}
+
+void RtpUdpInput::rtcpLoop() {
+    while (running_) {
+        int count = rtcpReceiver_.receive(RECEIVE_POLL_MS);
+        if (count < 0) {
+            break;  // Sender time is optional; the video keeps flowing
+        }
+        for (int i = 0; i < count; i++) {
+            senderClock_.onRtcp(rtcpReceiver_.data(i), rtcpReceiver_.size(i));
+        }
+    }
+}
+
+void RtpUdpInput::enqueue(RtpAccessUnit& unit) {
+    const bool hevc = codec_ == RtpVideoCodec::HEVC;
+    const uint8_t* delimiter = hevc ? HEVC_AUD : H264_AUD;
+    const size_t delimiterSize = hevc ? sizeof(HEVC_AUD) : sizeof(H264_AUD);
+
+    // We delimit every unit ourselves; drop the sender's own delimiter
+    size_t skip = 0;
+    if (unit.data.size() >= 5) {
+        int type = hevc ? (unit.data[4] >> 1) & 0x3F : unit.data[4] & 0x1F;
+        if (type == (hevc ? 35 : 9)) {
+            size_t next = 4;
+            while (next + 3 < unit.data.size() &&
+                   !(unit.data[next] == 0 && unit.data[next + 1] == 0 && unit.data[next + 2] == 0 &&
+                     unit.data[next + 3] == 1)) {
+                next++;
+            }
+            skip = next + 3 < unit.data.size() ? next : 0;
+        }
+    }
+    size_t unitSize = unit.data.size() - skip;
+
+    if (pending_.size() - readPos_ + unitSize > MAX_PENDING_BYTES) {
+        // Nobody is reading; start over from the next unit rather than grow
+        pending_.clear();
+        readPos_ = 0;
+        arrivals_.clear();
+        stats_.unitsOverflowed++;
+        return;
+    }
+    if (readPos_ > 0 && readPos_ >= pending_.size() / 2) {
+        pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(readPos_));
+        readPos_ = 0;
+    }
+
+    pending_.insert(pending_.end(), unit.data.begin() + static_cast<std::ptrdiff_t>(skip), unit.data.end());
+    pending_.insert(pending_.end(), delimiter, delimiter + delimiterSize);
+
+    // The parser returns each unit starting with the delimiter queued after the previous one
+    PendingArrival pending;
+    pending.arrival.firstArrivalNs = unit.firstArrivalNs;
+    pending.arrival.lastArrivalNs = unit.lastArrivalNs;
+    senderClock_.toSenderTime(unit.rtpTimestamp, pending.arrival.senderNs, pending.arrival.senderSource);
+    pending.packetSize = unitSize + (firstUnit_ ? 0 : delimiterSize);
+    firstUnit_ = false;
+    if (arrivals_.size() >= MAX_ARRIVALS) {
+        arrivals_.pop_front();
+    }
+    arrivals_.push_back(pending);
+}
+
+bool RtpUdpInput::takeArrival(int packetSize, AccessUnitArrival& arrival) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t limit = std::min(arrivals_.size(), ARRIVAL_SEARCH);
+    for (size_t i = 0; i < limit; i++) {
+        if (arrivals_[i].packetSize == static_cast<size_t>(packetSize)) {
+            arrival = arrivals_[i].arrival;
+            arrivals_.erase(arrivals_.begin(), arrivals_.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+RtpUdpInputStats RtpUdpInput::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::string RtpUdpInput::getLastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
+
+int RtpUdpInput::readPacket(void* opaque, uint8_t* buffer, int size) {
+    auto* self = static_cast<RtpUdpInput*>(opaque);
+    std::unique_lock<std::mutex> lock(self->mutex_);
+
+    // Never return 0: FFmpeg treats an empty read as the end of the stream
+    bool ready = self->dataCv_.wait_for(lock, std::chrono::milliseconds(self->readTimeoutMs_.load()), [self] {
+        return self->readPos_ < self->pending_.size() || !self->running_;
+    });
+    if (!ready) {
+        return AVERROR(ETIMEDOUT);
+    }
+    if (self->readPos_ >= self->pending_.size()) {
+        return AVERROR_EOF;
+    }
+
+    int count = static_cast<int>(std::min(static_cast<size_t>(size), self->pending_.size() - self->readPos_));
+    std::memcpy(buffer, self->pending_.data() + self->readPos_, count);
+    self->readPos_ += count;
+    return count;
+}
+
+} // namespace latency
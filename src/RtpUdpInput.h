@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Config.h"
+#include "RtpDepacketizer.h"
+#include "RtpStreamMonitor.h"
+#include "SenderClock.h"
+#include "UdpBatchReceiver.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct AVIOContext;
+
+namespace latency {
+
+struct RtpUdpInputStats {
+    UdpReceiveStats socket;
+    RtpDepacketizerStats rtp;
+    uint64_t unitsOverflowed = 0;    // Dropped because the demuxer stopped reading
+};
+
+// When the packets of one access unit reached the socket (Unix epoch ns)
+struct AccessUnitArrival {
+    int64_t firstArrivalNs = 0;
+    int64_t lastArrivalNs = 0;
+    int64_t senderNs = 0;            // Sender's wall clock for the unit, 0 if unknown
+    SenderClockSource senderSource = SenderClockSource::None;
+};
+
+// RTP/UDP input for VideoDecoder that bypasses FFmpeg's UDP protocol
+// handler and RTP demuxer. A thread reads the socket with UdpBatchReceiver,
+// reassembles H.264/H.265 access units and exposes them as an Annex-B byte
+// stream through a custom AVIOContext, for FFmpeg's raw h264/hevc demuxer.
+//
+// Each unit is followed by an access unit delimiter, so the demuxer's
+// parser can end a frame as soon as its last packet is in instead of
+// waiting for the next frame to start. The arrival times of every unit are
+// kept until the demuxed packet is matched to them with takeArrival().
+// RTCP on the port above (or muxed on the same port) and ONVIF header
+// extensions give each unit the sender's wall clock time as well.
+class RtpUdpInput {
+public:
+    RtpUdpInput() = default;
+    ~RtpUdpInput();
+
+    RtpUdpInput(const RtpUdpInput&) = delete;
+    RtpUdpInput& operator=(const RtpUdpInput&) = delete;
+
+    // url: rtp://[group]:port[?codec=h264|hevc] or an .sdp file (codec,
+    // port, payload type and parameter sets are taken from it). Every
+    // datagram is also passed to monitor, if given, on the receive thread.
+    bool open(const std::string& url, const UdpReceiveConfig& config, RtpStreamMonitor* monitor = nullptr);
+    void close();
+
+    // Make a blocked or future read return end of stream
+    void interrupt();
+
+    // Reads fail with a timeout after this long without data
+    void setReadTimeout(int timeoutMs) { readTimeoutMs_ = timeoutMs; }
+
+    AVIOContext* getIOContext() const { return ioContext_; }
+    const char* getInputFormat() const;   // "h264" or "hevc"
+
+    // Arrival of the unit the demuxer returned as a packetSize-byte packet
+    bool takeArrival(int packetSize, AccessUnitArrival& arrival);
+
+    RtpUdpInputStats getStats() const;
+    const std::string& getWarning() const { return warning_; }
+    std::string getLastError() const;
+
+private:
+    struct PendingArrival {
+        AccessUnitArrival arrival;
+        size_t packetSize = 0;       // Delimiter + unit, as the parser will return it
+    };
+
+    bool parseUrl(const std::string& url);
+    bool parseSdp(const std::string& path);
+    void receiveLoop();
+    void rtcpLoop();
+    void enqueue(RtpAccessUnit& unit);
+    static int readPacket(void* opaque, uint8_t* buffer, int size);
+
+    RtpVideoCodec codec_ = RtpVideoCodec::H264;
+    int payloadType_ = -1;
+    std::string address_;
+    int port_ = 0;
+    std::vector<uint8_t> parameterSets_;  // Annex-B, from the SDP
+
+    UdpBatchReceiver receiver_;
+    UdpBatchReceiver rtcpReceiver_;      // port + 1
+    SenderClock senderClock_;
+    RtpStreamMonitor* monitor_ = nullptr;
+    AVIOContext* ioContext_ = nullptr;
+    std::thread thread_;
+    std::thread rtcpThread_;
+    std::atomic<bool> running_{false};
+    std::atomic<int> readTimeoutMs_{5000};
+
+    mutable std::mutex mutex_;
+    std::condition_variable dataCv_;
+    std::vector<uint8_t> pending_;       // Annex-B bytes not yet read by the demuxer
+    size_t readPos_ = 0;
+    std::deque<PendingArrival> arrivals_;
+    bool firstUnit_ = true;
+    RtpUdpInputStats stats_;
+
+    std::string warning_;
+    std::string lastError_;              // Guarded by mutex_ once the thread runs
+};
+
+} // namespace latency
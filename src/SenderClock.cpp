@@ -0,0 +1,132 @@
+#include "SenderClock.h"
+
+namespace latency {
+
+namespace {
+
+// Seconds from the NTP epoch (1900) to the Unix epoch (1970)
+constexpr int64_t NTP_UNIX_OFFSET_SEC = 2208988800LL;
+
+constexpr int RTCP_SENDER_REPORT = 200;
+constexpr uint16_t ONVIF_EXTENSION_PROFILE = 0xABAC;
+
+uint32_t readU32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+int64_t ntpToUnixNs(uint32_t seconds, uint32_t fraction) {
+    int64_t unixSec = static_cast<int64_t>(seconds) - NTP_UNIX_OFFSET_SEC;
+    return unixSec * 1000000000LL + static_cast<int64_t>((static_cast<uint64_t>(fraction) * 1000000000ULL) >> 32);
+}
+
+} // namespace
+
+const char* senderClockSourceName(SenderClockSource source) {
+    switch (source) {
+        case SenderClockSource::RtcpSenderReport: return "RTCP SR";
+        case SenderClockSource::OnvifExtension:   return "ONVIF";
+        default:                                  return "None";
+    }
+}
+
+SenderClock::SenderClock(int clockRate)
+    : clockRate_(clockRate > 0 ? clockRate : 90000) {
+}
+
+bool SenderClock::isRtcp(const uint8_t* packet, size_t size) {
+    return size >= 8 && (packet[0] >> 6) == 2 && packet[1] >= 200 && packet[1] <= 204;
+}
+
+void SenderClock::onRtcp(const uint8_t* packet, size_t size) {
+    // Walk the compound packet; each part gives its length in words minus one
+    size_t offset = 0;
+    while (offset + 4 <= size) {
+        const uint8_t* part = packet + offset;
+        if ((part[0] >> 6) != 2) return;
+        size_t length = (static_cast<size_t>((part[2] << 8) | part[3]) + 1) * 4;
+        if (offset + length > size) return;
+
+        if (part[1] == RTCP_SENDER_REPORT && length >= 28) {
+            uint32_t ssrc = readU32(part + 4);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!haveSsrc_ || ssrc == ssrc_) {
+                reportUnixNs_ = ntpToUnixNs(readU32(part + 8), readU32(part + 12));
+                reportRtpTimestamp_ = readU32(part + 16);
+                reportSsrc_ = ssrc;
+                haveReport_ = true;
+                reports_++;
+            }
+        }
+        offset += length;
+    }
+}
+
+void SenderClock::onRtp(const uint8_t* packet, size_t size) {
+    if (size < 12 || (packet[0] >> 6) != 2) return;
+    uint32_t timestamp = readU32(packet + 4);
+    uint32_t ssrc = readU32(packet + 8);
+
+    int64_t onvifNs = 0;
+    if (packet[0] & 0x10) {
+        size_t extension = 12 + 4 * static_cast<size_t>(packet[0] & 0x0F);
+        if (extension + 4 <= size) {
+            uint16_t profile = static_cast<uint16_t>((packet[extension] << 8) | packet[extension + 1]);
+            size_t words = static_cast<size_t>((packet[extension + 2] << 8) | packet[extension + 3]);
+            if (profile == ONVIF_EXTENSION_PROFILE && words >= 3 && extension + 4 + words * 4 <= size) {
+                onvifNs = ntpToUnixNs(readU32(packet + extension + 4), readU32(packet + extension + 8));
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!haveSsrc_ || ssrc != ssrc_) {
+        // New sender: earlier reports and stamps don't describe this stream
+        haveSsrc_ = true;
+        ssrc_ = ssrc;
+        haveReport_ = haveReport_ && reportSsrc_ == ssrc;
+        onvifCount_ = 0;
+    }
+    if (onvifNs != 0) {
+        // Every packet of a frame may carry the stamp; keep one entry per frame
+        size_t last = (onvifCount_ + ONVIF_HISTORY - 1) % ONVIF_HISTORY;
+        if (onvifCount_ == 0 || onvif_[last].rtpTimestamp != timestamp) {
+            onvif_[onvifCount_ % ONVIF_HISTORY] = {timestamp, onvifNs};
+            onvifCount_++;
+        }
+    }
+}
+
+bool SenderClock::toSenderTime(uint32_t rtpTimestamp, int64_t& unixNs, SenderClockSource& source) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t stamps = onvifCount_ < ONVIF_HISTORY ? onvifCount_ : ONVIF_HISTORY;
+    for (size_t i = 0; i < stamps; i++) {
+        if (onvif_[i].rtpTimestamp == rtpTimestamp) {
+            unixNs = onvif_[i].unixNs;
+            source = SenderClockSource::OnvifExtension;
+            return true;
+        }
+    }
+    if (!haveReport_) return false;
+
+    // Signed difference: the frame may be just before the report's instant
+    int32_t elapsed = static_cast<int32_t>(rtpTimestamp - reportRtpTimestamp_);
+    unixNs = reportUnixNs_ + static_cast<int64_t>(elapsed) * 1000000000LL / clockRate_;
+    source = SenderClockSource::RtcpSenderReport;
+    return true;
+}
+
+uint64_t SenderClock::getReportCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reports_;
+}
+
+void SenderClock::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    haveSsrc_ = false;
+    haveReport_ = false;
+    reports_ = 0;
+    onvifCount_ = 0;
+}
+
+} // namespace latency
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace latency {
+
+enum class SenderClockSource {
+    None,
+    RtcpSenderReport,   // NTP <-> RTP timestamp pairs from RTCP SR (RFC 3550 6.4.1)
+    OnvifExtension      // NTP capture time in an ONVIF RTP header extension
+};
+
+const char* senderClockSourceName(SenderClockSource source);  // "RTCP SR", "ONVIF"
+
+// Maps the RTP timestamps of one stream to the sender's wall clock. Sender
+// reports give the NTP time of one RTP timestamp, which is extrapolated at
+// the stream's clock rate; the ONVIF replay extension (Streaming
+// Specification 6.3, profile 0xABAC) stamps frames directly and wins when
+// present. RTP and RTCP may be fed from different threads.
+class SenderClock {
+public:
+    // clockRate: RTP timestamp units per second (90000 for video)
+    explicit SenderClock(int clockRate = 90000);
+
+    // RTCP rather than RTP on a shared port (RFC 5761 4: packet types 200-204)
+    static bool isRtcp(const uint8_t* packet, size_t size);
+
+    // A compound RTCP packet; sender reports of the stream's SSRC update the mapping
+    void onRtcp(const uint8_t* packet, size_t size);
+
+    // An RTP packet: learns the SSRC and keeps any ONVIF capture time
+    void onRtp(const uint8_t* packet, size_t size);
+
+    // Sender wall clock (Unix epoch ns) at rtpTimestamp; false before the
+    // first sender report or ONVIF timestamp
+    bool toSenderTime(uint32_t rtpTimestamp, int64_t& unixNs, SenderClockSource& source) const;
+
+    uint64_t getReportCount() const;
+
+    // Forget the sender, e.g. before a new session
+    void reset();
+
+private:
+    static constexpr size_t ONVIF_HISTORY = 8;   // Frames whose capture time is kept
+
+    struct OnvifStamp {
+        uint32_t rtpTimestamp = 0;
+        int64_t unixNs = 0;
+    };
+
+    const int clockRate_;
+
+    mutable std::mutex mutex_;
+    bool haveSsrc_ = false;
+    uint32_t ssrc_ = 0;
+    bool haveReport_ = false;
+    uint32_t reportSsrc_ = 0;
+    uint32_t reportRtpTimestamp_ = 0;
+    int64_t reportUnixNs_ = 0;
+    uint64_t reports_ = 0;
+    std::array<OnvifStamp, ONVIF_HISTORY> onvif_;
+    size_t onvifCount_ = 0;
+};
+
+} // namespace latency
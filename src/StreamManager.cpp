@@ -0,0 +1,281 @@
+#include "StreamManager.h"
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace latency {
+
+StreamPipeline::StreamPipeline(const std::string& url, const TimestampDisplay* clock)
+    : url_(url), clock_(clock), decoder_(std::make_unique<VideoDecoder>()) {
+}
+
+StreamPipeline::~StreamPipeline() {
+    disconnect();
+}
+
+bool StreamPipeline::connect(const StreamConfig& baseConfig, WorkerPool* pool) {
+    StreamConfig config = baseConfig;
+    config.url = url_;
+
+    // Reset before connecting - the frame callback touches the measurer once decoding starts
+    measurer_.clearPatternRegion();
+    decoder_->setWorkerPool(pool);
+    decoder_->setFrameCallback([this](const VideoFrame& frame) { onFrame(frame); });
+
+    if (!decoder_->connect(config)) {
+        return false;
+    }
+
+    const auto& info = decoder_->getStreamInfo();
+    std::lock_guard<std::mutex> lock(resultsMutex_);
+    results_.startTest(url_, info.codecName, info.width, info.height);
+    lastMeasurement_ = LatencyMeasurement{};
+    return true;
+}
+
+void StreamPipeline::disconnect() {
+    decoder_->disconnect();
+}
+
+void StreamPipeline::onFrame(const VideoFrame& frame) {
+    // Runs on a pool worker right after decode; frames of one stream never overlap
+    uint32_t now = clock_->getCurrentTimestamp();
+    LatencyMeasurement measurement = measurer_.measure(&frame, now);
+
+    std::lock_guard<std::mutex> lock(resultsMutex_);
+    results_.addMeasurement(measurement);
+    if (measurement.valid) {
+        lastMeasurement_ = measurement;
+    }
+}
+
+LatencyMeasurement StreamPipeline::getLastMeasurement() const {
+    std::lock_guard<std::mutex> lock(resultsMutex_);
+    return lastMeasurement_;
+}
+
+LatencyStatistics StreamPipeline::getLatencyStatistics() const {
+    std::lock_guard<std::mutex> lock(resultsMutex_);
+    return results_.getCurrentStatistics();
+}
+
+TestResult StreamPipeline::endTest() {
+    auto stats = decoder_->getDecodeStats();
+    auto histograms = decoder_->getStageHistograms();
+
+    std::lock_guard<std::mutex> lock(resultsMutex_);
+    results_.setStageHistograms(histograms, stats.stageWindowSec);
+    TestResult result = results_.endTest();
+
+    // Keep measuring into a fresh test while the stream is up
+    if (decoder_->isConnected()) {
+        const auto& info = decoder_->getStreamInfo();
+        results_.startTest(url_, info.codecName, info.width, info.height);
+        decoder_->resetStageHistograms();
+    }
+    return result;
+}
+
+StreamManager::StreamManager(size_t workerThreads, const TimestampDisplay* clock)
+    : pool_(workerThreads), clock_(clock) {
+}
+
+StreamManager::~StreamManager() {
+    disconnectAll();
+}
+
+bool StreamManager::loadStreamList(const std::string& path, std::vector<std::string>& urls) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        // Trim whitespace and skip comments/blank lines
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+        size_t last = line.find_last_not_of(" \t\r");
+        urls.push_back(line.substr(first, last - first + 1));
+    }
+    return true;
+}
+
+void StreamManager::setStreams(const std::vector<std::string>& urls) {
+    disconnectAll();
+    streams_.clear();
+    for (const auto& url : urls) {
+        streams_.push_back(std::make_unique<StreamPipeline>(url, clock_));
+    }
+}
+
+int StreamManager::connectAll(const StreamConfig& baseConfig) {
+    // The pool provides the parallelism, so each decoder runs single-threaded
+    StreamConfig config = baseConfig;
+    config.decoderThreading = DecoderThreading::NONE;
+    config.decoderThreadCount = 1;
+
+    // Connecting blocks on the network, so do it on short-lived threads rather
+    // than tying up pool workers
+    std::vector<std::thread> connectors;
+    std::vector<char> connected(streams_.size(), 0);
+    for (size_t i = 0; i < streams_.size(); i++) {
+        connectors.emplace_back([this, i, &config, &connected] {
+            connected[i] = streams_[i]->connect(config, &pool_) ? 1 : 0;
+        });
+    }
+    for (auto& t : connectors) {
+        t.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(scalingMutex_);
+        scalingSamples_.clear();
+        runStart_ = std::chrono::steady_clock::now();
+        lastSampleTime_ = runStart_;
+        lastCpuSeconds_ = processCpuSeconds();
+        lastFramesDecoded_ = 0;
+    }
+
+    int count = 0;
+    for (char c : connected) count += c;
+    return count;
+}
+
+void StreamManager::disconnectAll() {
+    for (auto& stream : streams_) {
+        stream->disconnect();
+    }
+}
+
+int StreamManager::getConnectedCount() const {
+    int count = 0;
+    for (const auto& stream : streams_) {
+        if (stream->isConnected()) count++;
+    }
+    return count;
+}
+
+double StreamManager::processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exitTime, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user)) {
+        return 0.0;
+    }
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) / 1e7;  // 100 ns units
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.0;
+    }
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+#endif
+}
+
+void StreamManager::sampleScaling() {
+    ScalingSample sample;
+    for (const auto& stream : streams_) {
+        if (!stream->isConnected()) continue;
+        auto stats = stream->getDecoder().getDecodeStats();
+        sample.activeStreams++;
+        sample.framesDecoded += stats.framesDecoded;
+        sample.framesDropped += stats.framesDropped;
+    }
+    sample.pendingTasks = pool_.getPendingTasks();
+
+    auto now = std::chrono::steady_clock::now();
+    double cpuSeconds = processCpuSeconds();
+
+    std::lock_guard<std::mutex> lock(scalingMutex_);
+    double wallSec = std::chrono::duration<double>(now - lastSampleTime_).count();
+    if (wallSec <= 0.0) return;
+
+    sample.elapsedSec = std::chrono::duration<double>(now - runStart_).count();
+    sample.cpuPercent = (cpuSeconds - lastCpuSeconds_) / wallSec * 100.0;
+    sample.cpuPerStream = sample.activeStreams > 0 ? sample.cpuPercent / sample.activeStreams : 0.0;
+    if (sample.framesDecoded >= lastFramesDecoded_) {
+        sample.totalDecodeFps = (sample.framesDecoded - lastFramesDecoded_) / wallSec;
+    }
+
+    scalingSamples_.push_back(sample);
+    lastSampleTime_ = now;
+    lastCpuSeconds_ = cpuSeconds;
+    lastFramesDecoded_ = sample.framesDecoded;
+}
+
+ScalingSample StreamManager::getLatestScaling() const {
+    std::lock_guard<std::mutex> lock(scalingMutex_);
+    return scalingSamples_.empty() ? ScalingSample{} : scalingSamples_.back();
+}
+
+bool StreamManager::exportResults(const std::string& filename) {
+    nlohmann::json j;
+    j["worker_threads"] = pool_.getThreadCount();
+    j["hardware_threads"] = std::thread::hardware_concurrency();
+
+    nlohmann::json streams = nlohmann::json::array();
+    for (auto& stream : streams_) {
+        auto stats = stream->getDecoder().getDecodeStats();
+        TestResult result = stream->endTest();
+
+        streams.push_back({
+            {"url", result.streamUrl},
+            {"codec", result.codec},
+            {"resolution", {{"width", result.resolutionWidth}, {"height", result.resolutionHeight}}},
+            {"connected", stream->isConnected()},
+            {"frames_decoded", stats.framesDecoded},
+            {"frames_dropped", stats.framesDropped},
+            {"actual_fps", stats.actualFps},
+            {"frames_analyzed", result.framesAnalyzed},
+            {"latency", {
+                {"min_ms", result.statistics.minMs},
+                {"max_ms", result.statistics.maxMs},
+                {"avg_ms", result.statistics.avgMs},
+                {"std_dev_ms", result.statistics.stdDevMs},
+                {"p50_ms", result.statistics.p50Ms},
+                {"p95_ms", result.statistics.p95Ms},
+                {"p99_ms", result.statistics.p99Ms},
+                {"valid_samples", result.statistics.validSamples},
+                {"invalid_samples", result.statistics.invalidSamples}
+            }}
+        });
+    }
+    j["streams"] = streams;
+
+    nlohmann::json scaling = nlohmann::json::array();
+    {
+        std::lock_guard<std::mutex> lock(scalingMutex_);
+        for (const auto& s : scalingSamples_) {
+            scaling.push_back({
+                {"elapsed_sec", s.elapsedSec},
+                {"active_streams", s.activeStreams},
+                {"cpu_percent", s.cpuPercent},
+                {"cpu_per_stream", s.cpuPerStream},
+                {"total_decode_fps", s.totalDecodeFps},
+                {"frames_decoded", s.framesDecoded},
+                {"frames_dropped", s.framesDropped},
+                {"pending_tasks", s.pendingTasks}
+            });
+        }
+    }
+    j["scaling"] = scaling;
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << j.dump(2);
+    return true;
+}
+
+} // namespace latency
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Config.h"
+#include "VideoDecoder.h"
+#include "LatencyMeasurer.h"
+#include "ResultsManager.h"
+#include "TimestampDisplay.h"
+#include "WorkerPool.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace latency {
+
+// One camera: decoder, measurer and results of its own
+class StreamPipeline {
+public:
+    StreamPipeline(const std::string& url, const TimestampDisplay* clock);
+    ~StreamPipeline();
+
+    bool connect(const StreamConfig& baseConfig, WorkerPool* pool);
+    void disconnect();
+    bool isConnected() const { return decoder_->isConnected(); }
+
+    const std::string& getUrl() const { return url_; }
+    VideoDecoder& getDecoder() { return *decoder_; }
+    const VideoDecoder& getDecoder() const { return *decoder_; }
+
+    // Latest measurement and running statistics (thread-safe copies)
+    LatencyMeasurement getLastMeasurement() const;
+    LatencyStatistics getLatencyStatistics() const;
+
+    // Finish the current test and return its result; a new test starts if still connected
+    TestResult endTest();
+
+private:
+    void onFrame(const VideoFrame& frame);
+
+    std::string url_;
+    const TimestampDisplay* clock_;
+    std::unique_ptr<VideoDecoder> decoder_;
+
+    LatencyMeasurer measurer_;
+    ResultsManager results_;
+    LatencyMeasurement lastMeasurement_;
+    mutable std::mutex resultsMutex_;
+};
+
+// Process-wide load at one point in time
+struct ScalingSample {
+    double elapsedSec = 0.0;
+    int activeStreams = 0;
+    double cpuPercent = 0.0;        // Process CPU time / wall time (100% = one core)
+    double cpuPerStream = 0.0;
+    double totalDecodeFps = 0.0;
+    uint64_t framesDecoded = 0;     // Cumulative across streams
+    uint64_t framesDropped = 0;     // Cumulative across streams
+    size_t pendingTasks = 0;        // Worker pool backlog
+};
+
+// Runs N stream pipelines whose decoding shares one bounded worker pool
+class StreamManager {
+public:
+    // workerThreads == 0 picks hardware_concurrency() - 1
+    StreamManager(size_t workerThreads, const TimestampDisplay* clock);
+    ~StreamManager();
+
+    // Read one URL per line ('#' starts a comment)
+    static bool loadStreamList(const std::string& path, std::vector<std::string>& urls);
+
+    void setStreams(const std::vector<std::string>& urls);
+
+    // Connect all streams in parallel; returns the number that connected
+    int connectAll(const StreamConfig& baseConfig);
+    void disconnectAll();
+
+    size_t getStreamCount() const { return streams_.size(); }
+    StreamPipeline& getStream(size_t index) { return *streams_[index]; }
+    int getConnectedCount() const;
+    size_t getWorkerCount() const { return pool_.getThreadCount(); }
+
+    // Take a scaling sample (call about once a second while connected)
+    void sampleScaling();
+    ScalingSample getLatestScaling() const;
+
+    // Per-stream results plus the scaling history as one JSON file
+    bool exportResults(const std::string& filename);
+
+private:
+    static double processCpuSeconds();
+
+    WorkerPool pool_;  // Declared first so it outlives the pipelines using it
+    const TimestampDisplay* clock_;
+    std::vector<std::unique_ptr<StreamPipeline>> streams_;
+
+    std::vector<ScalingSample> scalingSamples_;
+    mutable std::mutex scalingMutex_;
+    std::chrono::steady_clock::time_point runStart_;
+    std::chrono::steady_clock::time_point lastSampleTime_;
+    double lastCpuSeconds_ = 0.0;
+    uint64_t lastFramesDecoded_ = 0;
+};
+
+} // namespace latency
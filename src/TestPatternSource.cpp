@@ -0,0 +1,388 @@
+#include "TestPatternSource.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/opt.h>
+#include <libswscale/swscale.h>
+}
+
+namespace latency {
+
+TestPatternSource::TestPatternSource() = default;
+
+TestPatternSource::~TestPatternSource() {
+    stop();
+}
+
+bool TestPatternSource::start(const TestSourceConfig& config) {
+    stop();
+    config_ = config;
+    lastError_.clear();
+
+    if (config_.width < 320 || config_.height < 240 || config_.fps <= 0) {
+        lastError_ = "Test source needs at least 320x240 and a positive frame rate";
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        framesSent_ = 0;
+        framesLate_ = 0;
+        renderHistogram_.reset();
+        encodeHistogram_.reset();
+    }
+
+    if (!openRenderer() || !openEncoder() || !openOutput()) {
+        cleanup();
+        return false;
+    }
+
+    display_->startTest();
+    running_ = true;
+    thread_ = std::thread(&TestPatternSource::generateThread, this);
+    return true;
+}
+
+void TestPatternSource::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    cleanup();
+}
+
+bool TestPatternSource::openRenderer() {
+    if (TTF_Init() < 0) {
+        lastError_ = "TTF_Init failed: " + std::string(TTF_GetError());
+        return false;
+    }
+    ttfInitialized_ = true;
+
+    // Software renderer on a plain surface works without a window or display
+    surface_ = SDL_CreateRGBSurfaceWithFormat(0, config_.width, config_.height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!surface_) {
+        lastError_ = "Failed to create frame surface: " + std::string(SDL_GetError());
+        return false;
+    }
+
+    renderer_ = SDL_CreateSoftwareRenderer(surface_);
+    if (!renderer_) {
+        lastError_ = "Failed to create software renderer: " + std::string(SDL_GetError());
+        return false;
+    }
+
+    display_ = std::make_unique<TimestampDisplay>();
+    if (!display_->init(renderer_, config_.fontPath, config_.fontSize)) {
+        lastError_ = "Failed to load font: " + config_.fontPath;
+        return false;
+    }
+    return true;
+}
+
+bool TestPatternSource::openEncoder() {
+    // Prefer the low-latency software encoders, then whatever this FFmpeg build has
+    const AVCodec* codec = nullptr;
+    AVPixelFormat pixFmt = AV_PIX_FMT_YUV420P;
+    if (config_.codec == "h264") {
+        codec = avcodec_find_encoder_by_name("libx264");
+        if (!codec) codec = avcodec_find_encoder_by_name("libopenh264");
+        if (!codec) codec = avcodec_find_encoder(AV_CODEC_ID_H264);
+    } else if (config_.codec == "hevc" || config_.codec == "h265") {
+        codec = avcodec_find_encoder_by_name("libx265");
+        if (!codec) codec = avcodec_find_encoder(AV_CODEC_ID_HEVC);
+    } else if (config_.codec == "mjpeg") {
+        codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+        pixFmt = AV_PIX_FMT_YUVJ420P;
+    } else {
+        lastError_ = "Unknown test source codec: " + config_.codec;
+        return false;
+    }
+
+    if (!codec) {
+        lastError_ = "No " + config_.codec + " encoder in this FFmpeg build";
+        return false;
+    }
+    encoderName_ = codec->name;
+
+    encoderCtx_ = avcodec_alloc_context3(codec);
+    if (!encoderCtx_) {
+        lastError_ = "Failed to allocate encoder context";
+        return false;
+    }
+
+    encoderCtx_->width = config_.width;
+    encoderCtx_->height = config_.height;
+    encoderCtx_->pix_fmt = pixFmt;
+    encoderCtx_->time_base = AVRational{1, config_.fps};
+    encoderCtx_->framerate = AVRational{config_.fps, 1};
+    encoderCtx_->gop_size = config_.gop;
+    encoderCtx_->max_b_frames = 0;
+    encoderCtx_->bit_rate = static_cast<int64_t>(config_.bitrateKbps) * 1000;
+
+    // Frame threading and lookahead would add encoder delay that isn't the receiver's
+    encoderCtx_->thread_type = FF_THREAD_SLICE;
+    av_opt_set(encoderCtx_->priv_data, "preset", "ultrafast", 0);
+    av_opt_set(encoderCtx_->priv_data, "tune", "zerolatency", 0);
+
+    int ret = avcodec_open2(encoderCtx_, codec, nullptr);
+    if (ret < 0) {
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        lastError_ = "Failed to open encoder " + encoderName_ + ": " + errBuf;
+        return false;
+    }
+
+    swsCtx_ = sws_getContext(
+        config_.width, config_.height, AV_PIX_FMT_BGRA,  // ARGB8888 in memory on little-endian
+        config_.width, config_.height, pixFmt,
+        SWS_BILINEAR, nullptr, nullptr, nullptr
+    );
+    if (!swsCtx_) {
+        lastError_ = "Failed to initialize scaler";
+        return false;
+    }
+
+    yuvFrame_ = av_frame_alloc();
+    yuvFrame_->format = pixFmt;
+    yuvFrame_->width = config_.width;
+    yuvFrame_->height = config_.height;
+    if (av_frame_get_buffer(yuvFrame_, 0) < 0) {
+        lastError_ = "Failed to allocate frame buffer";
+        return false;
+    }
+    return true;
+}
+
+bool TestPatternSource::openOutput() {
+    bool rtsp = config_.url.find("rtsp://") == 0;
+    bool rtp = config_.url.find("rtp://") == 0;
+    if (!rtsp && !rtp) {
+        lastError_ = "Test source URL must be rtp:// or rtsp://";
+        return false;
+    }
+
+    // An RTSP receiver may still be starting to listen, so retry for a while
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (true) {
+        avformat_alloc_output_context2(&outputCtx_, nullptr, rtsp ? "rtsp" : "rtp", config_.url.c_str());
+        if (!outputCtx_) {
+            lastError_ = "Failed to create output for " + config_.url;
+            return false;
+        }
+
+        outputStream_ = avformat_new_stream(outputCtx_, nullptr);
+        avcodec_parameters_from_context(outputStream_->codecpar, encoderCtx_);
+        outputStream_->time_base = encoderCtx_->time_base;
+
+        AVDictionary* options = nullptr;
+        if (rtsp) {
+            // TCP interleaving: no loss on loopback, and no UDP ports to negotiate
+            av_dict_set(&options, "rtsp_transport", "tcp", 0);
+        } else if (!(outputCtx_->oformat->flags & AVFMT_NOFILE)) {
+            int ret = avio_open(&outputCtx_->pb, config_.url.c_str(), AVIO_FLAG_WRITE);
+            if (ret < 0) {
+                char errBuf[256];
+                av_strerror(ret, errBuf, sizeof(errBuf));
+                lastError_ = "Failed to open " + config_.url + ": " + errBuf;
+                avformat_free_context(outputCtx_);
+                outputCtx_ = nullptr;
+                return false;
+            }
+        }
+
+        int ret = avformat_write_header(outputCtx_, &options);
+        av_dict_free(&options);
+        if (ret >= 0) break;
+
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        lastError_ = "Failed to start stream to " + config_.url + ": " + errBuf;
+
+        if (outputCtx_->pb && !(outputCtx_->oformat->flags & AVFMT_NOFILE)) {
+            avio_closep(&outputCtx_->pb);
+        }
+        avformat_free_context(outputCtx_);
+        outputCtx_ = nullptr;
+        outputStream_ = nullptr;
+
+        if (!rtsp || std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    if (rtp) {
+        char sdp[4096];
+        if (av_sdp_create(&outputCtx_, 1, sdp, sizeof(sdp)) == 0) {
+            std::ofstream file(config_.sdpPath);
+            if (file.is_open()) {
+                file << sdp;
+            } else {
+                std::cerr << "Failed to write " << config_.sdpPath << std::endl;
+            }
+        }
+    }
+
+    lastError_.clear();
+    return true;
+}
+
+void TestPatternSource::generateThread() {
+    using clock = std::chrono::steady_clock;
+    const auto frameInterval = std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(1.0 / config_.fps));
+    auto nextFrame = clock::now();
+    int64_t frameIndex = 0;
+
+    while (running_) {
+        std::this_thread::sleep_until(nextFrame);
+        bool late = clock::now() - nextFrame > frameInterval / 2;
+
+        // The pattern shows the moment this frame was drawn: its capture time
+        auto renderStart = clock::now();
+        if (!drawFrame(display_->getCurrentTimestamp())) {
+            break;
+        }
+        yuvFrame_->pts = frameIndex++;
+        auto renderEnd = clock::now();
+
+        bool sent = encodeAndSend(yuvFrame_);
+        auto encodeEnd = clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            renderHistogram_.record(std::chrono::duration<double, std::micro>(renderEnd - renderStart).count());
+            encodeHistogram_.record(std::chrono::duration<double, std::micro>(encodeEnd - renderEnd).count());
+            framesSent_++;
+            if (late) framesLate_++;
+        }
+
+        if (!sent) {
+            break;
+        }
+
+        // Keep the schedule, but don't burst to catch up after a stall
+        nextFrame += frameInterval;
+        if (clock::now() > nextFrame + frameInterval) {
+            nextFrame = clock::now();
+        }
+    }
+
+    running_ = false;
+}
+
+bool TestPatternSource::drawFrame(uint32_t timestamp) {
+    SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 255);
+    SDL_RenderClear(renderer_);
+
+    // LatencyMeasurer looks for patterns up to 900 px wide, so keep the panel
+    // camera-sized and centred rather than stretched across large frames
+    int panelWidth = std::min(config_.width, 640);
+    int panelHeight = std::min(config_.height, 480);
+    display_->renderAt((config_.width - panelWidth) / 2, (config_.height - panelHeight) / 2,
+                       panelWidth, panelHeight, timestamp);
+
+    if (av_frame_make_writable(yuvFrame_) < 0) {
+        lastError_ = "Frame buffer not writable";
+        return false;
+    }
+
+    const uint8_t* srcData[1] = { static_cast<const uint8_t*>(surface_->pixels) };
+    int srcLinesize[1] = { surface_->pitch };
+    sws_scale(swsCtx_, srcData, srcLinesize, 0, config_.height, yuvFrame_->data, yuvFrame_->linesize);
+    return true;
+}
+
+bool TestPatternSource::encodeAndSend(AVFrame* frame) {
+    int ret = avcodec_send_frame(encoderCtx_, frame);
+    if (ret < 0) {
+        lastError_ = "Encoder rejected frame";
+        return false;
+    }
+
+    AVPacket* packet = av_packet_alloc();
+    while (ret >= 0) {
+        ret = avcodec_receive_packet(encoderCtx_, packet);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            break;
+        }
+        if (ret < 0) {
+            lastError_ = "Encoding failed";
+            av_packet_free(&packet);
+            return false;
+        }
+
+        av_packet_rescale_ts(packet, encoderCtx_->time_base, outputStream_->time_base);
+        packet->stream_index = outputStream_->index;
+
+        // Single stream, so write straight through without interleaving delay
+        ret = av_write_frame(outputCtx_, packet);
+        av_packet_unref(packet);
+        if (ret < 0) {
+            char errBuf[256];
+            av_strerror(ret, errBuf, sizeof(errBuf));
+            lastError_ = "Failed to send packet: " + std::string(errBuf);
+            av_packet_free(&packet);
+            return false;
+        }
+    }
+
+    av_packet_free(&packet);
+    return true;
+}
+
+TestSourceStats TestPatternSource::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    TestSourceStats stats;
+    stats.framesSent = framesSent_;
+    stats.framesLate = framesLate_;
+    stats.renderUs = renderHistogram_.getPercentiles();
+    stats.encodeUs = encodeHistogram_.getPercentiles();
+    return stats;
+}
+
+void TestPatternSource::cleanup() {
+    if (outputCtx_) {
+        av_write_trailer(outputCtx_);
+        if (outputCtx_->pb && !(outputCtx_->oformat->flags & AVFMT_NOFILE)) {
+            avio_closep(&outputCtx_->pb);
+        }
+        avformat_free_context(outputCtx_);
+        outputCtx_ = nullptr;
+        outputStream_ = nullptr;
+    }
+
+    if (yuvFrame_) {
+        av_frame_free(&yuvFrame_);
+        yuvFrame_ = nullptr;
+    }
+    if (swsCtx_) {
+        sws_freeContext(swsCtx_);
+        swsCtx_ = nullptr;
+    }
+    if (encoderCtx_) {
+        avcodec_free_context(&encoderCtx_);
+        encoderCtx_ = nullptr;
+    }
+
+    display_.reset();
+    if (renderer_) {
+        SDL_DestroyRenderer(renderer_);
+        renderer_ = nullptr;
+    }
+    if (surface_) {
+        SDL_FreeSurface(surface_);
+        surface_ = nullptr;
+    }
+    if (ttfInitialized_) {
+        TTF_Quit();
+        ttfInitialized_ = false;
+    }
+}
+
+} // namespace latency
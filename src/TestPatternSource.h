@@ -0,0 +1,99 @@
+#pragma once
+
+#include "LatencyHistogram.h"
+#include "TimestampDisplay.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Forward declarations for FFmpeg types
+struct AVFormatContext;
+struct AVCodecContext;
+struct AVFrame;
+struct AVStream;
+struct SwsContext;
+
+namespace latency {
+
+struct TestSourceConfig {
+    // rtp://host:port, or rtsp://host:port/path to publish (ANNOUNCE/RECORD)
+    // to a receiver that is listening
+    std::string url = "rtp://127.0.0.1:5004";
+    std::string sdpPath = "test_source.sdp";  // RTP only: session description for receivers
+    std::string codec = "h264";               // h264, hevc or mjpeg
+    int width = 1280;
+    int height = 720;
+    int fps = 30;
+    int gop = 30;
+    int bitrateKbps = 4000;
+    std::string fontPath = "resources/fonts/RobotoMono-Bold.ttf";
+    int fontSize = 36;
+};
+
+struct TestSourceStats {
+    uint64_t framesSent = 0;
+    uint64_t framesLate = 0;        // Started after their slot (previous frame overran)
+    LatencyPercentiles renderUs;    // Draw the clock + convert to YUV
+    LatencyPercentiles encodeUs;    // Encode, packetize and send
+};
+
+// Synthetic camera: draws the TimestampDisplay panel offscreen at a fixed
+// frame rate, encodes it with libavcodec and streams it over RTP or RTSP.
+// Each frame shows the source clock at the moment it was drawn, so a
+// receiver comparing against the same clock measures the exact latency of
+// encode + network + its own pipeline. Needs no display or window.
+class TestPatternSource {
+public:
+    TestPatternSource();
+    ~TestPatternSource();
+
+    bool start(const TestSourceConfig& config);
+    void stop();
+    bool isRunning() const { return running_; }
+
+    // Clock drawn into the frames
+    uint32_t getCurrentTimestamp() const { return display_ ? display_->getCurrentTimestamp() : 0; }
+
+    TestSourceStats getStats() const;
+    std::string getEncoderName() const { return encoderName_; }
+    std::string getLastError() const { return lastError_; }
+
+private:
+    bool openRenderer();
+    bool openEncoder();
+    bool openOutput();
+    void generateThread();
+    bool drawFrame(uint32_t timestamp);
+    bool encodeAndSend(AVFrame* frame);
+    void cleanup();
+
+    TestSourceConfig config_;
+    std::string encoderName_;
+    std::string lastError_;
+
+    // Offscreen drawing
+    SDL_Surface* surface_ = nullptr;
+    SDL_Renderer* renderer_ = nullptr;
+    std::unique_ptr<TimestampDisplay> display_;
+    bool ttfInitialized_ = false;
+
+    // Encoding and output
+    AVCodecContext* encoderCtx_ = nullptr;
+    AVFormatContext* outputCtx_ = nullptr;
+    AVStream* outputStream_ = nullptr;
+    SwsContext* swsCtx_ = nullptr;
+    AVFrame* yuvFrame_ = nullptr;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    mutable std::mutex statsMutex_;
+    uint64_t framesSent_ = 0;
+    uint64_t framesLate_ = 0;
+    LatencyHistogram renderHistogram_;
+    LatencyHistogram encodeHistogram_;
+};
+
+} // namespace latency
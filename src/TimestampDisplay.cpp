@@ -1,4 +1,6 @@
 #include "TimestampDisplay.h"
+#include "TimestampPattern.h"
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 
@@ -15,7 +17,7 @@ TimestampDisplay::~TimestampDisplay() {
     }
 }
 
-bool TimestampDisplay::init(SDL_Renderer* renderer, const std::string& fontPath, int fontSize) {
+bool TimestampDisplay::init(SDL_Renderer* renderer, const std::string& fontPath, int fontSize, bool textAtlas) {
     renderer_ = renderer;
 
     // Load regular font
@@ -46,12 +48,21 @@ bool TimestampDisplay::init(SDL_Renderer* renderer, const std::string& fontPath,
         }
     }
 
+    // Text is drawn every frame on the clock's render path: build the glyphs once
+    text_.init(renderer_, font_, textAtlas);
+    clockText_.init(renderer_, largeFont_, textAtlas);
+
     return font_ != nullptr;
 }
 
 void TimestampDisplay::startTest() {
     testStartTime_ = std::chrono::steady_clock::now();
     running_ = true;
+
+    // Logged edges belong to the previous clock
+    std::lock_guard<std::mutex> lock(flashMutex_);
+    flashEdges_.clear();
+    lastFlashEdge_ = -1;
 }
 
 void TimestampDisplay::stopTest() {
@@ -66,7 +77,56 @@ uint32_t TimestampDisplay::getCurrentTimestamp() const {
     return static_cast<uint32_t>(elapsed.count());
 }
 
-void TimestampDisplay::render(int x, int y, int width, int height, bool paused, uint32_t frozenTimestamp) {
+uint32_t TimestampDisplay::getTimestampAt(std::chrono::steady_clock::time_point time) const {
+    if (!running_ || time < testStartTime_) return 0;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(time - testStartTime_);
+    return static_cast<uint32_t>(elapsed.count());
+}
+
+void TimestampDisplay::setPatternRows(int rows) {
+    patternRows_ = std::clamp(rows, 1, MAX_PATTERN_ROWS);
+}
+
+int TimestampDisplay::patternOffsetY(int row, int height) const {
+    if (row == 0) {
+        return PATTERN_OFFSET_Y;
+    }
+    if (row == 1) {
+        return height - PATTERN_BOTTOM_OFFSET;
+    }
+    return (height - PATTERN_HEIGHT) / 2;
+}
+
+void TimestampDisplay::render(int x, int y, int width, int height, bool paused, uint32_t frozenTimestamp,
+                              const PatternRowTimes& rowShownAt) {
+    // Use frozen timestamp when paused, otherwise the time each row will be seen
+    std::array<uint32_t, MAX_PATTERN_ROWS> rowTimestamps{};
+    for (int row = 0; row < MAX_PATTERN_ROWS; row++) {
+        if (paused) {
+            rowTimestamps[row] = frozenTimestamp;
+        } else {
+            rowTimestamps[row] = rowShownAt[row] == std::chrono::steady_clock::time_point{}
+                ? getCurrentTimestamp() : getTimestampAt(rowShownAt[row]);
+        }
+    }
+    renderPanel(x, y, width, height, rowTimestamps, paused);
+}
+
+void TimestampDisplay::renderAt(int x, int y, int width, int height, uint32_t timestamp, bool paused) {
+    std::array<uint32_t, MAX_PATTERN_ROWS> rowTimestamps;
+    rowTimestamps.fill(timestamp);
+    renderPanel(x, y, width, height, rowTimestamps, paused);
+}
+
+void TimestampDisplay::renderPanel(int x, int y, int width, int height,
+                                   const std::array<uint32_t, MAX_PATTERN_ROWS>& rowTimestamps, bool paused) {
+    const uint32_t timestamp = rowTimestamps[0];
+    if (flashMode_ && running_) {
+        renderFlash(x, y, width, height, timestamp, paused);
+        return;
+    }
+
     // White background for faster camera shutter
     SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 255);
     SDL_Rect bgRect = {x, y, width, height};
@@ -76,62 +136,36 @@ void TimestampDisplay::render(int x, int y, int width, int height, bool paused,
     SDL_SetRenderDrawColor(renderer_, 60, 60, 60, 255);
     SDL_RenderDrawRect(renderer_, &bgRect);
 
-    // Use frozen timestamp when paused, otherwise current timestamp
-    uint32_t timestamp = paused ? frozenTimestamp : getCurrentTimestamp();
     int centerX = x + width / 2;
 
     // Title at top - dark text on white background
-    if (font_) {
-        SDL_Color titleColor = running_ ? SDL_Color{0, 120, 60, 255} : SDL_Color{100, 100, 100, 255};
-        const char* title = paused ? "PAUSED" : (running_ ? "CLOCK RUNNING" : "WAITING FOR CONNECTION");
-        SDL_Surface* surface = TTF_RenderText_Blended(font_, title, titleColor);
-        if (surface) {
-            SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, surface);
-            if (texture) {
-                SDL_Rect dstRect = {centerX - surface->w / 2, y + 15, surface->w, surface->h};
-                SDL_RenderCopy(renderer_, texture, nullptr, &dstRect);
-                SDL_DestroyTexture(texture);
-            }
-            SDL_FreeSurface(surface);
-        }
+    SDL_Color titleColor = running_ ? SDL_Color{0, 120, 60, 255} : SDL_Color{100, 100, 100, 255};
+    const char* title = paused ? "PAUSED" : (running_ ? "CLOCK RUNNING" : "WAITING FOR CONNECTION");
+    text_.drawCentered(title, centerX, y + 15, titleColor);
+
+    // Machine-readable pattern below the title, and its copies further down
+    for (int row = 0; row < patternRows_; row++) {
+        renderPattern(centerX, y + patternOffsetY(row, height), width - 40, rowTimestamps[row]);
     }
 
-    // Clock display - centered vertically
+    // Clock display - centered vertically, or between the first two rows
+    // when a pattern row takes the middle
     int clockY = y + height / 2 - 60;
+    if (patternRows_ > 2) {
+        clockY = y + (PATTERN_OFFSET_Y + PATTERN_HEIGHT + patternOffsetY(2, height)) / 2 - 75;
+    }
     renderLargeClock(centerX, clockY, timestamp);
     renderMilliseconds(centerX, clockY + 70, timestamp);
 
     // Instructions at bottom - dark text
-    if (font_) {
-        SDL_Color darkBlue = {0, 80, 150, 255};
-        SDL_Surface* surface = TTF_RenderText_Blended(font_, "Point camera here", darkBlue);
-        if (surface) {
-            SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, surface);
-            if (texture) {
-                SDL_Rect dstRect = {centerX - surface->w / 2, y + height - 55, surface->w, surface->h};
-                SDL_RenderCopy(renderer_, texture, nullptr, &dstRect);
-                SDL_DestroyTexture(texture);
-            }
-            SDL_FreeSurface(surface);
-        }
+    SDL_Color darkBlue = {0, 80, 150, 255};
+    text_.drawCentered("Point camera here", centerX, y + height - 55, darkBlue);
 
-        SDL_Color darkOrange = {180, 100, 0, 255};
-        surface = TTF_RenderText_Blended(font_, "[SPACE] freeze", darkOrange);
-        if (surface) {
-            SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, surface);
-            if (texture) {
-                SDL_Rect dstRect = {centerX - surface->w / 2, y + height - 30, surface->w, surface->h};
-                SDL_RenderCopy(renderer_, texture, nullptr, &dstRect);
-                SDL_DestroyTexture(texture);
-            }
-            SDL_FreeSurface(surface);
-        }
-    }
+    SDL_Color darkOrange = {180, 100, 0, 255};
+    text_.drawCentered("[SPACE] freeze", centerX, y + height - 30, darkOrange);
 }
 
 void TimestampDisplay::renderLargeClock(int centerX, int y, uint32_t timestamp) {
-    if (!largeFont_) return;
-
     // Format: MM:SS
     uint32_t totalSec = timestamp / 1000;
     uint32_t sec = totalSec % 60;
@@ -142,26 +176,10 @@ void TimestampDisplay::renderLargeClock(int centerX, int y, uint32_t timestamp)
 
     // Dark text on white background
     SDL_Color black = {0, 0, 0, 255};
-    SDL_Surface* surface = TTF_RenderText_Blended(largeFont_, oss.str().c_str(), black);
-    if (!surface) return;
-
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, surface);
-    if (texture) {
-        SDL_Rect dstRect = {
-            centerX - surface->w / 2,
-            y,
-            surface->w,
-            surface->h
-        };
-        SDL_RenderCopy(renderer_, texture, nullptr, &dstRect);
-        SDL_DestroyTexture(texture);
-    }
-    SDL_FreeSurface(surface);
+    clockText_.drawCentered(oss.str(), centerX, y, black);
 }
 
 void TimestampDisplay::renderMilliseconds(int centerX, int y, uint32_t timestamp) {
-    if (!largeFont_) return;
-
     // Show centiseconds (10ms resolution) - more readable than full milliseconds
     uint32_t cs = (timestamp % 1000) / 10;
 
@@ -170,21 +188,78 @@ void TimestampDisplay::renderMilliseconds(int centerX, int y, uint32_t timestamp
 
     // Dark green for visibility on white background
     SDL_Color darkGreen = {0, 100, 50, 255};
-    SDL_Surface* surface = TTF_RenderText_Blended(largeFont_, oss.str().c_str(), darkGreen);
-    if (!surface) return;
-
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, surface);
-    if (texture) {
-        SDL_Rect dstRect = {
-            centerX - surface->w / 2,
-            y,
-            surface->w,
-            surface->h
-        };
-        SDL_RenderCopy(renderer_, texture, nullptr, &dstRect);
-        SDL_DestroyTexture(texture);
+    clockText_.drawCentered(oss.str(), centerX, y, darkGreen);
+}
+
+void TimestampDisplay::renderPattern(int centerX, int y, int maxWidth, uint32_t timestamp) {
+    const int bitWidth = std::max(4, maxWidth / PATTERN_TOTAL_UNITS);
+    const int patternWidth = bitWidth * PATTERN_TOTAL_UNITS;
+    const int patternX = centerX - patternWidth / 2;
+
+    // Green marker border used by LatencyMeasurer to locate the pattern
+    SDL_SetRenderDrawColor(renderer_, 0, 200, 0, 255);
+    SDL_Rect greenRect = {
+        patternX - PATTERN_GREEN_BORDER,
+        y - PATTERN_GREEN_BORDER,
+        patternWidth + PATTERN_GREEN_BORDER * 2,
+        PATTERN_HEIGHT + PATTERN_GREEN_BORDER * 2
+    };
+    SDL_RenderFillRect(renderer_, &greenRect);
+
+    // White pattern area (covers the quiet-zone border and all 1 bits)
+    SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 255);
+    SDL_Rect patternRect = {patternX, y, patternWidth, PATTERN_HEIGHT};
+    SDL_RenderFillRect(renderer_, &patternRect);
+
+    // Black cells: even sync bits and zero bits of the Gray-coded timestamp and its CRC
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 255);
+    int unit = PATTERN_BORDER_BITS;
+    auto fillUnit = [&](int u) {
+        SDL_Rect cell = {patternX + u * bitWidth, y, bitWidth, PATTERN_HEIGHT};
+        SDL_RenderFillRect(renderer_, &cell);
+    };
+
+    for (int i = 0; i < SYNC_BITS; i++, unit++) {
+        if (i % 2 == 0) fillUnit(unit);
+    }
+    const uint32_t word = encodePatternWord(timestamp);
+    for (int bit = 0; bit < PATTERN_DATA_BITS; bit++, unit++) {
+        if (!(word & (1U << (PATTERN_DATA_BITS - 1 - bit)))) fillUnit(unit);
+    }
+    for (int i = 0; i < SYNC_BITS; i++, unit++) {
+        if (i % 2 == 0) fillUnit(unit);
+    }
+}
+
+void TimestampDisplay::renderFlash(int x, int y, int width, int height, uint32_t timestamp, bool paused) {
+    const int edge = flashEdgeAt(timestamp);
+    const uint8_t level = edge % 2 == 0 ? 255 : 0;
+    SDL_SetRenderDrawColor(renderer_, level, level, level, 255);
+    SDL_Rect rect = {x, y, width, height};
+    SDL_RenderFillRect(renderer_, &rect);
+
+    // A frozen panel shows no new edges
+    if (paused) return;
+
+    std::lock_guard<std::mutex> lock(flashMutex_);
+    if (edge != lastFlashEdge_) {
+        flashEdges_.push_back(FlashEdge{timestamp, edge});
+        if (flashEdges_.size() > FLASH_EDGE_LOG) {
+            flashEdges_.pop_front();
+        }
+        lastFlashEdge_ = edge;
+    }
+}
+
+bool TimestampDisplay::findFlashEdge(int edge, uint32_t before, uint32_t& timestamp) const {
+    std::lock_guard<std::mutex> lock(flashMutex_);
+    for (auto it = flashEdges_.rbegin(); it != flashEdges_.rend(); ++it) {
+        if (it->edge == edge && it->timestamp <= before) {
+            timestamp = it->timestamp;
+            return true;
+        }
     }
-    SDL_FreeSurface(surface);
+    return false;
 }
 
 } // namespace latency
@@ -1,39 +1,100 @@
 #pragma once
 
+#include "GlyphAtlas.h"
+#include "TimestampPattern.h"
 #include <SDL.h>
 #include <SDL_ttf.h>
+#include <array>
 #include <cstdint>
+#include <atomic>
 #include <chrono>
+#include <deque>
+#include <mutex>
 #include <string>
 
 namespace latency {
 
 class TimestampDisplay {
 public:
+    static constexpr int PATTERN_OFFSET_Y = 60;         // First pattern's top, below the panel's top edge
+    static constexpr int PATTERN_BOTTOM_OFFSET = 110;   // Last pattern's top, above the panel's bottom edge
+
+    // When each pattern row is expected on screen (default: now)
+    using PatternRowTimes = std::array<std::chrono::steady_clock::time_point, MAX_PATTERN_ROWS>;
+
     TimestampDisplay();
     ~TimestampDisplay();
 
-    bool init(SDL_Renderer* renderer, const std::string& fontPath, int fontSize);
-    void render(int x, int y, int width, int height, bool paused = false, uint32_t frozenTimestamp = 0);
+    // textAtlas = false draws text through SDL_ttf per string (for comparison)
+    bool init(SDL_Renderer* renderer, const std::string& fontPath, int fontSize, bool textAtlas = true);
+    // rowShownAt: when each pattern row is expected on screen (default: now,
+    // i.e. render time). The clock digits show the first row's time.
+    void render(int x, int y, int width, int height, bool paused = false, uint32_t frozenTimestamp = 0,
+                const PatternRowTimes& rowShownAt = {});
+
+    // Render the panel showing a given timestamp (used to draw offscreen frames)
+    void renderAt(int x, int y, int width, int height, uint32_t timestamp, bool paused = false);
 
     // Get current timestamp (milliseconds since test start)
     uint32_t getCurrentTimestamp() const;
 
+    // Timestamp the clock will read at a given time (0 before the test started)
+    uint32_t getTimestampAt(std::chrono::steady_clock::time_point time) const;
+
     // Start/reset the timestamp counter
     void startTest();
     void stopTest();
     bool isRunning() const { return running_; }
 
+    // Font of the large MM:SS and .cc digits (null if none loaded)
+    TTF_Font* getClockFont() const { return largeFont_; }
+
+    // Copies of the pattern down the panel (1 to MAX_PATTERN_ROWS): top,
+    // then bottom, then middle
+    void setPatternRows(int rows);
+    int getPatternRows() const { return patternRows_; }
+
+    // Top of a pattern row below the panel's top edge, for a panel this tall
+    int patternOffsetY(int row, int height) const;
+
+    // Flash mode: the whole panel goes black/white on the FLASH_INTERVALS_MS
+    // cycle instead of showing the clock and pattern
+    void setFlashMode(bool enabled) { flashMode_ = enabled; }
+    bool isFlashMode() const { return flashMode_; }
+
+    // Timestamp of the first drawn frame showing a flash edge (index in the
+    // cycle), most recent at or before a timestamp. False if none is logged.
+    bool findFlashEdge(int edge, uint32_t before, uint32_t& timestamp) const;
+
 private:
     void renderLargeClock(int centerX, int y, uint32_t timestamp);
     void renderMilliseconds(int centerX, int y, uint32_t timestamp);
+    void renderPattern(int centerX, int y, int maxWidth, uint32_t timestamp);
+    void renderPanel(int x, int y, int width, int height, const std::array<uint32_t, MAX_PATTERN_ROWS>& rowTimestamps,
+                     bool paused);
+    void renderFlash(int x, int y, int width, int height, uint32_t timestamp, bool paused);
+
+    struct FlashEdge {
+        uint32_t timestamp;
+        int edge;
+    };
+    static constexpr size_t FLASH_EDGE_LOG = 64;  // Well over a cycle's worth
 
     SDL_Renderer* renderer_ = nullptr;
     TTF_Font* font_ = nullptr;
     TTF_Font* largeFont_ = nullptr;
+    GlyphAtlas text_;                   // Title and instructions
+    GlyphAtlas clockText_;              // Large clock digits
 
     std::chrono::steady_clock::time_point testStartTime_;
-    bool running_ = false;
+    std::atomic<bool> running_{false};  // Read by measurement threads
+
+    int patternRows_ = 1;
+
+    std::atomic<bool> flashMode_{false};
+    mutable std::mutex flashMutex_;     // Edges are looked up from the measuring thread
+    std::deque<FlashEdge> flashEdges_;
+    int lastFlashEdge_ = -1;            // Edge the last drawn frame showed
 };
 
 } // namespace latency
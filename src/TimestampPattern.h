@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+
+namespace latency {
+
+// Layout of the binary timestamp pattern drawn by TimestampDisplay and read
+// back by LatencyMeasurer. Everything is measured in bit widths so the
+// decoder works at whatever scale the camera sees the pattern.
+//
+//   [green][border][sync][timestamp bits][CRC bits][sync][border][green]
+//
+// Sync bits alternate starting with black; data bits are white for 1, MSB
+// first. The timestamp is Gray-coded: when the camera's exposure spans a
+// display update, only the bits that changed are ambiguous, and for one
+// refresh step those are a few low bits and at most one high bit (plain
+// binary can flip every bit at once). The CRC over the timestamp rejects
+// reads that match neither the old nor the new value.
+constexpr int PATTERN_BITS = 24;         // Milliseconds since clock start (~4.6 h), Gray-coded
+constexpr int PATTERN_CRC_BITS = 8;      // CRC-8 of the (binary) timestamp
+constexpr int PATTERN_DATA_BITS = PATTERN_BITS + PATTERN_CRC_BITS;
+constexpr int SYNC_BITS = 4;
+constexpr int PATTERN_BORDER_BITS = 1;   // White quiet zone inside the green border
+constexpr int PATTERN_TOTAL_UNITS = PATTERN_BORDER_BITS * 2 + SYNC_BITS * 2 + PATTERN_DATA_BITS;
+
+constexpr int PATTERN_HEIGHT = 40;       // Display pixels
+constexpr int PATTERN_GREEN_BORDER = 4;  // Display pixels
+
+// Copies of the pattern down the panel (top, middle, bottom), each showing
+// the time its own row is scanned out. Rows a camera reads at different
+// times then read differently: that is its rolling-shutter readout.
+constexpr int MAX_PATTERN_ROWS = 3;
+
+// Flash mode: the whole panel toggles black/white instead of showing the
+// pattern. Edges follow this cycle of intervals, white first at timestamp 0.
+// The intervals are all different and at least 40 ms apart, so the time
+// since the previous edge tells the reader which edge of the cycle it saw.
+constexpr uint32_t FLASH_INTERVALS_MS[] = {300, 540, 380, 620, 340, 580, 420, 660};
+constexpr int FLASH_EDGES_PER_CYCLE = sizeof(FLASH_INTERVALS_MS) / sizeof(FLASH_INTERVALS_MS[0]);
+constexpr uint32_t FLASH_INTERVAL_TOLERANCE_MS = 18;
+
+constexpr uint32_t flashCycleMs() {
+    uint32_t total = 0;
+    for (uint32_t interval : FLASH_INTERVALS_MS) total += interval;
+    return total;
+}
+
+// Edge index in the cycle at or before a timestamp; even edges turn the panel white
+constexpr int flashEdgeAt(uint32_t timestamp) {
+    uint32_t offset = timestamp % flashCycleMs();
+    int edge = 0;
+    while (offset >= FLASH_INTERVALS_MS[edge]) {
+        offset -= FLASH_INTERVALS_MS[edge];
+        edge++;
+    }
+    return edge;
+}
+
+// Interval that ends at an edge
+constexpr uint32_t flashIntervalBefore(int edge) {
+    return FLASH_INTERVALS_MS[(edge + FLASH_EDGES_PER_CYCLE - 1) % FLASH_EDGES_PER_CYCLE];
+}
+
+static_assert(FLASH_EDGES_PER_CYCLE % 2 == 0, "Flash edges must alternate white/black across cycles");
+
+constexpr uint32_t PATTERN_TIMESTAMP_MASK = (1U << PATTERN_BITS) - 1;
+
+constexpr uint32_t toGrayCode(uint32_t value) {
+    return value ^ (value >> 1);
+}
+
+constexpr uint32_t fromGrayCode(uint32_t gray) {
+    for (uint32_t shift = 1; shift < 32; shift <<= 1) {
+        gray ^= gray >> shift;
+    }
+    return gray;
+}
+
+// CRC-8 (polynomial 0x07) of the timestamp, MSB first. The 0xFF start
+// value keeps an all-black pattern from reading as a valid timestamp 0.
+constexpr uint32_t patternCrc(uint32_t timestamp) {
+    uint32_t crc = 0xFF;
+    for (int bit = PATTERN_BITS - 1; bit >= 0; bit--) {
+        uint32_t in = (timestamp >> bit) & 1U;
+        uint32_t top = (crc >> 7) & 1U;
+        crc = (crc << 1) & 0xFF;
+        if (in ^ top) crc ^= 0x07;
+    }
+    return crc;
+}
+
+// The PATTERN_DATA_BITS drawn for a timestamp (only its low PATTERN_BITS are kept)
+constexpr uint32_t encodePatternWord(uint32_t timestamp) {
+    timestamp &= PATTERN_TIMESTAMP_MASK;
+    return (toGrayCode(timestamp) << PATTERN_CRC_BITS) | patternCrc(timestamp);
+}
+
+// False if the word's CRC doesn't match its timestamp
+constexpr bool decodePatternWord(uint32_t word, uint32_t& timestamp) {
+    uint32_t value = fromGrayCode(word >> PATTERN_CRC_BITS) & PATTERN_TIMESTAMP_MASK;
+    if (patternCrc(value) != (word & ((1U << PATTERN_CRC_BITS) - 1))) return false;
+    timestamp = value;
+    return true;
+}
+
+} // namespace latency
@@ -0,0 +1,226 @@
+#include "UdpBatchReceiver.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace latency {
+
+#ifdef __linux__
+struct UdpBatchReceiver::Messages {
+    std::vector<mmsghdr> headers;
+    std::vector<iovec> iovecs;
+};
+#else
+struct UdpBatchReceiver::Messages {};
+#endif
+
+UdpBatchReceiver::UdpBatchReceiver() = default;
+
+UdpBatchReceiver::~UdpBatchReceiver() {
+    close();
+}
+
+#ifdef __linux__
+
+namespace {
+
+// SO_BUSY_POLL and SO_RXQ_OVFL are missing from older libc headers
+#ifndef SO_BUSY_POLL
+constexpr int SO_BUSY_POLL = 46;
+#endif
+#ifndef SO_RXQ_OVFL
+constexpr int SO_RXQ_OVFL = 40;
+#endif
+
+constexpr size_t CONTROL_SPACE = CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(uint32_t));
+
+int64_t wallClockNs() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+} // namespace
+
+bool UdpBatchReceiver::open(const std::string& address, int port, const UdpReceiveConfig& config) {
+    close();
+    lastError_.clear();
+    warning_.clear();
+    stats_ = UdpReceiveStats{};
+
+    in_addr group{};
+    bool multicast = false;
+    if (!address.empty() && address != "@" && inet_pton(AF_INET, address.c_str(), &group) == 1) {
+        multicast = IN_MULTICAST(ntohl(group.s_addr));
+    }
+
+    socket_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (socket_ == -1) {
+        lastError_ = "Failed to create UDP socket: " + std::string(std::strerror(errno));
+        return false;
+    }
+
+    int on = 1;
+    setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+    setsockopt(socket_, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on));
+
+    // SO_RCVBUFFORCE ignores net.core.rmem_max but needs CAP_NET_ADMIN
+    int requested = std::max(64, config.socketBufferKB) * 1024;
+    if (setsockopt(socket_, SOL_SOCKET, SO_RCVBUFFORCE, &requested, sizeof(requested)) != 0) {
+        setsockopt(socket_, SOL_SOCKET, SO_RCVBUF, &requested, sizeof(requested));
+    }
+    int granted = 0;
+    socklen_t grantedLen = sizeof(granted);
+    getsockopt(socket_, SOL_SOCKET, SO_RCVBUF, &granted, &grantedLen);
+    stats_.socketBufferBytes = granted / 2;  // The kernel reports double, for bookkeeping
+    if (stats_.socketBufferBytes < requested) {
+        warning_ = "Receive buffer capped at " + std::to_string(stats_.socketBufferBytes / 1024) +
+                   " KB (raise net.core.rmem_max)";
+    }
+
+    if (config.busyPollUs > 0) {
+        int busyPollUs = config.busyPollUs;
+        if (setsockopt(socket_, SOL_SOCKET, SO_BUSY_POLL, &busyPollUs, sizeof(busyPollUs)) != 0) {
+            if (!warning_.empty()) warning_ += "; ";
+            warning_ += "Busy polling unavailable: " + std::string(std::strerror(errno));
+        }
+    }
+
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(static_cast<uint16_t>(port));
+    local.sin_addr.s_addr = multicast ? group.s_addr : htonl(INADDR_ANY);
+    if (bind(socket_, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+        lastError_ = "Cannot bind UDP port " + std::to_string(port) + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+
+    if (multicast) {
+        ip_mreq membership{};
+        membership.imr_multiaddr = group;
+        membership.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (setsockopt(socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0) {
+            lastError_ = "Cannot join multicast group " + address + ": " + std::strerror(errno);
+            close();
+            return false;
+        }
+    }
+
+    timeoutMs_ = -1;
+    batchSize_ = std::max(1, config.batchSize);
+    buffers_.assign(static_cast<size_t>(batchSize_) * MAX_DATAGRAM, 0);
+    sizes_.assign(batchSize_, 0);
+    arrivalNs_.assign(batchSize_, 0);
+    control_.assign(static_cast<size_t>(batchSize_) * CONTROL_SPACE, 0);
+
+    messages_ = std::make_unique<Messages>();
+    messages_->headers.resize(batchSize_);
+    messages_->iovecs.resize(batchSize_);
+    for (int i = 0; i < batchSize_; i++) {
+        messages_->iovecs[i].iov_base = buffers_.data() + static_cast<size_t>(i) * MAX_DATAGRAM;
+        messages_->iovecs[i].iov_len = MAX_DATAGRAM;
+    }
+    return true;
+}
+
+void UdpBatchReceiver::close() {
+    if (socket_ != -1) {
+        ::close(socket_);
+        socket_ = -1;
+    }
+}
+
+int UdpBatchReceiver::receive(int timeoutMs) {
+    if (socket_ == -1) return -1;
+    timeoutMs = std::max(1, timeoutMs);  // A zero SO_RCVTIMEO blocks forever
+
+    // A blocking read busy-polls with SO_BUSY_POLL; poll() alone would not.
+    // SO_RCVTIMEO bounds the wait (recvmmsg's own timeout is only checked
+    // between datagrams).
+    if (timeoutMs != timeoutMs_) {
+        timeval timeout{};
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_usec = (timeoutMs % 1000) * 1000;
+        setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        timeoutMs_ = timeoutMs;
+    }
+
+    // The kernel rewrites the lengths and flags, so reset them every call
+    auto& messages = messages_->headers;
+    for (int i = 0; i < batchSize_; i++) {
+        msghdr& header = messages[i].msg_hdr;
+        header = msghdr{};
+        header.msg_iov = &messages_->iovecs[i];
+        header.msg_iovlen = 1;
+        header.msg_control = control_.data() + static_cast<size_t>(i) * CONTROL_SPACE;
+        header.msg_controllen = CONTROL_SPACE;
+    }
+
+    // MSG_WAITFORONE: block for the first datagram, then take whatever else is queued
+    int count = recvmmsg(socket_, messages.data(), static_cast<unsigned>(batchSize_), MSG_WAITFORONE, nullptr);
+    if (count < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return 0;
+        }
+        lastError_ = "recvmmsg failed: " + std::string(std::strerror(errno));
+        return -1;
+    }
+
+    int64_t fallbackNs = wallClockNs();
+    for (int i = 0; i < count; i++) {
+        msghdr& header = messages[i].msg_hdr;
+        sizes_[i] = messages[i].msg_len;
+        arrivalNs_[i] = fallbackNs;
+        if (header.msg_flags & MSG_TRUNC) {
+            stats_.truncated++;
+        }
+        for (cmsghdr* c = CMSG_FIRSTHDR(&header); c; c = CMSG_NXTHDR(&header, c)) {
+            if (c->cmsg_level != SOL_SOCKET) continue;
+            if (c->cmsg_type == SCM_TIMESTAMPNS) {
+                timespec ts;
+                std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+                arrivalNs_[i] = static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+            } else if (c->cmsg_type == SO_RXQ_OVFL) {
+                uint32_t drops;
+                std::memcpy(&drops, CMSG_DATA(c), sizeof(drops));
+                stats_.kernelDrops = drops;  // Running total for the socket
+            }
+        }
+        stats_.packets++;
+        stats_.bytes += sizes_[i];
+    }
+    if (count > 0) {
+        stats_.calls++;
+    }
+    return count;
+}
+
+#else
+
+bool UdpBatchReceiver::open(const std::string&, int, const UdpReceiveConfig&) {
+    lastError_ = "The recvmmsg receive path is only available on Linux";
+    return false;
+}
+
+void UdpBatchReceiver::close() {
+    socket_ = -1;
+}
+
+int UdpBatchReceiver::receive(int) {
+    return -1;
+}
+
+#endif
+
+} // namespace latency
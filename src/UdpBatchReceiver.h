@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Config.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace latency {
+
+struct UdpReceiveStats {
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint64_t calls = 0;              // recvmmsg calls that returned data
+    uint64_t kernelDrops = 0;        // Datagrams dropped on a full socket buffer (SO_RXQ_OVFL)
+    uint64_t truncated = 0;          // Datagrams larger than MAX_DATAGRAM
+    int socketBufferBytes = 0;       // Receive buffer the kernel actually granted
+};
+
+// Receives UDP datagrams in batches with recvmmsg, each stamped with the
+// kernel's arrival time (SO_TIMESTAMPNS, Unix epoch). The socket gets a
+// large receive buffer and optionally busy-polls the NIC queue, so bursts
+// of a high-bitrate stream are not lost while the reader is descheduled.
+// Linux only: open() fails elsewhere.
+class UdpBatchReceiver {
+public:
+    static constexpr size_t MAX_DATAGRAM = 9216;  // Jumbo frame
+
+    UdpBatchReceiver();
+    ~UdpBatchReceiver();
+
+    UdpBatchReceiver(const UdpBatchReceiver&) = delete;
+    UdpBatchReceiver& operator=(const UdpBatchReceiver&) = delete;
+
+    // Bind to port; a multicast address is joined, anything else binds all interfaces
+    bool open(const std::string& address, int port, const UdpReceiveConfig& config);
+    void close();
+    bool isOpen() const { return socket_ != -1; }
+
+    // Wait up to timeoutMs and read what is queued (at most config.batchSize).
+    // Returns the number of datagrams, 0 on timeout, -1 on error.
+    int receive(int timeoutMs);
+
+    // Datagram i of the last receive()
+    const uint8_t* data(int i) const { return buffers_.data() + static_cast<size_t>(i) * MAX_DATAGRAM; }
+    size_t size(int i) const { return sizes_[i]; }
+    int64_t arrivalNs(int i) const { return arrivalNs_[i]; }
+
+    UdpReceiveStats getStats() const { return stats_; }
+
+    // Options that could not be applied (e.g. busy polling without privileges)
+    const std::string& getWarning() const { return warning_; }
+    std::string getLastError() const { return lastError_; }
+
+private:
+    struct Messages;  // mmsghdr/iovec arrays, built once per open()
+
+    int socket_ = -1;
+    int batchSize_ = 0;
+    int timeoutMs_ = -1;             // SO_RCVTIMEO currently set
+    std::vector<uint8_t> buffers_;
+    std::vector<size_t> sizes_;
+    std::vector<int64_t> arrivalNs_;
+    std::vector<uint8_t> control_;   // cmsg space per datagram
+    std::unique_ptr<Messages> messages_;
+    UdpReceiveStats stats_;
+    std::string warning_;
+    std::string lastError_;
+};
+
+} // namespace latency
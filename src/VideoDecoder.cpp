@@ -1,4 +1,8 @@
 #include "VideoDecoder.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -9,7 +13,35 @@ extern "C" {
 
 namespace latency {
 
-VideoDecoder::VideoDecoder() = default;
+const char* pipelineStageName(PipelineStage stage) {
+    switch (stage) {
+        case PipelineStage::Transfer:  return "Transfer";
+        case PipelineStage::Ingest:    return "Ingest";
+        case PipelineStage::Demux:     return "Demux";
+        case PipelineStage::Decode:    return "Decode";
+        case PipelineStage::Convert:   return "Convert";
+        case PipelineStage::QueueWait: return "Queue wait";
+        case PipelineStage::Render:    return "Render";
+        default:                       return "Unknown";
+    }
+}
+
+const char* pipelineStageKey(PipelineStage stage) {
+    switch (stage) {
+        case PipelineStage::Transfer:  return "transfer";
+        case PipelineStage::Ingest:    return "ingest";
+        case PipelineStage::Demux:     return "demux";
+        case PipelineStage::Decode:    return "decode";
+        case PipelineStage::Convert:   return "convert";
+        case PipelineStage::QueueWait: return "queue_wait";
+        case PipelineStage::Render:    return "render";
+        default:                       return "unknown";
+    }
+}
+
+VideoDecoder::VideoDecoder()
+    : displayQueue_(frameBus_.subscribe(DISPLAY_QUEUE, MAX_QUEUE_SIZE)) {
+}
 
 VideoDecoder::~VideoDecoder() {
     disconnect();
@@ -31,10 +63,15 @@ bool VideoDecoder::connect(const StreamConfig& config) {
         detectedProtocol_ = config.protocol;
     }
     diagnostics_.detectedProtocol = detectedProtocol_;
+    offline_ = detectedProtocol_ == StreamProtocol::LOCAL_FILE;
+    endOfStream_ = false;
 
     // Build list of transports to try
     std::vector<TransportProtocol> transportsToTry;
-    if (detectedProtocol_ == StreamProtocol::RTSP) {
+    if (offline_) {
+        // Local file: transport selection not applicable
+        transportsToTry = { TransportProtocol::AUTO };
+    } else if (detectedProtocol_ == StreamProtocol::RTSP) {
         if (config.transport == TransportProtocol::AUTO) {
             transportsToTry = { TransportProtocol::UDP, TransportProtocol::TCP };
         } else {
@@ -64,8 +101,22 @@ bool VideoDecoder::connect(const StreamConfig& config) {
 
             if (stream->avg_frame_rate.den > 0) {
                 streamInfo_.fps = static_cast<double>(stream->avg_frame_rate.num) / stream->avg_frame_rate.den;
+            } else if (stream->r_frame_rate.den > 0) {
+                streamInfo_.fps = static_cast<double>(stream->r_frame_rate.num) / stream->r_frame_rate.den;
+            }
+
+            timeBaseSec_ = av_q2d(stream->time_base);
+            streamStartPts_ = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+
+            decodeFrame_ = av_frame_alloc();
+
+            if (packetRecorder_) {
+                packetRecorder_->start(stream);
             }
 
+            displayQueue_->reopen(offline_ ? OFFLINE_QUEUE_SIZE : MAX_QUEUE_SIZE,
+                                  offline_ ? FrameDropPolicy::Block : FrameDropPolicy::DropOldest);
+
             // Start decode thread
             connected_ = true;
             running_ = true;
@@ -93,33 +144,77 @@ bool VideoDecoder::tryConnect(const StreamConfig& config, TransportProtocol tran
         return false;
     }
 
+    // Batched UDP input: our socket feeds the raw h264/hevc demuxer
+    const AVInputFormat* inputFormat = nullptr;
+    std::string url = config.url;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        rtpMonitor_.reset();
+    }
+    if (detectedProtocol_ == StreamProtocol::RTP && config.udpReceive.enabled) {
+        auto monitor = std::make_unique<RtpStreamMonitor>();
+        udpInput_ = std::make_unique<RtpUdpInput>();
+        if (udpInput_->open(config.url, config.udpReceive, monitor.get())) {
+            {
+                std::lock_guard<std::mutex> lock(statsMutex_);
+                rtpMonitor_ = std::move(monitor);
+            }
+            if (!udpInput_->getWarning().empty()) {
+                std::cerr << "Batched UDP input: " << udpInput_->getWarning() << std::endl;
+            }
+            udpInput_->setReadTimeout(config.connectionTimeoutMs);
+            formatCtx_->pb = udpInput_->getIOContext();
+            formatCtx_->flags |= AVFMT_FLAG_CUSTOM_IO;
+            inputFormat = av_find_input_format(udpInput_->getInputFormat());
+            url.clear();
+        } else {
+            std::cerr << "Batched UDP input unavailable (" << udpInput_->getLastError()
+                      << "), using FFmpeg's UDP input" << std::endl;
+            udpInput_.reset();
+        }
+    }
+
     // Set protocol-specific and low-latency options
     AVDictionary* options = nullptr;
 
-    if (detectedProtocol_ == StreamProtocol::RTSP) {
+    if (offline_) {
+        // Files are probed with FFmpeg's defaults; none of the network options apply
+    } else if (detectedProtocol_ == StreamProtocol::RTSP) {
         av_dict_set(&options, "rtsp_transport",
                     transport == TransportProtocol::TCP ? "tcp" : "udp", 0);
         av_dict_set(&options, "stimeout",
                     std::to_string(config.connectionTimeoutMs * 1000).c_str(), 0);
+        if (config.rtspListen) {
+            av_dict_set(&options, "rtsp_flags", "listen", 0);
+            av_dict_set(&options, "listen_timeout",
+                        std::to_string(std::max(1, config.connectionTimeoutMs / 1000)).c_str(), 0);
+        }
+    } else if (udpInput_) {
+        // Raw elementary stream carries no timing; stamp packets as they are demuxed
+        av_dict_set(&options, "use_wallclock_as_timestamps", "1", 0);
     } else if (detectedProtocol_ == StreamProtocol::RTP) {
         av_dict_set(&options, "reorder_queue_size", "500", 0);
+        // An .sdp file describes the session; let it open the RTP/UDP sockets
+        av_dict_set(&options, "protocol_whitelist", "file,udp,rtp", 0);
     }
 
-    // Common low-latency flags
-    av_dict_set(&options, "fflags", "nobuffer", 0);
-    av_dict_set(&options, "flags", "low_delay", 0);
-    av_dict_set(&options, "max_delay", "0", 0);
+    if (!offline_) {
+        // Common low-latency flags
+        av_dict_set(&options, "fflags", "nobuffer", 0);
+        av_dict_set(&options, "flags", "low_delay", 0);
+        av_dict_set(&options, "max_delay", "0", 0);
 
-    // Use config-driven probe size and analyze duration
-    av_dict_set(&options, "probesize", std::to_string(config.probeSize).c_str(), 0);
-    av_dict_set(&options, "analyzeduration", std::to_string(config.analyzeDurationUs).c_str(), 0);
+        // Use config-driven probe size and analyze duration
+        av_dict_set(&options, "probesize", std::to_string(config.probeSize).c_str(), 0);
+        av_dict_set(&options, "analyzeduration", std::to_string(config.analyzeDurationUs).c_str(), 0);
 
-    // Receive timeout
-    av_dict_set(&options, "timeout", std::to_string(config.receiveTimeoutMs * 1000).c_str(), 0);
+        // Receive timeout
+        av_dict_set(&options, "timeout", std::to_string(config.receiveTimeoutMs * 1000).c_str(), 0);
+    }
 
     // Stage: Opening input
     attempt.failedAt = ConnectionStage::OpeningInput;
-    int ret = avformat_open_input(&formatCtx_, config.url.c_str(), nullptr, &options);
+    int ret = avformat_open_input(&formatCtx_, url.c_str(), inputFormat, &options);
     av_dict_free(&options);
 
     if (ret < 0) {
@@ -134,7 +229,9 @@ bool VideoDecoder::tryConnect(const StreamConfig& config, TransportProtocol tran
 
     // Stage: Finding stream info
     attempt.failedAt = ConnectionStage::FindingStreamInfo;
-    formatCtx_->max_analyze_duration = config.analyzeDurationUs;
+    if (!offline_) {
+        formatCtx_->max_analyze_duration = config.analyzeDurationUs;
+    }
     ret = avformat_find_stream_info(formatCtx_, nullptr);
     if (ret < 0) {
         char errBuf[256];
@@ -145,8 +242,14 @@ bool VideoDecoder::tryConnect(const StreamConfig& config, TransportProtocol tran
         return false;
     }
 
-    // Flush stale packets buffered during stream analysis
-    avformat_flush(formatCtx_);
+    // Flush stale packets buffered during stream analysis (a file keeps them:
+    // they are its first frames, not stale live data)
+    if (!offline_) {
+        avformat_flush(formatCtx_);
+    }
+    if (udpInput_) {
+        udpInput_->setReadTimeout(config.receiveTimeoutMs);
+    }
 
     // Stage: Finding video stream
     attempt.failedAt = ConnectionStage::FindingVideoStream;
@@ -166,7 +269,7 @@ bool VideoDecoder::tryConnect(const StreamConfig& config, TransportProtocol tran
 
     // Stage: Opening codec
     attempt.failedAt = ConnectionStage::OpeningCodec;
-    if (!openCodec()) {
+    if (!openCodec(config)) {
         attempt.ffmpegErrorString = lastError_;
         return false;
     }
@@ -178,6 +281,7 @@ void VideoDecoder::cleanupConnection() {
     if (swsCtx_) { sws_freeContext(swsCtx_); swsCtx_ = nullptr; }
     if (codecCtx_) { avcodec_free_context(&codecCtx_); codecCtx_ = nullptr; }
     if (formatCtx_) { avformat_close_input(&formatCtx_); formatCtx_ = nullptr; }
+    udpInput_.reset();  // After the format context, which reads through it
     videoStreamIndex_ = -1;
 }
 
@@ -188,6 +292,15 @@ void VideoDecoder::buildDiagnosticSuggestions() {
 
     const auto& lastAttempt = diagnostics_.attempts.back();
 
+    if (offline_) {
+        diagnostics_.summary = "Could not open the recording.";
+        diagnostics_.suggestions.push_back("Check that the file exists and is an mp4, mkv or ts recording.");
+        if (!lastAttempt.ffmpegErrorString.empty()) {
+            diagnostics_.suggestions.push_back("FFmpeg: " + lastAttempt.ffmpegErrorString);
+        }
+        return;
+    }
+
     // Stage-based summary
     switch (lastAttempt.failedAt) {
         case ConnectionStage::OpeningInput:
@@ -263,7 +376,44 @@ void VideoDecoder::buildDiagnosticSuggestions() {
     diagnostics_.suggestions.push_back("Verify the stream path (common paths: /stream, /live, /Streaming/Channels/1).");
 }
 
-bool VideoDecoder::openCodec() {
+void VideoDecoder::configureThreading(AVCodecContext* ctx, DecoderThreading threading, int threadCount) {
+    switch (threading) {
+        case DecoderThreading::AUTO:
+            ctx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+            ctx->thread_count = threadCount;
+            break;
+        case DecoderThreading::FRAME:
+            // FFmpeg refuses frame threads when LOW_DELAY is set, so drop it here
+            ctx->flags &= ~AV_CODEC_FLAG_LOW_DELAY;
+            ctx->thread_type = FF_THREAD_FRAME;
+            ctx->thread_count = threadCount;
+            break;
+        case DecoderThreading::SLICE:
+            ctx->thread_type = FF_THREAD_SLICE;
+            ctx->thread_count = threadCount;
+            break;
+        case DecoderThreading::NONE:
+            ctx->thread_type = 0;
+            ctx->thread_count = 1;
+            break;
+    }
+}
+
+std::string VideoDecoder::describeActiveThreading(const AVCodecContext* ctx) {
+    if (!ctx) return "None";
+
+    std::string mode;
+    if (ctx->active_thread_type & FF_THREAD_FRAME) {
+        mode = "Frame";
+    } else if (ctx->active_thread_type & FF_THREAD_SLICE) {
+        mode = "Slice";
+    } else {
+        return "Single";
+    }
+    return mode + " x" + std::to_string(ctx->thread_count);
+}
+
+bool VideoDecoder::openCodec(const StreamConfig& config) {
     AVStream* stream = formatCtx_->streams[videoStreamIndex_];
 
     // Find decoder
@@ -290,14 +440,9 @@ bool VideoDecoder::openCodec() {
     // Low-latency decoding options
     codecCtx_->flags |= AV_CODEC_FLAG_LOW_DELAY;
     codecCtx_->flags2 |= AV_CODEC_FLAG2_FAST;
-    codecCtx_->thread_count = 2;  // Limit threads for lower latency
-
-    // Open codec
-    AVDictionary* codecOpts = nullptr;
-    av_dict_set(&codecOpts, "threads", "2", 0);
+    configureThreading(codecCtx_, config.decoderThreading, config.decoderThreadCount);
 
-    int ret = avcodec_open2(codecCtx_, codec, &codecOpts);
-    av_dict_free(&codecOpts);
+    int ret = avcodec_open2(codecCtx_, codec, nullptr);
 
     if (ret < 0) {
         char errBuf[256];
@@ -307,12 +452,22 @@ bool VideoDecoder::openCodec() {
         return false;
     }
 
+    {
+        std::lock_guard<std::mutex> lock(timingMutex_);
+        packetTimings_.clear();
+        senderClockOffsetMs_ = config.senderClockOffsetMs;
+    }
+
     // Initialize decode statistics
     {
         std::lock_guard<std::mutex> lock(statsMutex_);
         decodeStats_ = DecodeStats{};
+        decodeErrors_ = 0;
+        corruptFrames_ = 0;
         decodeStats_.decoderName = codec->name;
-        decodeStats_.maxQueueSize = MAX_QUEUE_SIZE;
+        decodeStats_.maxQueueSize = offline_ ? OFFLINE_QUEUE_SIZE : MAX_QUEUE_SIZE;
+        displayDropped_ = 0;
+        decodeStats_.threading = describeActiveThreading(codecCtx_);
 
         // Detect hardware acceleration type
         decodeStats_.isHardwareAccelerated = false;
@@ -347,6 +502,11 @@ bool VideoDecoder::openCodec() {
         totalDemuxTimeUs_ = 0.0;
         totalConvertTimeUs_ = 0.0;
         statsStartTime_ = std::chrono::steady_clock::now();
+
+        for (auto& histogram : stageHistograms_) {
+            histogram.reset();
+        }
+        stageHistogramsStart_ = statsStartTime_;
     }
 
     // Initialize scaler for RGB conversion
@@ -365,6 +525,18 @@ bool VideoDecoder::openCodec() {
     return true;
 }
 
+void VideoDecoder::setWorkerPool(WorkerPool* pool) {
+    workerPool_ = pool;
+}
+
+void VideoDecoder::setPacketRecorder(PacketRecorder* recorder) {
+    packetRecorder_ = recorder;
+}
+
+void VideoDecoder::setFrameCallback(FrameCallback callback) {
+    frameCallback_ = std::move(callback);
+}
+
 void VideoDecoder::setPaused(bool paused) {
     paused_ = paused;
 }
@@ -373,21 +545,43 @@ void VideoDecoder::disconnect() {
     running_ = false;
     paused_ = false;
 
+    // A demux thread waiting on the socket returns end of stream instead of timing out
+    if (udpInput_) {
+        udpInput_->interrupt();
+    }
+
     if (decodeThread_.joinable()) {
-        queueCv_.notify_all();
+        // Releases an offline decoder waiting for queue space
+        displayQueue_->close();
         decodeThread_.join();
     }
 
-    connected_ = false;
-
-    // Clear frame queue
+    // Wait for any decode task still running on the worker pool, then drop the backlog
     {
-        std::lock_guard<std::mutex> lock(queueMutex_);
-        while (!frameQueue_.empty()) {
-            frameQueue_.pop();
+        std::unique_lock<std::mutex> lock(pendingMutex_);
+        pendingCv_.wait(lock, [this] { return !decodeScheduled_; });
+        for (auto& pending : pendingPackets_) {
+            av_packet_free(&pending.packet);
         }
+        pendingPackets_.clear();
+        resyncToKeyframe_ = false;
+    }
+
+    if (decodeFrame_) {
+        av_frame_free(&decodeFrame_);
+        decodeFrame_ = nullptr;
     }
 
+    if (packetRecorder_) {
+        packetRecorder_->stop();
+    }
+
+    connected_ = false;
+
+    // Clear frame queue
+    displayQueue_->close();
+    displayQueue_->clear();
+
     if (swsCtx_) {
         sws_freeContext(swsCtx_);
         swsCtx_ = nullptr;
@@ -402,18 +596,16 @@ void VideoDecoder::disconnect() {
         avformat_close_input(&formatCtx_);
         formatCtx_ = nullptr;
     }
+    udpInput_.reset();
 
     videoStreamIndex_ = -1;
 }
 
 void VideoDecoder::decodeThread() {
     AVPacket* packet = av_packet_alloc();
-    AVFrame* frame = av_frame_alloc();
 
-    if (!packet || !frame) {
+    if (!packet) {
         running_ = false;
-        if (packet) av_packet_free(&packet);
-        if (frame) av_frame_free(&frame);
         return;
     }
 
@@ -435,6 +627,11 @@ void VideoDecoder::decodeThread() {
         // Read packet
         int ret = av_read_frame(formatCtx_, packet);
         if (ret < 0) {
+            if (offline_ && ret != AVERROR(EAGAIN)) {
+                // End of the recording: drain frames still held by the decoder
+                decodePacket(nullptr, 0.0);
+                break;
+            }
             if (ret == AVERROR_EOF || ret == AVERROR(EAGAIN)) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
                 continue;
@@ -452,6 +649,24 @@ void VideoDecoder::decodeThread() {
             continue;
         }
 
+        // Without kernel timestamps the packet is taken to arrive when demuxed
+        PacketTiming timing;
+        timing.pts = packet->pts;
+        timing.demuxed = demuxEnd;
+        timing.firstPacket = demuxEnd;
+        if (udpInput_) {
+            recordArrival(packet, timing);
+        } else if (!offline_) {
+            // FFmpeg's RTP demuxer maps each packet through the last RTCP sender
+            // report and attaches the result as producer reference time
+            size_t sideDataSize = 0;
+            const uint8_t* prft = av_packet_get_side_data(packet, AV_PKT_DATA_PRFT, &sideDataSize);
+            if (prft && sideDataSize >= sizeof(AVProducerReferenceTime)) {
+                timing.senderNs = reinterpret_cast<const AVProducerReferenceTime*>(prft)->wallclock * 1000;
+                timing.senderSource = SenderClockSource::RtcpSenderReport;
+            }
+        }
+
         // Discard non-keyframe packets until we receive the first keyframe
         if (!gotFirstKeyframe) {
             if (packet->flags & AV_PKT_FLAG_KEY) {
@@ -462,102 +677,294 @@ void VideoDecoder::decodeThread() {
             }
         }
 
-        // Measure decode time
-        auto decodeStart = std::chrono::steady_clock::now();
+        if (!offline_) {
+            notePacketTiming(timing);
+        }
+
+        // Buffered before decoding - costs a packet reference, no decode work
+        if (packetRecorder_) {
+            packetRecorder_->push(packet);
+        }
 
-        // Send packet to decoder
-        ret = avcodec_send_packet(codecCtx_, packet);
+        if (workerPool_ && !offline_) {
+            submitPacket(packet, demuxTimeUs);
+        } else {
+            decodePacket(packet, demuxTimeUs);
+        }
         av_packet_unref(packet);
+    }
 
-        if (ret < 0) {
-            continue;
+    av_packet_free(&packet);
+
+    // Wake a consumer blocked in waitForFrame(); queued frames can still be taken
+    endOfStream_ = true;
+    displayQueue_->close();
+}
+
+void VideoDecoder::recordArrival(const AVPacket* packet, PacketTiming& timing) {
+    AccessUnitArrival arrival;
+    bool matched = udpInput_->takeArrival(packet->size, arrival);
+    auto input = udpInput_->getStats();
+
+    // Kernel timestamps are wall clock, so the demux side must be too
+    int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (matched) {
+        timing.kernelArrival = true;
+        timing.firstPacket = std::chrono::steady_clock::now() -
+                             std::chrono::nanoseconds(nowNs - arrival.firstArrivalNs);
+        timing.senderNs = arrival.senderNs;
+        timing.senderSource = arrival.senderSource;
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    if (matched) {
+        stageHistograms_[static_cast<size_t>(PipelineStage::Transfer)].record(
+            (arrival.lastArrivalNs - arrival.firstArrivalNs) / 1000.0);
+        stageHistograms_[static_cast<size_t>(PipelineStage::Ingest)].record(
+            (nowNs - arrival.lastArrivalNs) / 1000.0);
+    }
+    decodeStats_.udpPackets = input.socket.packets;
+    decodeStats_.udpKernelDrops = input.socket.kernelDrops;
+    decodeStats_.udpPacketsPerCall = input.socket.calls > 0
+        ? static_cast<double>(input.socket.packets) / input.socket.calls : 0.0;
+}
+
+void VideoDecoder::notePacketTiming(const PacketTiming& timing) {
+    if (timing.pts == AV_NOPTS_VALUE) return;
+
+    std::lock_guard<std::mutex> lock(timingMutex_);
+    if (packetTimings_.size() >= MAX_PACKET_TIMINGS) {
+        packetTimings_.pop_front();  // Packets the decoder never turned into frames
+    }
+    packetTimings_.push_back(timing);
+}
+
+bool VideoDecoder::takePacketTiming(int64_t pts, PacketTiming& timing) {
+    if (pts == AV_NOPTS_VALUE) return false;
+
+    // Frames leave the decoder in presentation order, so only the match is removed
+    std::lock_guard<std::mutex> lock(timingMutex_);
+    for (auto it = packetTimings_.begin(); it != packetTimings_.end(); ++it) {
+        if (it->pts == pts) {
+            timing = *it;
+            packetTimings_.erase(it);
+            return true;
         }
+    }
+    return false;
+}
 
-        // Receive decoded frames
-        while (ret >= 0 && running_) {
-            ret = avcodec_receive_frame(codecCtx_, frame);
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-                break;
+void VideoDecoder::submitPacket(AVPacket* packet, double demuxTimeUs) {
+    bool schedule = false;
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+
+        // After a backlog overflow, wait for a keyframe so the decoder restarts cleanly
+        if (resyncToKeyframe_) {
+            if (!(packet->flags & AV_PKT_FLAG_KEY)) {
+                dropped++;
+                packet = nullptr;
+            } else {
+                resyncToKeyframe_ = false;
             }
-            if (ret < 0) {
-                break;
+        }
+
+        // The pool can't keep up with this stream: drop the backlog rather than add latency
+        if (packet && pendingPackets_.size() >= MAX_PENDING_PACKETS) {
+            dropped += pendingPackets_.size();
+            for (auto& pending : pendingPackets_) {
+                av_packet_free(&pending.packet);
             }
+            pendingPackets_.clear();
+
+            if (!(packet->flags & AV_PKT_FLAG_KEY)) {
+                resyncToKeyframe_ = true;
+                dropped++;
+                packet = nullptr;
+            }
+        }
+
+        if (packet) {
+            PendingPacket pending;
+            pending.packet = av_packet_alloc();
+            av_packet_move_ref(pending.packet, packet);
+            pending.demuxTimeUs = demuxTimeUs;
+            pendingPackets_.push_back(pending);
+
+            if (!decodeScheduled_) {
+                decodeScheduled_ = true;
+                schedule = true;
+            }
+        }
+    }
 
-            auto decodeEnd = std::chrono::steady_clock::now();
-            double decodeTimeUs = std::chrono::duration<double, std::micro>(decodeEnd - decodeStart).count();
+    if (dropped > 0) {
+        std::lock_guard<std::mutex> statsLock(statsMutex_);
+        decodeStats_.framesDropped += dropped;
+    }
+
+    if (schedule) {
+        workerPool_->submit([this] { drainPendingPackets(); });
+    }
+}
 
-            // Measure RGB conversion time
-            auto convertStart = std::chrono::steady_clock::now();
+void VideoDecoder::drainPendingPackets() {
+    for (int i = 0; i < MAX_PACKETS_PER_TASK; i++) {
+        PendingPacket pending;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex_);
+            if (pendingPackets_.empty() || !running_) {
+                decodeScheduled_ = false;
+                pendingCv_.notify_all();
+                return;
+            }
+            pending = pendingPackets_.front();
+            pendingPackets_.pop_front();
+        }
 
-            // Convert frame to RGB
-            auto videoFrame = convertFrame(frame);
+        decodePacket(pending.packet, pending.demuxTimeUs);
+        av_packet_free(&pending.packet);
+    }
 
-            auto convertEnd = std::chrono::steady_clock::now();
-            double convertTimeUs = std::chrono::duration<double, std::micro>(convertEnd - convertStart).count();
+    // Requeue behind other streams' work instead of monopolising a worker
+    workerPool_->submit([this] { drainPendingPackets(); });
+}
 
-            if (videoFrame) {
-                std::unique_lock<std::mutex> lock(queueMutex_);
+void VideoDecoder::decodePacket(AVPacket* packet, double demuxTimeUs) {
+    AVFrame* frame = decodeFrame_;
 
-                bool dropped = false;
-                // Wait if queue is full (discard old frames for low latency)
-                while (frameQueue_.size() >= MAX_QUEUE_SIZE && running_) {
-                    frameQueue_.pop();  // Drop oldest frame
-                    dropped = true;
-                }
+    // Measure decode time
+    auto decodeStart = std::chrono::steady_clock::now();
 
-                size_t currentQueueDepth = frameQueue_.size();
-                frameQueue_.push(std::move(videoFrame));
-                lock.unlock();
-                queueCv_.notify_one();
-
-                // Update statistics
-                {
-                    std::lock_guard<std::mutex> statsLock(statsMutex_);
-                    decodeStats_.framesDecoded++;
-                    if (dropped) {
-                        decodeStats_.framesDropped++;
-                    }
+    // Send packet to decoder
+    int ret = avcodec_send_packet(codecCtx_, packet);
+    if (packet) {
+        av_packet_unref(packet);
+    }
 
-                    // Update timing stats
-                    totalDecodeTimeUs_ += decodeTimeUs;
-                    totalDemuxTimeUs_ += demuxTimeUs;
-                    totalConvertTimeUs_ += convertTimeUs;
+    if (ret < 0) {
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+            decodeErrors_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    // Receive decoded frames
+    while (ret >= 0 && running_) {
+        ret = avcodec_receive_frame(codecCtx_, frame);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            break;
+        }
+        if (ret < 0) {
+            decodeErrors_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        if ((frame->flags & AV_FRAME_FLAG_CORRUPT) || frame->decode_error_flags) {
+            corruptFrames_.fetch_add(1, std::memory_order_relaxed);
+        }
 
-                    decodeStats_.lastDecodeTimeUs = decodeTimeUs;
-                    decodeStats_.avgDecodeTimeUs = totalDecodeTimeUs_ / decodeStats_.framesDecoded;
-                    decodeStats_.avgDemuxTimeUs = totalDemuxTimeUs_ / decodeStats_.framesDecoded;
-                    decodeStats_.avgConvertTimeUs = totalConvertTimeUs_ / decodeStats_.framesDecoded;
+        auto decodeEnd = std::chrono::steady_clock::now();
+        double decodeTimeUs = std::chrono::duration<double, std::micro>(decodeEnd - decodeStart).count();
 
-                    // Track min/max
-                    if (decodeStats_.framesDecoded == 1) {
+        PacketTiming timing;
+        bool hasTiming = takePacketTiming(frame->pts, timing);
+
+        // Sender-to-decode: the sender's clock is wall clock, so ours must be too
+        bool hasSenderTime = hasTiming && timing.senderSource != SenderClockSource::None;
+        double senderLatencyMs = 0.0;
+        if (hasSenderTime) {
+            int64_t decodedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            senderLatencyMs = (decodedNs - timing.senderNs) / 1e6 - senderClockOffsetMs_;
+        }
+
+        // Measure RGB conversion time
+        auto convertStart = std::chrono::steady_clock::now();
+
+        // Convert frame to RGB
+        auto videoFrame = convertFrame(frame);
+
+        auto convertEnd = std::chrono::steady_clock::now();
+        double convertTimeUs = std::chrono::duration<double, std::micro>(convertEnd - convertStart).count();
+
+        if (videoFrame) {
+            if (hasSenderTime) {
+                videoFrame->senderClock = timing.senderSource;
+                videoFrame->senderLatencyMs = senderLatencyMs;
+            }
+            if (hasTiming) {
+                videoFrame->timeline.valid = true;
+                videoFrame->timeline.kernelArrival = timing.kernelArrival;
+                videoFrame->timeline.firstPacket = timing.firstPacket;
+                videoFrame->timeline.demuxed = timing.demuxed;
+                videoFrame->timeline.converted = convertEnd;
+            }
+
+            // Let in-process consumers (e.g. a per-stream measurer) see every frame
+            if (frameCallback_) {
+                frameCallback_(*videoFrame);
+            }
+            // Hand the same frame to every subscriber. Live, a full display queue
+            // discards its oldest frame for low latency; offline, every frame
+            // counts, so publishing waits for the consumer instead.
+            videoFrame->queuedAt = std::chrono::steady_clock::now();
+            frameBus_.publish(SharedFrame(std::move(videoFrame)));
+            FrameSubscriberStats display = displayQueue_->getStats();
+
+            // Update statistics
+            {
+                std::lock_guard<std::mutex> statsLock(statsMutex_);
+                decodeStats_.framesDecoded++;
+                decodeStats_.framesDropped += display.dropped - std::min(display.dropped, displayDropped_);
+                displayDropped_ = display.dropped;
+
+                // Update timing stats
+                totalDecodeTimeUs_ += decodeTimeUs;
+                totalDemuxTimeUs_ += demuxTimeUs;
+                totalConvertTimeUs_ += convertTimeUs;
+
+                decodeStats_.lastDecodeTimeUs = decodeTimeUs;
+                decodeStats_.avgDecodeTimeUs = totalDecodeTimeUs_ / decodeStats_.framesDecoded;
+                decodeStats_.avgDemuxTimeUs = totalDemuxTimeUs_ / decodeStats_.framesDecoded;
+                decodeStats_.avgConvertTimeUs = totalConvertTimeUs_ / decodeStats_.framesDecoded;
+
+                stageHistograms_[static_cast<size_t>(PipelineStage::Demux)].record(demuxTimeUs);
+                stageHistograms_[static_cast<size_t>(PipelineStage::Decode)].record(decodeTimeUs);
+                stageHistograms_[static_cast<size_t>(PipelineStage::Convert)].record(convertTimeUs);
+
+                // Track min/max
+                if (decodeStats_.framesDecoded == 1) {
+                    decodeStats_.minDecodeTimeUs = decodeTimeUs;
+                    decodeStats_.maxDecodeTimeUs = decodeTimeUs;
+                } else {
+                    if (decodeTimeUs < decodeStats_.minDecodeTimeUs) {
                         decodeStats_.minDecodeTimeUs = decodeTimeUs;
+                    }
+                    if (decodeTimeUs > decodeStats_.maxDecodeTimeUs) {
                         decodeStats_.maxDecodeTimeUs = decodeTimeUs;
-                    } else {
-                        if (decodeTimeUs < decodeStats_.minDecodeTimeUs) {
-                            decodeStats_.minDecodeTimeUs = decodeTimeUs;
-                        }
-                        if (decodeTimeUs > decodeStats_.maxDecodeTimeUs) {
-                            decodeStats_.maxDecodeTimeUs = decodeTimeUs;
-                        }
                     }
+                }
 
-                    // Calculate actual FPS
-                    auto now = std::chrono::steady_clock::now();
-                    double elapsedSec = std::chrono::duration<double>(now - statsStartTime_).count();
-                    if (elapsedSec > 0.1) {  // Avoid division by zero / early jitter
-                        decodeStats_.actualFps = decodeStats_.framesDecoded / elapsedSec;
-                    }
+                // Calculate actual FPS
+                auto now = std::chrono::steady_clock::now();
+                double elapsedSec = std::chrono::duration<double>(now - statsStartTime_).count();
+                if (elapsedSec > 0.1) {  // Avoid division by zero / early jitter
+                    decodeStats_.actualFps = decodeStats_.framesDecoded / elapsedSec;
+                }
+
+                decodeStats_.queueDepth = display.depth;
 
-                    decodeStats_.queueDepth = currentQueueDepth + 1;  // +1 for the frame we just added
+                if (hasSenderTime) {
+                    decodeStats_.senderClock = timing.senderSource;
+                    decodeStats_.senderLatencyMs = senderLatencyMs;
                 }
             }
-
-            av_frame_unref(frame);
         }
-    }
 
-    av_packet_free(&packet);
-    av_frame_free(&frame);
+        av_frame_unref(frame);
+    }
 }
 
 std::unique_ptr<VideoFrame> VideoDecoder::convertFrame(AVFrame* frame) {
@@ -566,6 +973,11 @@ std::unique_ptr<VideoFrame> VideoDecoder::convertFrame(AVFrame* frame) {
     videoFrame->height = frame->height;
     videoFrame->pitch = frame->width * 3;  // RGB24
     videoFrame->timestamp = frame->pts;
+
+    int64_t pts = frame->best_effort_timestamp != AV_NOPTS_VALUE ? frame->best_effort_timestamp : frame->pts;
+    if (pts != AV_NOPTS_VALUE) {
+        videoFrame->ptsMs = (pts - streamStartPts_) * timeBaseSec_ * 1000.0;
+    }
     videoFrame->data = new uint8_t[videoFrame->pitch * videoFrame->height];
 
     uint8_t* dstData[1] = { videoFrame->data };
@@ -579,21 +991,64 @@ std::unique_ptr<VideoFrame> VideoDecoder::convertFrame(AVFrame* frame) {
     return videoFrame;
 }
 
-std::unique_ptr<VideoFrame> VideoDecoder::getFrame() {
-    std::lock_guard<std::mutex> lock(queueMutex_);
+SharedFrame VideoDecoder::getFrame() {
+    return dequeued(displayQueue_->take());
+}
 
-    if (frameQueue_.empty()) {
+SharedFrame VideoDecoder::waitForFrame(int timeoutMs) {
+    return dequeued(displayQueue_->waitTake(timeoutMs));
+}
+
+SharedFrame VideoDecoder::dequeued(BusFrame frame) {
+    if (!frame) {
         return nullptr;
     }
 
-    auto frame = std::move(frameQueue_.front());
-    frameQueue_.pop();
-    return frame;
+    double waitUs = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - frame.queuedAt).count();
+    recordStageTime(PipelineStage::QueueWait, waitUs);
+
+    return std::move(frame.frame);
 }
 
 DecodeStats VideoDecoder::getDecodeStats() const {
     std::lock_guard<std::mutex> lock(statsMutex_);
-    return decodeStats_;
+    DecodeStats stats = decodeStats_;
+
+    for (size_t i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+        stats.stageLatency[i] = stageHistograms_[i].getPercentiles();
+    }
+    stats.stageWindowSec = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - stageHistogramsStart_).count();
+
+    stats.decodeErrors = decodeErrors_.load(std::memory_order_relaxed);
+    stats.corruptFrames = corruptFrames_.load(std::memory_order_relaxed);
+    if (rtpMonitor_) {
+        stats.hasRtpStats = true;
+        stats.rtp = rtpMonitor_->getStats();
+    }
+
+    return stats;
+}
+
+void VideoDecoder::recordStageTime(PipelineStage stage, double timeUs) {
+    if (stage == PipelineStage::Count) return;
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    stageHistograms_[static_cast<size_t>(stage)].record(timeUs);
+}
+
+void VideoDecoder::resetStageHistograms() {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    for (auto& histogram : stageHistograms_) {
+        histogram.reset();
+    }
+    stageHistogramsStart_ = std::chrono::steady_clock::now();
+}
+
+StageHistograms VideoDecoder::getStageHistograms() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return stageHistograms_;
 }
 
 StreamProtocol VideoDecoder::detectProtocol(const std::string& url) const {
@@ -604,6 +1059,24 @@ StreamProtocol VideoDecoder::detectProtocol(const std::string& url) const {
     if (url.find("rtp://") == 0) {
         return StreamProtocol::RTP;
     }
+    if (url.size() > 4 && url.compare(url.size() - 4, 4, ".sdp") == 0) {
+        return StreamProtocol::RTP;  // Session description for an RTP stream
+    }
+    // Recordings: file: URLs and paths to common container files
+    if (url.find("file:") == 0) {
+        return StreamProtocol::LOCAL_FILE;
+    }
+    if (url.find("://") == std::string::npos) {
+        std::string lower = url;
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        for (const char* ext : { ".mp4", ".mkv", ".ts", ".mov", ".avi" }) {
+            size_t len = std::strlen(ext);
+            if (lower.size() > len && lower.compare(lower.size() - len, len, ext) == 0) {
+                return StreamProtocol::LOCAL_FILE;
+            }
+        }
+    }
     // Default to RTSP for unknown schemes
     return StreamProtocol::RTSP;
 }
@@ -1,15 +1,22 @@
 #pragma once
 
 #include "Config.h"
+#include "FrameBus.h"
+#include "LatencyHistogram.h"
+#include "PacketRecorder.h"
+#include "RtpUdpInput.h"
+#include "WorkerPool.h"
 #include <string>
 #include <vector>
 #include <memory>
 #include <thread>
 #include <mutex>
 #include <atomic>
-#include <queue>
+#include <deque>
+#include <functional>
 #include <condition_variable>
 #include <chrono>
+#include <array>
 
 // Forward declarations for FFmpeg types
 struct AVFormatContext;
@@ -20,12 +27,26 @@ struct SwsContext;
 
 namespace latency {
 
+// Where a frame was along the receive pipeline (steady clock), for the latency budget
+struct FrameTimeline {
+    bool valid = false;                // Live stream and the packet's timing was found
+    bool kernelArrival = false;        // firstPacket is the socket's kernel timestamp, else demux time
+    std::chrono::steady_clock::time_point firstPacket;
+    std::chrono::steady_clock::time_point demuxed;
+    std::chrono::steady_clock::time_point converted;   // Decoded and converted to RGB
+};
+
 struct VideoFrame {
     uint8_t* data = nullptr;
     int width = 0;
     int height = 0;
     int pitch = 0;  // Bytes per row
     int64_t timestamp = 0;  // Presentation timestamp
+    double ptsMs = 0.0;     // Presentation time since stream start, in ms (container clock)
+    std::chrono::steady_clock::time_point queuedAt;  // When the frame was published to the frame bus
+    SenderClockSource senderClock = SenderClockSource::None;  // None: no sender latency
+    double senderLatencyMs = 0.0;  // Sender's clock at capture -> decoded
+    FrameTimeline timeline;
 
     ~VideoFrame() {
         delete[] data;
@@ -40,11 +61,31 @@ struct StreamInfo {
     int bitrate = 0;
 };
 
+// Pipeline stages tracked with per-stage latency histograms
+enum class PipelineStage {
+    Transfer,   // First -> last packet of a frame reaching the socket (batched UDP input)
+    Ingest,     // Last packet's kernel arrival -> demuxed (batched UDP input)
+    Demux,      // av_read_frame
+    Decode,     // avcodec_send_packet -> avcodec_receive_frame
+    Convert,    // sws_scale to RGB
+    QueueWait,  // Frame queue push -> getFrame
+    Render,     // Texture upload on the UI thread
+    Count
+};
+
+constexpr size_t PIPELINE_STAGE_COUNT = static_cast<size_t>(PipelineStage::Count);
+
+const char* pipelineStageName(PipelineStage stage);  // Display label ("Queue wait")
+const char* pipelineStageKey(PipelineStage stage);   // Export key ("queue_wait")
+
+using StageHistograms = std::array<LatencyHistogram, PIPELINE_STAGE_COUNT>;
+
 struct DecodeStats {
     // Decoding method
     std::string decoderName;           // Full decoder name (e.g., "h264", "h264_cuvid")
     bool isHardwareAccelerated = false;
     std::string hwAccelType;           // "None", "CUDA", "DXVA2", "D3D11VA", etc.
+    std::string threading;             // Threading FFmpeg actually used (e.g. "Slice x2")
 
     // Timing stats (in microseconds)
     double avgDecodeTimeUs = 0.0;
@@ -64,6 +105,27 @@ struct DecodeStats {
     // Network/demux stats
     double avgDemuxTimeUs = 0.0;
     double avgConvertTimeUs = 0.0;     // RGB conversion time
+
+    // Per-stage percentiles since connect or the last resetStageHistograms()
+    std::array<LatencyPercentiles, PIPELINE_STAGE_COUNT> stageLatency;
+    double stageWindowSec = 0.0;       // Time covered by the stage histograms
+
+    // Decoder health: packets the decoder failed on, and frames it output
+    // with concealed errors (AV_FRAME_FLAG_CORRUPT or decode_error_flags)
+    uint64_t decodeErrors = 0;
+    uint64_t corruptFrames = 0;
+
+    // Sender-to-decode latency against the sender's wall clock, for streams
+    // with RTCP sender reports or ONVIF timestamps
+    SenderClockSource senderClock = SenderClockSource::None;
+    double senderLatencyMs = 0.0;      // Last frame
+
+    // Batched UDP input (StreamConfig::udpReceive), zero on FFmpeg's own
+    bool hasRtpStats = false;
+    RtpStreamStats rtp;
+    uint64_t udpPackets = 0;
+    uint64_t udpKernelDrops = 0;       // Overflowed the socket buffer
+    double udpPacketsPerCall = 0.0;
 };
 
 class VideoDecoder {
@@ -76,12 +138,38 @@ public:
     void disconnect();
     bool isConnected() const { return connected_; }
 
+    // Decode on a shared worker pool instead of the demux thread (set before connect).
+    // Demuxing stays on a per-stream thread; packets are decoded by pool workers,
+    // at most one task per stream at a time.
+    void setWorkerPool(WorkerPool* pool);
+
+    // Keep recent compressed packets for dumping to a file (set before connect)
+    void setPacketRecorder(PacketRecorder* recorder);
+
+    // Called on the decoding thread for every converted frame, before it is queued
+    using FrameCallback = std::function<void(const VideoFrame&)>;
+    void setFrameCallback(FrameCallback callback);
+
     // Pause/resume decoding (stops frame processing without disconnecting)
     void setPaused(bool paused);
     bool isPaused() const { return paused_; }
 
+    // Every converted frame is published here. getFrame() reads the decoder's
+    // own "display" subscription; other consumers subscribe with their own
+    // depth and drop policy (any time, across reconnects) and share the frame.
+    FrameBus& getFrameBus() { return frameBus_; }
+    static constexpr const char* DISPLAY_QUEUE = "display";
+
     // Get next decoded frame (returns nullptr if none available)
-    std::unique_ptr<VideoFrame> getFrame();
+    SharedFrame getFrame();
+
+    // Local files are decoded offline: as fast as frames are taken from the
+    // queue, never dropping one, until the end of the file
+    bool isOffline() const { return offline_; }
+    bool isEndOfStream() const { return endOfStream_; }
+
+    // Block up to timeoutMs for the next frame (nullptr on timeout or end of stream)
+    SharedFrame waitForFrame(int timeoutMs);
 
     // Get stream information
     const StreamInfo& getStreamInfo() const { return streamInfo_; }
@@ -90,12 +178,27 @@ public:
     // Get decode statistics (thread-safe copy)
     DecodeStats getDecodeStats() const;
 
+    // Stage histograms: record a stage timed outside the decoder (e.g. Render),
+    // reset without reconnecting, or copy out for export
+    void recordStageTime(PipelineStage stage, double timeUs);
+    void resetStageHistograms();
+    StageHistograms getStageHistograms() const;
+
     // Get detected stream protocol
     StreamProtocol getDetectedProtocol() const { return detectedProtocol_; }
 
+    // RTP is read by RtpUdpInput (recvmmsg) rather than FFmpeg's UDP handler
+    bool isBatchedUdp() const { return udpInput_ != nullptr; }
+
     // Get connection diagnostics (populated after connect attempt)
     const ConnectionDiagnostics& getConnectionDiagnostics() const { return diagnostics_; }
 
+    // Apply a threading mode/count to a codec context before avcodec_open2
+    static void configureThreading(AVCodecContext* ctx, DecoderThreading threading, int threadCount);
+
+    // Describe the threading FFmpeg chose after avcodec_open2 (e.g. "Frame x4")
+    static std::string describeActiveThreading(const AVCodecContext* ctx);
+
 private:
     // Detect protocol from URL scheme
     StreamProtocol detectProtocol(const std::string& url) const;
@@ -103,8 +206,25 @@ private:
     void cleanupConnection();
     void buildDiagnosticSuggestions();
     void decodeThread();
-    bool openCodec();
+    // Timing of a demuxed packet, kept by pts until its frame is decoded
+    struct PacketTiming {
+        int64_t pts = 0;
+        bool kernelArrival = false;
+        std::chrono::steady_clock::time_point firstPacket;
+        std::chrono::steady_clock::time_point demuxed;
+        int64_t senderNs = 0;          // Sender's wall clock, 0 if unknown
+        SenderClockSource senderSource = SenderClockSource::None;
+    };
+
+    void recordArrival(const AVPacket* packet, PacketTiming& timing);
+    void notePacketTiming(const PacketTiming& timing);
+    bool takePacketTiming(int64_t pts, PacketTiming& timing);
+    void decodePacket(AVPacket* packet, double demuxTimeUs);
+    void submitPacket(AVPacket* packet, double demuxTimeUs);
+    void drainPendingPackets();
+    bool openCodec(const StreamConfig& config);
     std::unique_ptr<VideoFrame> convertFrame(AVFrame* frame);
+    SharedFrame dequeued(BusFrame frame);
 
     AVFormatContext* formatCtx_ = nullptr;
     AVCodecContext* codecCtx_ = nullptr;
@@ -120,11 +240,49 @@ private:
     std::atomic<bool> running_{false};
     std::atomic<bool> connected_{false};
     std::atomic<bool> paused_{false};
+    std::atomic<bool> endOfStream_{false};
+    bool offline_ = false;
+
+    // Container clock of the video stream, for VideoFrame::ptsMs
+    int64_t streamStartPts_ = 0;
+    double timeBaseSec_ = 0.0;
 
-    std::queue<std::unique_ptr<VideoFrame>> frameQueue_;
-    std::mutex queueMutex_;
-    std::condition_variable queueCv_;
+    FrameBus frameBus_;
+    std::shared_ptr<FrameSubscription> displayQueue_;   // Reopened on each connect
+    uint64_t displayDropped_ = 0;                       // Display drops already counted in decodeStats_
     static constexpr size_t MAX_QUEUE_SIZE = 4;
+    static constexpr size_t OFFLINE_QUEUE_SIZE = 16;
+
+    // Batched UDP input, owned for the connection; formatCtx_ reads through it
+    std::unique_ptr<RtpUdpInput> udpInput_;
+
+    // RTP accounting of the batched input; outlives it so counters stay
+    // readable after a disconnect. Replaced under statsMutex_.
+    std::unique_ptr<RtpStreamMonitor> rtpMonitor_;
+
+    // Demuxed packets waiting for their frame
+    std::deque<PacketTiming> packetTimings_;
+    std::mutex timingMutex_;
+    double senderClockOffsetMs_ = 0.0;
+    static constexpr size_t MAX_PACKET_TIMINGS = 64;
+
+    AVFrame* decodeFrame_ = nullptr;
+    FrameCallback frameCallback_;
+    PacketRecorder* packetRecorder_ = nullptr;
+
+    // Worker pool mode: compressed packets waiting for a pool worker
+    struct PendingPacket {
+        AVPacket* packet = nullptr;
+        double demuxTimeUs = 0.0;
+    };
+    WorkerPool* workerPool_ = nullptr;
+    std::deque<PendingPacket> pendingPackets_;
+    std::mutex pendingMutex_;
+    std::condition_variable pendingCv_;
+    bool decodeScheduled_ = false;
+    bool resyncToKeyframe_ = false;
+    static constexpr size_t MAX_PENDING_PACKETS = 60;
+    static constexpr int MAX_PACKETS_PER_TASK = 4;
 
     // Decode statistics
     DecodeStats decodeStats_;
@@ -133,6 +291,10 @@ private:
     double totalDecodeTimeUs_ = 0.0;
     double totalDemuxTimeUs_ = 0.0;
     double totalConvertTimeUs_ = 0.0;
+    StageHistograms stageHistograms_;
+    std::atomic<uint64_t> decodeErrors_{0};
+    std::atomic<uint64_t> corruptFrames_{0};
+    std::chrono::steady_clock::time_point stageHistogramsStart_;
 };
 
 } // namespace latency
@@ -15,7 +15,7 @@ bool VideoRenderer::init(SDL_Renderer* renderer) {
     return renderer_ != nullptr;
 }
 
-void VideoRenderer::updateFrame(std::unique_ptr<VideoFrame> frame) {
+void VideoRenderer::updateFrame(SharedFrame frame) {
     if (!frame) return;
 
     // Recreate texture if dimensions changed
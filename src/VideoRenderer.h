@@ -15,7 +15,7 @@ public:
     void render(int x, int y, int width, int height);
 
     // Update with new frame
-    void updateFrame(std::unique_ptr<VideoFrame> frame);
+    void updateFrame(SharedFrame frame);
 
     // Get current frame data for analysis
     const VideoFrame* getCurrentFrame() const { return currentFrame_.get(); }
@@ -28,7 +28,7 @@ private:
     SDL_Renderer* renderer_ = nullptr;
     SDL_Texture* texture_ = nullptr;
 
-    std::unique_ptr<VideoFrame> currentFrame_;
+    SharedFrame currentFrame_;   // Shared with the decoder's other frame consumers
     int textureWidth_ = 0;
     int textureHeight_ = 0;
 };
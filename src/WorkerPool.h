@@ -0,0 +1,38 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace latency {
+
+// Fixed-size thread pool with a FIFO task queue. Used to bound the number
+// of threads doing CPU work when many streams are decoded at once.
+class WorkerPool {
+public:
+    // threadCount == 0 picks hardware_concurrency() - 1 (at least 1)
+    explicit WorkerPool(size_t threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    size_t getThreadCount() const { return workers_.size(); }
+    size_t getPendingTasks() const;
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
+
+} // namespace latency
@@ -1,8 +1,411 @@
 #include "App.h"
+#include "DecoderBenchmark.h"
+#include "FleetSurvey.h"
+#include "ImpairmentProxy.h"
+#include "LoopbackBenchmark.h"
+#include "OfflineAnalyzer.h"
+#include "ReplayBenchmark.h"
+#include "ResultsHistory.h"
+#include "StreamManager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// The executable is built for the GUI subsystem on Windows, which starts
+// without stdout/stderr; reattach them to the launching console so the
+// command-line modes' reports and errors are visible
+static void attachParentConsole() {
+#ifdef _WIN32
+    if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+        freopen("CONOUT$", "w", stdout);
+        freopen("CONOUT$", "w", stderr);
+    }
+#endif
+}
+
+static bool parseThreading(const std::string& value, latency::DecoderThreading& out) {
+    if (value == "auto")  { out = latency::DecoderThreading::AUTO;  return true; }
+    if (value == "frame") { out = latency::DecoderThreading::FRAME; return true; }
+    if (value == "slice") { out = latency::DecoderThreading::SLICE; return true; }
+    if (value == "none")  { out = latency::DecoderThreading::NONE;  return true; }
+    return false;
+}
+
+static bool parseSize(const std::string& value, int& width, int& height) {
+    size_t x = value.find('x');
+    if (x == std::string::npos) return false;
+    width = std::atoi(value.substr(0, x).c_str());
+    height = std::atoi(value.substr(x + 1).c_str());
+    return width > 0 && height > 0;
+}
+
+static void printUsage() {
+    std::cout <<
+        "Usage:\n"
+        "  LatencyTestTool [--decoder-threads N] [--decoder-threading auto|frame|slice|none]\n"
+        "                  [--buffer-seconds S] [--buffer-mb MB] [--spike-threshold MS]\n"
+        "                  [--udp-batched] [--udp-rcvbuf KB] [--udp-batch N] [--busy-poll US]\n"
+        "                  [--sender-clock-offset MS] [--display-lag MS] [--no-text-atlas]\n"
+        "                  [--flash] [--no-ocr] [--pattern-rows 1|2|3] [--warmup-frames N]\n"
+        "                  [--history results/history.jsonl]\n"
+        "                  [--export-frames NAME] [--export-slots N] [--export-max-size WxH]\n"
+        "  LatencyTestTool --streams <url-list.txt> [--workers N]\n"
+        "  LatencyTestTool --survey <url-list.txt> [--workers N] [--duration S] [--output report.json]\n"
+        "  LatencyTestTool --benchmark-decoder <clip> [--output report.json] [--frames N]\n"
+        "  LatencyTestTool --analyze <recording> [--analyze ...] [--clock-offset MS]\n"
+        "                  [--workers N] [--output report.json]\n"
+        "  LatencyTestTool --read-screenshot <screenshot.bmp> [--read-screenshot ...]\n"
+        "  LatencyTestTool --history-list [stream-url] [--history results/history.jsonl]\n"
+        "  LatencyTestTool --compare <baseline-id> <candidate-id> [--workers N] [--history ...]\n"
+        "  LatencyTestTool --compare-last <stream-url> [--workers N] [--history ...]\n"
+        "  LatencyTestTool --loopback-benchmark [rtp://127.0.0.1:5004 | rtsp://127.0.0.1:8554/test]\n"
+        "                  [--duration S] [--output report.json] [source options]\n"
+        "  LatencyTestTool --test-source <rtp://host:port | rtsp://host:port/path>\n"
+        "                  [--duration S] [--sdp file.sdp] [source options]\n"
+        "\n"
+        "  LatencyTestTool --impair-only --impair <relay> [--duration S] [impairment options]\n"
+        "  LatencyTestTool --replay <capture.pcap> [--replay-speed X] [--replay-port N]\n"
+        "                  [--sdp stream.sdp] [--output report.json]\n"
+        "\n"
+        "Source options: [--source-codec h264|hevc|mjpeg] [--source-size WxH] [--source-fps N]\n"
+        "                [--source-gop N] [--source-bitrate KBPS]\n"
+        "\n"
+        "Impairment relay (any mode): --impair udp|tcp:LISTEN_PORT:HOST:PORT\n"
+        "                [--impair-delay MS] [--impair-jitter MS]\n"
+        "                [--impair-distribution constant|uniform|normal|pareto]\n"
+        "                [--impair-loss PCT] [--impair-burst N] [--impair-reorder PCT]\n"
+        "                [--impair-bandwidth KBPS] [--impair-queue MS] [--impair-seed N]\n"
+        "                [--impair-log packets.csv] [--capture packets.pcap]\n";
+}
+
+// Run only the impairment relay, for receivers outside this process
+static int runImpairmentRelay(const latency::ImpairmentConfig& impairment, int durationSec) {
+    latency::ImpairmentProxy proxy;
+    if (!proxy.start(impairment)) {
+        std::cerr << proxy.getLastError() << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (durationSec <= 0 || std::chrono::steady_clock::now() - start < std::chrono::seconds(durationSec)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    auto stats = proxy.getStats();
+    proxy.stop();
+    std::cout << stats.packetsIn << " packets in, " << stats.packetsForwarded << " forwarded, "
+              << stats.packetsLost << " lost, " << stats.packetsOverflow << " overflowed, "
+              << stats.packetsReordered << " reordered" << std::endl;
+    return 0;
+}
+
+// Stream the timestamp pattern to external receivers until stopped
+// (or for --duration seconds)
+static int runTestSource(const latency::TestSourceConfig& sourceConfig, int durationSec) {
+    latency::TestPatternSource source;
+    if (!source.start(sourceConfig)) {
+        std::cerr << source.getLastError() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Streaming " << sourceConfig.width << "x" << sourceConfig.height << "@"
+              << sourceConfig.fps << " " << source.getEncoderName() << " to " << sourceConfig.url;
+    if (sourceConfig.url.find("rtp://") == 0) {
+        std::cout << " (SDP: " << sourceConfig.sdpPath << ")";
+    }
+    std::cout << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    while (source.isRunning()) {
+        if (durationSec > 0 && std::chrono::steady_clock::now() - start >= std::chrono::seconds(durationSec)) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    bool failed = !source.isRunning();
+    std::string error = source.getLastError();
+    source.stop();
+    if (failed) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Run the test source and the receiver in one process and report the
+// ground-truth latency split between encode and the receiving pipeline
+static int runLoopbackBenchmark(const latency::LoopbackBenchmarkConfig& benchmarkConfig,
+                                const std::string& output) {
+    latency::LoopbackBenchmark benchmark;
+    latency::LoopbackBenchmarkResult result;
+    if (!benchmark.run(benchmarkConfig, result)) {
+        std::cerr << benchmark.getLastError() << std::endl;
+        return 1;
+    }
+
+    std::cout << latency::LoopbackBenchmark::formatSummary(result);
+
+    if (!output.empty()) {
+        if (!latency::LoopbackBenchmark::writeReport(output, result)) {
+            std::cerr << "Failed to write report: " << output << std::endl;
+            return 1;
+        }
+        std::cout << "\nReport written: " << output << std::endl;
+    }
+    return 0;
+}
+
+// Feed a packet capture into the decoder with its original timing and
+// report how the receiving pipeline handled it
+static int runReplay(const latency::ReplayBenchmarkConfig& replayConfig, const std::string& output) {
+    latency::ReplayBenchmark benchmark;
+    latency::ReplayBenchmarkResult result;
+    if (!benchmark.run(replayConfig, result)) {
+        std::cerr << benchmark.getLastError() << std::endl;
+        return 1;
+    }
+
+    std::cout << latency::ReplayBenchmark::formatSummary(result);
+
+    if (!output.empty()) {
+        if (!latency::ReplayBenchmark::writeReport(output, result)) {
+            std::cerr << "Failed to write report: " << output << std::endl;
+            return 1;
+        }
+        std::cout << "\nReport written: " << output << std::endl;
+    }
+    return 0;
+}
+
+// Measure latency from recordings of the camera feed, faster than real time.
+// Each report goes to <recording>.latency.json unless --output names one.
+static int runOfflineAnalysis(const std::vector<std::string>& files, const std::string& output,
+                              const latency::OfflineAnalysisOptions& options) {
+    if (!output.empty() && files.size() > 1) {
+        std::cerr << "--output takes a single --analyze file" << std::endl;
+        return 1;
+    }
+
+    latency::OfflineAnalyzer analyzer(options);
+    int failures = 0;
+
+    for (const auto& file : files) {
+        latency::OfflineAnalysisResult result;
+        if (!analyzer.analyze(file, result)) {
+            std::cerr << file << ": " << analyzer.getLastError() << std::endl;
+            failures++;
+            continue;
+        }
+
+        std::cout << latency::OfflineAnalyzer::formatSummary(result);
+
+        std::string reportPath = output.empty() ? file + ".latency.json" : output;
+        if (!latency::OfflineAnalyzer::writeReport(reportPath, result)) {
+            std::cerr << "Failed to write report: " << reportPath << std::endl;
+            failures++;
+            continue;
+        }
+        std::cout << "Report written: " << reportPath << "\n" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// MM:SS.cc as the clock panel shows a time within the hour
+static std::string formatClock(uint32_t timestamp) {
+    std::ostringstream oss;
+    oss << std::setfill('0') << std::setw(2) << timestamp / 60000 << ":" << std::setw(2)
+        << (timestamp / 1000) % 60 << "." << std::setw(2) << (timestamp % 1000) / 10;
+    return oss.str();
+}
+
+// Read the latency off freeze-frame screenshots: the panel's clock (left)
+// against the camera's view of it. One tab-separated line per file.
+static int runScreenshotReading(const std::vector<std::string>& files, const std::string& fontPath, int fontSize) {
+    if (TTF_Init() < 0) {
+        std::cerr << "TTF_Init failed: " << TTF_GetError() << std::endl;
+        return 1;
+    }
+    TTF_Font* font = TTF_OpenFont(fontPath.c_str(), fontSize * 2);  // The panel's clock size
+    latency::ClockReader reader;
+    bool ready = font && reader.init(font);
+    if (font) TTF_CloseFont(font);
+    TTF_Quit();
+    if (!ready) {
+        std::cerr << "Cannot build digit templates from " << fontPath << std::endl;
+        return 1;
+    }
+
+    int failures = 0;
+    std::cout << "file\tpanel\tvideo\tlatency_ms" << std::endl;
+    for (const auto& file : files) {
+        SDL_Surface* loaded = SDL_LoadBMP(file.c_str());
+        SDL_Surface* rgb = loaded ? SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGB24, 0) : nullptr;
+        if (loaded) SDL_FreeSurface(loaded);
+        if (!rgb) {
+            std::cerr << file << ": " << SDL_GetError() << std::endl;
+            failures++;
+            continue;
+        }
+
+        latency::VideoFrame frame;
+        frame.width = rgb->w;
+        frame.height = rgb->h;
+        frame.pitch = rgb->pitch;
+        frame.data = new uint8_t[static_cast<size_t>(rgb->pitch) * rgb->h];
+        SDL_LockSurface(rgb);
+        std::memcpy(frame.data, rgb->pixels, static_cast<size_t>(rgb->pitch) * rgb->h);
+        SDL_UnlockSurface(rgb);
+        SDL_FreeSurface(rgb);
+
+        auto readings = reader.readAll(frame);
+        if (readings.size() < 2) {
+            std::cerr << file << ": " << readings.size() << " readable clock(s), need the panel's and the video's"
+                      << std::endl;
+            failures++;
+            continue;
+        }
+
+        // The frozen panel shows the later time
+        const auto& panel = readings[0];
+        const auto& video = readings[1];
+        uint32_t latency = (panel.timestamp + latency::ClockReader::CLOCK_WRAP_MS - video.timestamp) %
+                           latency::ClockReader::CLOCK_WRAP_MS;
+        std::cout << file << "\t" << formatClock(panel.timestamp) << "\t" << formatClock(video.timestamp)
+                  << "\t" << latency << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// List the stored runs, oldest first, optionally of one stream
+static int runHistoryList(const std::string& historyPath, const std::string& streamUrl) {
+    latency::ResultsHistory history;
+    if (!history.load(historyPath)) {
+        std::cerr << history.getLastError() << std::endl;
+        return 1;
+    }
+
+    latency::HistoryQuery query;
+    query.streamUrl = streamUrl;
+    auto runs = history.find(query);
+    for (const auto* run : runs) {
+        std::cout << latency::ResultsHistory::formatRun(*run) << std::endl;
+    }
+    std::cout << runs.size() << " of " << history.size() << " runs in " << historyPath << std::endl;
+    return 0;
+}
+
+// Compare two stored runs by test ID, or a stream's latest run against the
+// one before it when baselineId is empty. Exits 2 on a regression, for
+// scripts that gate firmware rollouts on it.
+static int runHistoryCompare(const std::string& historyPath, const std::string& baselineId,
+                             const std::string& candidateId, const std::string& streamUrl, int threads) {
+    latency::ResultsHistory history;
+    if (!history.load(historyPath)) {
+        std::cerr << history.getLastError() << std::endl;
+        return 1;
+    }
+
+    const latency::HistoryRun* baseline = nullptr;
+    const latency::HistoryRun* candidate = nullptr;
+    if (!streamUrl.empty()) {
+        latency::HistoryQuery query;
+        query.streamUrl = streamUrl;
+        auto runs = history.find(query);
+        if (runs.empty()) {
+            std::cerr << "No runs of " << streamUrl << " in " << historyPath << std::endl;
+            return 1;
+        }
+        candidate = runs.back();
+        baseline = history.findPrevious(*candidate);
+        if (!baseline) {
+            std::cerr << "No earlier run of " << streamUrl << " with the same codec and resolution" << std::endl;
+            return 1;
+        }
+    } else {
+        baseline = history.findById(baselineId);
+        candidate = history.findById(candidateId);
+        if (!baseline || !candidate) {
+            std::cerr << "Run not found in " << historyPath << ": "
+                      << (!baseline ? baselineId : candidateId) << std::endl;
+            return 1;
+        }
+    }
+
+    auto comparison = latency::ResultsHistory::compare(*baseline, *candidate,
+                                                       latency::ResultsHistory::BOOTSTRAP_RESAMPLES,
+                                                       static_cast<size_t>(std::max(0, threads)));
+    std::cout << latency::ResultsHistory::formatComparison(comparison);
+    return comparison.regression ? 2 : 0;
+}
+
+// Probe every camera in a list without decoding and write one site report
+static int runSurvey(const std::string& listPath, const latency::SurveyConfig& surveyConfig,
+                     const std::string& output) {
+    std::vector<std::string> urls;
+    if (!latency::StreamManager::loadStreamList(listPath, urls) || urls.empty()) {
+        std::cerr << "Cannot read stream list: " << listPath << std::endl;
+        return 1;
+    }
+
+    std::cout << "Surveying " << urls.size() << " cameras, " << surveyConfig.concurrency
+              << " at a time..." << std::endl;
+
+    latency::FleetSurvey survey(surveyConfig);
+    auto start = std::chrono::steady_clock::now();
+    auto results = survey.run(urls, [&](const latency::SurveyResult& result, size_t finished) {
+        std::cout << "[" << finished << "/" << urls.size() << "] "
+                  << latency::FleetSurvey::formatLine(result) << std::endl;
+    });
+    double wallTimeSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "\n" << latency::FleetSurvey::formatTable(results);
+
+    std::string reportPath = output.empty() ? listPath + ".survey.json" : output;
+    if (!survey.writeReport(reportPath, results, wallTimeSec)) {
+        std::cerr << "Failed to write report: " << reportPath << std::endl;
+        return 1;
+    }
+    std::cout << "Report written: " << reportPath << std::endl;
+    return 0;
+}
+
+// Decode a recorded clip under each threading configuration and report
+// throughput next to per-frame decoder delay
+static int runDecoderBenchmark(const std::string& clip, const std::string& output, int maxFrames) {
+    latency::DecoderBenchmark benchmark;
+    if (!benchmark.loadClip(clip, maxFrames)) {
+        std::cerr << benchmark.getLastError() << std::endl;
+        return 1;
+    }
+
+    auto results = benchmark.runAll(latency::DecoderBenchmark::defaultCases());
+    std::cout << benchmark.formatTable(results);
+
+    if (!output.empty()) {
+        if (!benchmark.writeReport(output, results)) {
+            std::cerr << "Failed to write report: " << output << std::endl;
+            return 1;
+        }
+        std::cout << "\nReport written: " << output << std::endl;
+    }
+    return 0;
+}
 
 int main(int argc, char* argv[]) {
-    (void)argc;
-    (void)argv;
+    if (argc > 1) {
+        attachParentConsole();
+    }
 
     latency::AppConfig config;
     config.windowWidth = 1280;
@@ -11,6 +414,245 @@ int main(int argc, char* argv[]) {
     config.fontPath = "resources/fonts/RobotoMono-Bold.ttf";
     config.fontSize = 36;
 
+    std::string benchmarkClip;
+    std::string outputPath;
+    int benchmarkFrames = 1500;
+    std::vector<std::string> analyzeFiles;
+    std::vector<std::string> screenshotFiles;
+    latency::OfflineAnalysisOptions analysisOptions;
+    bool loopbackBenchmark = false;
+    bool testSource = false;
+    int durationSec = 0;
+    bool impairOnly = false;
+    std::string surveyList;
+    bool historyList = false;
+    std::string historyStream;
+    std::string compareBaseline;
+    std::string compareCandidate;
+    latency::ReplayBenchmarkConfig replayConfig;
+    latency::TestSourceConfig sourceConfig;
+    sourceConfig.fontPath = config.fontPath;
+    sourceConfig.fontSize = config.fontSize;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--decoder-threads" && hasValue) {
+            config.decoderThreadCount = std::atoi(argv[++i]);
+        } else if (arg == "--decoder-threading" && hasValue) {
+            if (!parseThreading(argv[++i], config.decoderThreading)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--buffer-seconds" && hasValue) {
+            config.packetBufferSec = std::atof(argv[++i]);
+        } else if (arg == "--buffer-mb" && hasValue) {
+            config.packetBufferMaxMB = std::atoi(argv[++i]);
+        } else if (arg == "--spike-threshold" && hasValue) {
+            config.spikeThresholdMs = std::atoi(argv[++i]);
+        } else if (arg == "--udp-batched") {
+            config.udpReceive.enabled = true;
+        } else if (arg == "--udp-rcvbuf" && hasValue) {
+            config.udpReceive.socketBufferKB = std::atoi(argv[++i]);
+        } else if (arg == "--udp-batch" && hasValue) {
+            config.udpReceive.batchSize = std::atoi(argv[++i]);
+        } else if (arg == "--busy-poll" && hasValue) {
+            config.udpReceive.busyPollUs = std::atoi(argv[++i]);
+        } else if (arg == "--sender-clock-offset" && hasValue) {
+            config.senderClockOffsetMs = std::atof(argv[++i]);
+        } else if (arg == "--display-lag" && hasValue) {
+            config.displayLagMs = std::atof(argv[++i]);
+        } else if (arg == "--no-text-atlas") {
+            config.textAtlas = false;
+        } else if (arg == "--flash") {
+            config.flashMode = true;
+        } else if (arg == "--no-ocr") {
+            config.clockOcr = false;
+        } else if (arg == "--pattern-rows" && hasValue) {
+            config.patternRows = std::atoi(argv[++i]);
+        } else if (arg == "--warmup-frames" && hasValue) {
+            config.test.warmupFrames = std::atoi(argv[++i]);
+        } else if (arg == "--export-frames" && hasValue) {
+            config.frameExportName = argv[++i];
+        } else if (arg == "--export-slots" && hasValue) {
+            config.frameExportSlots = std::atoi(argv[++i]);
+        } else if (arg == "--export-max-size" && hasValue) {
+            if (!parseSize(argv[++i], config.frameExportMaxWidth, config.frameExportMaxHeight)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--streams" && hasValue) {
+            std::string listPath = argv[++i];
+            if (!latency::StreamManager::loadStreamList(listPath, config.streamUrls)) {
+                std::cerr << "Cannot read stream list: " << listPath << std::endl;
+                return 1;
+            }
+        } else if (arg == "--workers" && hasValue) {
+            config.workerThreads = std::atoi(argv[++i]);
+            analysisOptions.measureThreads = config.workerThreads;
+        } else if (arg == "--history" && hasValue) {
+            config.historyPath = argv[++i];
+        } else if (arg == "--history-list") {
+            historyList = true;
+            if (hasValue && argv[i + 1][0] != '-') {
+                historyStream = argv[++i];
+            }
+        } else if (arg == "--compare" && i + 2 < argc) {
+            compareBaseline = argv[++i];
+            compareCandidate = argv[++i];
+        } else if (arg == "--compare-last" && hasValue) {
+            historyStream = argv[++i];
+        } else if (arg == "--survey" && hasValue) {
+            surveyList = argv[++i];
+        } else if (arg == "--analyze" && hasValue) {
+            analyzeFiles.push_back(argv[++i]);
+        } else if (arg == "--read-screenshot" && hasValue) {
+            screenshotFiles.push_back(argv[++i]);
+        } else if (arg == "--clock-offset" && hasValue) {
+            analysisOptions.hasClockOffset = true;
+            analysisOptions.clockOffsetMs = std::atoll(argv[++i]);
+        } else if (arg == "--benchmark-decoder" && hasValue) {
+            benchmarkClip = argv[++i];
+        } else if (arg == "--output" && hasValue) {
+            outputPath = argv[++i];
+        } else if (arg == "--frames" && hasValue) {
+            benchmarkFrames = std::atoi(argv[++i]);
+        } else if (arg == "--loopback-benchmark") {
+            loopbackBenchmark = true;
+            if (hasValue && argv[i + 1][0] != '-') {
+                sourceConfig.url = argv[++i];
+            }
+        } else if (arg == "--test-source" && hasValue) {
+            testSource = true;
+            sourceConfig.url = argv[++i];
+        } else if (arg == "--duration" && hasValue) {
+            durationSec = std::atoi(argv[++i]);
+        } else if (arg == "--sdp" && hasValue) {
+            sourceConfig.sdpPath = argv[++i];
+            replayConfig.sdpPath = sourceConfig.sdpPath;
+        } else if (arg == "--source-codec" && hasValue) {
+            sourceConfig.codec = argv[++i];
+        } else if (arg == "--source-size" && hasValue) {
+            if (!parseSize(argv[++i], sourceConfig.width, sourceConfig.height)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--source-fps" && hasValue) {
+            sourceConfig.fps = std::atoi(argv[++i]);
+        } else if (arg == "--source-gop" && hasValue) {
+            sourceConfig.gop = std::atoi(argv[++i]);
+        } else if (arg == "--source-bitrate" && hasValue) {
+            sourceConfig.bitrateKbps = std::atoi(argv[++i]);
+        } else if (arg == "--impair" && hasValue) {
+            if (!latency::ImpairmentProxy::parseRelaySpec(argv[++i], config.impairment)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--impair-only") {
+            impairOnly = true;
+        } else if (arg == "--impair-delay" && hasValue) {
+            config.impairment.delayMs = std::atof(argv[++i]);
+        } else if (arg == "--impair-jitter" && hasValue) {
+            config.impairment.jitterMs = std::atof(argv[++i]);
+        } else if (arg == "--impair-distribution" && hasValue) {
+            if (!latency::ImpairmentProxy::parseDistribution(argv[++i], config.impairment.distribution)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--impair-loss" && hasValue) {
+            config.impairment.lossPercent = std::atof(argv[++i]);
+        } else if (arg == "--impair-burst" && hasValue) {
+            config.impairment.lossBurst = std::atof(argv[++i]);
+        } else if (arg == "--impair-reorder" && hasValue) {
+            config.impairment.reorderPercent = std::atof(argv[++i]);
+        } else if (arg == "--impair-bandwidth" && hasValue) {
+            config.impairment.bandwidthKbps = std::atof(argv[++i]);
+        } else if (arg == "--impair-queue" && hasValue) {
+            config.impairment.queueLimitMs = std::atoi(argv[++i]);
+        } else if (arg == "--impair-seed" && hasValue) {
+            config.impairment.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--impair-log" && hasValue) {
+            config.impairment.logPath = argv[++i];
+        } else if (arg == "--capture" && hasValue) {
+            config.impairment.capturePath = argv[++i];
+        } else if (arg == "--replay" && hasValue) {
+            replayConfig.pcapPath = argv[++i];
+        } else if (arg == "--replay-speed" && hasValue) {
+            replayConfig.speed = std::atof(argv[++i]);
+        } else if (arg == "--replay-port" && hasValue) {
+            replayConfig.port = std::atoi(argv[++i]);
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (!benchmarkClip.empty()) {
+        return runDecoderBenchmark(benchmarkClip, outputPath, benchmarkFrames);
+    }
+
+    if (!analyzeFiles.empty()) {
+        return runOfflineAnalysis(analyzeFiles, outputPath, analysisOptions);
+    }
+
+    if (!screenshotFiles.empty()) {
+        return runScreenshotReading(screenshotFiles, config.fontPath, config.fontSize);
+    }
+
+    if (historyList) {
+        return runHistoryList(config.historyPath, historyStream);
+    }
+
+    if (!compareBaseline.empty() || !historyStream.empty()) {
+        return runHistoryCompare(config.historyPath, compareBaseline, compareCandidate, historyStream,
+                                 config.workerThreads);
+    }
+
+    if (!surveyList.empty()) {
+        latency::SurveyConfig surveyConfig;
+        if (config.workerThreads > 0) {
+            surveyConfig.concurrency = config.workerThreads;
+        }
+        if (durationSec > 0) {
+            surveyConfig.sampleSec = durationSec;
+        }
+        return runSurvey(surveyList, surveyConfig, outputPath);
+    }
+
+    if (!config.impairment.capturePath.empty() && config.impairment.mode == latency::ImpairmentMode::NONE) {
+        std::cerr << "--capture records through the relay; add --impair" << std::endl;
+        return 1;
+    }
+
+    if (!replayConfig.pcapPath.empty()) {
+        replayConfig.decoderThreading = config.decoderThreading;
+        replayConfig.decoderThreadCount = config.decoderThreadCount;
+        replayConfig.udpReceive = config.udpReceive;
+        return runReplay(replayConfig, outputPath);
+    }
+
+    if (impairOnly) {
+        return runImpairmentRelay(config.impairment, durationSec);
+    }
+
+    if (testSource) {
+        return runTestSource(sourceConfig, durationSec);
+    }
+
+    if (loopbackBenchmark) {
+        latency::LoopbackBenchmarkConfig benchmarkConfig;
+        benchmarkConfig.source = sourceConfig;
+        benchmarkConfig.decoderThreading = config.decoderThreading;
+        benchmarkConfig.decoderThreadCount = config.decoderThreadCount;
+        benchmarkConfig.udpReceive = config.udpReceive;
+        benchmarkConfig.impairment = config.impairment;
+        if (durationSec > 0) {
+            benchmarkConfig.durationSec = durationSec;
+        }
+        return runLoopbackBenchmark(benchmarkConfig, outputPath);
+    }
+
     latency::App app;
 
     if (!app.init(config)) {
@@ -0,0 +1,85 @@
+// Regression checks for ChangePointDetector (standard library only).
+// Exits non-zero on the first failure.
+
+#include "ChangePointDetector.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using latency::ChangePointDetector;
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+bool near(size_t actual, size_t expected, size_t tolerance) {
+    return actual + tolerance >= expected && actual <= expected + tolerance;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> jitter(-8.0, 8.0);
+    std::uniform_real_distribution<double> quiet(-1.0, 1.0);
+
+    // A burst shorter than a baseline used to restart the same segment forever
+    {
+        ChangePointDetector detector;
+        for (int i = 0; i < 2000; i++) {
+            detector.add(i >= 500 && i < 506 ? 300.0 : 100.0 + jitter(rng));
+        }
+        check(detector.getChangePoints().size() <= 2, "short burst in a steady series");
+    }
+
+    // Likewise a short startup transient at the very start of the series
+    {
+        ChangePointDetector detector;
+        for (int i = 0; i < 2000; i++) {
+            detector.add(i < 8 ? 400.0 - 30.0 * i : 100.0 + jitter(rng));
+        }
+        check(detector.getChangePoints().size() <= 1, "short transient at the start");
+    }
+
+    // Quiet series: the drift is widened past the clip, which must not mute the sums
+    {
+        ChangePointDetector detector;
+        for (int i = 0; i < 2000; i++) {
+            detector.add((i < 1000 ? 100.0 : 200.0) + quiet(rng));
+        }
+        const auto& changes = detector.getChangePoints();
+        check(changes.size() == 1 && near(changes[0], 1000, 2), "step in a quiet series");
+    }
+
+    // Constant series (zero MAD) stepping up
+    {
+        ChangePointDetector detector;
+        for (int i = 0; i < 2000; i++) {
+            detector.add(i < 1000 ? 100.0 : 130.0);
+        }
+        const auto& changes = detector.getChangePoints();
+        check(changes.size() == 1 && near(changes[0], 1000, 2), "step in a constant series");
+    }
+
+    // A step after the settled history has been trimmed
+    {
+        ChangePointDetector detector;
+        for (int i = 0; i < 6000; i++) {
+            detector.add((i < 5000 ? 100.0 : 130.0) + quiet(rng));
+        }
+        const auto& changes = detector.getChangePoints();
+        check(changes.size() == 1 && near(changes[0], 5000, 2), "step after trimming");
+    }
+
+    if (failures == 0) {
+        std::printf("ChangePointDetector: all checks passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
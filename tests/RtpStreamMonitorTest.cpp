@@ -0,0 +1,88 @@
+// Regression checks for RtpStreamMonitor (standard library only).
+// Exits non-zero on the first failure.
+
+#include "RtpStreamMonitor.h"
+#include <cstdio>
+#include <vector>
+
+using latency::RtpStreamMonitor;
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// Video packets 40 ms apart in both timestamp and arrival, so jitter stays zero
+struct Sender {
+    RtpStreamMonitor monitor;
+    int64_t arrivalNs = 1700000000LL * 1000000000LL;
+    uint32_t timestamp = 1000;
+
+    void send(uint16_t sequence) {
+        uint8_t packet[12] = {0x80, 96,
+                              static_cast<uint8_t>(sequence >> 8), static_cast<uint8_t>(sequence),
+                              static_cast<uint8_t>(timestamp >> 24), static_cast<uint8_t>(timestamp >> 16),
+                              static_cast<uint8_t>(timestamp >> 8), static_cast<uint8_t>(timestamp)};
+        monitor.onPacket(packet, sizeof(packet), arrivalNs);
+        arrivalNs += 40000000;
+        timestamp += 3600;
+    }
+};
+
+} // namespace
+
+int main() {
+    // One stray packet far out of the window used to resync twice and count
+    // the jump back as loss
+    {
+        Sender sender;
+        for (uint16_t s = 100; s < 200; s++) {
+            sender.send(s);
+            if (s == 150) sender.send(40000);
+        }
+        auto stats = sender.monitor.getStats();
+        check(stats.sequenceResets == 0, "stray packet: no resync");
+        check(stats.lost == 0, "stray packet: no loss");
+        check(stats.packets == 100, "stray packet: not counted");
+        check(stats.jitterMs == 0.0, "stray packet: jitter untouched");
+    }
+
+    // A real restart: two packets in a row from the new base resync once
+    {
+        Sender sender;
+        for (uint16_t s = 100; s < 200; s++) {
+            sender.send(s);
+        }
+        for (uint16_t s = 30000; s < 30100; s++) {
+            sender.send(s);
+        }
+        auto stats = sender.monitor.getStats();
+        check(stats.sequenceResets == 1, "restart: one resync");
+        check(stats.lost == 0, "restart: no loss");
+    }
+
+    // Loss and reordering inside the window are still counted
+    {
+        Sender sender;
+        for (uint16_t s = 65500; s != 100; s++) {
+            if (s == 10 || s == 20) continue;
+            sender.send(s);
+            if (s == 30) sender.send(20);
+        }
+        auto stats = sender.monitor.getStats();
+        check(stats.lost == 1, "wrap: one lost");
+        check(stats.reordered == 1, "wrap: one reordered");
+        check(stats.sequenceResets == 0, "wrap: no resync");
+    }
+
+    if (failures == 0) {
+        std::printf("RtpStreamMonitor: all checks passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}